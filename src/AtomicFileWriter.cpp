@@ -0,0 +1,240 @@
+#include "AtomicFileWriter.h"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AtomicFileWriter::AtomicFileWriter() : file_(nullptr), createdTarget_(false), linked_(false), failed_(false) {}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    discard();
+}
+
+bool AtomicFileWriter::open(const std::string& path) {
+    discard();
+    failed_ = false;
+    linked_ = false;
+    error_.clear();
+#ifdef _WIN32
+    target_ = path;
+    temporary_ = path + ".litepad-tmp";
+    file_ = std::fopen(temporary_.c_str(), "wb");
+    if (!file_) {
+        fail("create temporary file");
+        temporary_.clear();
+        return false;
+    }
+    return true;
+#else
+    // 目标不存在时先按 umask 新建一个空文件，之后与已有文件走同一条路径
+    char resolved[PATH_MAX];
+    if (!::realpath(path.c_str(), resolved)) {
+        if (errno != ENOENT) {
+            fail("resolve path");
+            return false;
+        }
+        int created = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (created < 0) {
+            fail("create");
+            return false;
+        }
+        ::close(created);
+        createdTarget_ = true;
+        if (!::realpath(path.c_str(), resolved)) {
+            fail("resolve path");
+            discard();
+            return false;
+        }
+    }
+    target_ = resolved;
+    struct stat info;
+    if (::stat(target_.c_str(), &info) != 0) {
+        fail("stat");
+        discard();
+        return false;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        error_ = "not a regular file";
+        discard();
+        return false;
+    }
+    linked_ = info.st_nlink > 1;
+
+    size_t slash = target_.find_last_of('/');
+    std::string directory = target_.substr(0, slash + 1);
+    std::string name = target_.substr(slash + 1);
+    temporary_ = directory + "." + name + ".litepad-XXXXXX";
+    int fd = ::mkstemp(&temporary_[0]);
+    if (fd < 0) {
+        fail("create temporary file");
+        temporary_.clear();
+        discard();
+        return false;
+    }
+    // 先改所有者再改权限：改所有者会清除 setuid/setgid 位
+    const char* action = nullptr;
+    if (::fchown(fd, info.st_uid, info.st_gid) != 0) {
+        action = "fchown";
+    } else if (::fchmod(fd, info.st_mode & 07777) != 0) {
+        action = "fchmod";
+    }
+    file_ = action ? nullptr : ::fdopen(fd, "wb");
+    if (!file_) {
+        fail(action ? action : "create temporary file");
+        ::close(fd);
+        discard();
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool AtomicFileWriter::write(const char* data, size_t length) {
+    if (failed_ || !file_) {
+        return false;
+    }
+    if (length > 0 && std::fwrite(data, 1, length, file_) != length) {
+        fail("write");
+        return false;
+    }
+    return true;
+}
+
+bool AtomicFileWriter::commit() {
+    if (!file_) {
+        return false;
+    }
+    if (!failed_ && std::fflush(file_) != 0) {
+        fail("write");
+    }
+#ifndef _WIN32
+    if (!failed_ && ::fsync(::fileno(file_)) != 0) {
+        fail("fsync");
+    }
+#endif
+    if (std::fclose(file_) != 0 && !failed_) {
+        fail("close");
+    }
+    file_ = nullptr;
+    if (failed_) {
+        discard();
+        return false;
+    }
+
+#ifdef _WIN32
+    std::error_code error;
+    std::filesystem::rename(temporary_, target_, error);
+    if (error) {
+        failed_ = true;
+        error_ = "rename: " + error.message();
+        discard();
+        return false;
+    }
+#else
+    if (linked_ ? !copyToTarget() : std::rename(temporary_.c_str(), target_.c_str()) != 0) {
+        if (!linked_) {
+            fail("rename");
+        }
+        discard();
+        return false;
+    }
+    if (linked_) {
+        ::unlink(temporary_.c_str());
+    }
+#endif
+    temporary_.clear();
+    createdTarget_ = false;
+    return true;
+}
+
+void AtomicFileWriter::discard() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    if (!temporary_.empty()) {
+        std::remove(temporary_.c_str());
+        temporary_.clear();
+    }
+    if (createdTarget_) {
+        std::remove(target_.c_str());
+        createdTarget_ = false;
+    }
+}
+
+const std::string& AtomicFileWriter::getError() const {
+    return error_;
+}
+
+void AtomicFileWriter::fail(const std::string& action) {
+    failed_ = true;
+    error_ = action + ": " + std::strerror(errno);
+}
+
+bool AtomicFileWriter::copyToTarget() {
+#ifdef _WIN32
+    return false;
+#else
+    int input = ::open(temporary_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (input < 0) {
+        fail("open temporary file");
+        return false;
+    }
+    int output = ::open(target_.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (output < 0) {
+        fail("open");
+        ::close(input);
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    bool success = true;
+    for (;;) {
+        ssize_t count = ::read(input, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            fail("read temporary file");
+            success = false;
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        for (ssize_t written = 0; written < count;) {
+            ssize_t step = ::write(output, buffer.data() + written, static_cast<size_t>(count - written));
+            if (step < 0 && errno == EINTR) {
+                continue;
+            }
+            if (step < 0) {
+                fail("write");
+                success = false;
+                break;
+            }
+            written += step;
+        }
+        if (!success) {
+            break;
+        }
+    }
+    if (success && ::fsync(output) != 0) {
+        fail("fsync");
+        success = false;
+    }
+    ::close(input);
+    if (::close(output) != 0 && success) {
+        fail("close");
+        success = false;
+    }
+    return success;
+#endif
+}
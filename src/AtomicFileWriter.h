@@ -0,0 +1,82 @@
+#ifndef ATOMIC_FILE_WRITER_H
+#define ATOMIC_FILE_WRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+/**
+ * 先写临时文件、成功后再替换目标的文件写入（批量替换和按原编码保存共用）
+ * 符号链接先解析为其指向的文件；临时文件用 mkstemp 在目标所在目录中创建，名字不会与其他保存冲突，
+ * 并沿用原文件的权限、所有者和所属组。提交时先 fsync 再重命名覆盖，中途失败或崩溃时原文件保持不变。
+ * 目标有多个硬链接时不能重命名（会断开其他链接），改为写完临时文件后再把内容复制回原文件，
+ * 此时只有复制期间崩溃才会留下不完整的文件。
+ * 目标不存在时按当前 umask 新建
+ */
+class AtomicFileWriter {
+public:
+    AtomicFileWriter();
+
+    /**
+     * 析构时丢弃尚未提交的临时文件
+     */
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    /**
+     * 为目标文件创建临时文件
+     * @param path 目标文件路径
+     * @return 是否成功
+     */
+    bool open(const std::string& path);
+
+    /**
+     * 写入一段内容
+     * @param data 内容
+     * @param length 长度
+     * @return 是否成功（之前的写入失败后一直返回 false）
+     */
+    bool write(const char* data, size_t length);
+
+    /**
+     * 刷新到磁盘并替换目标文件
+     * @return 是否成功（失败时目标文件保持不变，临时文件被删除）
+     */
+    bool commit();
+
+    /**
+     * 放弃写入，删除临时文件
+     */
+    void discard();
+
+    /**
+     * 获取失败原因
+     * @return 形如 "rename: Permission denied" 的描述，成功时为空
+     */
+    const std::string& getError() const;
+
+private:
+    std::string target_;     // 解析符号链接后的目标路径
+    std::string temporary_;  // 临时文件路径
+    FILE* file_;
+    bool createdTarget_;     // 目标原本不存在，由 open 新建
+    bool linked_;            // 目标有多个硬链接，提交时复制内容而不是重命名
+    bool failed_;
+    std::string error_;
+
+    /**
+     * 记录失败原因（附上 errno 的描述）
+     * @param action 失败的操作
+     */
+    void fail(const std::string& action);
+
+    /**
+     * 把临时文件的内容复制回目标文件并刷新到磁盘
+     * @return 是否成功
+     */
+    bool copyToTarget();
+};
+
+#endif // ATOMIC_FILE_WRITER_H
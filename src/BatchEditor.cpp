@@ -0,0 +1,291 @@
+#include "BatchEditor.h"
+#include "AtomicFileWriter.h"
+#include "FileSearcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: LitePad --find PATTERN [--replace TEXT] [--regex] [--ignore-case] [--word] PATH..."
+              << std::endl
+              << "  Directories are searched recursively. Without --replace, only matches are counted." << std::endl;
+}
+
+std::string describeError(const std::string& action) {
+    return action + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+BatchEditor::BatchEditor(size_t threadCount)
+    : replace_(false), maxFileSize_(FileSearchOptions().maxFileSize), pool_(threadCount) {}
+
+bool BatchEditor::setPattern(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord) {
+    return pattern_.compile(pattern, caseSensitive, regex, wholeWord);
+}
+
+void BatchEditor::setReplacement(const std::string& replacement) {
+    replacement_ = replacement;
+    replace_ = true;
+}
+
+void BatchEditor::setMaxFileSize(uint64_t maxFileSize) {
+    maxFileSize_ = maxFileSize;
+}
+
+std::vector<BatchFileResult> BatchEditor::run(const std::vector<std::string>& paths, ResultCallback onResult) {
+    // 展开目录，与在文件中查找使用相同的目录过滤规则
+    std::vector<std::string> files;
+    FileSearcher lister;
+    FileSearchOptions options;
+    options.maxFileSize = maxFileSize_;
+    for (const std::string& path : paths) {
+#ifdef _WIN32
+        bool directory = std::filesystem::is_directory(path);
+#else
+        struct stat info;
+        bool directory = ::stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+        if (directory) {
+            lister.listFiles({path}, options, files);
+        } else {
+            files.push_back(path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    std::vector<BatchFileResult> results(files.size());
+    std::mutex callbackMutex;
+    for (size_t i = 0; i < files.size(); i++) {
+        pool_.submit([this, &files, &results, &callbackMutex, &onResult, i]() {
+            results[i] = processFile(files[i]);
+            if (onResult) {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                onResult(results[i]);
+            }
+        });
+    }
+    pool_.wait();
+    return results;
+}
+
+size_t BatchEditor::replaceAll(const SearchPattern& pattern, const char* data, size_t length,
+                               const std::string& replacement, const std::function<void(const char*, size_t)>& write) {
+    size_t count = 0;
+    size_t copied = 0;
+    size_t from = 0;
+    size_t matchStart = 0;
+    size_t matchLength = 0;
+    while (from < length && pattern.findNext(data, length, from, matchStart, matchLength)) {
+        if (matchLength == 0) {
+            from = matchStart + 1;
+            continue;
+        }
+        if (write) {
+            write(data + copied, matchStart - copied);
+            write(replacement.data(), replacement.size());
+        }
+        count++;
+        copied = matchStart + matchLength;
+        from = copied;
+    }
+    if (write) {
+        write(data + copied, length - copied);
+    }
+    return count;
+}
+
+BatchFileResult BatchEditor::processFile(const std::string& path) const {
+    BatchFileResult result{path, 0, false, ""};
+#ifdef _WIN32
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) {
+        result.error = "cannot open";
+        return result;
+    }
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error || size > maxFileSize_) {
+        result.skipped = true;
+        return result;
+    }
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    const char* data = content.data();
+    size_t length = content.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        result.error = describeError("open");
+        return result;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        result.error = "not a regular file";
+        return result;
+    }
+    if (static_cast<uint64_t>(info.st_size) > maxFileSize_) {
+        ::close(fd);
+        result.skipped = true;
+        return result;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    const char* data = "";
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            result.error = describeError("mmap");
+            ::close(fd);
+            return result;
+        }
+        data = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+#endif
+
+    if (FileSearcher::isBinary(data, length)) {
+        result.skipped = true;
+    } else if (!replace_) {
+        result.count = replaceAll(pattern_, data, length, replacement_, nullptr);
+    } else {
+        // 先确认有匹配，没有匹配的文件不创建临时文件
+        size_t matchStart = 0;
+        size_t matchLength = 0;
+        bool found = false;
+        for (size_t from = 0; from < length && pattern_.findNext(data, length, from, matchStart, matchLength);
+             from = matchStart + 1) {
+            if (matchLength > 0) {
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            rewriteFile(path, data, length, result);
+        }
+    }
+
+#ifndef _WIN32
+    if (length > 0) {
+        ::munmap(const_cast<char*>(data), length);
+    }
+#endif
+    return result;
+}
+
+void BatchEditor::rewriteFile(const std::string& path, const char* data, size_t length,
+                              BatchFileResult& result) const {
+    AtomicFileWriter writer;
+    if (!writer.open(path)) {
+        result.error = writer.getError();
+        return;
+    }
+    result.count = replaceAll(pattern_, data, length, replacement_, [&writer](const char* chunk, size_t size) {
+        writer.write(chunk, size);
+    });
+    if (!writer.commit()) {
+        result.error = writer.getError();
+        result.count = 0;
+    }
+}
+
+bool BatchEditor::isBatchCommand(int argc, char* argv[]) {
+    // 选项可以按任意顺序出现（如 --regex --find ...），-- 之后的都是路径
+    for (int i = 1; i < argc && std::strcmp(argv[i], "--") != 0; i++) {
+        if (std::strcmp(argv[i], "--find") == 0 || std::strcmp(argv[i], "--replace") == 0 ||
+            std::strcmp(argv[i], "--help") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int BatchEditor::runCommandLine(int argc, char* argv[]) {
+    std::string pattern;
+    std::string replacement;
+    bool hasPattern = false;
+    bool replace = false;
+    bool regex = false;
+    bool caseSensitive = true;
+    bool wholeWord = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--find" && i + 1 < argc) {
+            pattern = argv[++i];
+            hasPattern = true;
+        } else if (argument == "--replace" && i + 1 < argc) {
+            replacement = argv[++i];
+            replace = true;
+        } else if (argument == "--regex") {
+            regex = true;
+        } else if (argument == "--ignore-case") {
+            caseSensitive = false;
+        } else if (argument == "--word") {
+            wholeWord = true;
+        } else if (argument == "--") {
+            paths.insert(paths.end(), argv + i + 1, argv + argc);
+            break;
+        } else if (argument.size() > 1 && argument[0] == '-') {
+            printUsage();
+            return 2;
+        } else {
+            paths.push_back(argument);
+        }
+    }
+    if (!hasPattern || paths.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    BatchEditor editor;
+    if (!editor.setPattern(pattern, caseSensitive, regex, wholeWord)) {
+        std::cerr << "Invalid pattern: " << pattern << std::endl;
+        return 2;
+    }
+    if (replace) {
+        editor.setReplacement(replacement);
+    }
+
+    // 每个文件处理完立即输出，脚本可以边处理边读取
+    const char* unit = replace ? " replacements" : " matches";
+    std::vector<BatchFileResult> results = editor.run(paths, [unit](const BatchFileResult& result) {
+        if (!result.error.empty()) {
+            std::cerr << result.path << ": " << result.error << std::endl;
+        } else if (result.count > 0) {
+            std::cout << result.path << ": " << result.count << unit << std::endl;
+        }
+    });
+
+    size_t total = 0;
+    size_t matchedFiles = 0;
+    size_t failedFiles = 0;
+    size_t skippedFiles = 0;
+    for (const BatchFileResult& result : results) {
+        total += result.count;
+        matchedFiles += result.count > 0 ? 1 : 0;
+        failedFiles += result.error.empty() ? 0 : 1;
+        skippedFiles += result.skipped ? 1 : 0;
+    }
+    std::cout << total << unit << " in " << matchedFiles << " files (" << results.size() << " scanned, "
+              << skippedFiles << " skipped, " << failedFiles << " failed)" << std::endl;
+    if (failedFiles > 0) {
+        return 2;
+    }
+    return total > 0 ? 0 : 1;
+}
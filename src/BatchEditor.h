@@ -0,0 +1,119 @@
+#ifndef BATCH_EDITOR_H
+#define BATCH_EDITOR_H
+
+#include "SearchPattern.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * 批量处理中单个文件的结果
+ */
+struct BatchFileResult {
+    std::string path;   // 文件路径
+    size_t count;       // 匹配（或替换）次数
+    bool skipped;       // 因二进制或过大而跳过
+    std::string error;  // 读写失败的原因，成功时为空
+};
+
+/**
+ * 命令行批量查找替换
+ * 与编辑器使用相同的查找条件（SearchPattern / TextSearch）和替换语义：从前向后查找互不重叠的匹配，
+ * 替换后从替换文本之后继续。多个文件在线程池中并行处理；替换结果边生成边写入同目录下的临时文件，
+ * 完成后原子地重命名覆盖原文件，没有匹配的文件不会被改写
+ */
+class BatchEditor {
+public:
+    using ResultCallback = std::function<void(const BatchFileResult&)>;
+
+    /**
+     * 构造批量处理器
+     * @param threadCount 工作线程数，0 表示使用硬件线程数
+     */
+    explicit BatchEditor(size_t threadCount = 0);
+
+    /**
+     * 设置查找条件
+     * @param pattern 查找文本或正则表达式
+     * @param caseSensitive 是否区分大小写
+     * @param regex 是否为正则表达式（按行匹配）
+     * @param wholeWord 是否全字匹配
+     * @return 是否成功
+     */
+    bool setPattern(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord = false);
+
+    /**
+     * 设置替换文本，不设置时只统计匹配次数
+     * @param replacement 替换文本（按原样插入）
+     */
+    void setReplacement(const std::string& replacement);
+
+    /**
+     * 设置文件大小上限，超过的文件跳过
+     * @param maxFileSize 字节数
+     */
+    void setMaxFileSize(uint64_t maxFileSize);
+
+    /**
+     * 并行处理文件，目录会递归展开
+     * @param paths 文件或目录
+     * @param onResult 每个文件处理完后调用（在工作线程中，调用之间互斥）
+     * @return 全部文件的结果（按路径排序）
+     */
+    std::vector<BatchFileResult> run(const std::vector<std::string>& paths, ResultCallback onResult = nullptr);
+
+    /**
+     * 处理一段内容
+     * @param pattern 查找条件
+     * @param data 内容
+     * @param length 长度
+     * @param replacement 替换文本
+     * @param write 依次接收替换后内容的各个片段，为空时只统计
+     * @return 匹配次数（长度为 0 的正则匹配不计入也不替换）
+     */
+    static size_t replaceAll(const SearchPattern& pattern, const char* data, size_t length,
+                             const std::string& replacement, const std::function<void(const char*, size_t)>& write);
+
+    /**
+     * 命令行入口：LitePad --find PATTERN [--replace TEXT] [--regex] [--ignore-case] PATH...
+     * @param argc 参数数量
+     * @param argv 参数
+     * @return 退出码：有匹配为 0，没有匹配为 1，参数错误或有文件处理失败为 2
+     */
+    static int runCommandLine(int argc, char* argv[]);
+
+    /**
+     * 判断命令行是否为批量模式（-- 之前有 --find、--replace 或 --help）
+     * @param argc 参数数量
+     * @param argv 参数
+     * @return 是否为批量模式
+     */
+    static bool isBatchCommand(int argc, char* argv[]);
+
+private:
+    SearchPattern pattern_;
+    std::string replacement_;
+    bool replace_;
+    uint64_t maxFileSize_;
+    ThreadPool pool_;
+
+    /**
+     * 处理单个文件
+     * @param path 文件路径
+     * @return 结果
+     */
+    BatchFileResult processFile(const std::string& path) const;
+
+    /**
+     * 把替换结果写入临时文件并替换原文件（保留权限、所有者和链接，见 AtomicFileWriter）
+     * @param path 文件路径
+     * @param data 原内容
+     * @param length 原长度
+     * @param result 输出替换次数或错误
+     */
+    void rewriteFile(const std::string& path, const char* data, size_t length, BatchFileResult& result) const;
+};
+
+#endif // BATCH_EDITOR_H
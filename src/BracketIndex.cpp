@@ -0,0 +1,389 @@
+#include "BracketIndex.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr int64_t kInfinity = std::numeric_limits<int64_t>::max() / 4;
+
+const std::vector<BracketToken>& emptyLine() {
+    static const std::vector<BracketToken> empty;
+    return empty;
+}
+
+}  // namespace
+
+BracketIndex::BracketIndex() : root_(kNull), random_(0x4c50u) {}
+
+void BracketIndex::clear() {
+    nodes_.clear();
+    freeNodes_.clear();
+    root_ = kNull;
+}
+
+void BracketIndex::replaceLines(size_t firstLine, size_t removedCount, std::vector<std::vector<BracketToken>> lines) {
+    size_t lineCount = getLineCount();
+    firstLine = std::min(firstLine, lineCount);
+    removedCount = std::min(removedCount, lineCount - firstLine);
+
+    int32_t head = kNull;
+    int32_t rest = kNull;
+    int32_t removed = kNull;
+    int32_t tail = kNull;
+    split(root_, firstLine, head, rest);
+    split(rest, removedCount, removed, tail);
+    releaseSubtree(removed);
+
+    int32_t middle = kNull;
+    for (auto& brackets : lines) {
+        int32_t node = createNode(std::move(brackets));
+        middle = merge(middle, node);
+    }
+
+    root_ = merge(merge(head, middle), tail);
+}
+
+size_t BracketIndex::getLineCount() const {
+    return sizeOf(root_);
+}
+
+const std::vector<BracketToken>& BracketIndex::getLineBrackets(size_t line) const {
+    int32_t node = nodeAt(line);
+    return node == kNull ? emptyLine() : nodes_[node].brackets;
+}
+
+bool BracketIndex::findMatch(size_t line, size_t column, BracketPosition& match) const {
+    int32_t node = nodeAt(line);
+    if (node == kNull) {
+        return false;
+    }
+
+    const std::vector<BracketToken>& brackets = nodes_[node].brackets;
+    auto it = std::lower_bound(brackets.begin(), brackets.end(), column,
+                               [](const BracketToken& token, size_t value) { return token.column < value; });
+    if (it == brackets.end() || it->column != column) {
+        return false;
+    }
+    size_t index = static_cast<size_t>(it - brackets.begin());
+
+    int64_t lineDepth = prefixBefore(line);
+    int64_t depthBefore = lineDepth;
+    for (size_t i = 0; i < index; ++i) {
+        depthBefore += isOpen(brackets[i].ch) ? 1 : -1;
+    }
+
+    if (isOpen(it->ch)) {
+        // 配对的右括号是之后第一个使深度回到 depthBefore 的括号
+        int64_t target = depthBefore;
+        if (findCloseFrom(line, index + 1, depthBefore + 1, target, match)) {
+            return true;
+        }
+        size_t foundLine = 0;
+        int64_t foundDepth = 0;
+        if (!findFirstAfter(root_, 0, 0, line + 1, target, foundLine, foundDepth)) {
+            return false;
+        }
+        return findCloseFrom(foundLine, 0, foundDepth, target, match);
+    }
+
+    // 配对的左括号是之前最后一个“括号前深度”不超过 depthBefore - 1 的括号
+    int64_t target = depthBefore - 1;
+    if (findOpenBefore(line, index, lineDepth, target, match)) {
+        return true;
+    }
+    size_t foundLine = 0;
+    int64_t foundDepth = 0;
+    if (!findLastBefore(root_, 0, 0, line, target, foundLine, foundDepth)) {
+        return false;
+    }
+    return findOpenBefore(foundLine, getLineBrackets(foundLine).size(), foundDepth, target, match);
+}
+
+bool BracketIndex::findEnclosingOpen(size_t line, size_t column, BracketPosition& open) const {
+    int32_t node = nodeAt(line);
+    if (node == kNull) {
+        return false;
+    }
+
+    const std::vector<BracketToken>& brackets = nodes_[node].brackets;
+    size_t endIndex = static_cast<size_t>(
+        std::lower_bound(brackets.begin(), brackets.end(), column,
+                         [](const BracketToken& token, size_t value) { return token.column < value; }) -
+        brackets.begin());
+
+    int64_t lineDepth = prefixBefore(line);
+    int64_t depth = lineDepth;
+    for (size_t i = 0; i < endIndex; ++i) {
+        depth += isOpen(brackets[i].ch) ? 1 : -1;
+    }
+    // 前面有多余的右括号时深度可能为负，只比较相对深度
+    int64_t target = depth - 1;
+    if (findOpenBefore(line, endIndex, lineDepth, target, open)) {
+        return true;
+    }
+    size_t foundLine = 0;
+    int64_t foundDepth = 0;
+    if (!findLastBefore(root_, 0, 0, line, target, foundLine, foundDepth)) {
+        return false;
+    }
+    return findOpenBefore(foundLine, getLineBrackets(foundLine).size(), foundDepth, target, open);
+}
+
+int64_t BracketIndex::getDepthAt(size_t line, size_t column) const {
+    int64_t depth = prefixBefore(line);
+    for (const BracketToken& token : getLineBrackets(line)) {
+        if (token.column >= column) {
+            break;
+        }
+        depth += isOpen(token.ch) ? 1 : -1;
+    }
+    return depth;
+}
+
+bool BracketIndex::isOpen(char c) {
+    return c == '(' || c == '[' || c == '{';
+}
+
+bool BracketIndex::isClose(char c) {
+    return c == ')' || c == ']' || c == '}';
+}
+
+bool BracketIndex::isMatchingPair(char open, char close) {
+    return (open == '(' && close == ')') || (open == '[' && close == ']') || (open == '{' && close == '}');
+}
+
+int32_t BracketIndex::createNode(std::vector<BracketToken> brackets) {
+    int32_t index;
+    if (!freeNodes_.empty()) {
+        index = freeNodes_.back();
+        freeNodes_.pop_back();
+    } else {
+        index = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[index];
+    node.left = kNull;
+    node.right = kNull;
+    node.priority = random_();
+    node.brackets = std::move(brackets);
+    node.line = summarize(node.brackets);
+    update(index);
+    return index;
+}
+
+void BracketIndex::releaseSubtree(int32_t node) {
+    // 显式栈，避免退化时递归过深
+    std::vector<int32_t> pending;
+    if (node != kNull) {
+        pending.push_back(node);
+    }
+    while (!pending.empty()) {
+        int32_t current = pending.back();
+        pending.pop_back();
+        if (nodes_[current].left != kNull) {
+            pending.push_back(nodes_[current].left);
+        }
+        if (nodes_[current].right != kNull) {
+            pending.push_back(nodes_[current].right);
+        }
+        nodes_[current].brackets.clear();
+        nodes_[current].brackets.shrink_to_fit();
+        freeNodes_.push_back(current);
+    }
+}
+
+void BracketIndex::update(int32_t node) {
+    Node& current = nodes_[node];
+    Summary empty{0, kInfinity, kInfinity};
+    const Summary& left = current.left == kNull ? empty : nodes_[current.left].subtree;
+    const Summary& right = current.right == kNull ? empty : nodes_[current.right].subtree;
+    current.subtree = combine(combine(left, current.line), right);
+    current.size = 1 + sizeOf(current.left) + sizeOf(current.right);
+}
+
+size_t BracketIndex::sizeOf(int32_t node) const {
+    return node == kNull ? 0 : nodes_[node].size;
+}
+
+int32_t BracketIndex::merge(int32_t left, int32_t right) {
+    if (left == kNull) {
+        return right;
+    }
+    if (right == kNull) {
+        return left;
+    }
+    if (nodes_[left].priority > nodes_[right].priority) {
+        int32_t merged = merge(nodes_[left].right, right);
+        nodes_[left].right = merged;
+        update(left);
+        return left;
+    }
+    int32_t merged = merge(left, nodes_[right].left);
+    nodes_[right].left = merged;
+    update(right);
+    return right;
+}
+
+void BracketIndex::split(int32_t node, size_t count, int32_t& left, int32_t& right) {
+    if (node == kNull) {
+        left = kNull;
+        right = kNull;
+        return;
+    }
+    size_t leftSize = sizeOf(nodes_[node].left);
+    if (count <= leftSize) {
+        int32_t subLeft = kNull;
+        int32_t subRight = kNull;
+        split(nodes_[node].left, count, subLeft, subRight);
+        nodes_[node].left = subRight;
+        update(node);
+        left = subLeft;
+        right = node;
+    } else {
+        int32_t subLeft = kNull;
+        int32_t subRight = kNull;
+        split(nodes_[node].right, count - leftSize - 1, subLeft, subRight);
+        nodes_[node].right = subLeft;
+        update(node);
+        left = node;
+        right = subRight;
+    }
+}
+
+int32_t BracketIndex::nodeAt(size_t line) const {
+    int32_t node = root_;
+    while (node != kNull) {
+        size_t leftSize = sizeOf(nodes_[node].left);
+        if (line < leftSize) {
+            node = nodes_[node].left;
+        } else if (line == leftSize) {
+            return node;
+        } else {
+            line -= leftSize + 1;
+            node = nodes_[node].right;
+        }
+    }
+    return kNull;
+}
+
+int64_t BracketIndex::prefixBefore(size_t line) const {
+    int64_t acc = 0;
+    int32_t node = root_;
+    while (node != kNull) {
+        const Node& current = nodes_[node];
+        size_t leftSize = sizeOf(current.left);
+        int64_t leftDelta = current.left == kNull ? 0 : nodes_[current.left].subtree.delta;
+        if (line < leftSize) {
+            node = current.left;
+        } else if (line == leftSize) {
+            return acc + leftDelta;
+        } else {
+            acc += leftDelta + current.line.delta;
+            line -= leftSize + 1;
+            node = current.right;
+        }
+    }
+    return acc;
+}
+
+bool BracketIndex::findFirstAfter(int32_t node, size_t offset, int64_t acc, size_t startLine, int64_t threshold,
+                                  size_t& line, int64_t& lineDepth) const {
+    if (node == kNull) {
+        return false;
+    }
+    const Node& current = nodes_[node];
+    if (offset + current.size <= startLine) {
+        return false;
+    }
+    if (offset >= startLine && acc + current.subtree.minAfter > threshold) {
+        return false;
+    }
+
+    if (findFirstAfter(current.left, offset, acc, startLine, threshold, line, lineDepth)) {
+        return true;
+    }
+    size_t index = offset + sizeOf(current.left);
+    int64_t depth = acc + (current.left == kNull ? 0 : nodes_[current.left].subtree.delta);
+    if (index >= startLine && depth + current.line.minAfter <= threshold) {
+        line = index;
+        lineDepth = depth;
+        return true;
+    }
+    return findFirstAfter(current.right, index + 1, depth + current.line.delta, startLine, threshold, line,
+                          lineDepth);
+}
+
+bool BracketIndex::findLastBefore(int32_t node, size_t offset, int64_t acc, size_t endLine, int64_t threshold,
+                                  size_t& line, int64_t& lineDepth) const {
+    if (node == kNull || offset >= endLine) {
+        return false;
+    }
+    const Node& current = nodes_[node];
+    if (offset + current.size <= endLine && acc + current.subtree.minBefore > threshold) {
+        return false;
+    }
+
+    size_t index = offset + sizeOf(current.left);
+    int64_t depth = acc + (current.left == kNull ? 0 : nodes_[current.left].subtree.delta);
+    if (findLastBefore(current.right, index + 1, depth + current.line.delta, endLine, threshold, line, lineDepth)) {
+        return true;
+    }
+    if (index < endLine && depth + current.line.minBefore <= threshold) {
+        line = index;
+        lineDepth = depth;
+        return true;
+    }
+    return findLastBefore(current.left, offset, acc, endLine, threshold, line, lineDepth);
+}
+
+bool BracketIndex::findCloseFrom(size_t line, size_t fromIndex, int64_t depth, int64_t target,
+                                 BracketPosition& result) const {
+    const std::vector<BracketToken>& brackets = getLineBrackets(line);
+    for (size_t i = fromIndex; i < brackets.size(); ++i) {
+        depth += isOpen(brackets[i].ch) ? 1 : -1;
+        if (depth <= target) {
+            result = {line, brackets[i].column, brackets[i].ch};
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BracketIndex::findOpenBefore(size_t line, size_t endIndex, int64_t lineDepth, int64_t target,
+                                  BracketPosition& result) const {
+    const std::vector<BracketToken>& brackets = getLineBrackets(line);
+    endIndex = std::min(endIndex, brackets.size());
+
+    // 先求出 endIndex 处的深度，再向前逐个回退
+    int64_t depth = lineDepth;
+    for (size_t i = 0; i < endIndex; ++i) {
+        depth += isOpen(brackets[i].ch) ? 1 : -1;
+    }
+    for (size_t i = endIndex; i > 0; --i) {
+        depth -= isOpen(brackets[i - 1].ch) ? 1 : -1;
+        if (depth <= target) {
+            result = {line, brackets[i - 1].column, brackets[i - 1].ch};
+            return true;
+        }
+    }
+    return false;
+}
+
+BracketIndex::Summary BracketIndex::summarize(const std::vector<BracketToken>& brackets) {
+    Summary summary{0, kInfinity, kInfinity};
+    for (const BracketToken& token : brackets) {
+        summary.minBefore = std::min(summary.minBefore, summary.delta);
+        summary.delta += isOpen(token.ch) ? 1 : -1;
+        summary.minAfter = std::min(summary.minAfter, summary.delta);
+    }
+    return summary;
+}
+
+BracketIndex::Summary BracketIndex::combine(const Summary& first, const Summary& second) {
+    Summary result;
+    result.delta = first.delta + second.delta;
+    result.minAfter = std::min(first.minAfter, first.delta + second.minAfter);
+    result.minBefore = std::min(first.minBefore, first.delta + second.minBefore);
+    return result;
+}
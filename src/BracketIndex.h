@@ -0,0 +1,154 @@
+#ifndef BRACKET_INDEX_H
+#define BRACKET_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * 行内括号记号
+ */
+struct BracketToken {
+    size_t column;  // 行内字节偏移
+    char ch;        // 括号字符
+};
+
+/**
+ * 括号位置
+ */
+struct BracketPosition {
+    size_t line;    // 行号（从0开始）
+    size_t column;  // 行内字节偏移
+    char ch;        // 括号字符
+};
+
+/**
+ * 增量括号索引
+ * 以行为叶子的隐式平衡树（treap），每个结点汇总子树的深度增量和最小前缀深度，
+ * 括号匹配、查找外层代码块、计算嵌套深度均为 O(log n)，按行替换同样为 O(log n)
+ * 字符串和注释中的括号由词法分析器事先排除
+ */
+class BracketIndex {
+public:
+    BracketIndex();
+
+    /**
+     * 清空索引
+     */
+    void clear();
+
+    /**
+     * 用新的行数据替换一段行
+     * @param firstLine 起始行（从0开始）
+     * @param removedCount 被替换的行数
+     * @param lines 新的行数据，每行一个括号列表（按列升序）
+     */
+    void replaceLines(size_t firstLine, size_t removedCount, std::vector<std::vector<BracketToken>> lines);
+
+    /**
+     * 获取索引中的行数
+     * @return 行数
+     */
+    size_t getLineCount() const;
+
+    /**
+     * 获取指定行的括号
+     * @param line 行号（从0开始）
+     * @return 括号列表，行号越界时返回空列表
+     */
+    const std::vector<BracketToken>& getLineBrackets(size_t line) const;
+
+    /**
+     * 查找与指定括号配对的括号
+     * @param line 括号所在行
+     * @param column 括号所在列
+     * @param match 输出配对括号的位置
+     * @return 是否找到（类型不一致时也返回 true，由调用方用 isMatchingPair 判断）
+     */
+    bool findMatch(size_t line, size_t column, BracketPosition& match) const;
+
+    /**
+     * 查找包围指定位置的最内层左括号
+     * @param line 行号
+     * @param column 列
+     * @param open 输出左括号位置
+     * @return 是否找到
+     */
+    bool findEnclosingOpen(size_t line, size_t column, BracketPosition& open) const;
+
+    /**
+     * 获取指定位置之前的嵌套深度
+     * @param line 行号
+     * @param column 列
+     * @return 深度（未闭合左括号数量减去多余右括号数量）
+     */
+    int64_t getDepthAt(size_t line, size_t column) const;
+
+    /**
+     * 检查是否为左括号
+     */
+    static bool isOpen(char c);
+
+    /**
+     * 检查是否为右括号
+     */
+    static bool isClose(char c);
+
+    /**
+     * 检查两个括号是否配对
+     * @param open 左括号
+     * @param close 右括号
+     * @return 是否配对
+     */
+    static bool isMatchingPair(char open, char close);
+
+private:
+    static constexpr int32_t kNull = -1;
+
+    struct Summary {
+        int64_t delta;      // 深度增量
+        int64_t minAfter;   // 各括号之后深度的最小值（相对起点）
+        int64_t minBefore;  // 各括号之前深度的最小值（相对起点）
+    };
+
+    struct Node {
+        int32_t left;
+        int32_t right;
+        uint32_t priority;
+        size_t size;
+        Summary line;     // 本行汇总
+        Summary subtree;  // 子树汇总
+        std::vector<BracketToken> brackets;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> freeNodes_;
+    int32_t root_;
+    std::mt19937 random_;
+
+    int32_t createNode(std::vector<BracketToken> brackets);
+    void releaseSubtree(int32_t node);
+    void update(int32_t node);
+    size_t sizeOf(int32_t node) const;
+    int32_t merge(int32_t left, int32_t right);
+    void split(int32_t node, size_t count, int32_t& left, int32_t& right);
+
+    int32_t nodeAt(size_t line) const;
+    int64_t prefixBefore(size_t line) const;
+
+    bool findFirstAfter(int32_t node, size_t offset, int64_t acc, size_t startLine, int64_t threshold,
+                        size_t& line, int64_t& lineDepth) const;
+    bool findLastBefore(int32_t node, size_t offset, int64_t acc, size_t endLine, int64_t threshold,
+                        size_t& line, int64_t& lineDepth) const;
+
+    bool findCloseFrom(size_t line, size_t fromIndex, int64_t lineDepth, int64_t target,
+                       BracketPosition& result) const;
+    bool findOpenBefore(size_t line, size_t endIndex, int64_t lineDepth, int64_t target,
+                        BracketPosition& result) const;
+
+    static Summary summarize(const std::vector<BracketToken>& brackets);
+    static Summary combine(const Summary& first, const Summary& second);
+};
+
+#endif // BRACKET_INDEX_H
@@ -3,6 +3,8 @@
 #include <sstream>
 #include <algorithm>
 #include <map>
+#include <cstdlib>
+#include <filesystem>
 
 ConfigManager::ConfigManager() = default;
 
@@ -175,6 +177,38 @@ void ConfigManager::setGroup(const std::string& groupName, std::shared_ptr<Confi
     groups_[groupName] = config;
 }
 
+std::string ConfigManager::getUserConfigDirectory() {
+    std::filesystem::path directory;
+#if defined(_WIN32)
+    const char* appData = std::getenv("APPDATA");
+    if (appData && *appData) {
+        directory = std::filesystem::path(appData) / "LitePad";
+    }
+#elif defined(__APPLE__)
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        directory = std::filesystem::path(home) / "Library" / "Application Support" / "LitePad";
+    }
+#else
+    const char* configHome = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    if (configHome && *configHome) {
+        directory = std::filesystem::path(configHome) / "litepad";
+    } else if (home && *home) {
+        directory = std::filesystem::path(home) / ".config" / "litepad";
+    }
+#endif
+    if (directory.empty()) {
+        return "";
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        return "";
+    }
+    return directory.string();
+}
+
 void ConfigManager::notifyConfigChanged(const std::string& key) {
     auto it = callbacks_.find(key);
     if (it != callbacks_.end()) {
@@ -146,6 +146,14 @@ public:
      * @param config 配置管理器
      */
     void setGroup(const std::string& groupName, std::shared_ptr<ConfigManager> config);
+    
+    /**
+     * 获取用户配置目录（不存在时创建），用于保存用户配置和索引等缓存
+     * Linux 为 $XDG_CONFIG_HOME/litepad（默认 ~/.config/litepad），
+     * macOS 为 ~/Library/Application Support/LitePad，Windows 为 %APPDATA%\LitePad
+     * @return 目录路径，无法确定或创建时返回空字符串
+     */
+    static std::string getUserConfigDirectory();
 
 private:
     std::unordered_map<std::string, std::string> stringValues_;
@@ -0,0 +1,163 @@
+#include "DelimiterScanner.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LITEPAD_DELIMITER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEPAD_DELIMITER_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline size_t countTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(__builtin_ctzll(mask));
+#endif
+}
+
+#if defined(LITEPAD_DELIMITER_AVX2)
+
+// 每个分隔符广播成一个向量，整段扫描期间只构造一次
+struct Broadcasts {
+    __m256i values[DelimiterScanner::kMaxDelimiters];
+    size_t count;
+
+    explicit Broadcasts(const std::string& delimiters) : count(delimiters.size()) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = _mm256_set1_epi8(delimiters[i]);
+        }
+    }
+
+    uint64_t mask(const char* block) const {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        __m256i hitsLo = _mm256_setzero_si256();
+        __m256i hitsHi = _mm256_setzero_si256();
+        for (size_t i = 0; i < count; ++i) {
+            hitsLo = _mm256_or_si256(hitsLo, _mm256_cmpeq_epi8(lo, values[i]));
+            hitsHi = _mm256_or_si256(hitsHi, _mm256_cmpeq_epi8(hi, values[i]));
+        }
+        uint64_t maskLo = static_cast<uint32_t>(_mm256_movemask_epi8(hitsLo));
+        uint64_t maskHi = static_cast<uint32_t>(_mm256_movemask_epi8(hitsHi));
+        return maskLo | (maskHi << 32);
+    }
+};
+
+#elif defined(LITEPAD_DELIMITER_SSE2)
+
+struct Broadcasts {
+    __m128i values[DelimiterScanner::kMaxDelimiters];
+    size_t count;
+
+    explicit Broadcasts(const std::string& delimiters) : count(delimiters.size()) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = _mm_set1_epi8(delimiters[i]);
+        }
+    }
+
+    uint64_t mask(const char* block) const {
+        uint64_t result = 0;
+        for (size_t lane = 0; lane < 4; ++lane) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+            __m128i hits = _mm_setzero_si128();
+            for (size_t i = 0; i < count; ++i) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, values[i]));
+            }
+            result |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(hits))) << (lane * 16);
+        }
+        return result;
+    }
+};
+
+#endif
+
+}  // namespace
+
+DelimiterScanner::DelimiterScanner() {
+    std::memset(table_, 0, sizeof(table_));
+}
+
+DelimiterScanner::DelimiterScanner(const std::string& delimiters) : DelimiterScanner() {
+    setDelimiters(delimiters);
+}
+
+void DelimiterScanner::setDelimiters(const std::string& delimiters) {
+    std::memset(table_, 0, sizeof(table_));
+    delimiters_.clear();
+    for (char c : delimiters) {
+        unsigned char index = static_cast<unsigned char>(c);
+        if (table_[index] || delimiters_.size() >= kMaxDelimiters) {
+            continue;
+        }
+        table_[index] = true;
+        delimiters_.push_back(c);
+    }
+}
+
+const std::string& DelimiterScanner::getDelimiters() const {
+    return delimiters_;
+}
+
+size_t DelimiterScanner::findNext(const char* data, size_t length, size_t from) const {
+    if (from >= length || delimiters_.empty()) {
+        return length;
+    }
+
+    size_t pos = from;
+#if defined(LITEPAD_DELIMITER_AVX2) || defined(LITEPAD_DELIMITER_SSE2)
+    Broadcasts broadcasts(delimiters_);
+    while (pos + kBlockSize <= length) {
+        uint64_t mask = broadcasts.mask(data + pos);
+        if (mask != 0) {
+            return pos + countTrailingZeros(mask);
+        }
+        pos += kBlockSize;
+    }
+#endif
+
+    // 尾部不足一个块的部分（以及无向量指令时的全部数据）逐字节查表
+    for (; pos < length; ++pos) {
+        if (table_[static_cast<unsigned char>(data[pos])]) {
+            return pos;
+        }
+    }
+    return length;
+}
+
+uint64_t DelimiterScanner::blockMask(const char* block) const {
+#if defined(LITEPAD_DELIMITER_AVX2) || defined(LITEPAD_DELIMITER_SSE2)
+    return Broadcasts(delimiters_).mask(block);
+#else
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        if (table_[static_cast<unsigned char>(block[i])]) {
+            mask |= uint64_t(1) << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+bool DelimiterScanner::isDelimiter(char c) const {
+    return table_[static_cast<unsigned char>(c)];
+}
+
+const char* DelimiterScanner::backendName() {
+#if defined(LITEPAD_DELIMITER_AVX2)
+    return "AVX2";
+#elif defined(LITEPAD_DELIMITER_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
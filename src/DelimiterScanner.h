@@ -0,0 +1,79 @@
+#ifndef DELIMITER_SCANNER_H
+#define DELIMITER_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * 分隔符预扫描器
+ * 一次比较 64 字节，定位引号、注释起始符、换行符、转义符等“关键字节”，
+ * 让词法分析器在字符串和注释内部直接跳到下一个需要处理的位置
+ */
+class DelimiterScanner {
+public:
+    /**
+     * 最多支持的分隔符数量
+     */
+    static constexpr size_t kMaxDelimiters = 8;
+
+    /**
+     * 每次扫描的块大小（字节）
+     */
+    static constexpr size_t kBlockSize = 64;
+
+    DelimiterScanner();
+
+    /**
+     * 构造扫描器
+     * @param delimiters 关键字节集合，超出 kMaxDelimiters 的部分被忽略
+     */
+    explicit DelimiterScanner(const std::string& delimiters);
+
+    /**
+     * 重新设置关键字节集合
+     * @param delimiters 关键字节集合
+     */
+    void setDelimiters(const std::string& delimiters);
+
+    /**
+     * 获取关键字节集合
+     * @return 关键字节集合
+     */
+    const std::string& getDelimiters() const;
+
+    /**
+     * 查找下一个关键字节
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param from 开始查找位置
+     * @return 关键字节位置，如果未找到则返回 length
+     */
+    size_t findNext(const char* data, size_t length, size_t from) const;
+
+    /**
+     * 计算一个 64 字节块的关键字节位图
+     * @param block 块起始地址，必须至少可读 kBlockSize 字节
+     * @return 位图，第 i 位为 1 表示 block[i] 是关键字节
+     */
+    uint64_t blockMask(const char* block) const;
+
+    /**
+     * 检查字节是否为关键字节
+     * @param c 字节
+     * @return 是否为关键字节
+     */
+    bool isDelimiter(char c) const;
+
+    /**
+     * 获取当前编译启用的向量指令集名称
+     * @return "AVX2"、"SSE2" 或 "scalar"
+     */
+    static const char* backendName();
+
+private:
+    std::string delimiters_;
+    bool table_[256];
+};
+
+#endif // DELIMITER_SCANNER_H
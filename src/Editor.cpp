@@ -1,10 +1,16 @@
 #include "Editor.h"
+#include "GzipReader.h"
+#include "TextSearch.h"
+#include "Transcoder.h"
 #include <fstream>
+#include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
 
-Editor::Editor() : modified_(false) {
+Editor::Editor()
+    : modified_(false), readOnly_(false), transcoded_(false), nextEditListenerId_(1), retentionBytes_(0),
+      retentionLines_(0), discardedLines_(0), discardedBytes_(0) {
     // 初始化编辑器
 }
 
@@ -12,16 +18,64 @@ Editor::~Editor() = default;
 
 bool Editor::openFile(const std::string& filePath) {
     try {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
+        std::string content;
+        auto readPlain = [&filePath, &content]() {
+            std::ifstream file(filePath);
+            if (!file.is_open()) {
+                return false;
+            }
+            
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            content = buffer.str();
+            return true;
+        };
+        bool compressed = GzipReader::isGzipFile(filePath);
+        if (compressed) {
+            GzipReader reader;
+            if (!reader.open(filePath, GzipReader::defaultIndexPath(filePath)) || !reader.readAll(content)) {
+                return false;
+            }
+        } else if (!readPlain()) {
             return false;
         }
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        content_ = buffer.str();
+        // 不是 UTF-8 的内容无法在文本视图中原样编辑：能转换的编码按块解码为 UTF-8，保存时再转换回去；
+        // 其余的（或解码失败的）以只读方式打开
+        DetectedEncoding encoding = EncodingDetector::detect(content.data(), content.size());
+        // 大文件只按开头检测：开头是 UTF-8 时再验证整份内容，后面有无效字节的不能按 UTF-8 编辑，
+        // 也不整体按单字节编码转换（会把前面的 UTF-8 变成乱码），以只读方式打开
+        bool invalidUtf8 = encoding.sampled && encoding.isUtf8Compatible() &&
+                           !EncodingDetector::isValidUtf8(content.data() + encoding.bomLength,
+                                                          content.size() - encoding.bomLength);
+        if (invalidUtf8) {
+            encoding.encoding = TextEncoding::Windows1252;
+            encoding.sampled = false;
+        }
+        bool transcoded = false;
+        if (!invalidUtf8 && !encoding.isUtf8Compatible() && Transcoder::supports(encoding.encoding)) {
+            std::string decoded;
+            if (compressed) {
+                transcoded = Transcoder::decodeBuffer(content, encoding, decoded);
+            } else {
+                // 先释放原始内容再从文件按块解码，峰值内存只有解码结果加一个块
+                std::string().swap(content);
+                transcoded = Transcoder::decodeFile(filePath, encoding, decoded);
+                if (!transcoded && !readPlain()) {
+                    return false;
+                }
+            }
+            if (transcoded) {
+                content.swap(decoded);
+            }
+        }
+        encoding_ = encoding;
+        transcoded_ = transcoded;
+        replaceContent(std::move(content));
         filePath_ = filePath;
         modified_ = false;
+        readOnly_ = compressed || (!encoding_.isUtf8Compatible() && !transcoded_);
+        discardedLines_ = 0;
+        discardedBytes_ = 0;
         
         // 更新撤销重做栈
         updateUndoRedoStack();
@@ -35,21 +89,48 @@ bool Editor::openFile(const std::string& filePath) {
     }
 }
 
+void Editor::openStreamedFile(const std::string& filePath) {
+    replaceContent(std::string());
+    filePath_ = filePath;
+    modified_ = false;
+    readOnly_ = true;
+    encoding_ = DetectedEncoding();
+    transcoded_ = false;
+    discardedLines_ = 0;
+    discardedBytes_ = 0;
+    undoStack_.clear();
+    redoStack_.clear();
+    
+    // 通知文件路径变化
+    notifyFilePathChanged();
+}
+
 bool Editor::saveFile(const std::string& filePath) {
     std::string targetPath = filePath.empty() ? filePath_ : filePath;
     if (targetPath.empty()) {
         return false;
     }
+    if (readOnly_ && targetPath == filePath_) {
+        std::cerr << "Cannot save read-only document: " << filePath_ << std::endl;
+        return false;
+    }
     
     try {
-        std::ofstream file(targetPath);
-        if (!file.is_open()) {
-            return false;
+        if (transcoded_) {
+            // 按块转换回打开时的编码
+            if (!Transcoder::encodeFile(targetPath, encoding_, content_)) {
+                return false;
+            }
+        } else {
+            std::ofstream file(targetPath);
+            if (!file.is_open()) {
+                return false;
+            }
+            
+            file << content_;
+            file.close();
         }
         
-        file << content_;
-        file.close();
-        
         if (filePath.empty()) {
             filePath_ = targetPath;
         }
@@ -72,9 +153,17 @@ std::string Editor::getContent() const {
     return content_;
 }
 
+std::string_view Editor::getContentView() const {
+    return content_;
+}
+
 void Editor::setContent(const std::string& content) {
+    if (readOnly_) {
+        // 只读文档（压缩文件、无法转换的编码）保留打开时的原始内容
+        return;
+    }
     if (content_ != content) {
-        content_ = content;
+        replaceContent(content);
         modified_ = true;
         
         // 更新撤销重做栈
@@ -85,6 +174,48 @@ void Editor::setContent(const std::string& content) {
     }
 }
 
+void Editor::appendText(std::string_view text) {
+    if (text.empty()) {
+        return;
+    }
+    
+    // 撤销栈保存的是整篇快照，为每次追加保存快照会让跟随大文件的开销随文件大小增长
+    replaceRange(content_.size(), 0, text);
+    undoStack_.clear();
+    redoStack_.clear();
+    enforceRetention();
+    
+    // 通知内容变化
+    notifyContentChanged();
+}
+
+void Editor::reloadContent(std::string content) {
+    replaceContent(std::move(content));
+    modified_ = false;
+    undoStack_.clear();
+    redoStack_.clear();
+    discardedLines_ = 0;
+    discardedBytes_ = 0;
+    enforceRetention();
+    
+    // 通知内容变化
+    notifyContentChanged();
+}
+
+void Editor::setRetentionLimit(size_t maxBytes, size_t maxLines) {
+    retentionBytes_ = maxBytes;
+    retentionLines_ = maxLines;
+    enforceRetention();
+}
+
+size_t Editor::getDiscardedLineCount() const {
+    return discardedLines_;
+}
+
+uint64_t Editor::getDiscardedByteCount() const {
+    return discardedBytes_;
+}
+
 std::string Editor::getFilePath() const {
     return filePath_;
 }
@@ -93,6 +224,18 @@ bool Editor::isModified() const {
     return modified_;
 }
 
+bool Editor::isReadOnly() const {
+    return readOnly_;
+}
+
+const DetectedEncoding& Editor::getEncoding() const {
+    return encoding_;
+}
+
+bool Editor::isTranscoded() const {
+    return transcoded_;
+}
+
 void Editor::setModified(bool modified) {
     modified_ = modified;
 }
@@ -102,29 +245,21 @@ size_t Editor::getLineCount() const {
         return 0;
     }
     
-    size_t count = 1;
-    for (char c : content_) {
-        if (c == '\n') {
-            count++;
-        }
-    }
-    return count;
+    return lineIndex_.getLineCount();
 }
 
 std::string Editor::getLine(size_t lineNumber) const {
+    return std::string(getLineView(lineNumber));
+}
+
+std::string_view Editor::getLineView(size_t lineNumber) const {
     if (lineNumber < 1 || lineNumber > getLineCount()) {
-        return "";
+        return std::string_view();
     }
     
-    std::istringstream stream(content_);
-    std::string line;
-    size_t currentLine = 1;
-    
-    while (std::getline(stream, line) && currentLine < lineNumber) {
-        currentLine++;
-    }
-    
-    return line;
+    size_t start = lineIndex_.getLineStart(lineNumber - 1);
+    size_t end = lineIndex_.getLineEnd(lineNumber - 1);
+    return std::string_view(content_).substr(start, end - start);
 }
 
 void Editor::insertText(size_t position, const std::string& text) {
@@ -132,7 +267,7 @@ void Editor::insertText(size_t position, const std::string& text) {
         position = content_.length();
     }
     
-    content_.insert(position, text);
+    replaceRange(position, 0, text);
     modified_ = true;
     
     // 更新撤销重做栈
@@ -151,7 +286,7 @@ void Editor::deleteText(size_t start, size_t length) {
         length = content_.length() - start;
     }
     
-    content_.erase(start, length);
+    replaceRange(start, length, std::string_view());
     modified_ = true;
     
     // 更新撤销重做栈
@@ -161,21 +296,54 @@ void Editor::deleteText(size_t start, size_t length) {
     notifyContentChanged();
 }
 
-size_t Editor::findText(const std::string& searchText, size_t startPosition, bool caseSensitive) {
+size_t Editor::findText(const std::string& searchText, size_t startPosition, bool caseSensitive, bool wholeWord) {
     if (searchText.empty() || startPosition >= content_.length()) {
         return std::string::npos;
     }
     
-    std::string searchContent = content_.substr(startPosition);
-    std::string searchPattern = searchText;
-    
-    if (!caseSensitive) {
-        std::transform(searchContent.begin(), searchContent.end(), searchContent.begin(), ::tolower);
-        std::transform(searchPattern.begin(), searchPattern.end(), searchPattern.begin(), ::tolower);
+    // 直接在内容上查找，忽略大小写时也不再复制并转换整篇文档
+    TextSearch search(searchText, caseSensitive, wholeWord);
+    return search.find(content_.data(), content_.size(), startPosition);
+}
+
+size_t Editor::findTextInRange(const std::string& searchText, size_t rangeStart, size_t rangeEnd, bool forward,
+                               bool caseSensitive, bool wholeWord) const {
+    size_t end = std::min(rangeEnd, content_.size());
+    if (searchText.empty() || rangeStart >= end) {
+        return std::string::npos;
     }
     
-    size_t pos = searchContent.find(searchPattern);
-    return pos == std::string::npos ? std::string::npos : startPosition + pos;
+    // 把区间结束当作数据长度，匹配不会越过区间；向后查找使用反向内核。
+    // 区间边界不是单词边界，全字匹配在整篇内容上检查
+    TextSearch search(searchText, caseSensitive);
+    size_t matchLength = search.getMatchLength();
+    const char* data = content_.data();
+    if (forward) {
+        size_t position = search.find(data, end, rangeStart);
+        while (wholeWord && position != std::string::npos &&
+               !TextSearch::isWholeWord(data, content_.size(), position, matchLength)) {
+            position = search.find(data, end, position + 1);
+        }
+        return position;
+    }
+    size_t position = search.findLast(data, end, rangeStart);
+    while (wholeWord && position != std::string::npos &&
+           !TextSearch::isWholeWord(data, content_.size(), position, matchLength)) {
+        position = position + matchLength - 1 > rangeStart
+                       ? search.findLast(data, position + matchLength - 1, rangeStart)
+                       : std::string::npos;
+    }
+    return position;
+}
+
+size_t Editor::findTextBackward(const std::string& searchText, size_t position, bool caseSensitive,
+                                bool wholeWord) const {
+    if (searchText.empty() || position == 0) {
+        return std::string::npos;
+    }
+    // 起始位置在 position 之前的匹配最远结束于 position - 1 + 匹配长度
+    size_t matchLength = TextSearch(searchText, caseSensitive).getMatchLength();
+    return findTextInRange(searchText, 0, position - 1 + matchLength, false, caseSensitive, wholeWord);
 }
 
 size_t Editor::replaceText(const std::string& searchText, const std::string& replaceText, 
@@ -199,11 +367,12 @@ bool Editor::undo() {
     }
     
     // 保存当前状态到重做栈
+    std::string previous = std::move(undoStack_.back());
+    undoStack_.pop_back();
     redoStack_.push_back(content_);
     
     // 恢复上一个状态
-    content_ = undoStack_.back();
-    undoStack_.pop_back();
+    replaceContent(std::move(previous));
     modified_ = true;
     
     // 通知内容变化
@@ -218,11 +387,12 @@ bool Editor::redo() {
     }
     
     // 保存当前状态到撤销栈
+    std::string next = std::move(redoStack_.back());
+    redoStack_.pop_back();
     undoStack_.push_back(content_);
     
     // 恢复下一个状态
-    content_ = redoStack_.back();
-    redoStack_.pop_back();
+    replaceContent(std::move(next));
     modified_ = true;
     
     // 通知内容变化
@@ -240,9 +410,14 @@ bool Editor::canRedo() const {
 }
 
 void Editor::clear() {
-    content_.clear();
+    replaceContent(std::string());
     filePath_.clear();
     modified_ = false;
+    readOnly_ = false;
+    encoding_ = DetectedEncoding();
+    transcoded_ = false;
+    discardedLines_ = 0;
+    discardedBytes_ = 0;
     undoStack_.clear();
     redoStack_.clear();
     
@@ -258,6 +433,110 @@ void Editor::setFilePathChangedCallback(std::function<void(const std::string&)>
     filePathChangedCallback_ = callback;
 }
 
+size_t Editor::addEditListener(std::function<void(const TextEdit&)> listener) {
+    size_t listenerId = nextEditListenerId_++;
+    editListeners_.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void Editor::removeEditListener(size_t listenerId) {
+    editListeners_.erase(std::remove_if(editListeners_.begin(), editListeners_.end(),
+                                        [listenerId](const auto& entry) { return entry.first == listenerId; }),
+                         editListeners_.end());
+}
+
+const LineIndex& Editor::getLineIndex() const {
+    return lineIndex_;
+}
+
+void Editor::replaceRange(size_t position, size_t removedLength, std::string_view text) {
+    TextEdit edit;
+    edit.position = position;
+    edit.removedLength = removedLength;
+    edit.insertedLength = text.size();
+    edit.startLine = lineIndex_.getLineOfOffset(position);
+    edit.removedLineBreaks = LineIndex::countLineBreaks(content_.data() + position, removedLength);
+    edit.insertedLineBreaks = LineIndex::countLineBreaks(text.data(), text.size());
+    
+    content_.replace(position, removedLength, text.data(), text.size());
+    lineIndex_.applyEdit(position, removedLength, text.data(), text.size());
+    
+    notifyEdit(edit);
+}
+
+void Editor::replaceContent(std::string content) {
+    // 去掉首尾公共部分，只通知真正变化的区间
+    size_t oldLength = content_.size();
+    size_t newLength = content.size();
+    size_t shorter = std::min(oldLength, newLength);
+    size_t prefix = static_cast<size_t>(
+        std::mismatch(content_.begin(), content_.begin() + shorter, content.begin()).first - content_.begin());
+    if (prefix == oldLength && prefix == newLength) {
+        return;
+    }
+    size_t suffix = 0;
+    while (suffix < shorter - prefix && content_[oldLength - 1 - suffix] == content[newLength - 1 - suffix]) {
+        suffix++;
+    }
+    
+    TextEdit edit;
+    edit.position = prefix;
+    edit.removedLength = oldLength - prefix - suffix;
+    edit.insertedLength = newLength - prefix - suffix;
+    edit.startLine = lineIndex_.getLineOfOffset(prefix);
+    edit.removedLineBreaks = LineIndex::countLineBreaks(content_.data() + prefix, edit.removedLength);
+    edit.insertedLineBreaks = LineIndex::countLineBreaks(content.data() + prefix, edit.insertedLength);
+    
+    lineIndex_.applyEdit(prefix, edit.removedLength, content.data() + prefix, edit.insertedLength);
+    content_.swap(content);
+    
+    notifyEdit(edit);
+}
+
+void Editor::enforceRetention() {
+    size_t length = content_.size();
+    size_t lines = lineIndex_.getLineCount();
+    if ((retentionBytes_ == 0 || length <= retentionBytes_) && (retentionLines_ == 0 || lines <= retentionLines_)) {
+        return;
+    }
+    
+    // 一次丢弃到上限的 7/8，而不是每次追加都丢弃刚好超出的部分
+    size_t cutLine = 0;
+    if (retentionLines_ > 0) {
+        size_t target = retentionLines_ - retentionLines_ / 8;
+        cutLine = lines > target ? lines - target : 0;
+    }
+    if (retentionBytes_ > 0) {
+        size_t target = retentionBytes_ - retentionBytes_ / 8;
+        if (length > target) {
+            cutLine = std::max(cutLine, lineIndex_.getLineOfOffset(length - target) + 1);
+        }
+    }
+    // 至少保留最后一行（单独一行超过上限时整行保留）
+    cutLine = std::min(cutLine, lines - 1);
+    size_t cut = lineIndex_.getLineStart(cutLine);
+    if (cut > 0) {
+        discardFront(cut);
+    }
+}
+
+void Editor::discardFront(size_t length) {
+    TextEdit edit;
+    edit.position = 0;
+    edit.removedLength = length;
+    edit.insertedLength = 0;
+    edit.startLine = 0;
+    edit.insertedLineBreaks = 0;
+    
+    // 行索引只移动基准偏移，不改写其余各行
+    content_.erase(0, length);
+    edit.removedLineBreaks = lineIndex_.dropFront(length);
+    discardedLines_ += edit.removedLineBreaks;
+    discardedBytes_ += length;
+    
+    notifyEdit(edit);
+}
+
 void Editor::updateUndoRedoStack() {
     // 限制撤销栈大小
     const size_t maxStackSize = 100;
@@ -283,3 +562,9 @@ void Editor::notifyFilePathChanged() {
         filePathChangedCallback_(filePath_);
     }
 }
+
+void Editor::notifyEdit(const TextEdit& edit) {
+    for (const auto& entry : editListeners_) {
+        entry.second(edit);
+    }
+}
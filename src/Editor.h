@@ -1,10 +1,27 @@
 #ifndef EDITOR_H
 #define EDITOR_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <functional>
+#include "LineIndex.h"
+#include "EncodingDetector.h"
+
+/**
+ * 范围编辑描述
+ * 每次文本变化都以“在 position 处用 insertedLength 字节替换 removedLength 字节”的形式通知
+ */
+struct TextEdit {
+    size_t position;            // 编辑起始偏移
+    size_t removedLength;       // 被删除的字节数
+    size_t insertedLength;      // 插入的字节数
+    size_t startLine;           // 编辑起始行（从0开始）
+    size_t removedLineBreaks;   // 被删除文本中的换行符数量
+    size_t insertedLineBreaks;  // 插入文本中的换行符数量
+};
 
 /**
  * 编辑器类
@@ -17,13 +34,21 @@ public:
     
     /**
      * 打开文件
+     * gzip 文件解压后以只读方式打开
      * @param filePath 文件路径
      * @return 是否打开成功
      */
     bool openFile(const std::string& filePath);
     
+    /**
+     * 以只读方式打开一个空文档，内容随后由 appendText() 分批追加（后台解压 gzip 文件时使用）
+     * @param filePath 文件路径
+     */
+    void openStreamedFile(const std::string& filePath);
+    
     /**
      * 保存文件
+     * 只读文档不能保存回原文件，可以另存到其他路径
      * @param filePath 文件路径，如果为空则保存到当前文件
      * @return 是否保存成功
      */
@@ -43,11 +68,53 @@ public:
     std::string getContent() const;
     
     /**
-     * 设置文件内容
+     * 获取文件内容的只读视图（不复制）
+     * 视图在下一次编辑前有效
+     * @return 内容视图
+     */
+    std::string_view getContentView() const;
+    
+    /**
+     * 设置文件内容（只读文档不变）
      * @param content 新内容
      */
     void setContent(const std::string& content);
     
+    /**
+     * 在末尾追加从文件读到的内容（跟随文件增长时使用）
+     * 只通知一次范围编辑，不改变修改状态；追加不可撤销，撤销重做栈被清空
+     * @param text 追加的内容
+     */
+    void appendText(std::string_view text);
+    
+    /**
+     * 用重新读到的文件内容替换当前内容（文件被截断或替换时使用）
+     * 不改变文件路径，修改状态复位，撤销重做栈被清空，已丢弃的行数归零
+     * @param content 新内容
+     */
+    void reloadContent(std::string content);
+    
+    /**
+     * 设置保留上限（长时间跟随日志时使用）
+     * 追加后超过上限时从开头丢弃整行，一次丢弃到上限的 7/8，使搬移内容的开销均摊到每个追加的字节上；
+     * 丢弃以一次范围编辑通知，行号通过 getDiscardedLineCount() 换算为文件中的行号
+     * @param maxBytes 最多保留的字节数，0 表示不限制
+     * @param maxLines 最多保留的行数，0 表示不限制
+     */
+    void setRetentionLimit(size_t maxBytes, size_t maxLines);
+    
+    /**
+     * 获取已从开头丢弃的行数
+     * @return 行数
+     */
+    size_t getDiscardedLineCount() const;
+    
+    /**
+     * 获取已从开头丢弃的字节数
+     * @return 字节数
+     */
+    uint64_t getDiscardedByteCount() const;
+    
     /**
      * 获取当前文件路径
      * @return 文件路径
@@ -60,6 +127,24 @@ public:
      */
     bool isModified() const;
     
+    /**
+     * 文档是否只读（打开的是压缩文件、不是 UTF-8 的文件等无法原样写回的文件）
+     * @return 是否只读
+     */
+    bool isReadOnly() const;
+    
+    /**
+     * 获取打开文件时检测到的编码
+     * @return 编码检测结果
+     */
+    const DetectedEncoding& getEncoding() const;
+    
+    /**
+     * 内容是否由其他编码转换而来（保存时转换回原编码）
+     * @return 是否经过转换
+     */
+    bool isTranscoded() const;
+    
     /**
      * 设置修改状态
      * @param modified 修改状态
@@ -79,6 +164,14 @@ public:
      */
     std::string getLine(size_t lineNumber) const;
     
+    /**
+     * 获取指定行的内容视图（不复制，超长行也不会整行拷贝）
+     * 视图在内容下一次改变之前有效
+     * @param lineNumber 行号（从1开始）
+     * @return 行内容视图
+     */
+    std::string_view getLineView(size_t lineNumber) const;
+    
     /**
      * 插入文本
      * @param position 插入位置
@@ -98,9 +191,35 @@ public:
      * @param searchText 要查找的文本
      * @param startPosition 开始查找位置
      * @param caseSensitive 是否区分大小写
+     * @param wholeWord 是否全字匹配
+     * @return 找到的位置，如果未找到则返回std::string::npos
+     */
+    size_t findText(const std::string& searchText, size_t startPosition = 0, bool caseSensitive = true,
+                    bool wholeWord = false);
+    
+    /**
+     * 在区间内查找文本（直接在缓冲区上查找，可用于在选区中查找）
+     * @param searchText 要查找的文本
+     * @param rangeStart 区间起始
+     * @param rangeEnd 区间结束，匹配必须完全落在区间内；超过文档长度时按文档长度处理
+     * @param forward 为 true 时返回区间内第一个匹配，否则返回最后一个
+     * @param caseSensitive 是否区分大小写
+     * @param wholeWord 是否全字匹配（单词边界按整篇文档判断，不受区间影响）
      * @return 找到的位置，如果未找到则返回std::string::npos
      */
-    size_t findText(const std::string& searchText, size_t startPosition = 0, bool caseSensitive = true);
+    size_t findTextInRange(const std::string& searchText, size_t rangeStart, size_t rangeEnd, bool forward = true,
+                           bool caseSensitive = true, bool wholeWord = false) const;
+    
+    /**
+     * 向前查找文本：返回起始位置在 position 之前的最后一个匹配
+     * @param searchText 要查找的文本
+     * @param position 查找位置
+     * @param caseSensitive 是否区分大小写
+     * @param wholeWord 是否全字匹配
+     * @return 找到的位置，如果未找到则返回std::string::npos
+     */
+    size_t findTextBackward(const std::string& searchText, size_t position, bool caseSensitive = true,
+                            bool wholeWord = false) const;
     
     /**
      * 替换文本
@@ -153,15 +272,71 @@ public:
      * @param callback 回调函数
      */
     void setFilePathChangedCallback(std::function<void(const std::string&)> callback);
+    
+    /**
+     * 添加范围编辑监听器
+     * 监听器在内容和行索引更新之后调用
+     * @param listener 监听函数
+     * @return 监听器编号，用于移除
+     */
+    size_t addEditListener(std::function<void(const TextEdit&)> listener);
+    
+    /**
+     * 移除范围编辑监听器
+     * @param listenerId 监听器编号
+     */
+    void removeEditListener(size_t listenerId);
+    
+    /**
+     * 获取行索引
+     * @return 行索引
+     */
+    const LineIndex& getLineIndex() const;
 
 private:
     std::string content_;
     std::string filePath_;
     bool modified_;
+    bool readOnly_;
+    DetectedEncoding encoding_;
+    bool transcoded_;
     std::vector<std::string> undoStack_;
     std::vector<std::string> redoStack_;
     std::function<void()> contentChangedCallback_;
     std::function<void(const std::string&)> filePathChangedCallback_;
+    std::vector<std::pair<size_t, std::function<void(const TextEdit&)>>> editListeners_;
+    size_t nextEditListenerId_;
+    LineIndex lineIndex_;
+    size_t retentionBytes_;    // 保留上限（0 表示不限制）
+    size_t retentionLines_;
+    size_t discardedLines_;    // 已从开头丢弃的行数
+    uint64_t discardedBytes_;  // 已从开头丢弃的字节数
+    
+    /**
+     * 替换一段文本，更新行索引并通知编辑监听器
+     * @param position 起始偏移
+     * @param removedLength 删除的字节数
+     * @param text 插入的文本
+     */
+    void replaceRange(size_t position, size_t removedLength, std::string_view text);
+    
+    /**
+     * 用新内容整体替换当前内容
+     * 只把首尾公共部分之外的差异区间作为一次范围编辑通知
+     * @param content 新内容
+     */
+    void replaceContent(std::string content);
+    
+    /**
+     * 超过保留上限时从开头丢弃整行
+     */
+    void enforceRetention();
+    
+    /**
+     * 丢弃开头的内容并通知范围编辑
+     * @param length 丢弃的字节数
+     */
+    void discardFront(size_t length);
     
     /**
      * 更新撤销重做栈
@@ -177,6 +352,12 @@ private:
      * 通知文件路径变化
      */
     void notifyFilePathChanged();
+    
+    /**
+     * 通知范围编辑
+     * @param edit 编辑描述
+     */
+    void notifyEdit(const TextEdit& edit);
 };
 
 #endif // EDITOR_H
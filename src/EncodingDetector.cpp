@@ -0,0 +1,396 @@
+#include "EncodingDetector.h"
+#include <algorithm>
+#include <cstring>
+
+// AVX2 的查表验证不依赖编译选项：GCC/Clang 按函数指定目标指令集编译，运行时检测 CPU 后选用；
+// 其他编译器只在整体开启 AVX2 时使用
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LITEPAD_ENCODING_AVX2 1
+#define LITEPAD_AVX2_TARGET
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LITEPAD_ENCODING_AVX2 1
+#define LITEPAD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEPAD_ENCODING_SSE2 1
+#endif
+
+namespace {
+
+// 检查 UTF-16 零字节分布和二进制内容时只看开头
+const size_t kProbeBytes = 8192;
+
+// 统计 GB18030 特征时最多检查的字节数
+const size_t kLegacySampleBytes = 1024 * 1024;
+
+#if defined(LITEPAD_ENCODING_AVX2)
+
+// 查表法中的错误类别：前一个字节的高、低半字节与当前字节的高半字节各查出一组可能的错误，三者求与
+const uint8_t kTooShort = 1 << 0;     // 11______ 0_______、11______ 11______
+const uint8_t kTooLong = 1 << 1;      // 0_______ 10______
+const uint8_t kOverlong3 = 1 << 2;    // 11100000 100_____
+const uint8_t kTooLarge = 1 << 3;     // 11110100 1001____ 等
+const uint8_t kSurrogate = 1 << 4;    // 11101101 101_____
+const uint8_t kOverlong2 = 1 << 5;    // 1100000_ 10______
+const uint8_t kTooLarge1000 = 1 << 6; // 11110101 1000____ 等
+const uint8_t kOverlong4 = 1 << 6;    // 11110000 1000____
+const uint8_t kTwoConts = 1 << 7;     // 10______ 10______
+const uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+LITEPAD_AVX2_TARGET inline __m256i table16(uint8_t v0, uint8_t v1, uint8_t v2, uint8_t v3, uint8_t v4,
+                                           uint8_t v5, uint8_t v6, uint8_t v7, uint8_t v8, uint8_t v9, uint8_t v10,
+                                           uint8_t v11, uint8_t v12, uint8_t v13, uint8_t v14, uint8_t v15) {
+    return _mm256_setr_epi8(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15,
+                            v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15);
+}
+
+LITEPAD_AVX2_TARGET inline __m256i highNibbles(__m256i value) {
+    return _mm256_and_si256(_mm256_srli_epi16(value, 4), _mm256_set1_epi8(0x0F));
+}
+
+// 当前块整体后移 n 个字节，前面补上一块的末尾
+template <int N>
+LITEPAD_AVX2_TARGET inline __m256i previous(__m256i input, __m256i previousInput) {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previousInput, input, 0x21), 16 - N);
+}
+
+/**
+ * 验证一个 32 字节块，返回错误位（全零表示没有错误）
+ */
+LITEPAD_AVX2_TARGET inline __m256i checkBlock(__m256i input, __m256i previousInput) {
+    const __m256i byte1HighTable = table16(
+        kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+        kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+        kTooShort | kOverlong2, kTooShort, kTooShort | kOverlong3 | kSurrogate,
+        kTooShort | kTooLarge | kTooLarge1000 | kOverlong4);
+    const __m256i byte1LowTable = table16(
+        kCarry | kOverlong3 | kOverlong2 | kOverlong4, kCarry | kOverlong2, kCarry, kCarry,
+        kCarry | kTooLarge, kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000 | kSurrogate, kCarry | kTooLarge | kTooLarge1000,
+        kCarry | kTooLarge | kTooLarge1000);
+    const __m256i byte2HighTable = table16(
+        kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+        kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+        kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+        kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+        kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+        kTooShort, kTooShort, kTooShort, kTooShort);
+
+    __m256i previous1 = previous<1>(input, previousInput);
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(byte1HighTable, highNibbles(previous1)),
+                         _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(previous1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(byte2HighTable, highNibbles(input)));
+
+    // 三字节、四字节字符的第三、四个字节必须是续字节
+    __m256i third = _mm256_subs_epu8(previous<2>(input, previousInput), _mm256_set1_epi8(0x60));
+    __m256i fourth = _mm256_subs_epu8(previous<3>(input, previousInput), _mm256_set1_epi8(0x70));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must23, special);
+}
+
+/**
+ * 用查表法验证 UTF-8，每次 32 字节
+ */
+LITEPAD_AVX2_TARGET bool validateUtf8Avx2(const unsigned char* bytes, size_t length) {
+    __m256i error = _mm256_setzero_si256();
+    __m256i previousInput = _mm256_setzero_si256();
+    __m256i previousIncomplete = _mm256_setzero_si256();
+    // 块末尾的三个字节分别不能是四字节、三字节、两字节字符的首字节
+    const __m256i maxValue = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    size_t pos = 0;
+    for (; pos + 32 <= length; pos += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + pos));
+        if (_mm256_movemask_epi8(input) == 0) {
+            // 整块 ASCII：只需检查上一块末尾没有未完成的字符
+            error = _mm256_or_si256(error, previousIncomplete);
+            previousIncomplete = _mm256_setzero_si256();
+        } else {
+            error = _mm256_or_si256(error, checkBlock(input, previousInput));
+            previousIncomplete = _mm256_subs_epu8(input, maxValue);
+        }
+        previousInput = input;
+    }
+    // 尾部补零成一个整块：截断的字符后面跟着 ASCII，会被当作过短的序列
+    unsigned char tail[32] = {0};
+    std::memcpy(tail, bytes + pos, length - pos);
+    __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+    error = _mm256_or_si256(error, checkBlock(input, previousInput));
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+/**
+ * 是否只有 ASCII 字节，每次 32 字节
+ */
+LITEPAD_AVX2_TARGET bool isAsciiAvx2(const unsigned char* bytes, size_t length) {
+    size_t pos = 0;
+    __m256i any = _mm256_setzero_si256();
+    for (; pos + 32 <= length; pos += 32) {
+        any = _mm256_or_si256(any, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + pos)));
+    }
+    unsigned char rest = 0;
+    for (; pos < length; pos++) {
+        rest |= bytes[pos];
+    }
+    return _mm256_movemask_epi8(any) == 0 && rest < 0x80;
+}
+
+/**
+ * CPU 是否支持 AVX2（只检测一次）
+ */
+bool hasAvx2() {
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
+}
+
+#endif
+
+}  // namespace
+
+DetectedEncoding EncodingDetector::detect(const char* data, size_t length, size_t sampleBytes) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    DetectedEncoding result;
+    result.sampled = length > sampleBytes;
+    size_t sample = std::min(length, sampleBytes);
+
+    // 字节顺序标记
+    if (sample >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        result.encoding = TextEncoding::Utf8;
+        result.bomLength = 3;
+        return result;
+    }
+    if (sample >= 2 && ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF))) {
+        result.encoding = bytes[0] == 0xFF ? TextEncoding::Utf16LE : TextEncoding::Utf16BE;
+        result.bomLength = 2;
+        return result;
+    }
+
+    size_t probe = std::min(sample, kProbeBytes);
+    if (looksLikeUtf16(bytes, probe, result.encoding)) {
+        return result;
+    }
+    if (std::memchr(bytes, 0, probe)) {
+        result.encoding = TextEncoding::Binary;
+        return result;
+    }
+
+    // 只检查开头时，末尾被截断的字符不算错误
+    size_t end = sample;
+    if (result.sampled) {
+        size_t back = 0;
+        while (back < 3 && back < end && (bytes[end - 1 - back] & 0xC0) == 0x80) {
+            back++;
+        }
+        if (back < end) {
+            unsigned char lead = bytes[end - 1 - back];
+            size_t needed = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+            if (back + 1 < needed) {
+                end -= back + 1;
+            }
+        }
+    }
+
+    if (isAscii(data, end)) {
+        result.encoding = TextEncoding::Ascii;
+    } else if (isValidUtf8(data, end)) {
+        result.encoding = TextEncoding::Utf8;
+    } else if (looksLikeGb18030(bytes, std::min(end, kLegacySampleBytes))) {
+        result.encoding = TextEncoding::Gb18030;
+    } else {
+        result.encoding = TextEncoding::Windows1252;
+    }
+    return result;
+}
+
+bool EncodingDetector::isValidUtf8(const char* data, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+#if defined(LITEPAD_ENCODING_AVX2)
+    if (hasAvx2()) {
+        return validateUtf8Avx2(bytes, length);
+    }
+#endif
+#if defined(LITEPAD_ENCODING_SSE2)
+    size_t pos = 0;
+    while (pos + 64 <= length) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos + 48));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+            pos += 64;
+            continue;
+        }
+        if (!validateScalar(bytes, length, pos, pos + 64, pos)) {
+            return false;
+        }
+    }
+    return validateScalar(bytes, length, pos, length, pos);
+#else
+    size_t pos = 0;
+    return validateScalar(bytes, length, 0, length, pos);
+#endif
+}
+
+bool EncodingDetector::isAscii(const char* data, size_t length) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t pos = 0;
+#if defined(LITEPAD_ENCODING_AVX2)
+    if (hasAvx2()) {
+        return isAsciiAvx2(bytes, length);
+    }
+#endif
+#if defined(LITEPAD_ENCODING_SSE2)
+    __m128i any = _mm_setzero_si128();
+    for (; pos + 16 <= length; pos += 16) {
+        any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos)));
+    }
+    if (_mm_movemask_epi8(any) != 0) {
+        return false;
+    }
+#endif
+    unsigned char rest = 0;
+    for (; pos < length; pos++) {
+        rest |= bytes[pos];
+    }
+    return rest < 0x80;
+}
+
+const char* EncodingDetector::getName(TextEncoding encoding) {
+    switch (encoding) {
+    case TextEncoding::Ascii:
+        return "ASCII";
+    case TextEncoding::Utf8:
+        return "UTF-8";
+    case TextEncoding::Utf16LE:
+        return "UTF-16 LE";
+    case TextEncoding::Utf16BE:
+        return "UTF-16 BE";
+    case TextEncoding::Gb18030:
+        return "GB18030";
+    case TextEncoding::Windows1252:
+        return "Windows-1252";
+    case TextEncoding::Binary:
+        return "二进制";
+    }
+    return "";
+}
+
+bool EncodingDetector::validateScalar(const unsigned char* data, size_t length, size_t from, size_t until,
+                                      size_t& position) {
+    size_t i = from;
+    while (i < length && i < until) {
+        unsigned char c = data[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t count = 0;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            count = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            count = 2;
+            low = c == 0xE0 ? 0xA0 : 0x80;
+            high = c == 0xED ? 0x9F : 0xBF;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            count = 3;
+            low = c == 0xF0 ? 0x90 : 0x80;
+            high = c == 0xF4 ? 0x8F : 0xBF;
+        } else {
+            return false;
+        }
+        if (i + count >= length) {
+            return false;
+        }
+        if (data[i + 1] < low || data[i + 1] > high) {
+            return false;
+        }
+        for (size_t k = 2; k <= count; k++) {
+            if ((data[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += count + 1;
+    }
+    position = i;
+    return true;
+}
+
+bool EncodingDetector::looksLikeUtf16(const unsigned char* data, size_t length, TextEncoding& encoding) {
+    size_t pairs = length / 2;
+    if (pairs < 2) {
+        return false;
+    }
+    size_t evenZeros = 0;
+    size_t oddZeros = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        evenZeros += data[i] == 0 ? 1 : 0;
+        oddZeros += data[i + 1] == 0 ? 1 : 0;
+    }
+    // 以 ASCII 为主的 UTF-16 文本每两个字节中有一个零字节，且总在同一侧
+    if (oddZeros * 10 >= pairs * 3 && evenZeros * 20 < pairs) {
+        encoding = TextEncoding::Utf16LE;
+        return true;
+    }
+    if (evenZeros * 10 >= pairs * 3 && oddZeros * 20 < pairs) {
+        encoding = TextEncoding::Utf16BE;
+        return true;
+    }
+    return false;
+}
+
+bool EncodingDetector::looksLikeGb18030(const unsigned char* data, size_t length) {
+    size_t characters = 0;
+    size_t common = 0;
+    size_t i = 0;
+    while (i < length) {
+        unsigned char c = data[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        if (c == 0x80 || c == 0xFF) {
+            return false;
+        }
+        if (i + 1 >= length) {
+            break;  // 末尾被截断
+        }
+        unsigned char d = data[i + 1];
+        if (d >= 0x30 && d <= 0x39) {
+            // 四字节序列：首字节、数字、首字节范围、数字
+            if (i + 3 >= length) {
+                break;
+            }
+            if (data[i + 2] < 0x81 || data[i + 2] > 0xFE || data[i + 3] < 0x30 || data[i + 3] > 0x39) {
+                return false;
+            }
+            characters++;
+            i += 4;
+            continue;
+        }
+        if (d < 0x40 || d == 0x7F || d == 0xFF) {
+            return false;
+        }
+        characters++;
+        // GB2312 的符号区（A1-A9）和汉字区（B0-F7）
+        if (d >= 0xA1 && ((c >= 0xA1 && c <= 0xA9) || (c >= 0xB0 && c <= 0xF7))) {
+            common++;
+        }
+        i += 2;
+    }
+    // 西欧文本中偶尔连续出现的两个重音字母也能凑成双字节序列，但很少落在常用区
+    return characters > 0 && common * 2 >= characters;
+}
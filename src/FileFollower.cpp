@@ -0,0 +1,191 @@
+#include "FileFollower.h"
+#include <cerrno>
+#include <iostream>
+
+#ifndef _WIN32
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 每次 pread 读取的字节数
+const size_t kReadChunk = 256 * 1024;
+
+}  // namespace
+
+FileFollower::FileFollower() : fd_(-1), device_(0), inode_(0), offset_(0), reset_(false) {
+    // 监视的是单个文件，任何变化（包括事件队列溢出）都只需重新检查这个文件
+    watcher_.setCallback([this](const std::vector<FileChange>&) { poll(); });
+}
+
+FileFollower::~FileFollower() {
+    stop();
+}
+
+bool FileFollower::start(const std::string& path, uint64_t offset) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        offset_ = offset;
+        reset_ = false;
+        pending_.clear();
+        if (!reopen()) {
+            return false;
+        }
+    }
+    if (!watcher_.watchFile(path)) {
+        stop();
+        return false;
+    }
+    // 载入文件与开始监视之间写入的内容
+    poll();
+    return true;
+}
+
+void FileFollower::stop() {
+    watcher_.stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+#ifndef _WIN32
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    pending_.clear();
+    reset_ = false;
+}
+
+bool FileFollower::isFollowing() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fd_ >= 0;
+}
+
+const std::string& FileFollower::getPath() const {
+    return path_;
+}
+
+bool FileFollower::poll() {
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        changed = readChanges();
+    }
+    if (changed) {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        if (dataReadyCallback_) {
+            dataReadyCallback_();
+        }
+    }
+    return changed;
+}
+
+bool FileFollower::collect(FollowUpdate& update) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t length = completeLength(pending_.data(), pending_.size());
+    if (!reset_ && length == 0) {
+        return false;
+    }
+    update.reset = reset_;
+    update.data.assign(pending_, 0, length);
+    pending_.erase(0, length);
+    reset_ = false;
+    return true;
+}
+
+void FileFollower::setDataReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    dataReadyCallback_ = callback;
+}
+
+size_t FileFollower::completeLength(const char* data, size_t length) {
+    // 从末尾向前最多看 3 个字节，找到最后一个字符的首字节
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        unsigned char c = static_cast<unsigned char>(data[length - back]);
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+        if (c >= 0xC0) {
+            size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            return back < need ? length - back : length;
+        }
+        return length;
+    }
+    return length;
+}
+
+bool FileFollower::reopen() {
+#ifdef _WIN32
+    return false;
+#else
+    int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+    device_ = static_cast<uint64_t>(info.st_dev);
+    inode_ = static_cast<uint64_t>(info.st_ino);
+    return true;
+#endif
+}
+
+bool FileFollower::readChanges() {
+#ifdef _WIN32
+    return false;
+#else
+    bool changed = false;
+    struct stat info;
+    // 路径指向了另一个文件（改名式轮转后重新创建），切换到新文件并从头读取；
+    // 文件被删除而尚未重新创建时继续读旧文件
+    if (::stat(path_.c_str(), &info) == 0 &&
+        (fd_ < 0 || static_cast<uint64_t>(info.st_dev) != device_ || static_cast<uint64_t>(info.st_ino) != inode_) &&
+        reopen()) {
+        resetPending();
+        changed = true;
+    }
+    if (fd_ < 0 || ::fstat(fd_, &info) != 0) {
+        return changed;
+    }
+    if (static_cast<uint64_t>(info.st_size) < offset_) {
+        // 文件变短：被截断后重新写入
+        resetPending();
+        changed = true;
+    }
+
+    // 一直读到文件末尾，不依赖 fstat 得到的大小（读取期间文件可能继续增长）
+    while (true) {
+        size_t used = pending_.size();
+        pending_.resize(used + kReadChunk);
+        ssize_t count = ::pread(fd_, &pending_[used], kReadChunk, static_cast<off_t>(offset_));
+        if (count <= 0) {
+            pending_.resize(used);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        pending_.resize(used + static_cast<size_t>(count));
+        offset_ += static_cast<uint64_t>(count);
+        changed = true;
+    }
+    return changed;
+#endif
+}
+
+void FileFollower::resetPending() {
+    pending_.clear();
+    reset_ = true;
+    offset_ = 0;
+}
@@ -0,0 +1,121 @@
+#ifndef FILE_FOLLOWER_H
+#define FILE_FOLLOWER_H
+
+#include "FileWatcher.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+/**
+ * 跟随文件增长读到的内容
+ */
+struct FollowUpdate {
+    bool reset;        // 文件被截断或替换（inode 变化），data 为新文件从头开始的内容
+    std::string data;  // 追加的内容
+};
+
+/**
+ * 文件跟随器（tail -F）
+ * 用 FileWatcher 监视文件所在目录，收到变化后在监视线程中用 pread 从上次读到的位置读出追加的字节，
+ * 界面线程通过 collect() 取走。两次写入之间线程阻塞在 inotify 上，不占用 CPU。
+ *
+ * 文件变短视为被截断（copytruncate 式轮转），路径指向的 inode 变化视为被替换（改名式轮转），
+ * 两种情况都重新打开并从头读取。末尾不完整的 UTF-8 字符暂不送出，等后续字节到达后一起送出
+ */
+class FileFollower {
+public:
+    FileFollower();
+    ~FileFollower();
+
+    FileFollower(const FileFollower&) = delete;
+    FileFollower& operator=(const FileFollower&) = delete;
+
+    /**
+     * 开始跟随文件（已在跟随时先停止）
+     * @param path 文件路径
+     * @param offset 已经载入的字节数，从这里开始读取
+     * @return 是否成功（文件无法打开或平台不支持时返回 false）
+     */
+    bool start(const std::string& path, uint64_t offset);
+
+    /**
+     * 停止跟随，丢弃尚未取走的内容
+     */
+    void stop();
+
+    /**
+     * 是否正在跟随
+     * @return 是否正在跟随
+     */
+    bool isFollowing() const;
+
+    /**
+     * 获取正在跟随的文件路径
+     * @return 文件路径
+     */
+    const std::string& getPath() const;
+
+    /**
+     * 立即检查文件并读取新内容（通常由监视线程调用，也可在界面线程中主动调用）
+     * @return 是否有新内容可以取走
+     */
+    bool poll();
+
+    /**
+     * 取走已读到的内容（在界面线程中调用，通常在收到回调之后）
+     * @param update 输出内容
+     * @return 是否有新内容
+     */
+    bool collect(FollowUpdate& update);
+
+    /**
+     * 设置新内容到达回调
+     * 回调在监视线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setDataReadyCallback(std::function<void()> callback);
+
+    /**
+     * 计算末尾不完整的 UTF-8 字符之前的长度
+     * @param data 数据
+     * @param length 长度
+     * @return 可以送出的字节数
+     */
+    static size_t completeLength(const char* data, size_t length);
+
+private:
+    std::string path_;
+    FileWatcher watcher_;
+
+    mutable std::mutex mutex_;  // 保护以下状态
+    int fd_;
+    uint64_t device_;
+    uint64_t inode_;
+    uint64_t offset_;      // 已读到的文件偏移
+    bool reset_;           // pending_ 从新文件开头开始
+    std::string pending_;  // 尚未取走的内容（可能以不完整的 UTF-8 字符结尾）
+
+    std::mutex callbackMutex_;
+    std::function<void()> dataReadyCallback_;
+
+    /**
+     * 打开路径当前指向的文件，记录其 inode（需持有锁）
+     * @return 是否成功
+     */
+    bool reopen();
+
+    /**
+     * 检测截断和替换，并读出追加的字节（需持有锁）
+     * @return 是否读到了新内容或发生了重置
+     */
+    bool readChanges();
+
+    /**
+     * 丢弃已读内容，下一次从文件开头读取（需持有锁）
+     */
+    void resetPending();
+};
+
+#endif // FILE_FOLLOWER_H
@@ -0,0 +1,415 @@
+#include "FileSearcher.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <utility>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <fstream>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 每次读取的窗口大小，不超过此大小的文件一次读完
+const size_t kReadWindow = 1 << 20;
+
+// 判断二进制内容时检查的前缀长度
+const size_t kBinaryProbeLength = 8192;
+
+std::string joinPath(const std::string& directory, const std::string& name) {
+    if (!directory.empty() && (directory.back() == '/' || directory.back() == '\\')) {
+        return directory + name;
+    }
+    return directory + "/" + name;
+}
+
+}  // namespace
+
+FileSearchOptions::FileSearchOptions()
+    : caseSensitive(true), useRegex(false), wholeWord(false), maxFileSize(64ull << 20), maxMatchesPerFile(1000),
+      maxLineLength(512), followSymlinks(false), excludedDirectories{".git", ".svn", ".hg"} {}
+
+/**
+ * 一次查找的共享状态，由该次查找的所有任务共同持有
+ */
+struct FileSearcher::Search {
+    FileSearchOptions options;
+    SearchPattern pattern;
+    MatchCallback onMatches;
+    FinishedCallback onFinished;
+    std::function<void(const std::string&)> onFile;  // 设置时只列出文件，不扫描内容
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> running{true};
+    std::atomic<size_t> outstanding{0};  // 尚未完成的任务数
+
+    std::atomic<size_t> directoriesScanned{0};
+    std::atomic<size_t> filesScanned{0};
+    std::atomic<size_t> filesSkipped{0};
+    std::atomic<uint64_t> bytesScanned{0};
+    std::atomic<size_t> matchCount{0};
+
+    std::mutex callbackMutex;
+    std::mutex visitedMutex;
+    std::set<std::pair<uint64_t, uint64_t>> visited;  // 跟随符号链接时已遍历目录的 (设备, inode)
+
+    FileSearchStats stats() const {
+        return FileSearchStats{directoriesScanned, filesScanned, filesSkipped, bytesScanned, matchCount, cancelled};
+    }
+};
+
+FileSearcher::FileSearcher(size_t threadCount) : pool_(threadCount) {}
+
+FileSearcher::~FileSearcher() {
+    cancel();
+    wait();
+}
+
+bool FileSearcher::start(const std::vector<std::string>& roots, const FileSearchOptions& options,
+                         MatchCallback onMatches, FinishedCallback onFinished) {
+    auto search = std::make_shared<Search>();
+    if (!search->pattern.compile(options.pattern, options.caseSensitive, options.useRegex, options.wholeWord)) {
+        return false;
+    }
+    cancel();
+    wait();
+
+    search->options = options;
+    search->onMatches = std::move(onMatches);
+    search->onFinished = std::move(onFinished);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_ = search;
+    }
+
+    submitRoots(search, roots);
+    return true;
+}
+
+void FileSearcher::listFiles(const std::vector<std::string>& roots, const FileSearchOptions& options,
+                             std::vector<std::string>& files) {
+    auto search = std::make_shared<Search>();
+    search->options = options;
+    std::mutex filesMutex;
+    search->onFile = [&files, &filesMutex](const std::string& path) {
+        std::lock_guard<std::mutex> lock(filesMutex);
+        files.push_back(path);
+    };
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    bool done = false;
+    search->onFinished = [&](const FileSearchStats&) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done = true;
+        doneCondition.notify_all();
+    };
+    submitRoots(search, roots);
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&done]() { return done; });
+}
+
+void FileSearcher::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_) {
+        current_->cancelled = true;
+    }
+}
+
+void FileSearcher::wait() {
+    pool_.wait();
+}
+
+bool FileSearcher::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_ && current_->running;
+}
+
+FileSearchStats FileSearcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_) {
+        return FileSearchStats{0, 0, 0, 0, 0, false};
+    }
+    return current_->stats();
+}
+
+void FileSearcher::submitRoots(const std::shared_ptr<Search>& search, const std::vector<std::string>& roots) {
+    // 先计入一个占位任务，避免第一个根目录还在派生子任务时计数就归零
+    search->outstanding = 1;
+    for (const std::string& root : roots) {
+#ifdef _WIN32
+        std::error_code error;
+        bool directory = std::filesystem::is_directory(root, error);
+#else
+        struct stat info;
+        bool directory = ::stat(root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+        if (directory) {
+            submitTask(search, [this, search, root]() { walkDirectory(search, root); });
+        } else {
+            submitTask(search, [this, search, root]() { scanFile(search, root); });
+        }
+    }
+    finishTask(search);
+}
+
+bool FileSearcher::isBinary(const char* data, size_t length) {
+    return std::memchr(data, '\0', std::min(length, kBinaryProbeLength)) != nullptr;
+}
+
+void FileSearcher::searchBuffer(const std::string& path, const char* data, size_t length, size_t firstLine,
+                                const SearchPattern& pattern, const FileSearchOptions& options,
+                                std::vector<FileSearchMatch>& matches, const std::atomic<bool>* cancelled) {
+    size_t line = firstLine;
+    size_t lineStart = 0;
+    size_t counted = 0;  // [0, counted) 中的换行已计入 line
+    size_t pos = 0;
+    size_t matchLength = 0;
+    while (matches.size() < options.maxMatchesPerFile && pos <= length &&
+           pattern.findNext(data, length, pos, pos, matchLength)) {
+        if (cancelled && *cancelled) {
+            return;
+        }
+        // 只在有匹配时才向前数换行，没有匹配的大段文本不逐字节处理
+        const char* newline = nullptr;
+        while ((newline = static_cast<const char*>(std::memchr(data + counted, '\n', pos - counted))) != nullptr) {
+            line++;
+            counted = static_cast<size_t>(newline - data) + 1;
+            lineStart = counted;
+        }
+        counted = pos;
+
+        const char* lineEnd = static_cast<const char*>(std::memchr(data + lineStart, '\n', length - lineStart));
+        size_t lineLength = (lineEnd ? static_cast<size_t>(lineEnd - data) : length) - lineStart;
+        if (lineLength > 0 && data[lineStart + lineLength - 1] == '\r') {
+            lineLength--;
+        }
+        matches.push_back(FileSearchMatch{path, line, pos - lineStart,
+                                          std::string(data + lineStart, std::min(lineLength, options.maxLineLength))});
+        pos += std::max<size_t>(matchLength, 1);
+    }
+}
+
+#ifdef _WIN32
+
+bool FileSearcher::searchFile(const std::string& path, const SearchPattern& pattern, const FileSearchOptions& options,
+                              std::vector<FileSearchMatch>& matches, uint64_t* bytesRead,
+                              const std::atomic<bool>* cancelled) {
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return false;
+    }
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error || size > options.maxFileSize) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string content(static_cast<size_t>(size), '\0');
+    file.read(&content[0], static_cast<std::streamsize>(size));
+    content.resize(static_cast<size_t>(file.gcount()));
+    if (isBinary(content.data(), content.size())) {
+        return false;
+    }
+    if (bytesRead) {
+        *bytesRead = content.size();
+    }
+    std::vector<FileSearchMatch> found;
+    searchBuffer(path, content.data(), content.size(), 0, pattern, options, found, cancelled);
+    std::move(found.begin(), found.end(), std::back_inserter(matches));
+    return true;
+}
+
+void FileSearcher::walkDirectory(const std::shared_ptr<Search>& search, const std::string& path) {
+    search->directoriesScanned++;
+    std::error_code error;
+    std::filesystem::directory_iterator it(path, error);
+    for (; !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+        if (search->cancelled) {
+            break;
+        }
+        const std::filesystem::directory_entry& entry = *it;
+        std::string child = entry.path().string();
+        if (entry.is_symlink(error) && !search->options.followSymlinks) {
+            continue;
+        }
+        if (entry.is_directory(error)) {
+            const auto& excluded = search->options.excludedDirectories;
+            if (std::find(excluded.begin(), excluded.end(), entry.path().filename().string()) == excluded.end()) {
+                submitTask(search, [this, search, child]() { walkDirectory(search, child); });
+            }
+        } else if (entry.is_regular_file(error)) {
+            submitTask(search, [this, search, child]() { scanFile(search, child); });
+        }
+    }
+}
+
+#else
+
+bool FileSearcher::searchFile(const std::string& path, const SearchPattern& pattern, const FileSearchOptions& options,
+                              std::vector<FileSearchMatch>& matches, uint64_t* bytesRead,
+                              const std::atomic<bool>* cancelled) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+        static_cast<uint64_t>(info.st_size) > options.maxFileSize) {
+        ::close(fd);
+        return false;
+    }
+
+    // 窗口只在行边界处结束，最后一个不完整的行留到下一个窗口，
+    // 因此行号和行文本在窗口间保持正确；不直接 mmap 是为了避免日志被截断时访问越界页
+    thread_local std::vector<char> buffer;
+    size_t windowSize = std::min(static_cast<size_t>(info.st_size), kReadWindow);
+    std::vector<FileSearchMatch> found;
+    uint64_t offset = 0;
+    size_t carry = 0;
+    size_t line = 0;
+    bool scanned = true;
+    while (!(cancelled && *cancelled) && found.size() < options.maxMatchesPerFile) {
+        if (buffer.size() < carry + windowSize) {
+            buffer.resize(carry + windowSize);
+        }
+        ssize_t count = ::pread(fd, buffer.data() + carry, windowSize, static_cast<off_t>(offset));
+        if (count < 0 || (offset == 0 && count > 0 && isBinary(buffer.data(), static_cast<size_t>(count)))) {
+            scanned = false;
+            break;
+        }
+        offset += static_cast<uint64_t>(count);
+        size_t length = carry + static_cast<size_t>(count);
+        bool last = count == 0 || offset >= static_cast<uint64_t>(info.st_size);
+
+        size_t end = length;
+        if (!last) {
+            // 超长的行（没有换行）只能在窗口处切开
+            for (size_t i = length; i > 0; --i) {
+                if (buffer[i - 1] == '\n') {
+                    end = i;
+                    break;
+                }
+            }
+        }
+        searchBuffer(path, buffer.data(), end, line, pattern, options, found, cancelled);
+        if (last) {
+            break;
+        }
+        line += static_cast<size_t>(std::count(buffer.data(), buffer.data() + end, '\n'));
+        carry = length - end;
+        std::memmove(buffer.data(), buffer.data() + end, carry);
+    }
+    ::close(fd);
+
+    if (bytesRead) {
+        *bytesRead = offset;
+    }
+    std::move(found.begin(), found.end(), std::back_inserter(matches));
+    return scanned;
+}
+
+void FileSearcher::walkDirectory(const std::shared_ptr<Search>& search, const std::string& path) {
+    DIR* directory = ::opendir(path.c_str());
+    if (!directory) {
+        return;
+    }
+    int directoryFd = ::dirfd(directory);
+    if (search->options.followSymlinks) {
+        // 跟随符号链接时可能形成环，按 (设备, inode) 去重
+        struct stat info;
+        if (::fstat(directoryFd, &info) == 0) {
+            std::lock_guard<std::mutex> lock(search->visitedMutex);
+            if (!search->visited.emplace(info.st_dev, info.st_ino).second) {
+                ::closedir(directory);
+                return;
+            }
+        }
+    }
+    search->directoriesScanned++;
+
+    const auto& excluded = search->options.excludedDirectories;
+    struct dirent* entry = nullptr;
+    while (!search->cancelled && (entry = ::readdir(directory)) != nullptr) {
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+            continue;
+        }
+        // 大多数文件系统直接给出类型，只有未知类型和符号链接才需要 stat
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN || (type == DT_LNK && search->options.followSymlinks)) {
+            struct stat info;
+            int flags = type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW;
+            if (::fstatat(directoryFd, name, &info, flags) != 0) {
+                continue;
+            }
+            type = S_ISDIR(info.st_mode) ? DT_DIR : S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+
+        if (type == DT_DIR) {
+            if (std::find(excluded.begin(), excluded.end(), name) == excluded.end()) {
+                std::string child = joinPath(path, name);
+                submitTask(search, [this, search, child]() { walkDirectory(search, child); });
+            }
+        } else if (type == DT_REG) {
+            std::string child = joinPath(path, name);
+            submitTask(search, [this, search, child]() { scanFile(search, child); });
+        }
+    }
+    ::closedir(directory);
+}
+
+#endif
+
+void FileSearcher::scanFile(const std::shared_ptr<Search>& search, const std::string& path) {
+    if (search->cancelled) {
+        return;
+    }
+    if (search->onFile) {
+        search->onFile(path);
+        return;
+    }
+    std::vector<FileSearchMatch> matches;
+    uint64_t bytesRead = 0;
+    if (searchFile(path, search->pattern, search->options, matches, &bytesRead, &search->cancelled)) {
+        search->filesScanned++;
+    } else {
+        search->filesSkipped++;
+    }
+    search->bytesScanned += bytesRead;
+    if (!matches.empty() && !search->cancelled) {
+        search->matchCount += matches.size();
+        std::lock_guard<std::mutex> lock(search->callbackMutex);
+        if (search->onMatches) {
+            search->onMatches(matches);
+        }
+    }
+}
+
+void FileSearcher::submitTask(const std::shared_ptr<Search>& search, std::function<void()> task) {
+    search->outstanding++;
+    pool_.submit([this, search, task]() {
+        task();
+        finishTask(search);
+    });
+}
+
+void FileSearcher::finishTask(const std::shared_ptr<Search>& search) {
+    if (--search->outstanding > 0) {
+        return;
+    }
+    search->running = false;
+    if (search->onFinished) {
+        search->onFinished(search->stats());
+    }
+}
@@ -0,0 +1,204 @@
+#ifndef FILE_SEARCHER_H
+#define FILE_SEARCHER_H
+
+#include "SearchPattern.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * 文件查找选项
+ */
+struct FileSearchOptions {
+    std::string pattern;                            // 查找文本或正则表达式
+    bool caseSensitive;                             // 是否区分大小写
+    bool useRegex;                                  // 是否为正则表达式（按行匹配）
+    bool wholeWord;                                 // 是否全字匹配
+    uint64_t maxFileSize;                           // 超过此大小的文件跳过（字节）
+    size_t maxMatchesPerFile;                       // 单个文件最多报告的匹配数
+    size_t maxLineLength;                           // 结果中保存的行文本最大长度（字节）
+    bool followSymlinks;                            // 是否跟随符号链接
+    std::vector<std::string> excludedDirectories;   // 跳过的目录名
+
+    FileSearchOptions();
+};
+
+/**
+ * 文件中的一处匹配
+ */
+struct FileSearchMatch {
+    std::string path;      // 文件路径
+    size_t line;           // 行号（从0开始）
+    size_t column;         // 列（字节）
+    std::string lineText;  // 所在行文本（可能被截断）
+};
+
+/**
+ * 查找统计
+ */
+struct FileSearchStats {
+    size_t directoriesScanned;  // 遍历的目录数
+    size_t filesScanned;        // 扫描的文件数
+    size_t filesSkipped;        // 因二进制、过大或无法读取而跳过的文件数
+    uint64_t bytesScanned;      // 扫描的字节数
+    size_t matchCount;          // 匹配数
+    bool cancelled;             // 是否被取消
+};
+
+/**
+ * 在文件中查找
+ * 在工作窃取线程池中并行遍历目录树：每个目录和文件都是一个任务，
+ * 子目录任务由遍历它的线程派生，空闲线程从其他线程窃取。
+ * 文件用 pread 按窗口读入线程本地缓冲区（窗口在行边界处切分），再交给 SearchPattern 查找。
+ * 结果按文件分批通过回调实时送出，可随时取消
+ */
+class FileSearcher {
+public:
+    /**
+     * 一个文件的全部匹配，在工作线程中调用（同一时刻只有一个回调在执行）
+     */
+    using MatchCallback = std::function<void(std::vector<FileSearchMatch>&)>;
+
+    /**
+     * 查找结束（完成或取消），在最后一个完成任务的工作线程中调用；
+     * 没有任何可扫描的内容时直接在调用 start 的线程中调用
+     */
+    using FinishedCallback = std::function<void(const FileSearchStats&)>;
+
+    /**
+     * 构造查找器
+     * @param threadCount 工作线程数，0 表示使用硬件线程数
+     */
+    explicit FileSearcher(size_t threadCount = 0);
+    ~FileSearcher();
+
+    FileSearcher(const FileSearcher&) = delete;
+    FileSearcher& operator=(const FileSearcher&) = delete;
+
+    /**
+     * 开始查找，如有正在进行的查找则先取消
+     * @param roots 起始目录或文件
+     * @param options 查找选项
+     * @param onMatches 匹配回调
+     * @param onFinished 结束回调
+     * @return 是否成功开始（查找文本为空或正则表达式无效时返回 false）
+     */
+    bool start(const std::vector<std::string>& roots, const FileSearchOptions& options, MatchCallback onMatches,
+               FinishedCallback onFinished);
+
+    /**
+     * 并行遍历目录树，列出其中的普通文件（不读取内容，不影响当前查找）
+     * @param roots 起始目录或文件
+     * @param options 查找选项（使用其中的目录过滤和符号链接设置）
+     * @param files 输出文件路径
+     */
+    void listFiles(const std::vector<std::string>& roots, const FileSearchOptions& options,
+                   std::vector<std::string>& files);
+
+    /**
+     * 取消当前查找，正在扫描的文件会尽快停止
+     */
+    void cancel();
+
+    /**
+     * 等待当前查找结束
+     */
+    void wait();
+
+    /**
+     * 是否正在查找
+     * @return 是否正在查找
+     */
+    bool isRunning() const;
+
+    /**
+     * 获取当前（或最近一次）查找的统计
+     * @return 统计
+     */
+    FileSearchStats getStats() const;
+
+    /**
+     * 判断数据是否像二进制内容（开头一段中含 NUL 字节）
+     * @param data 数据
+     * @param length 长度
+     * @return 是否为二进制
+     */
+    static bool isBinary(const char* data, size_t length);
+
+    /**
+     * 在一段文件内容中查找，matches 中的数量达到 maxMatchesPerFile 后停止
+     * @param path 文件路径（写入结果）
+     * @param data 文件内容
+     * @param length 长度
+     * @param firstLine data 第一行的行号
+     * @param pattern 查找条件
+     * @param options 查找选项
+     * @param matches 输出匹配，追加到末尾
+     * @param cancelled 取消标志，可为 nullptr
+     */
+    static void searchBuffer(const std::string& path, const char* data, size_t length, size_t firstLine,
+                             const SearchPattern& pattern, const FileSearchOptions& options,
+                             std::vector<FileSearchMatch>& matches, const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * 读取并查找单个文件
+     * @param path 文件路径
+     * @param pattern 查找条件
+     * @param options 查找选项
+     * @param matches 输出匹配，追加到末尾
+     * @param bytesRead 输出读取的字节数，可为 nullptr
+     * @param cancelled 取消标志，可为 nullptr
+     * @return 是否扫描了文件（不是普通文件、过大、二进制或无法读取时返回 false）
+     */
+    static bool searchFile(const std::string& path, const SearchPattern& pattern, const FileSearchOptions& options,
+                           std::vector<FileSearchMatch>& matches, uint64_t* bytesRead = nullptr,
+                           const std::atomic<bool>* cancelled = nullptr);
+
+private:
+    struct Search;
+
+    ThreadPool pool_;
+    std::shared_ptr<Search> current_;
+    mutable std::mutex mutex_;
+
+    /**
+     * 列出目录，为子目录和文件分别派生任务
+     * @param search 查找状态
+     * @param path 目录路径
+     */
+    void walkDirectory(const std::shared_ptr<Search>& search, const std::string& path);
+
+    /**
+     * 扫描单个文件并送出匹配
+     * @param search 查找状态
+     * @param path 文件路径
+     */
+    void scanFile(const std::shared_ptr<Search>& search, const std::string& path);
+
+    /**
+     * 为每个起始目录或文件提交任务
+     * @param search 查找状态
+     * @param roots 起始目录或文件
+     */
+    void submitRoots(const std::shared_ptr<Search>& search, const std::vector<std::string>& roots);
+
+    /**
+     * 提交任务并计入未完成任务数
+     * @param search 查找状态
+     * @param task 任务
+     */
+    void submitTask(const std::shared_ptr<Search>& search, std::function<void()> task);
+
+    /**
+     * 完成一个任务，最后一个任务完成时调用结束回调
+     * @param search 查找状态
+     */
+    void finishTask(const std::shared_ptr<Search>& search);
+};
+
+#endif // FILE_SEARCHER_H
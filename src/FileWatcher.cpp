@@ -0,0 +1,286 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace {
+
+#ifdef __linux__
+const uint32_t kTreeMask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                           IN_DELETE_SELF | IN_ONLYDIR;
+const uint32_t kFileMask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                           IN_ONLYDIR;
+#endif
+
+std::string parentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+std::string joinPath(const std::string& directory, const std::string& name) {
+    return directory.empty() || directory.back() == '/' ? directory + name : directory + "/" + name;
+}
+
+}  // namespace
+
+FileWatcher::FileWatcher() : inotifyFd_(-1), wakePipe_{-1, -1}, latency_(0) {}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::isSupported() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileWatcher::setCallback(Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = callback;
+}
+
+void FileWatcher::setLatency(unsigned milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_ = milliseconds;
+}
+
+#ifdef __linux__
+
+bool FileWatcher::watchTree(const std::string& root, const std::vector<std::string>& excludedDirectories) {
+    if (!ensureStarted()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    excludedDirectories_ = excludedDirectories;
+    addTree(root, nullptr);
+    return !watches_.empty();
+}
+
+bool FileWatcher::watchFile(const std::string& path) {
+    if (!ensureStarted()) {
+        return false;
+    }
+    std::string directory = parentDirectory(path);
+    int wd = inotify_add_watch(inotifyFd_, directory.c_str(), kFileMask);
+    if (wd < 0) {
+        std::cerr << "Failed to watch " << directory << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    watches_[wd] = Watch{directory, path.substr(path.find_last_of('/') + 1)};
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (thread_.joinable()) {
+        char wake = 0;
+        ssize_t written = ::write(wakePipe_[1], &wake, 1);
+        (void)written;
+        thread_.join();
+    }
+    for (int* fd : {&inotifyFd_, &wakePipe_[0], &wakePipe_[1]}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    watches_.clear();
+}
+
+bool FileWatcher::ensureStarted() {
+    if (inotifyFd_ >= 0) {
+        return true;
+    }
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        std::cerr << "inotify_init1 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (::pipe2(wakePipe_, O_CLOEXEC) != 0) {
+        ::close(inotifyFd_);
+        inotifyFd_ = -1;
+        return false;
+    }
+    thread_ = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::addTree(const std::string& directory, std::vector<FileChange>* created) {
+    int wd = inotify_add_watch(inotifyFd_, directory.c_str(), kTreeMask);
+    if (wd < 0) {
+        // 常见原因是达到 max_user_watches 上限，此目录之下的变化将无法发现
+        std::cerr << "Failed to watch " << directory << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    watches_[wd] = Watch{directory, ""};
+
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry = nullptr;
+    while ((entry = ::readdir(dir)) != nullptr) {
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+            continue;
+        }
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat info;
+            if (::fstatat(::dirfd(dir), name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            type = S_ISDIR(info.st_mode) ? DT_DIR : S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+        if (type == DT_DIR) {
+            if (std::find(excludedDirectories_.begin(), excludedDirectories_.end(), name) ==
+                excludedDirectories_.end()) {
+                addTree(joinPath(directory, name), created);
+            }
+        } else if (type == DT_REG && created) {
+            created->push_back(FileChange{FileChange::Type::Created, joinPath(directory, name)});
+        }
+    }
+    ::closedir(dir);
+}
+
+void FileWatcher::run() {
+    // 同一路径的多次变化只保留最后一次
+    std::map<std::string, FileChange::Type> pending;
+    bool overflow = false;
+    alignas(struct inotify_event) char buffer[64 * 1024];
+
+    while (true) {
+        unsigned latency = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            latency = latency_;
+        }
+        struct pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}};
+        bool hasPending = !pending.empty() || overflow;
+        int timeout = hasPending ? static_cast<int>(latency) : -1;
+        int ready = ::poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            std::vector<FileChange> created;
+            ssize_t length = 0;
+            while ((length = ::read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (char* p = buffer; p < buffer + length;) {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                    p += sizeof(struct inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        overflow = true;
+                        continue;
+                    }
+                    auto it = watches_.find(event->wd);
+                    if (it == watches_.end()) {
+                        continue;
+                    }
+                    if (event->mask & (IN_IGNORED | IN_DELETE_SELF)) {
+                        if (event->mask & IN_IGNORED) {
+                            watches_.erase(it);
+                        }
+                        continue;
+                    }
+                    const Watch& watch = it->second;
+                    std::string name = event->len > 0 ? event->name : "";
+                    if (name.empty() || (!watch.fileName.empty() && name != watch.fileName)) {
+                        continue;
+                    }
+                    std::string path = joinPath(watch.directory, name);
+                    if (event->mask & IN_ISDIR) {
+                        // 新建或移入的子目录加入监视，并补报其中已有的文件
+                        if (watch.fileName.empty() && (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                            std::find(excludedDirectories_.begin(), excludedDirectories_.end(), name) ==
+                                excludedDirectories_.end()) {
+                            addTree(path, &created);
+                        }
+                        continue;
+                    }
+                    if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        pending[path] = FileChange::Type::Deleted;
+                    } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        pending[path] = FileChange::Type::Created;
+                    } else if (pending.find(path) == pending.end()) {
+                        pending[path] = FileChange::Type::Modified;
+                    }
+                }
+            }
+            for (const FileChange& change : created) {
+                pending[change.path] = FileChange::Type::Created;
+            }
+            if (latency > 0) {
+                // 还在持续收到事件，等安静下来再送出
+                continue;
+            }
+        }
+
+        if (pending.empty() && !overflow) {
+            continue;
+        }
+        std::vector<FileChange> changes;
+        if (overflow) {
+            changes.push_back(FileChange{FileChange::Type::Overflow, ""});
+        }
+        for (const auto& entry : pending) {
+            changes.push_back(FileChange{entry.second, entry.first});
+        }
+        pending.clear();
+        overflow = false;
+
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            callback = callback_;
+        }
+        if (callback) {
+            callback(changes);
+        }
+    }
+}
+
+#else
+
+bool FileWatcher::watchTree(const std::string&, const std::vector<std::string>&) {
+    return false;
+}
+
+bool FileWatcher::watchFile(const std::string&) {
+    return false;
+}
+
+void FileWatcher::stop() {}
+
+bool FileWatcher::ensureStarted() {
+    return false;
+}
+
+void FileWatcher::addTree(const std::string&, std::vector<FileChange>*) {}
+
+void FileWatcher::run() {}
+
+#endif
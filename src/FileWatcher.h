@@ -0,0 +1,122 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 文件变化
+ */
+struct FileChange {
+    enum class Type : uint8_t {
+        Modified,  // 内容被修改
+        Created,   // 新建或移入
+        Deleted,   // 删除或移出
+        Overflow   // 事件队列溢出，部分变化丢失，调用方应整体重新检查
+    };
+
+    Type type;
+    std::string path;  // 文件路径（Overflow 时为空）
+};
+
+/**
+ * 文件监视器
+ * Linux 上基于 inotify，在后台线程中等待事件；同一路径在延迟时间内的多次变化合并为一次，
+ * 批量通过回调送出。没有事件时线程阻塞在 poll 上，不占用 CPU。
+ * 其他平台暂不支持，watch* 直接返回 false
+ */
+class FileWatcher {
+public:
+    /**
+     * 变化回调，在后台线程中调用
+     */
+    using Callback = std::function<void(const std::vector<FileChange>&)>;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * 当前平台是否支持文件监视
+     * @return 是否支持
+     */
+    static bool isSupported();
+
+    /**
+     * 设置变化回调（应在添加监视之前设置）
+     * @param callback 回调函数
+     */
+    void setCallback(Callback callback);
+
+    /**
+     * 设置合并事件的延迟，最后一次事件之后经过该时间才送出
+     * @param milliseconds 延迟（毫秒），0 表示读到事件后立即送出
+     */
+    void setLatency(unsigned milliseconds);
+
+    /**
+     * 递归监视目录树，之后新建的子目录会自动加入监视
+     * @param root 根目录
+     * @param excludedDirectories 跳过的目录名
+     * @return 是否成功
+     */
+    bool watchTree(const std::string& root, const std::vector<std::string>& excludedDirectories);
+
+    /**
+     * 监视单个文件（通过所在目录监视，因此能发现删除、改名和重新创建）
+     * @param path 文件路径
+     * @return 是否成功
+     */
+    bool watchFile(const std::string& path);
+
+    /**
+     * 停止监视并结束后台线程
+     */
+    void stop();
+
+private:
+    /**
+     * 一个 inotify 监视项
+     */
+    struct Watch {
+        std::string directory;  // 被监视的目录
+        std::string fileName;   // 只关心的文件名（监视目录树时为空）
+    };
+
+    int inotifyFd_;
+    int wakePipe_[2];
+    unsigned latency_;
+    Callback callback_;
+    std::vector<std::string> excludedDirectories_;
+
+    std::mutex mutex_;
+    std::unordered_map<int, Watch> watches_;
+    std::thread thread_;
+
+    /**
+     * 初始化 inotify 并启动后台线程
+     * @return 是否成功
+     */
+    bool ensureStarted();
+
+    /**
+     * 为目录及其子目录添加监视
+     * @param directory 目录
+     * @param created 为新建目录补报其中已有的文件时输出变化，可为 nullptr
+     */
+    void addTree(const std::string& directory, std::vector<FileChange>* created);
+
+    /**
+     * 后台线程主循环
+     */
+    void run();
+};
+
+#endif // FILE_WATCHER_H
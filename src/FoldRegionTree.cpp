@@ -0,0 +1,345 @@
+#include "FoldRegionTree.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// 作为分割键：起始行小于 line 的区域全部排在它之前
+FoldRegion lineKey(size_t line) {
+    return FoldRegion{line, std::numeric_limits<size_t>::max(), FoldKind::Bracket, false};
+}
+
+}  // namespace
+
+FoldRegionTree::FoldRegionTree() : root_(kNull), random_(0x464cu) {}
+
+void FoldRegionTree::clear() {
+    nodes_.clear();
+    freeNodes_.clear();
+    root_ = kNull;
+}
+
+void FoldRegionTree::insert(const FoldRegion& region) {
+    int32_t left = kNull;
+    int32_t right = kNull;
+    split(root_, region, left, right);
+    root_ = merge(merge(left, createNode(region)), right);
+}
+
+size_t FoldRegionTree::size() const {
+    return root_ == kNull ? 0 : nodes_[root_].size;
+}
+
+void FoldRegionTree::applyLineEdit(size_t firstLine, size_t lastLine, int64_t delta,
+                                   std::vector<FoldRegion>& removed) {
+    int32_t head = kNull;
+    int32_t rest = kNull;
+    int32_t middle = kNull;
+    int32_t tail = kNull;
+    split(root_, lineKey(firstLine), head, rest);
+    split(rest, lineKey(lastLine + 1), middle, tail);
+
+    // 起始于编辑范围内的区域全部作废
+    collectAndRelease(middle, removed);
+
+    // 编辑范围之后的区域整体平移
+    if (tail != kNull) {
+        applyShift(tail, delta);
+    }
+
+    // 起始于编辑范围之前、但延伸进编辑范围的区域同样需要重新计算
+    size_t spanningBegin = removed.size();
+    head = extract(head, firstLine, 0xff, [](const FoldRegion&) { return true; }, removed);
+    for (size_t i = spanningBegin; i < removed.size(); ++i) {
+        if (removed[i].endLine > lastLine) {
+            removed[i].endLine = static_cast<size_t>(static_cast<int64_t>(removed[i].endLine) + delta);
+        }
+    }
+
+    root_ = merge(head, tail);
+}
+
+void FoldRegionTree::removeOverlapping(size_t firstLine, size_t lastLine, FoldKind kind,
+                                       std::vector<FoldRegion>& removed) {
+    int32_t head = kNull;
+    int32_t tail = kNull;
+    split(root_, lineKey(lastLine + 1), head, tail);
+    head = extract(head, firstLine, kindBit(kind), [kind](const FoldRegion& region) { return region.kind == kind; },
+                   removed);
+    root_ = merge(head, tail);
+}
+
+void FoldRegionTree::query(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& regions) const {
+    queryNode(root_, 0, firstLine, lastLine, regions);
+}
+
+void FoldRegionTree::collectCollapsed(std::vector<FoldRegion>& regions) const {
+    collectCollapsedNode(root_, 0, regions);
+}
+
+bool FoldRegionTree::setCollapsed(size_t line, bool collapsed) {
+    int32_t head = kNull;
+    int32_t rest = kNull;
+    int32_t middle = kNull;
+    int32_t tail = kNull;
+    split(root_, lineKey(line), head, rest);
+    split(rest, lineKey(line + 1), middle, tail);
+
+    bool found = middle != kNull;
+    if (found) {
+        setLeftmostCollapsed(middle, collapsed);
+    }
+
+    root_ = merge(merge(head, middle), tail);
+    return found;
+}
+
+void FoldRegionTree::setAllCollapsed(bool collapsed) {
+    setAllCollapsedNode(root_, collapsed);
+}
+
+bool FoldRegionTree::findStartingAt(size_t line, FoldRegion& region) const {
+    int32_t node = root_;
+    int64_t pending = 0;
+    bool found = false;
+    while (node != kNull) {
+        const Node& current = nodes_[node];
+        size_t start = static_cast<size_t>(static_cast<int64_t>(current.region.startLine) + pending);
+        int64_t childPending = pending + current.shift;
+        if (start < line) {
+            node = current.right;
+        } else {
+            if (start == line) {
+                region = current.region;
+                region.startLine = start;
+                region.endLine = static_cast<size_t>(static_cast<int64_t>(current.region.endLine) + pending);
+                found = true;
+            }
+            node = current.left;
+        }
+        pending = childPending;
+    }
+    return found;
+}
+
+int32_t FoldRegionTree::createNode(const FoldRegion& region) {
+    int32_t index;
+    if (!freeNodes_.empty()) {
+        index = freeNodes_.back();
+        freeNodes_.pop_back();
+    } else {
+        index = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[index];
+    node.left = kNull;
+    node.right = kNull;
+    node.priority = random_();
+    node.region = region;
+    node.shift = 0;
+    update(index);
+    return index;
+}
+
+void FoldRegionTree::releaseNode(int32_t node) {
+    freeNodes_.push_back(node);
+}
+
+void FoldRegionTree::applyShift(int32_t node, int64_t delta) {
+    Node& current = nodes_[node];
+    current.region.startLine = static_cast<size_t>(static_cast<int64_t>(current.region.startLine) + delta);
+    current.region.endLine = static_cast<size_t>(static_cast<int64_t>(current.region.endLine) + delta);
+    current.maxEnd = static_cast<size_t>(static_cast<int64_t>(current.maxEnd) + delta);
+    current.shift += delta;
+}
+
+void FoldRegionTree::push(int32_t node) {
+    Node& current = nodes_[node];
+    if (current.shift == 0) {
+        return;
+    }
+    if (current.left != kNull) {
+        applyShift(current.left, current.shift);
+    }
+    if (current.right != kNull) {
+        applyShift(current.right, current.shift);
+    }
+    current.shift = 0;
+}
+
+void FoldRegionTree::update(int32_t node) {
+    Node& current = nodes_[node];
+    current.maxEnd = current.region.endLine;
+    current.kinds = kindBit(current.region.kind);
+    current.collapsedCount = current.region.collapsed ? 1 : 0;
+    current.size = 1;
+    for (int32_t child : {current.left, current.right}) {
+        if (child == kNull) {
+            continue;
+        }
+        const Node& childNode = nodes_[child];
+        current.maxEnd = std::max(current.maxEnd, childNode.maxEnd);
+        current.kinds |= childNode.kinds;
+        current.collapsedCount += childNode.collapsedCount;
+        current.size += childNode.size;
+    }
+}
+
+int32_t FoldRegionTree::merge(int32_t left, int32_t right) {
+    if (left == kNull) {
+        return right;
+    }
+    if (right == kNull) {
+        return left;
+    }
+    if (nodes_[left].priority > nodes_[right].priority) {
+        push(left);
+        int32_t merged = merge(nodes_[left].right, right);
+        nodes_[left].right = merged;
+        update(left);
+        return left;
+    }
+    push(right);
+    int32_t merged = merge(left, nodes_[right].left);
+    nodes_[right].left = merged;
+    update(right);
+    return right;
+}
+
+void FoldRegionTree::split(int32_t node, const FoldRegion& key, int32_t& left, int32_t& right) {
+    if (node == kNull) {
+        left = kNull;
+        right = kNull;
+        return;
+    }
+    push(node);
+    if (before(nodes_[node].region, key)) {
+        int32_t subLeft = kNull;
+        int32_t subRight = kNull;
+        split(nodes_[node].right, key, subLeft, subRight);
+        nodes_[node].right = subLeft;
+        update(node);
+        left = node;
+        right = subRight;
+    } else {
+        int32_t subLeft = kNull;
+        int32_t subRight = kNull;
+        split(nodes_[node].left, key, subLeft, subRight);
+        nodes_[node].left = subRight;
+        update(node);
+        left = subLeft;
+        right = node;
+    }
+}
+
+void FoldRegionTree::collectAndRelease(int32_t node, std::vector<FoldRegion>& regions) {
+    if (node == kNull) {
+        return;
+    }
+    push(node);
+    collectAndRelease(nodes_[node].left, regions);
+    regions.push_back(nodes_[node].region);
+    collectAndRelease(nodes_[node].right, regions);
+    releaseNode(node);
+}
+
+int32_t FoldRegionTree::extract(int32_t node, size_t minEnd, uint8_t kindMask,
+                                const std::function<bool(const FoldRegion&)>& predicate,
+                                std::vector<FoldRegion>& removed) {
+    // 子树最大结束行不够或不含目标类型时整棵跳过
+    if (node == kNull || nodes_[node].maxEnd < minEnd || !(nodes_[node].kinds & kindMask)) {
+        return node;
+    }
+    push(node);
+    int32_t left = extract(nodes_[node].left, minEnd, kindMask, predicate, removed);
+    const FoldRegion region = nodes_[node].region;
+    bool remove = region.endLine >= minEnd && (kindBit(region.kind) & kindMask) && predicate(region);
+    if (remove) {
+        removed.push_back(region);
+    }
+    int32_t right = extract(nodes_[node].right, minEnd, kindMask, predicate, removed);
+
+    if (remove) {
+        releaseNode(node);
+        return merge(left, right);
+    }
+    nodes_[node].left = left;
+    nodes_[node].right = right;
+    update(node);
+    return node;
+}
+
+void FoldRegionTree::queryNode(int32_t node, int64_t pending, size_t firstLine, size_t lastLine,
+                               std::vector<FoldRegion>& regions) const {
+    if (node == kNull) {
+        return;
+    }
+    const Node& current = nodes_[node];
+    if (static_cast<size_t>(static_cast<int64_t>(current.maxEnd) + pending) < firstLine) {
+        return;
+    }
+    FoldRegion region = current.region;
+    region.startLine = static_cast<size_t>(static_cast<int64_t>(region.startLine) + pending);
+    region.endLine = static_cast<size_t>(static_cast<int64_t>(region.endLine) + pending);
+    int64_t childPending = pending + current.shift;
+
+    queryNode(current.left, childPending, firstLine, lastLine, regions);
+    if (region.startLine > lastLine) {
+        return;
+    }
+    if (region.endLine >= firstLine) {
+        regions.push_back(region);
+    }
+    queryNode(current.right, childPending, firstLine, lastLine, regions);
+}
+
+void FoldRegionTree::collectCollapsedNode(int32_t node, int64_t pending, std::vector<FoldRegion>& regions) const {
+    if (node == kNull || nodes_[node].collapsedCount == 0) {
+        return;
+    }
+    const Node& current = nodes_[node];
+    int64_t childPending = pending + current.shift;
+    collectCollapsedNode(current.left, childPending, regions);
+    if (current.region.collapsed) {
+        FoldRegion region = current.region;
+        region.startLine = static_cast<size_t>(static_cast<int64_t>(region.startLine) + pending);
+        region.endLine = static_cast<size_t>(static_cast<int64_t>(region.endLine) + pending);
+        regions.push_back(region);
+    }
+    collectCollapsedNode(current.right, childPending, regions);
+}
+
+void FoldRegionTree::setAllCollapsedNode(int32_t node, bool collapsed) {
+    if (node == kNull) {
+        return;
+    }
+    // 先下传偏移，update 才能把本节点的区域与子树的 maxEnd 放在同一基准下比较
+    push(node);
+    setAllCollapsedNode(nodes_[node].left, collapsed);
+    setAllCollapsedNode(nodes_[node].right, collapsed);
+    nodes_[node].region.collapsed = collapsed;
+    update(node);
+}
+
+void FoldRegionTree::setLeftmostCollapsed(int32_t node, bool collapsed) {
+    push(node);
+    if (nodes_[node].left != kNull) {
+        setLeftmostCollapsed(nodes_[node].left, collapsed);
+    } else {
+        nodes_[node].region.collapsed = collapsed;
+    }
+    update(node);
+}
+
+bool FoldRegionTree::before(const FoldRegion& first, const FoldRegion& second) {
+    // 起始行升序；同一起始行时外层（结束行更大）在前
+    if (first.startLine != second.startLine) {
+        return first.startLine < second.startLine;
+    }
+    return first.endLine > second.endLine;
+}
+
+uint8_t FoldRegionTree::kindBit(FoldKind kind) {
+    return static_cast<uint8_t>(1u << static_cast<unsigned>(kind));
+}
@@ -0,0 +1,152 @@
+#ifndef FOLD_REGION_TREE_H
+#define FOLD_REGION_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+/**
+ * 折叠区域类型
+ */
+enum class FoldKind : uint8_t {
+    Bracket,      // 跨行的括号对
+    Indentation,  // 缩进块
+    Comment,      // 连续注释行或多行块注释
+    Region        // #region / #endregion 等标记
+};
+
+/**
+ * 折叠区域
+ * 折叠后 startLine 保持可见，(startLine, endLine] 被隐藏
+ */
+struct FoldRegion {
+    size_t startLine;  // 起始行（从0开始）
+    size_t endLine;    // 结束行（包含）
+    FoldKind kind;     // 区域类型
+    bool collapsed;    // 是否已折叠
+};
+
+/**
+ * 折叠区域区间树
+ * 以起始行为键的 treap，子树上维护最大结束行、类型掩码和折叠数量，
+ * 行号平移通过懒标记完成，一次编辑的更新代价为 O(k log n)（k 为受影响区域数）
+ */
+class FoldRegionTree {
+public:
+    FoldRegionTree();
+
+    /**
+     * 清空
+     */
+    void clear();
+
+    /**
+     * 插入区域
+     * @param region 区域
+     */
+    void insert(const FoldRegion& region);
+
+    /**
+     * 获取区域数量
+     * @return 区域数量
+     */
+    size_t size() const;
+
+    /**
+     * 应用一次按行的编辑
+     * 起始行位于 [firstLine, lastLine] 的区域以及跨入该范围的区域被移除，
+     * 起始行在 lastLine 之后的区域整体平移 delta 行
+     * @param firstLine 编辑起始行（旧坐标）
+     * @param lastLine 编辑结束行（旧坐标，包含）
+     * @param delta 行数变化量
+     * @param removed 输出被移除的区域，起始行在 firstLine 之前的区域其结束行已按新坐标换算
+     */
+    void applyLineEdit(size_t firstLine, size_t lastLine, int64_t delta, std::vector<FoldRegion>& removed);
+
+    /**
+     * 移除与指定行范围重叠的某类区域
+     * @param firstLine 起始行
+     * @param lastLine 结束行（包含）
+     * @param kind 区域类型
+     * @param removed 输出被移除的区域
+     */
+    void removeOverlapping(size_t firstLine, size_t lastLine, FoldKind kind, std::vector<FoldRegion>& removed);
+
+    /**
+     * 查询与指定行范围重叠的区域（按起始行升序）
+     * @param firstLine 起始行
+     * @param lastLine 结束行（包含）
+     * @param regions 输出区域
+     */
+    void query(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& regions) const;
+
+    /**
+     * 获取所有已折叠的区域（按起始行升序）
+     * @param regions 输出区域
+     */
+    void collectCollapsed(std::vector<FoldRegion>& regions) const;
+
+    /**
+     * 设置起始于指定行的最外层区域的折叠状态
+     * @param line 起始行
+     * @param collapsed 折叠状态
+     * @return 是否存在这样的区域
+     */
+    bool setCollapsed(size_t line, bool collapsed);
+
+    /**
+     * 设置所有区域的折叠状态
+     * @param collapsed 折叠状态
+     */
+    void setAllCollapsed(bool collapsed);
+
+    /**
+     * 查找起始于指定行的最外层区域
+     * @param line 起始行
+     * @param region 输出区域
+     * @return 是否找到
+     */
+    bool findStartingAt(size_t line, FoldRegion& region) const;
+
+private:
+    static constexpr int32_t kNull = -1;
+
+    struct Node {
+        int32_t left;
+        int32_t right;
+        uint32_t priority;
+        FoldRegion region;
+        int64_t shift;         // 尚未下传给子结点的行号平移
+        size_t maxEnd;         // 子树最大结束行
+        uint8_t kinds;         // 子树包含的区域类型掩码
+        size_t collapsedCount; // 子树中已折叠区域数量
+        size_t size;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> freeNodes_;
+    int32_t root_;
+    std::mt19937 random_;
+
+    int32_t createNode(const FoldRegion& region);
+    void releaseNode(int32_t node);
+    void applyShift(int32_t node, int64_t delta);
+    void push(int32_t node);
+    void update(int32_t node);
+    int32_t merge(int32_t left, int32_t right);
+    void split(int32_t node, const FoldRegion& key, int32_t& left, int32_t& right);
+    void collectAndRelease(int32_t node, std::vector<FoldRegion>& regions);
+    int32_t extract(int32_t node, size_t minEnd, uint8_t kindMask,
+                    const std::function<bool(const FoldRegion&)>& predicate, std::vector<FoldRegion>& removed);
+    void queryNode(int32_t node, int64_t pending, size_t firstLine, size_t lastLine,
+                   std::vector<FoldRegion>& regions) const;
+    void collectCollapsedNode(int32_t node, int64_t pending, std::vector<FoldRegion>& regions) const;
+    void setAllCollapsedNode(int32_t node, bool collapsed);
+    void setLeftmostCollapsed(int32_t node, bool collapsed);
+    static bool before(const FoldRegion& first, const FoldRegion& second);
+    static uint8_t kindBit(FoldKind kind);
+};
+
+#endif // FOLD_REGION_TREE_H
@@ -0,0 +1,453 @@
+#include "FoldingModel.h"
+#include "Editor.h"
+#include "SyntaxModel.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <string>
+
+namespace {
+
+const size_t kAllLines = std::numeric_limits<size_t>::max() / 2;
+const int kTabWidth = 4;
+
+bool startsWith(std::string_view text, const std::string& prefix) {
+    return !prefix.empty() && text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::string_view trimLeft(std::string_view text) {
+    size_t pos = 0;
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) {
+        pos++;
+    }
+    return text.substr(pos);
+}
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+}  // namespace
+
+FoldingModel::FoldingModel() : syntaxModel_(nullptr), updateListenerId_(0), bracketMode_(false) {}
+
+FoldingModel::~FoldingModel() {
+    if (syntaxModel_) {
+        syntaxModel_->removeUpdateListener(updateListenerId_);
+    }
+}
+
+void FoldingModel::setSyntaxModel(SyntaxModel* syntaxModel) {
+    if (syntaxModel_) {
+        syntaxModel_->removeUpdateListener(updateListenerId_);
+        updateListenerId_ = 0;
+    }
+    syntaxModel_ = syntaxModel;
+    if (syntaxModel_) {
+        updateListenerId_ = syntaxModel_->addUpdateListener([this](const TextEdit* edit) { handleUpdate(edit); });
+    }
+    reset();
+}
+
+void FoldingModel::reset() {
+    tree_.clear();
+    markers_.clear();
+
+    if (syntaxModel_ && syntaxModel_->getEditor()) {
+        std::string language = syntaxModel_->getLanguage();
+        bracketMode_ = language == "C" || language == "C++" || language == "Java" || language == "JavaScript" ||
+                       language == "JSON" || language == "CSS";
+
+        size_t lineCount = getLineCount();
+        if (bracketMode_) {
+            computeBracketRegions();
+        } else {
+            computeIndentRegions(0, lineCount, lineCount);
+        }
+        computeCommentRegions(0, lineCount - 1);
+
+        updateMarkers(0, 0, lineCount - 1, 0);
+        std::vector<FoldRegion> removed;
+        pairMarkers(removed);
+    }
+
+    rebuildHiddenRanges();
+    notifyChanged();
+}
+
+void FoldingModel::getRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& regions) const {
+    tree_.query(firstLine, lastLine, regions);
+}
+
+size_t FoldingModel::getRegionCount() const {
+    return tree_.size();
+}
+
+bool FoldingModel::findRegionAt(size_t line, FoldRegion& region) const {
+    return tree_.findStartingAt(line, region);
+}
+
+size_t FoldingModel::toggleFold(size_t line) {
+    FoldRegion region;
+    if (!tree_.findStartingAt(line, region)) {
+        // 不是起始行：折叠包含该行的最内层区域
+        std::vector<FoldRegion> regions;
+        tree_.query(line, line, regions);
+        if (regions.empty()) {
+            return std::string::npos;
+        }
+        region = regions.back();
+        region.collapsed = false;
+    }
+    tree_.setCollapsed(region.startLine, !region.collapsed);
+    rebuildHiddenRanges();
+    notifyChanged();
+    return region.startLine;
+}
+
+void FoldingModel::foldAll() {
+    tree_.setAllCollapsed(true);
+    rebuildHiddenRanges();
+    notifyChanged();
+}
+
+void FoldingModel::unfoldAll() {
+    tree_.setAllCollapsed(false);
+    rebuildHiddenRanges();
+    notifyChanged();
+}
+
+const std::vector<std::pair<size_t, size_t>>& FoldingModel::getHiddenRanges() const {
+    return hiddenRanges_;
+}
+
+bool FoldingModel::isLineHidden(size_t line) const {
+    auto it = std::upper_bound(hiddenRanges_.begin(), hiddenRanges_.end(), line,
+                               [](size_t value, const std::pair<size_t, size_t>& range) {
+                                   return value < range.first;
+                               });
+    return it != hiddenRanges_.begin() && line <= std::prev(it)->second;
+}
+
+size_t FoldingModel::nextVisibleLine(size_t line) const {
+    auto it = std::upper_bound(hiddenRanges_.begin(), hiddenRanges_.end(), line,
+                               [](size_t value, const std::pair<size_t, size_t>& range) {
+                                   return value < range.first;
+                               });
+    if (it != hiddenRanges_.begin() && line <= std::prev(it)->second) {
+        return std::prev(it)->second + 1;
+    }
+    return line;
+}
+
+void FoldingModel::setFoldsChangedCallback(std::function<void()> callback) {
+    foldsChangedCallback_ = callback;
+}
+
+void FoldingModel::handleUpdate(const TextEdit* edit) {
+    if (!edit || !syntaxModel_->getEditor()) {
+        reset();
+        return;
+    }
+
+    size_t firstLine = edit->startLine;
+    size_t oldLastLine = firstLine + edit->removedLineBreaks;
+    size_t newLastLine = firstLine + edit->insertedLineBreaks;
+    int64_t delta = static_cast<int64_t>(edit->insertedLineBreaks) - static_cast<int64_t>(edit->removedLineBreaks);
+
+    // 平移编辑范围之后的区域，移除起始于或跨入编辑范围的区域
+    std::vector<FoldRegion> removed;
+    tree_.applyLineEdit(firstLine, oldLastLine, delta, removed);
+
+    std::vector<FoldRegion> collapsed;
+    for (const FoldRegion& region : removed) {
+        if (region.collapsed && region.startLine <= firstLine) {
+            collapsed.push_back(region);
+        }
+    }
+
+    // 词法状态变化（如块注释开闭）波及的后续行同样作废，此时已是新坐标，无需平移
+    removed.clear();
+    size_t lastLine = std::max(newLastLine, syntaxModel_->getLastUpdatedLine());
+    if (lastLine > newLastLine) {
+        tree_.applyLineEdit(newLastLine + 1, lastLine, 0, removed);
+    }
+
+    if (bracketMode_) {
+        updateBracketRegions(firstLine, lastLine);
+    } else {
+        updateIndentRegions(firstLine, lastLine, removed);
+    }
+    updateCommentRegions(firstLine, lastLine, removed);
+    updateMarkers(firstLine, oldLastLine, newLastLine, delta);
+    pairMarkers(removed);
+
+    for (const FoldRegion& region : removed) {
+        if (region.collapsed) {
+            collapsed.push_back(region);
+        }
+    }
+    restoreCollapsed(collapsed);
+    rebuildHiddenRanges();
+    notifyChanged();
+}
+
+size_t FoldingModel::getLineCount() const {
+    return syntaxModel_->getEditor()->getLineIndex().getLineCount();
+}
+
+std::string_view FoldingModel::getLineText(size_t line) const {
+    const auto& editor = syntaxModel_->getEditor();
+    const LineIndex& lines = editor->getLineIndex();
+    size_t start = lines.getLineStart(line);
+    return editor->getContentView().substr(start, lines.getLineEnd(line) - start);
+}
+
+int FoldingModel::getIndent(size_t line) const {
+    std::string_view text = getLineText(line);
+    int indent = 0;
+    for (char c : text) {
+        if (c == ' ') {
+            indent++;
+        } else if (c == '\t') {
+            indent = (indent / kTabWidth + 1) * kTabWidth;
+        } else if (c != '\r') {
+            return indent;
+        }
+    }
+    return -1;
+}
+
+bool FoldingModel::isCommentLine(size_t line) const {
+    if (syntaxModel_->getLineState(line).mode == LexState::Mode::BlockComment) {
+        return true;
+    }
+    const LanguageRules& rules = syntaxModel_->getLexer().getRules();
+    std::string_view text = trimLeft(getLineText(line));
+    return startsWith(text, rules.lineComment) || startsWith(text, rules.blockCommentStart);
+}
+
+int FoldingModel::getMarkerType(size_t line) const {
+    std::string_view text = trimLeft(getLineText(line));
+    size_t pos = 0;
+    while (pos < text.size() && std::string_view("/*<!-#;' ").find(text[pos]) != std::string_view::npos) {
+        pos++;
+    }
+    if (pos == 0 || pos >= text.size()) {
+        return 0;
+    }
+    // 标记必须紧跟注释符或 #（如 "#region"、"//region"、"// #region"），或以 "pragma " 引出，
+    // 避免把普通注释中的 "region" 一词误认为标记
+    std::string_view word = text.substr(pos);
+    if (word.compare(0, 7, "pragma ") == 0) {
+        word = trimLeft(word.substr(7));
+    } else if (text[pos - 1] != '#' && text[pos - 1] != '/') {
+        return 0;
+    }
+
+    int type = 0;
+    size_t length = 0;
+    if (word.compare(0, 6, "region") == 0) {
+        type = 1;
+        length = 6;
+    } else if (word.compare(0, 9, "endregion") == 0) {
+        type = -1;
+        length = 9;
+    }
+    if (type == 0 || (length < word.size() && isWordChar(word[length]))) {
+        return 0;
+    }
+    return type;
+}
+
+void FoldingModel::computeBracketRegions() {
+    const BracketIndex& brackets = syntaxModel_->getBracketIndex();
+    std::vector<BracketPosition> stack;
+    size_t lineCount = brackets.getLineCount();
+    for (size_t line = 0; line < lineCount; ++line) {
+        for (const BracketToken& token : brackets.getLineBrackets(line)) {
+            if (BracketIndex::isOpen(token.ch)) {
+                stack.push_back({line, token.column, token.ch});
+            } else if (!stack.empty()) {
+                if (stack.back().line < line) {
+                    tree_.insert({stack.back().line, line, FoldKind::Bracket, false});
+                }
+                stack.pop_back();
+            }
+        }
+    }
+}
+
+void FoldingModel::updateBracketRegions(size_t firstLine, size_t lastLine) {
+    const BracketIndex& brackets = syntaxModel_->getBracketIndex();
+
+    // 一端位于编辑范围内的括号对
+    for (size_t line = firstLine; line <= lastLine; ++line) {
+        for (const BracketToken& token : brackets.getLineBrackets(line)) {
+            BracketPosition match;
+            if (!brackets.findMatch(line, token.column, match)) {
+                continue;
+            }
+            if (BracketIndex::isOpen(token.ch) && match.line > line) {
+                tree_.insert({line, match.line, FoldKind::Bracket, false});
+            } else if (BracketIndex::isClose(token.ch) && match.line < firstLine) {
+                tree_.insert({match.line, line, FoldKind::Bracket, false});
+            }
+        }
+    }
+
+    // 完整跨越编辑范围的括号对：沿包围链逐层向外，每层一次 O(log n) 查询
+    BracketPosition open;
+    size_t line = firstLine;
+    size_t column = 0;
+    while (brackets.findEnclosingOpen(line, column, open)) {
+        BracketPosition close;
+        if (brackets.findMatch(open.line, open.column, close) && close.line > lastLine) {
+            tree_.insert({open.line, close.line, FoldKind::Bracket, false});
+        }
+        line = open.line;
+        column = open.column;
+    }
+}
+
+void FoldingModel::computeIndentRegions(size_t fromLine, size_t toLine, size_t maxStartLine) {
+    std::vector<std::pair<size_t, int>> stack;
+    size_t lastContentLine = fromLine;
+    auto emit = [this, maxStartLine, &lastContentLine](size_t startLine) {
+        if (lastContentLine > startLine && startLine <= maxStartLine) {
+            tree_.insert({startLine, lastContentLine, FoldKind::Indentation, false});
+        }
+    };
+
+    for (size_t line = fromLine; line < toLine; ++line) {
+        int indent = getIndent(line);
+        if (indent < 0) {
+            continue;
+        }
+        while (!stack.empty() && stack.back().second >= indent) {
+            emit(stack.back().first);
+            stack.pop_back();
+        }
+        stack.emplace_back(line, indent);
+        lastContentLine = line;
+    }
+    while (!stack.empty()) {
+        emit(stack.back().first);
+        stack.pop_back();
+    }
+}
+
+void FoldingModel::updateIndentRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& removed) {
+    // 缩进区域只依赖其后的行，因此重扫范围为：编辑之前最近的顶层行到编辑之后最近的顶层行
+    size_t lineCount = getLineCount();
+    size_t topLine = firstLine > 0 ? firstLine - 1 : 0;
+    while (topLine > 0 && getIndent(topLine) != 0) {
+        topLine--;
+    }
+    size_t bottomLine = lastLine + 1;
+    while (bottomLine < lineCount && getIndent(bottomLine) != 0) {
+        bottomLine++;
+    }
+
+    tree_.removeOverlapping(topLine, lastLine, FoldKind::Indentation, removed);
+    computeIndentRegions(topLine, bottomLine, lastLine);
+}
+
+void FoldingModel::computeCommentRegions(size_t fromLine, size_t toLine) {
+    size_t line = fromLine;
+    while (line <= toLine) {
+        if (!isCommentLine(line)) {
+            line++;
+            continue;
+        }
+        size_t runStart = line;
+        while (line + 1 <= toLine && isCommentLine(line + 1)) {
+            line++;
+        }
+        if (line > runStart) {
+            tree_.insert({runStart, line, FoldKind::Comment, false});
+        }
+        line++;
+    }
+}
+
+void FoldingModel::updateCommentRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& removed) {
+    // 扩展到编辑范围两侧相连的注释行（块注释的开闭会改变其后各行的行首状态）
+    size_t lineCount = getLineCount();
+    size_t fromLine = firstLine;
+    while (fromLine > 0 && isCommentLine(fromLine - 1)) {
+        fromLine--;
+    }
+    size_t toLine = lastLine;
+    while (toLine + 1 < lineCount && isCommentLine(toLine + 1)) {
+        toLine++;
+    }
+
+    tree_.removeOverlapping(fromLine, toLine, FoldKind::Comment, removed);
+    computeCommentRegions(fromLine, toLine);
+}
+
+void FoldingModel::updateMarkers(size_t firstLine, size_t oldLastLine, size_t newLastLine, int64_t delta) {
+    auto begin = std::lower_bound(markers_.begin(), markers_.end(), std::make_pair(firstLine, false));
+    auto end = std::lower_bound(begin, markers_.end(), std::make_pair(oldLastLine + 1, false));
+    for (auto it = end; it != markers_.end(); ++it) {
+        it->first = static_cast<size_t>(static_cast<int64_t>(it->first) + delta);
+    }
+
+    std::vector<std::pair<size_t, bool>> inserted;
+    for (size_t line = firstLine; line <= newLastLine; ++line) {
+        int type = getMarkerType(line);
+        if (type != 0) {
+            inserted.emplace_back(line, type > 0);
+        }
+    }
+    auto position = markers_.erase(begin, end);
+    markers_.insert(position, inserted.begin(), inserted.end());
+}
+
+void FoldingModel::pairMarkers(std::vector<FoldRegion>& removed) {
+    tree_.removeOverlapping(0, kAllLines, FoldKind::Region, removed);
+
+    std::vector<size_t> stack;
+    for (const auto& marker : markers_) {
+        if (marker.second) {
+            stack.push_back(marker.first);
+        } else if (!stack.empty()) {
+            tree_.insert({stack.back(), marker.first, FoldKind::Region, false});
+            stack.pop_back();
+        }
+    }
+}
+
+void FoldingModel::restoreCollapsed(const std::vector<FoldRegion>& collapsed) {
+    for (const FoldRegion& previous : collapsed) {
+        FoldRegion region;
+        if (tree_.findStartingAt(previous.startLine, region) && region.kind == previous.kind) {
+            tree_.setCollapsed(previous.startLine, true);
+        }
+    }
+}
+
+void FoldingModel::rebuildHiddenRanges() {
+    hiddenRanges_.clear();
+    std::vector<FoldRegion> regions;
+    tree_.collectCollapsed(regions);
+    for (const FoldRegion& region : regions) {
+        size_t first = region.startLine + 1;
+        size_t last = region.endLine;
+        if (first > last) {
+            continue;
+        }
+        if (!hiddenRanges_.empty() && first <= hiddenRanges_.back().second + 1) {
+            hiddenRanges_.back().second = std::max(hiddenRanges_.back().second, last);
+        } else {
+            hiddenRanges_.emplace_back(first, last);
+        }
+    }
+}
+
+void FoldingModel::notifyChanged() {
+    if (foldsChangedCallback_) {
+        foldsChangedCallback_();
+    }
+}
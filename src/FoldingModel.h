@@ -0,0 +1,149 @@
+#ifndef FOLDING_MODEL_H
+#define FOLDING_MODEL_H
+
+#include "FoldRegionTree.h"
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class SyntaxModel;
+struct TextEdit;
+
+/**
+ * 代码折叠模型
+ * 在语法模型完成增量更新后，只重新计算受编辑影响的折叠区域：
+ * 括号区域利用括号索引查询跨越编辑范围的配对，缩进区域只重扫编辑所在的顶层块，
+ * 注释区域只重扫编辑所在的连续注释段，折叠状态随行号平移保留
+ */
+class FoldingModel {
+public:
+    FoldingModel();
+    ~FoldingModel();
+
+    FoldingModel(const FoldingModel&) = delete;
+    FoldingModel& operator=(const FoldingModel&) = delete;
+
+    /**
+     * 设置语法模型，并订阅其更新
+     * @param syntaxModel 语法模型指针（由调用方持有）
+     */
+    void setSyntaxModel(SyntaxModel* syntaxModel);
+
+    /**
+     * 重新计算整篇文档的折叠区域（折叠状态被清除）
+     */
+    void reset();
+
+    /**
+     * 获取与指定行范围重叠的折叠区域
+     * @param firstLine 起始行
+     * @param lastLine 结束行（包含）
+     * @param regions 输出区域，按起始行升序
+     */
+    void getRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& regions) const;
+
+    /**
+     * 获取折叠区域总数
+     * @return 区域数量
+     */
+    size_t getRegionCount() const;
+
+    /**
+     * 查找起始于指定行的最外层折叠区域
+     * @param line 行号
+     * @param region 输出区域
+     * @return 是否找到
+     */
+    bool findRegionAt(size_t line, FoldRegion& region) const;
+
+    /**
+     * 切换折叠状态
+     * 指定行是区域起始行时切换该区域，否则折叠包含该行的最内层区域
+     * @param line 行号
+     * @return 被切换区域的起始行，没有可切换的区域时返回 std::string::npos
+     */
+    size_t toggleFold(size_t line);
+
+    /**
+     * 折叠所有区域
+     */
+    void foldAll();
+
+    /**
+     * 展开所有区域
+     */
+    void unfoldAll();
+
+    /**
+     * 获取隐藏的行范围（已合并，按起始行升序）
+     * @return [起始行, 结束行] 列表
+     */
+    const std::vector<std::pair<size_t, size_t>>& getHiddenRanges() const;
+
+    /**
+     * 检查行是否被折叠隐藏
+     * @param line 行号
+     * @return 是否隐藏
+     */
+    bool isLineHidden(size_t line) const;
+
+    /**
+     * 获取不早于指定行的第一个可见行
+     * @param line 行号
+     * @return 可见行号（可能等于文档行数，表示之后没有可见行）
+     */
+    size_t nextVisibleLine(size_t line) const;
+
+    /**
+     * 设置折叠区域或折叠状态变化的回调
+     * @param callback 回调函数
+     */
+    void setFoldsChangedCallback(std::function<void()> callback);
+
+private:
+    SyntaxModel* syntaxModel_;
+    size_t updateListenerId_;
+    FoldRegionTree tree_;
+    std::vector<std::pair<size_t, bool>> markers_;  // (行号, 是否为 #region)，按行号升序
+    std::vector<std::pair<size_t, size_t>> hiddenRanges_;
+    bool bracketMode_;
+    std::function<void()> foldsChangedCallback_;
+
+    /**
+     * 处理语法模型更新
+     * @param edit 编辑描述，为空表示整篇文档已重新分析
+     */
+    void handleUpdate(const TextEdit* edit);
+
+    size_t getLineCount() const;
+    std::string_view getLineText(size_t line) const;
+
+    /**
+     * 计算行的缩进宽度
+     * @return 缩进宽度，空白行返回 -1
+     */
+    int getIndent(size_t line) const;
+
+    bool isCommentLine(size_t line) const;
+
+    /**
+     * 识别折叠标记行
+     * @return 1 表示 #region，-1 表示 #endregion，0 表示不是标记
+     */
+    int getMarkerType(size_t line) const;
+
+    void computeBracketRegions();
+    void updateBracketRegions(size_t firstLine, size_t lastLine);
+    void computeIndentRegions(size_t fromLine, size_t toLine, size_t maxStartLine);
+    void updateIndentRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& removed);
+    void computeCommentRegions(size_t fromLine, size_t toLine);
+    void updateCommentRegions(size_t firstLine, size_t lastLine, std::vector<FoldRegion>& removed);
+    void updateMarkers(size_t firstLine, size_t oldLastLine, size_t newLastLine, int64_t delta);
+    void pairMarkers(std::vector<FoldRegion>& removed);
+    void restoreCollapsed(const std::vector<FoldRegion>& collapsed);
+    void rebuildHiddenRanges();
+    void notifyChanged();
+};
+
+#endif // FOLDING_MODEL_H
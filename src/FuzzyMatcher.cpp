@@ -0,0 +1,576 @@
+#include "FuzzyMatcher.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LITEPAD_FUZZY_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEPAD_FUZZY_SSE2 1
+#endif
+
+namespace {
+
+// 不超过此长度的条目用位图匹配，更长的逐字节匹配
+const size_t kBlockSize = 64;
+
+// 候选数达到此值时分块并行打分
+const size_t kParallelThreshold = 32768;
+
+// 打分参数
+const int kScoreMatch = 16;          // 每个匹配字符
+const int kBonusSeparator = 10;      // 位于开头或 / 之后
+const int kBonusBoundary = 8;        // 位于 _ - . 空格之后或驼峰大写处
+const int kBonusConsecutive = 6;     // 紧接上一个匹配字符
+const int kPenaltyGapStart = 3;      // 匹配字符之间出现间隔
+const int kPenaltyGapExtension = 1;  // 间隔每多一个字符
+const int kBonusBasename = 24;       // 全部匹配都在文件名部分
+
+inline char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/**
+ * 字符在位图中的位：字母和数字各占一位，常见分隔符各占一位，其余字节共用最高位
+ */
+inline int maskBit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a';
+    }
+    if (c >= '0' && c <= '9') {
+        return 26 + (c - '0');
+    }
+    switch (c) {
+    case '_':
+        return 36;
+    case '-':
+        return 37;
+    case '.':
+        return 38;
+    case '/':
+        return 39;
+    case ' ':
+        return 40;
+    default:
+        return 63;
+    }
+}
+
+/**
+ * 位置 i 处字符作为单词开头的加分
+ */
+inline int boundaryBonus(const char* text, size_t i) {
+    if (i == 0) {
+        return kBonusSeparator;
+    }
+    char previous = text[i - 1];
+    if (previous == '/' || previous == '\\') {
+        return kBonusSeparator;
+    }
+    if (previous == '_' || previous == '-' || previous == '.' || previous == ' ') {
+        return kBonusBoundary;
+    }
+    if (text[i] >= 'A' && text[i] <= 'Z' && previous >= 'a' && previous <= 'z') {
+        return kBonusBoundary;
+    }
+    return 0;
+}
+
+/**
+ * 筛选出位图包含 required 中所有位的条目
+ */
+void filterMasks(const uint64_t* masks, size_t count, uint64_t required, std::vector<uint32_t>& out) {
+    size_t i = 0;
+#if defined(LITEPAD_FUZZY_AVX2)
+    const __m256i need = _mm256_set1_epi64x(static_cast<long long>(required));
+    for (; i + 4 <= count; i += 4) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+        __m256i hit = _mm256_cmpeq_epi64(_mm256_and_si256(value, need), need);
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(hit)));
+        for (unsigned lane = 0; bits; lane++, bits >>= 1) {
+            if (bits & 1) {
+                out.push_back(static_cast<uint32_t>(i + lane));
+            }
+        }
+    }
+#elif defined(LITEPAD_FUZZY_SSE2)
+    // SSE2 没有 64 位比较：按 32 位比较，两半都相等才算命中
+    const __m128i need = _mm_set1_epi64x(static_cast<long long>(required));
+    for (; i + 2 <= count; i += 2) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+        int bits = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(value, need), need));
+        if ((bits & 0x00ff) == 0x00ff) {
+            out.push_back(static_cast<uint32_t>(i));
+        }
+        if ((bits & 0xff00) == 0xff00) {
+            out.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if ((masks[i] & required) == required) {
+            out.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+/**
+ * 一个不超过 64 字节的条目，与查询字符比较后得到命中位置的位图
+ */
+#if defined(LITEPAD_FUZZY_AVX2)
+
+struct Block {
+    __m256i low;
+    __m256i high;
+
+    explicit Block(const char* data)
+        : low(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))),
+          high(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32))) {}
+
+    uint64_t equal(char c) const {
+        __m256i needle = _mm256_set1_epi8(c);
+        uint64_t lowBits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, needle)));
+        uint64_t highBits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, needle)));
+        return lowBits | (highBits << 32);
+    }
+};
+
+#elif defined(LITEPAD_FUZZY_SSE2)
+
+struct Block {
+    __m128i part[4];
+
+    explicit Block(const char* data) {
+        for (int i = 0; i < 4; i++) {
+            part[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+        }
+    }
+
+    uint64_t equal(char c) const {
+        __m128i needle = _mm_set1_epi8(c);
+        uint64_t bits = 0;
+        for (int i = 0; i < 4; i++) {
+            bits |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(part[i], needle)))) << (i * 16);
+        }
+        return bits;
+    }
+};
+
+#else
+
+struct Block {
+    const char* data;
+
+    explicit Block(const char* bytes) : data(bytes) {}
+
+    uint64_t equal(char c) const {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i++) {
+            bits |= uint64_t(data[i] == c) << i;
+        }
+        return bits;
+    }
+};
+
+#endif
+
+inline int lowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+inline int highestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(bits);
+#endif
+}
+
+/**
+ * 不小于 position 的所有位（position 超出范围时为空）
+ */
+inline uint64_t wordFrom(int position) {
+    return position >= 64 ? 0 : position <= 0 ? ~uint64_t(0) : ~uint64_t(0) << position;
+}
+
+/**
+ * 64 位的位置位图
+ */
+struct Bits64 {
+    uint64_t word;
+
+    static Bits64 from(int position) { return Bits64{wordFrom(position)}; }
+    bool any() const { return word != 0; }
+    bool test(int position) const { return (word >> position) & 1; }
+    int lowest() const { return lowestBit(word); }
+    int highest() const { return highestBit(word); }
+    Bits64 operator&(const Bits64& other) const { return Bits64{word & other.word}; }
+    Bits64 operator~() const { return Bits64{~word}; }
+};
+
+/**
+ * 128 位的位置位图，用于 65 到 128 字节的条目
+ */
+struct Bits128 {
+    uint64_t low;
+    uint64_t high;
+
+    static Bits128 from(int position) { return Bits128{wordFrom(position), wordFrom(position - 64)}; }
+    bool any() const { return (low | high) != 0; }
+    bool test(int position) const { return position < 64 ? (low >> position) & 1 : (high >> (position - 64)) & 1; }
+    int lowest() const { return low ? lowestBit(low) : 64 + lowestBit(high); }
+    int highest() const { return high ? 64 + highestBit(high) : highestBit(low); }
+    Bits128 operator&(const Bits128& other) const { return Bits128{low & other.low, high & other.high}; }
+    Bits128 operator~() const { return Bits128{~low, ~high}; }
+};
+
+/**
+ * 在窗口允许的范围内用命中位图打分，结果与 FuzzyMatcher::scoreWindow 逐字节计算的相同
+ * @param text 条目原始文本（用于计算单词开头加分）
+ * @param positions 每个查询字符在条目中的命中位图
+ * @param queryLength 查询长度
+ * @param window 允许匹配的位置
+ * @return 得分，不匹配时返回 -1
+ */
+template <typename Bits>
+int scoreBitsWindow(const char* text, const Bits* positions, size_t queryLength, const Bits& window) {
+    // 向前：每次取允许范围内最低的命中位，得到最早的匹配结尾
+    Bits allowed = window;
+    int end = -1;
+    for (size_t j = 0; j < queryLength; j++) {
+        Bits hits = positions[j] & allowed;
+        if (!hits.any()) {
+            return -1;
+        }
+        end = hits.lowest();
+        allowed = Bits::from(end + 1);
+    }
+
+    // 向后：从结尾取最高的命中位，得到最靠后的起点
+    int start = end + 1;
+    for (size_t j = queryLength; j-- > 0;) {
+        start = (positions[j] & window & ~Bits::from(start)).highest();
+    }
+
+    // 在最紧的窗口内再向前取一次位置
+    int score = 0;
+    int previous = -1;
+    allowed = Bits::from(start);
+    for (size_t j = 0; j < queryLength; j++) {
+        int position = (positions[j] & allowed).lowest();
+        int bonus = boundaryBonus(text, static_cast<size_t>(position));
+        score += kScoreMatch + bonus;
+        if (j == 0) {
+            score += bonus;
+        } else if (position == previous + 1) {
+            score += kBonusConsecutive;
+        } else {
+            score -= kPenaltyGapStart + (position - previous - 2) * kPenaltyGapExtension;
+        }
+        previous = position;
+        allowed = Bits::from(position + 1);
+    }
+    return std::max(score, 0);
+}
+
+/**
+ * 用命中位图打分，与 FuzzyMatcher::scoreText 一样优先在文件名部分匹配
+ */
+template <typename Bits>
+int scoreBits(const char* text, const Bits* positions, size_t queryLength, size_t basename) {
+    if (basename > 0) {
+        int inBasename = scoreBitsWindow(text, positions, queryLength, Bits::from(static_cast<int>(basename)));
+        if (inBasename >= 0) {
+            return inBasename + kBonusBasename;
+        }
+        return scoreBitsWindow(text, positions, queryLength, Bits::from(0));
+    }
+    int value = scoreBitsWindow(text, positions, queryLength, Bits::from(0));
+    return value >= 0 ? value + kBonusBasename : -1;
+}
+
+}  // namespace
+
+FuzzyMatcher::FuzzyMatcher() : survivorsValid_(false) {
+    offsets_.push_back(0);
+}
+
+void FuzzyMatcher::setItems(const std::vector<std::string>& items) {
+    size_t total = 0;
+    for (const std::string& item : items) {
+        total += item.size();
+    }
+    text_.clear();
+    text_.reserve(total);
+    offsets_.clear();
+    offsets_.reserve(items.size() + 1);
+    masks_.clear();
+    masks_.reserve(items.size());
+    for (const std::string& item : items) {
+        offsets_.push_back(static_cast<uint32_t>(text_.size()));
+        text_ += item;
+    }
+    offsets_.push_back(static_cast<uint32_t>(text_.size()));
+
+    // 末尾补齐两个块，最后一个条目按块读取时不会越界
+    folded_.assign(text_.size() + 2 * kBlockSize, '\0');
+    std::transform(text_.begin(), text_.end(), folded_.begin(), toLowerAscii);
+    basenames_.clear();
+    basenames_.reserve(items.size());
+    for (size_t i = 0; i + 1 < offsets_.size(); i++) {
+        const char* item = text_.data() + offsets_[i];
+        size_t length = offsets_[i + 1] - offsets_[i];
+        masks_.push_back(characterMask(folded_.data() + offsets_[i], length));
+        basenames_.push_back(static_cast<uint32_t>(basenameOffset(item, length)));
+    }
+    lastQuery_.clear();
+    survivors_.clear();
+    survivorsValid_ = false;
+}
+
+size_t FuzzyMatcher::getItemCount() const {
+    return masks_.size();
+}
+
+std::string FuzzyMatcher::getItem(size_t index) const {
+    if (index >= masks_.size()) {
+        return "";
+    }
+    return text_.substr(offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+std::vector<FuzzyMatch> FuzzyMatcher::match(const std::string& query, size_t limit) {
+    std::string folded(query.size(), '\0');
+    std::transform(query.begin(), query.end(), folded.begin(), toLowerAscii);
+
+    std::vector<FuzzyMatch> results;
+    if (folded.empty()) {
+        lastQuery_.clear();
+        survivorsValid_ = false;
+        for (size_t i = 0; i < masks_.size() && results.size() < limit; i++) {
+            results.push_back(FuzzyMatch{static_cast<uint32_t>(i), 0});
+        }
+        return results;
+    }
+
+    // 新查询以上一次查询开头时，匹配的条目只可能在上一次的结果中
+    uint64_t required = characterMask(folded.data(), folded.size());
+    std::vector<uint32_t>& candidates = candidates_;
+    candidates.clear();
+    bool refine = survivorsValid_ && folded.compare(0, lastQuery_.size(), lastQuery_) == 0;
+    if (refine) {
+        candidates.reserve(survivors_.size());
+        for (uint32_t index : survivors_) {
+            if ((masks_[index] & required) == required) {
+                candidates.push_back(index);
+            }
+        }
+    } else {
+        filterMasks(masks_.data(), masks_.size(), required, candidates);
+    }
+
+    // 候选很多时分块并行打分，每块各自选出前 limit 个再合并
+    size_t chunkCount = 1;
+    if (candidates.size() >= kParallelThreshold) {
+        if (!pool_) {
+            pool_ = std::make_unique<ThreadPool>();
+        }
+        if (pool_->getThreadCount() > 1) {
+            chunkCount = std::min(pool_->getThreadCount() * 4, candidates.size() / (kParallelThreshold / 4));
+        }
+    }
+    if (chunks_.size() < chunkCount) {
+        chunks_.resize(chunkCount);
+    }
+    size_t chunkSize = (candidates.size() + chunkCount - 1) / chunkCount;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        const uint32_t* begin = candidates.data() + std::min(candidates.size(), chunk * chunkSize);
+        const uint32_t* end = candidates.data() + std::min(candidates.size(), (chunk + 1) * chunkSize);
+        Chunk* target = &chunks_[chunk];
+        if (chunkCount == 1) {
+            scoreCandidates(begin, end, folded, limit, *target);
+        } else {
+            pool_->submit([this, begin, end, &folded, limit, target]() {
+                scoreCandidates(begin, end, folded, limit, *target);
+            });
+        }
+    }
+    if (chunkCount > 1) {
+        pool_->wait();
+    }
+
+    survivors_.clear();
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        survivors_.insert(survivors_.end(), chunks_[chunk].survivors.begin(), chunks_[chunk].survivors.end());
+        results.insert(results.end(), chunks_[chunk].top.begin(), chunks_[chunk].top.end());
+    }
+    lastQuery_ = folded;
+    survivorsValid_ = true;
+    selectTop(results, limit);
+    return results;
+}
+
+void FuzzyMatcher::scoreCandidates(const uint32_t* begin, const uint32_t* end, const std::string& query,
+                                   size_t limit, Chunk& chunk) const {
+    chunk.top.clear();
+    chunk.survivors.clear();
+    // 每个查询字符在条目中的命中位置各是一个位图，之后的匹配和计分都是位运算；
+    // 超过 128 字节的条目很少，逐字节计算
+    Bits64 shortPositions[kBlockSize];
+    Bits128 longPositions[2 * kBlockSize];
+    for (const uint32_t* it = begin; it != end; ++it) {
+        uint32_t index = *it;
+        uint32_t start = offsets_[index];
+        size_t length = offsets_[index + 1] - start;
+        if (query.size() > length) {
+            continue;
+        }
+        const char* text = text_.data() + start;
+        int value = -1;
+        if (length <= kBlockSize) {
+            Block block(folded_.data() + start);
+            Bits64 valid = ~Bits64::from(static_cast<int>(length));
+            for (size_t j = 0; j < query.size(); j++) {
+                shortPositions[j] = Bits64{block.equal(query[j])} & valid;
+            }
+            value = scoreBits(text, shortPositions, query.size(), basenames_[index]);
+        } else if (length <= 2 * kBlockSize) {
+            Block low(folded_.data() + start);
+            Block high(folded_.data() + start + kBlockSize);
+            Bits128 valid = ~Bits128::from(static_cast<int>(length));
+            for (size_t j = 0; j < query.size(); j++) {
+                longPositions[j] = Bits128{low.equal(query[j]), high.equal(query[j])} & valid;
+            }
+            value = scoreBits(text, longPositions, query.size(), basenames_[index]);
+        } else {
+            value = scoreText(text, folded_.data() + start, length, basenames_[index], query);
+        }
+        if (value >= 0) {
+            chunk.top.push_back(FuzzyMatch{index, value});
+            chunk.survivors.push_back(index);
+        }
+    }
+    selectTop(chunk.top, limit);
+}
+
+void FuzzyMatcher::selectTop(std::vector<FuzzyMatch>& matches, size_t limit) const {
+    // 只需要前 limit 个有序，部分排序即可；同分时较短的条目在前
+    auto better = [this](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        uint32_t lengthA = offsets_[a.index + 1] - offsets_[a.index];
+        uint32_t lengthB = offsets_[b.index + 1] - offsets_[b.index];
+        return lengthA != lengthB ? lengthA < lengthB : a.index < b.index;
+    };
+    size_t count = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), better);
+    matches.resize(count);
+}
+
+size_t FuzzyMatcher::getMatchCount() const {
+    return survivorsValid_ ? survivors_.size() : masks_.size();
+}
+
+int FuzzyMatcher::score(const std::string& item, const std::string& query) {
+    std::string foldedItem(item.size(), '\0');
+    std::transform(item.begin(), item.end(), foldedItem.begin(), toLowerAscii);
+    std::string foldedQuery(query.size(), '\0');
+    std::transform(query.begin(), query.end(), foldedQuery.begin(), toLowerAscii);
+    return scoreText(item.data(), foldedItem.data(), item.size(), basenameOffset(item.data(), item.size()),
+                     foldedQuery);
+}
+
+uint64_t FuzzyMatcher::characterMask(const char* data, size_t length) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < length; i++) {
+        mask |= uint64_t(1) << maskBit(static_cast<unsigned char>(data[i]));
+    }
+    return mask;
+}
+
+int FuzzyMatcher::scoreText(const char* text, const char* folded, size_t length, size_t basename,
+                            const std::string& query) {
+    // 整个查询能在文件名部分匹配时直接按文件名内的窗口计分，多数结果只需计算一次
+    if (length - basename >= query.size()) {
+        int inBasename = scoreWindow(text, folded, basename, length, query);
+        if (inBasename >= 0) {
+            return inBasename + kBonusBasename;
+        }
+    }
+    return basename > 0 ? scoreWindow(text, folded, 0, length, query) : -1;
+}
+
+size_t FuzzyMatcher::basenameOffset(const char* text, size_t length) {
+    size_t basename = length;
+    while (basename > 0 && text[basename - 1] != '/' && text[basename - 1] != '\\') {
+        basename--;
+    }
+    return basename;
+}
+
+int FuzzyMatcher::scoreWindow(const char* text, const char* folded, size_t from, size_t length,
+                              const std::string& query) {
+    // 向前：找到最早能完成匹配的结尾（路径很短，逐字节比较比逐个调用 memchr 快）
+    const char* pattern = query.data();
+    size_t patternLength = query.size();
+    size_t matched = 0;
+    size_t end = from;
+    for (; end < length; end++) {
+        if (folded[end] == pattern[matched] && ++matched == patternLength) {
+            break;
+        }
+    }
+    if (matched < patternLength) {
+        return -1;
+    }
+
+    // 向后：从结尾反向匹配，得到最靠后的起点，窗口最紧
+    size_t start = end;
+    size_t j = query.size();
+    for (size_t i = end + 1; i-- > from;) {
+        if (folded[i] == query[j - 1] && --j == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    int score = 0;
+    bool previousMatched = false;
+    bool inGap = false;
+    j = 0;
+    for (size_t i = start; i <= end; i++) {
+        if (j < query.size() && folded[i] == query[j]) {
+            int bonus = boundaryBonus(text, i);
+            score += kScoreMatch + bonus;
+            if (previousMatched) {
+                score += kBonusConsecutive;
+            }
+            if (j == 0) {
+                // 第一个字符落在单词开头最能体现用户意图
+                score += bonus;
+            }
+            previousMatched = true;
+            inGap = false;
+            j++;
+        } else {
+            score -= inGap ? kPenaltyGapExtension : kPenaltyGapStart;
+            previousMatched = false;
+            inGap = true;
+        }
+    }
+    return std::max(score, 0);
+}
@@ -0,0 +1,151 @@
+#ifndef FUZZY_MATCHER_H
+#define FUZZY_MATCHER_H
+
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 模糊匹配结果
+ */
+struct FuzzyMatch {
+    uint32_t index;  // 条目下标
+    int score;       // 得分，越大越好
+};
+
+/**
+ * 模糊匹配器（用于快速打开文件）
+ * 查询的每个字符按顺序出现在路径中即为匹配（不区分 ASCII 大小写）。
+ * 所有路径连续存放，并预先计算每条路径的字符集位图：先用 SIMD 按位图一次筛掉
+ * 缺少查询字符的路径，再对剩下的做子序列检查和打分，最后部分排序取前 K 个。
+ * 查询在上一次的基础上追加字符时，只需重新检查上一次匹配的路径。
+ * 候选很多时分块在线程池中并行打分
+ */
+class FuzzyMatcher {
+public:
+    FuzzyMatcher();
+
+    /**
+     * 设置候选条目（通常是相对于工作区的文件路径）
+     * @param items 条目
+     */
+    void setItems(const std::vector<std::string>& items);
+
+    /**
+     * 获取条目数
+     * @return 条目数
+     */
+    size_t getItemCount() const;
+
+    /**
+     * 获取条目
+     * @param index 条目下标
+     * @return 条目文本
+     */
+    std::string getItem(size_t index) const;
+
+    /**
+     * 匹配查询，返回得分最高的若干条目
+     * @param query 查询
+     * @param limit 最多返回的数量
+     * @return 按得分从高到低排列的结果（同分时较短的条目在前）；查询为空时按原顺序返回前 limit 个
+     */
+    std::vector<FuzzyMatch> match(const std::string& query, size_t limit);
+
+    /**
+     * 获取最近一次查询匹配的条目总数
+     * @return 匹配数
+     */
+    size_t getMatchCount() const;
+
+    /**
+     * 计算单个条目的得分
+     * 匹配的字符越集中、越靠近单词开头（/、_、-、. 之后或驼峰大写处）、越位于文件名部分，得分越高
+     * @param item 条目
+     * @param query 查询
+     * @return 得分，不匹配时返回 -1
+     */
+    static int score(const std::string& item, const std::string& query);
+
+private:
+    /**
+     * 一块候选的打分结果
+     */
+    struct Chunk {
+        std::vector<FuzzyMatch> top;         // 得分最高的若干条目
+        std::vector<uint32_t> survivors;     // 全部匹配的条目（保持原顺序）
+    };
+
+    std::string text_;              // 全部条目首尾相接
+    std::string folded_;            // text_ 的小写形式
+    std::vector<uint32_t> offsets_;  // 每个条目的起始位置，末尾多一项
+    std::vector<uint64_t> masks_;    // 每个条目的字符集位图
+    std::vector<uint32_t> basenames_;  // 每个条目中文件名部分的起始位置（相对条目开头）
+    std::string lastQuery_;         // 上一次的查询（已转为小写）
+    std::vector<uint32_t> survivors_;  // 上一次匹配的条目
+    bool survivorsValid_;
+    std::vector<uint32_t> candidates_;  // 以下两项在查询之间复用，避免每次按键重新分配
+    std::vector<Chunk> chunks_;
+    std::unique_ptr<ThreadPool> pool_;  // 第一次需要并行时创建
+
+    /**
+     * 对一段候选打分，记录全部匹配并选出得分最高的若干个
+     * @param begin 候选起始
+     * @param end 候选结束
+     * @param query 小写查询
+     * @param limit 保留的数量
+     * @param chunk 输出结果
+     */
+    void scoreCandidates(const uint32_t* begin, const uint32_t* end, const std::string& query, size_t limit,
+                         Chunk& chunk) const;
+
+    /**
+     * 部分排序，只保留得分最高的若干个
+     * @param matches 匹配结果
+     * @param limit 保留的数量
+     */
+    void selectTop(std::vector<FuzzyMatch>& matches, size_t limit) const;
+
+    /**
+     * 计算字符集位图
+     * @param data 文本（已转为小写）
+     * @param length 长度
+     * @return 位图
+     */
+    static uint64_t characterMask(const char* data, size_t length);
+
+    /**
+     * 获取文件名部分的起始位置（最后一个路径分隔符之后）
+     * @param text 文本
+     * @param length 长度
+     * @return 起始位置
+     */
+    static size_t basenameOffset(const char* text, size_t length);
+
+    /**
+     * 对一段文本打分，优先在文件名部分匹配
+     * @param text 原始文本（用于判断驼峰边界）
+     * @param folded 小写文本
+     * @param length 长度
+     * @param basename 文件名部分的起始位置
+     * @param query 小写查询
+     * @return 得分，不匹配时返回 -1
+     */
+    static int scoreText(const char* text, const char* folded, size_t length, size_t basename,
+                         const std::string& query);
+
+    /**
+     * 在 [from, length) 内打分：先向前找到最早的匹配结尾，再向后收紧起点，在最紧的窗口内计分
+     * @param text 原始文本
+     * @param folded 小写文本
+     * @param from 起始位置
+     * @param length 长度
+     * @param query 小写查询
+     * @return 得分，不匹配时返回 -1
+     */
+    static int scoreWindow(const char* text, const char* folded, size_t from, size_t length, const std::string& query);
+};
+
+#endif // FUZZY_MATCHER_H
@@ -0,0 +1,30 @@
+#ifndef GB18030_TABLE_H
+#define GB18030_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * GB18030 双字节区的码位表
+ * 下标为 (首字节 - 0x81) × 190 + 尾字节序号（尾字节 0x40-0x7E 为 0-62，0x80-0xFE 为 63-189）
+ */
+const size_t kGb18030TwoByteCount = 126 * 190;
+extern const uint16_t kGb18030TwoByte[kGb18030TwoByteCount];
+
+/**
+ * GB18030 四字节区中 BMP 部分的一个分段：从线性序号 linear 开始的字符对应从 codePoint 开始的连续码位，
+ * 到下一个分段为止。线性序号为 (((b1 - 0x81) × 10 + (b2 - 0x30)) × 126 + (b3 - 0x81)) × 10 + (b4 - 0x30)。
+ * 分段按线性序号和码位都是递增的；BMP 以外的码位从线性序号 189000（0x90308130）开始顺序排列
+ */
+struct Gb18030Range {
+    uint16_t linear;
+    uint16_t codePoint;
+};
+
+const size_t kGb18030RangeCount = 206;
+extern const Gb18030Range kGb18030Ranges[kGb18030RangeCount];
+
+// 四字节区中 BMP 部分的线性序号个数
+const uint32_t kGb18030BmpLinearCount = 39420;
+
+#endif // GB18030_TABLE_H
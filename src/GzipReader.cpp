@@ -0,0 +1,525 @@
+#include "GzipReader.h"
+#include "ConfigManager.h"
+#include "FileFollower.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+
+namespace {
+
+const char kIndexMagic[8] = {'L', 'P', 'G', 'Z', 'I', 'D', 'X', '\0'};
+const uint32_t kIndexVersion = 1;
+
+// deflate 的最大回溯距离，也是检查点保存的字典大小
+const size_t kWindowSize = 32768;
+
+// 每次从文件读取的压缩数据字节数
+const size_t kInputChunk = 64 * 1024;
+
+// 默认检查点间隔（解压数据字节数）
+const uint64_t kDefaultSpan = 4 << 20;
+
+// gzip 成员末尾的 CRC32 和长度
+const size_t kTrailerSize = 8;
+
+/**
+ * 索引文件头，之后依次是各检查点的记录及其字典（按本机字节序存储）
+ */
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t checkpointCount;
+    uint64_t fileSize;
+    int64_t modificationTime;
+    uint64_t span;
+    uint64_t uncompressedSize;
+    uint64_t lineCount;
+};
+
+/**
+ * 检查点记录
+ */
+struct CheckpointRecord {
+    uint64_t output;
+    uint64_t input;
+    uint64_t line;
+    uint32_t bits;
+    uint32_t windowSize;
+};
+
+/**
+ * 读取文件大小和修改时间
+ */
+bool statFile(const std::string& path, uint64_t& size, int64_t& modificationTime) {
+    std::error_code error;
+    size = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+    auto time = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    modificationTime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+}  // namespace
+
+GzipReader::GzipReader()
+    : fileSize_(0), modificationTime_(0), span_(kDefaultSpan), indexComplete_(false), uncompressedSize_(0),
+      lineCount_(0), finished_(false), error_(false), cancelled_(false) {}
+
+GzipReader::~GzipReader() {
+    close();
+}
+
+bool GzipReader::isGzipFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[2] = {0, 0};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    return file.gcount() == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+std::string GzipReader::defaultIndexPath(const std::string& path) {
+    std::string directory = ConfigManager::getUserConfigDirectory();
+    if (directory.empty()) {
+        return "";
+    }
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.gzindex",
+                  static_cast<unsigned long long>(std::hash<std::string>()(error ? path : absolute.string())));
+    return (std::filesystem::path(directory) / "index" / name).string();
+}
+
+bool GzipReader::open(const std::string& path, const std::string& indexPath) {
+    close();
+    if (!isGzipFile(path) || !statFile(path, fileSize_, modificationTime_)) {
+        std::cerr << "Not a readable gzip file: " << path << std::endl;
+        return false;
+    }
+    path_ = path;
+    indexPath_ = indexPath;
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadIndex();
+    return true;
+}
+
+void GzipReader::close() {
+    stopWorker();
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_.clear();
+    indexPath_.clear();
+    checkpoints_.clear();
+    indexComplete_ = false;
+    uncompressedSize_ = 0;
+    lineCount_ = 0;
+    pending_.clear();
+    finished_ = false;
+    error_ = false;
+}
+
+void GzipReader::setSpan(uint64_t span) {
+    span_ = std::max<uint64_t>(span, kWindowSize);
+}
+
+bool GzipReader::startStreaming() {
+    stopWorker();
+    if (path_.empty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        finished_ = false;
+        error_ = false;
+    }
+    cancelled_ = false;
+    worker_ = std::thread([this]() {
+        bool ok = runFullPass([this](const char* data, size_t length, uint64_t) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.append(data, length);
+            }
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (dataReadyCallback_) {
+                dataReadyCallback_();
+            }
+            return !cancelled_;
+        });
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+            error_ = !ok;
+        }
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        if (dataReadyCallback_) {
+            dataReadyCallback_();
+        }
+    });
+    return true;
+}
+
+bool GzipReader::readAll(std::string& content) {
+    content.clear();
+    if (path_.empty()) {
+        return false;
+    }
+    content.reserve(getUncompressedSize());
+    return runFullPass([&content](const char* data, size_t length, uint64_t) {
+        content.append(data, length);
+        return true;
+    });
+}
+
+bool GzipReader::collect(std::string& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t length = finished_ ? pending_.size() : FileFollower::completeLength(pending_.data(), pending_.size());
+    if (length == 0) {
+        return false;
+    }
+    data.assign(pending_, 0, length);
+    pending_.erase(0, length);
+    return true;
+}
+
+bool GzipReader::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finished_;
+}
+
+bool GzipReader::hasError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void GzipReader::setDataReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    dataReadyCallback_ = callback;
+}
+
+bool GzipReader::isIndexComplete() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return indexComplete_;
+}
+
+uint64_t GzipReader::getUncompressedSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return uncompressedSize_;
+}
+
+uint64_t GzipReader::getLineCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lineCount_;
+}
+
+size_t GzipReader::getCheckpointCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return checkpoints_.size();
+}
+
+bool GzipReader::read(uint64_t offset, size_t length, std::string& data) {
+    data.clear();
+    if (path_.empty()) {
+        return false;
+    }
+    GzipCheckpoint checkpoint;
+    bool found = findCheckpoint(offset, checkpoint);
+    uint64_t end = offset + length;
+    return inflateFrom(found ? &checkpoint : nullptr, false,
+                       [&data, offset, end](const char* chunk, size_t size, uint64_t at) {
+                           uint64_t from = std::max(at, offset);
+                           uint64_t to = std::min(at + size, end);
+                           if (from < to) {
+                               data.append(chunk + (from - at), static_cast<size_t>(to - from));
+                           }
+                           return at + size < end;
+                       });
+}
+
+bool GzipReader::findLine(uint64_t line, uint64_t& offset) {
+    if (path_.empty()) {
+        return false;
+    }
+    if (line == 0) {
+        offset = 0;
+        return true;
+    }
+    // 行首在换行符之后，必须从之前换行符数量小于 line 的检查点开始
+    GzipCheckpoint checkpoint;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::partition_point(checkpoints_.begin(), checkpoints_.end(),
+                                       [line](const GzipCheckpoint& point) { return point.line < line; });
+        if (it != checkpoints_.begin()) {
+            checkpoint = *(it - 1);
+            found = true;
+        }
+    }
+    uint64_t remaining = line - (found ? checkpoint.line : 0);
+    bool reached = false;
+    bool ok = inflateFrom(found ? &checkpoint : nullptr, false,
+                          [&](const char* chunk, size_t size, uint64_t at) {
+                              for (const char* p = chunk; (p = static_cast<const char*>(
+                                                               std::memchr(p, '\n', chunk + size - p)));) {
+                                  p++;
+                                  if (--remaining == 0) {
+                                      offset = at + static_cast<uint64_t>(p - chunk);
+                                      reached = true;
+                                      return false;
+                                  }
+                              }
+                              return true;
+                          });
+    return ok && reached;
+}
+
+bool GzipReader::inflateFrom(const GzipCheckpoint* start, bool record, const Sink& sink) {
+    std::ifstream file(path_, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << path_ << std::endl;
+        return false;
+    }
+    // 从文件开头解压时自动识别 gzip 头；从检查点开始时是裸 deflate 数据
+    bool raw = start != nullptr;
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, raw ? -15 : 47) != Z_OK) {
+        return false;
+    }
+
+    uint64_t input = 0;  // 已读入缓冲区的文件偏移
+    uint64_t output = 0;
+    uint64_t line = 0;
+    if (start) {
+        input = start->input;
+        output = start->output;
+        line = start->line;
+        if (start->bits > 0) {
+            // 检查点落在字节中间：先送入该字节中属于本块的高位
+            file.seekg(static_cast<std::streamoff>(input - 1));
+            int byte = file.get();
+            if (byte == EOF) {
+                inflateEnd(&stream);
+                return false;
+            }
+            inflatePrime(&stream, start->bits, byte >> (8 - start->bits));
+        }
+        file.seekg(static_cast<std::streamoff>(input));
+        if (!start->window.empty()) {
+            inflateSetDictionary(&stream, start->window.data(), static_cast<uInt>(start->window.size()));
+        }
+    }
+
+    std::vector<unsigned char> in(kInputChunk);
+    std::vector<unsigned char> window(kWindowSize);  // 循环使用的输出缓冲区，同时是最近 32KB 的字典
+    size_t windowPos = 0;
+    uint64_t lastCheckpoint = 0;
+    bool hasCheckpoint = false;
+    size_t trailer = 0;         // 裸 deflate 数据结束后尚待跳过的成员尾部字节数
+    bool betweenMembers = false;  // 上一个成员已结束，尚未解出下一个成员的数据
+    bool ok = true;
+    bool stopped = false;
+    while (!stopped) {
+        if (stream.avail_in == 0) {
+            file.read(reinterpret_cast<char*>(in.data()), static_cast<std::streamsize>(in.size()));
+            size_t count = static_cast<size_t>(file.gcount());
+            if (count == 0) {
+                // 文件结束：必须恰好在成员之间，否则文件被截断
+                ok = betweenMembers && trailer == 0;
+                break;
+            }
+            stream.next_in = in.data();
+            stream.avail_in = static_cast<uInt>(count);
+            input += count;
+        }
+        if (trailer > 0) {
+            size_t skipped = std::min<size_t>(trailer, stream.avail_in);
+            stream.next_in += skipped;
+            stream.avail_in -= static_cast<uInt>(skipped);
+            trailer -= skipped;
+            if (trailer == 0) {
+                inflateReset2(&stream, 47);
+                raw = false;
+            }
+            continue;
+        }
+
+        stream.next_out = window.data() + windowPos;
+        stream.avail_out = static_cast<uInt>(kWindowSize - windowPos);
+        int result = inflate(&stream, Z_BLOCK);
+        size_t produced = kWindowSize - windowPos - stream.avail_out;
+        if (result == Z_DATA_ERROR && betweenMembers && produced == 0) {
+            break;  // 最后一个成员之后的填充字节
+        }
+        if (result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_MEM_ERROR) {
+            std::cerr << "Corrupt gzip data in " << path_ << std::endl;
+            ok = false;
+            break;
+        }
+        if (produced > 0) {
+            const char* data = reinterpret_cast<const char*>(window.data() + windowPos);
+            betweenMembers = false;
+            line += static_cast<uint64_t>(std::count(data, data + produced, '\n'));
+            stopped = !sink(data, produced, output);
+            output += produced;
+            windowPos = (windowPos + produced) % kWindowSize;
+        }
+
+        // 块边界（不是最后一块之后）：距离上一个检查点足够远时记录
+        if (record && (stream.data_type & 128) && !(stream.data_type & 64) &&
+            (!hasCheckpoint || output - lastCheckpoint >= span_)) {
+            GzipCheckpoint checkpoint{output, input - stream.avail_in, line, stream.data_type & 7, {}};
+            if (output > 0) {
+                checkpoint.window.reserve(kWindowSize);
+                checkpoint.window.insert(checkpoint.window.end(), window.begin() + windowPos, window.end());
+                checkpoint.window.insert(checkpoint.window.end(), window.begin(), window.begin() + windowPos);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            checkpoints_.push_back(std::move(checkpoint));
+            lastCheckpoint = output;
+            hasCheckpoint = true;
+        }
+
+        if (result == Z_STREAM_END) {
+            // 一个成员结束，之后可能还有成员
+            betweenMembers = true;
+            if (raw) {
+                trailer = kTrailerSize;
+            } else {
+                inflateReset(&stream);
+            }
+        }
+    }
+    inflateEnd(&stream);
+
+    if (record && ok && !stopped) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uncompressedSize_ = output;
+        lineCount_ = line + 1;
+        indexComplete_ = true;
+    }
+    return ok;
+}
+
+bool GzipReader::runFullPass(const Sink& sink) {
+    bool record = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        record = !indexComplete_;
+        if (record) {
+            checkpoints_.clear();
+        }
+    }
+    if (!inflateFrom(nullptr, record, sink)) {
+        return false;
+    }
+    if (record && isIndexComplete() && !indexPath_.empty()) {
+        saveIndex();
+    }
+    return true;
+}
+
+bool GzipReader::findCheckpoint(uint64_t offset, GzipCheckpoint& checkpoint) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::partition_point(checkpoints_.begin(), checkpoints_.end(),
+                                   [offset](const GzipCheckpoint& point) { return point.output <= offset; });
+    if (it == checkpoints_.begin()) {
+        return false;
+    }
+    checkpoint = *(it - 1);
+    return true;
+}
+
+bool GzipReader::loadIndex() {
+    if (indexPath_.empty()) {
+        return false;
+    }
+    std::ifstream file(indexPath_, std::ios::binary);
+    IndexHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || header.version != kIndexVersion ||
+        header.fileSize != fileSize_ || header.modificationTime != modificationTime_) {
+        return false;
+    }
+    std::vector<GzipCheckpoint> checkpoints(header.checkpointCount);
+    for (GzipCheckpoint& checkpoint : checkpoints) {
+        CheckpointRecord record;
+        if (!file.read(reinterpret_cast<char*>(&record), sizeof(record)) || record.bits > 7 ||
+            record.windowSize > kWindowSize) {
+            return false;
+        }
+        checkpoint.output = record.output;
+        checkpoint.input = record.input;
+        checkpoint.line = record.line;
+        checkpoint.bits = static_cast<int>(record.bits);
+        checkpoint.window.resize(record.windowSize);
+        if (!file.read(reinterpret_cast<char*>(checkpoint.window.data()), record.windowSize)) {
+            return false;
+        }
+    }
+    checkpoints_ = std::move(checkpoints);
+    uncompressedSize_ = header.uncompressedSize;
+    lineCount_ = header.lineCount;
+    indexComplete_ = true;
+    return true;
+}
+
+bool GzipReader::saveIndex() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    IndexHeader header;
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.version = kIndexVersion;
+    header.checkpointCount = static_cast<uint32_t>(checkpoints_.size());
+    header.fileSize = fileSize_;
+    header.modificationTime = modificationTime_;
+    header.span = span_;
+    header.uncompressedSize = uncompressedSize_;
+    header.lineCount = lineCount_;
+
+    std::error_code error;
+    std::filesystem::path target(indexPath_);
+    std::filesystem::create_directories(target.parent_path(), error);
+    std::string temporaryPath = indexPath_ + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write gzip index: " << temporaryPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const GzipCheckpoint& checkpoint : checkpoints_) {
+            CheckpointRecord record{checkpoint.output, checkpoint.input, checkpoint.line,
+                                    static_cast<uint32_t>(checkpoint.bits),
+                                    static_cast<uint32_t>(checkpoint.window.size())};
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            file.write(reinterpret_cast<const char*>(checkpoint.window.data()),
+                       static_cast<std::streamsize>(checkpoint.window.size()));
+        }
+        if (!file) {
+            std::cerr << "Failed to write gzip index: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, target, error);
+    if (error) {
+        std::cerr << "Failed to replace gzip index " << indexPath_ << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+void GzipReader::stopWorker() {
+    cancelled_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
@@ -0,0 +1,224 @@
+#ifndef GZIP_READER_H
+#define GZIP_READER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 解压检查点：从这里开始解压不必从文件开头重新解压
+ * 位于 deflate 块的边界，保存之前 32KB 解压数据作为字典
+ */
+struct GzipCheckpoint {
+    uint64_t output;                  // 解压后的偏移
+    uint64_t input;                   // 压缩文件中的字节偏移
+    uint64_t line;                    // output 之前的换行符数量
+    int bits;                         // input 前一个字节中属于本块的位数（0-7）
+    std::vector<unsigned char> window;  // 之前的 32KB 解压数据
+};
+
+/**
+ * gzip 文件只读访问（.log.1.gz 等轮转后的日志）
+ * 第一次完整解压时在 deflate 块边界上每隔一段（默认 4MB 解压数据）记录一个检查点，
+ * 之后读取任意位置或按行号定位时从最近的检查点开始解压，不必从头解压。
+ * 检查点索引按文件大小和修改时间缓存在用户配置目录下，再次打开同一文件时直接载入。
+ *
+ * 流式解压在后台线程中进行，解出的内容由界面线程通过 collect() 分批取走，
+ * 第一批到达即可显示；支持多个 gzip 成员首尾相接的文件
+ */
+class GzipReader {
+public:
+    GzipReader();
+    ~GzipReader();
+
+    GzipReader(const GzipReader&) = delete;
+    GzipReader& operator=(const GzipReader&) = delete;
+
+    /**
+     * 检查文件是否为 gzip 格式（按文件头判断）
+     * @param path 文件路径
+     * @return 是否为 gzip 文件
+     */
+    static bool isGzipFile(const std::string& path);
+
+    /**
+     * 获取检查点索引的默认缓存路径
+     * @param path gzip 文件路径
+     * @return 索引文件路径（无法确定用户配置目录时为空）
+     */
+    static std::string defaultIndexPath(const std::string& path);
+
+    /**
+     * 打开 gzip 文件（已打开时先关闭），缓存的索引与文件大小和修改时间一致时载入
+     * @param path 文件路径
+     * @param indexPath 索引缓存路径，为空时不缓存
+     * @return 是否成功
+     */
+    bool open(const std::string& path, const std::string& indexPath);
+
+    /**
+     * 停止后台解压并关闭文件
+     */
+    void close();
+
+    /**
+     * 设置检查点间隔（在开始解压之前调用）
+     * @param span 相邻检查点之间的解压数据字节数
+     */
+    void setSpan(uint64_t span);
+
+    /**
+     * 在后台线程中从头解压，解出的内容通过 collect() 取走，同时建立检查点索引，完成后写入缓存
+     * @return 是否成功启动
+     */
+    bool startStreaming();
+
+    /**
+     * 在当前线程中解压全部内容（同时建立检查点索引并写入缓存）
+     * @param content 输出解压后的内容
+     * @return 是否成功
+     */
+    bool readAll(std::string& content);
+
+    /**
+     * 取走后台解压出的内容（末尾不完整的 UTF-8 字符留到下一次）
+     * @param data 输出内容
+     * @return 是否有新内容
+     */
+    bool collect(std::string& data);
+
+    /**
+     * 后台解压是否已结束（成功或出错）
+     * @return 是否结束
+     */
+    bool isFinished() const;
+
+    /**
+     * 解压过程中是否出错（文件损坏或被截断）
+     * @return 是否出错
+     */
+    bool hasError() const;
+
+    /**
+     * 设置新内容到达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setDataReadyCallback(std::function<void()> callback);
+
+    /**
+     * 检查点索引是否覆盖整个文件
+     * @return 是否完整
+     */
+    bool isIndexComplete() const;
+
+    /**
+     * 获取解压后的总大小（索引完整时有效）
+     * @return 字节数
+     */
+    uint64_t getUncompressedSize() const;
+
+    /**
+     * 获取解压后的总行数（索引完整时有效）
+     * @return 行数
+     */
+    uint64_t getLineCount() const;
+
+    /**
+     * 获取检查点数量
+     * @return 检查点数量
+     */
+    size_t getCheckpointCount() const;
+
+    /**
+     * 从最近的检查点开始解压，读取指定范围（可与后台解压同时进行）
+     * @param offset 解压后的起始偏移
+     * @param length 最多读取的字节数
+     * @param data 输出内容（到达文件末尾时可能短于 length）
+     * @return 是否成功
+     */
+    bool read(uint64_t offset, size_t length, std::string& data);
+
+    /**
+     * 从最近的检查点开始解压并数换行符，定位到指定行的起始偏移
+     * @param line 行号（从0开始）
+     * @param offset 输出解压后的偏移
+     * @return 是否成功（行号超出文件时返回 false）
+     */
+    bool findLine(uint64_t line, uint64_t& offset);
+
+private:
+    std::string path_;
+    std::string indexPath_;
+    uint64_t fileSize_;
+    int64_t modificationTime_;
+    uint64_t span_;
+
+    mutable std::mutex mutex_;  // 保护以下状态
+    std::vector<GzipCheckpoint> checkpoints_;
+    bool indexComplete_;
+    uint64_t uncompressedSize_;
+    uint64_t lineCount_;
+    std::string pending_;  // 尚未取走的解压内容
+    bool finished_;
+    bool error_;
+
+    std::atomic<bool> cancelled_;
+    std::mutex callbackMutex_;
+    std::function<void()> dataReadyCallback_;
+    std::thread worker_;
+
+    /**
+     * 解压数据的接收函数
+     * 参数为数据、长度和数据在解压后的偏移，返回 false 时停止解压
+     */
+    using Sink = std::function<bool(const char* data, size_t length, uint64_t offset)>;
+
+    /**
+     * 从检查点（为空时从文件开头）开始解压
+     * @param start 起始检查点
+     * @param record 是否记录检查点（只用于从文件开头的完整解压），到达文件末尾时标记索引完整
+     * @param sink 接收函数
+     * @return 是否成功（到达文件末尾或被接收函数停止）
+     */
+    bool inflateFrom(const GzipCheckpoint* start, bool record, const Sink& sink);
+
+    /**
+     * 完整解压一遍，解压结束后写入索引缓存
+     * @param sink 接收函数
+     * @return 是否成功
+     */
+    bool runFullPass(const Sink& sink);
+
+    /**
+     * 查找解压后偏移不大于 offset 的最后一个检查点
+     * @param offset 解压后的偏移
+     * @param checkpoint 输出检查点
+     * @return 是否找到
+     */
+    bool findCheckpoint(uint64_t offset, GzipCheckpoint& checkpoint) const;
+
+    /**
+     * 载入索引缓存（需持有锁）
+     * @return 是否载入（缓存不存在或与文件不一致时返回 false）
+     */
+    bool loadIndex();
+
+    /**
+     * 写入索引缓存
+     * @return 是否成功
+     */
+    bool saveIndex() const;
+
+    /**
+     * 停止后台线程
+     */
+    void stopWorker();
+};
+
+#endif // GZIP_READER_H
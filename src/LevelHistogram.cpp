@@ -0,0 +1,301 @@
+#include "LevelHistogram.h"
+#include "Editor.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 追加超过此大小时改为在后台重新扫描
+const size_t kRescanThreshold = 1 << 20;
+
+// 归类时每段的字节数（每段需要记录段内各行的起始位置和级别）
+const size_t kSegmentSize = 4 << 20;
+
+// 默认关键字
+const char* const kDefaultKeywords[kLogLevelCount] = {"ERROR,FATAL,CRITICAL,SEVERE", "WARN,WARNING",
+                                                      "INFO,NOTICE", "DEBUG,TRACE,FINE"};
+
+}  // namespace
+
+void LevelHistogram::Histogram::add(size_t line, size_t level, int delta) {
+    size_t bucket = line / linesPerBucket;
+    while (bucket >= maxBuckets) {
+        // 相邻两个桶合并，每桶行数加倍
+        size_t merged = (buckets.size() + 1) / 2;
+        for (size_t i = 0; i < merged; i++) {
+            LevelBucket sum = buckets[2 * i];
+            if (2 * i + 1 < buckets.size()) {
+                for (size_t j = 0; j < kLogLevelCount; j++) {
+                    sum.counts[j] += buckets[2 * i + 1].counts[j];
+                }
+            }
+            buckets[i] = sum;
+        }
+        buckets.resize(merged);
+        linesPerBucket *= 2;
+        bucket = line / linesPerBucket;
+    }
+    if (bucket >= buckets.size()) {
+        buckets.resize(bucket + 1, LevelBucket{{0, 0, 0, 0}});
+    }
+    buckets[bucket].counts[level] += delta;
+    totals[level] += delta;
+}
+
+LevelHistogram::LevelHistogram(size_t maxBuckets)
+    : maxBuckets_(std::max<size_t>(maxBuckets, 2)), editListenerId_(0), generation_(0), complete_(true),
+      lastLine_(0), lastLineStart_(0), lastLevel_(-1), cancelled_(false), busy_(false), stopWorker_(false),
+      hasResult_(false), resultGeneration_(0) {
+    histogram_ = Histogram{{}, 1, maxBuckets_, {0, 0, 0, 0}};
+    for (size_t i = 0; i < kLogLevelCount; i++) {
+        keywords_[i] = kDefaultKeywords[i];
+    }
+    worker_ = std::thread(&LevelHistogram::workerLoop, this);
+}
+
+LevelHistogram::~LevelHistogram() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+        cancelled_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void LevelHistogram::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    startScan();
+}
+
+void LevelHistogram::setKeywords(LogLevel level, const std::string& keywords) {
+    keywords_[static_cast<size_t>(level)] = keywords;
+    startScan();
+}
+
+bool LevelHistogram::collect() {
+    std::unique_ptr<Result> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hasResult_) {
+            return false;
+        }
+        hasResult_ = false;
+        if (resultGeneration_ != generation_) {
+            return false;
+        }
+        result = std::move(result_);
+    }
+    histogram_ = result->histogram;
+    lastLine_ = result->lastLine;
+    lastLineStart_ = result->lastLineStart;
+    lastLevel_ = result->lastLevel;
+    complete_ = true;
+    // 扫描期间只可能有追加（其他编辑会重新提交扫描），补上快照之后追加的内容
+    if (editor_ && editor_->getContentView().size() > result->scannedLength) {
+        classifyTail();
+    }
+    return true;
+}
+
+void LevelHistogram::waitForIdle() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCondition_.wait(lock, [this]() { return !pendingJob_ && !busy_; });
+    }
+    collect();
+}
+
+bool LevelHistogram::isComplete() const {
+    return complete_;
+}
+
+size_t LevelHistogram::getBucketCount() const {
+    return complete_ ? histogram_.buckets.size() : 0;
+}
+
+size_t LevelHistogram::getLinesPerBucket() const {
+    return histogram_.linesPerBucket;
+}
+
+const LevelBucket& LevelHistogram::getBucket(size_t index) const {
+    return histogram_.buckets[index];
+}
+
+size_t LevelHistogram::getTotal(LogLevel level) const {
+    return complete_ ? static_cast<size_t>(histogram_.totals[static_cast<size_t>(level)]) : 0;
+}
+
+void LevelHistogram::setHistogramReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    histogramReadyCallback_ = callback;
+}
+
+void LevelHistogram::startScan() {
+    auto compiled = std::make_shared<KeywordSet>();
+    for (size_t level = 0; level < kLogLevelCount; level++) {
+        const std::string& list = keywords_[level];
+        for (size_t start = 0; start <= list.size();) {
+            size_t end = std::min(list.find(',', start), list.size());
+            size_t first = list.find_first_not_of(' ', start);
+            if (first < end) {
+                size_t last = list.find_last_not_of(' ', end - 1);
+                compiled->searches[level].emplace_back(list.substr(first, last - first + 1), true, true);
+            }
+            start = end + 1;
+        }
+    }
+    compiled_ = compiled;
+
+    generation_++;
+    histogram_ = Histogram{{}, 1, maxBuckets_, {0, 0, 0, 0}};
+    lastLine_ = 0;
+    lastLineStart_ = 0;
+    lastLevel_ = -1;
+    complete_ = !editor_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    hasResult_ = false;
+    if (complete_) {
+        pendingJob_.reset();
+        return;
+    }
+    pendingJob_ = std::make_unique<Job>(
+        Job{compiled_, std::make_shared<const std::string>(editor_->getContentView()), generation_});
+    workCondition_.notify_one();
+}
+
+void LevelHistogram::handleEdit(const TextEdit& edit) {
+    bool append = edit.removedLength == 0 && edit.insertedLength <= kRescanThreshold &&
+                  edit.position + edit.insertedLength == editor_->getContentView().size();
+    if (!append) {
+        startScan();
+    } else if (complete_) {
+        classifyTail();
+    }
+}
+
+void LevelHistogram::classifyTail() {
+    // 原来的最后一行可能被追加的内容延长，先撤销它的计数再和新增的行一起重新归类
+    if (lastLevel_ >= 0) {
+        histogram_.add(lastLine_, static_cast<size_t>(lastLevel_), -1);
+    }
+    std::string_view text = editor_->getContentView();
+    lastLine_ = classify(*compiled_, text.data(), text.size(), lastLineStart_, lastLine_, histogram_, lastLineStart_,
+                         lastLevel_, nullptr);
+}
+
+void LevelHistogram::workerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCondition_.wait(lock, [this]() { return stopWorker_ || pendingJob_; });
+            if (stopWorker_) {
+                return;
+            }
+            job = std::move(pendingJob_);
+            cancelled_ = false;
+            busy_ = true;
+        }
+
+        auto result = std::make_unique<Result>();
+        result->histogram = Histogram{{}, 1, maxBuckets_, {0, 0, 0, 0}};
+        result->scannedLength = job->text->size();
+        result->lastLine = classify(*job->keywords, job->text->data(), job->text->size(), 0, 0, result->histogram,
+                                    result->lastLineStart, result->lastLevel, &cancelled_);
+        if (result->lastLine != std::string::npos) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                result_ = std::move(result);
+                resultGeneration_ = job->generation;
+                hasResult_ = true;
+            }
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (histogramReadyCallback_) {
+                histogramReadyCallback_();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        idleCondition_.notify_all();
+    }
+}
+
+size_t LevelHistogram::classify(const KeywordSet& keywords, const char* data, size_t length, size_t begin,
+                                size_t firstLine, Histogram& histogram, size_t& lastLineStart, int& lastLevel,
+                                const std::atomic<bool>* cancelled) {
+    std::vector<size_t> starts;
+    std::vector<int8_t> levels;
+    size_t line = firstLine;
+    size_t segmentBegin = begin;
+    while (true) {
+        if (cancelled && *cancelled) {
+            return std::string::npos;
+        }
+        // 段结束于换行之后；最后一段包括末尾换行之后的（可能为空的）行
+        size_t segmentEnd = length;
+        if (length - segmentBegin > kSegmentSize) {
+            const char* newline = static_cast<const char*>(
+                std::memchr(data + segmentBegin + kSegmentSize, '\n', length - segmentBegin - kSegmentSize));
+            segmentEnd = newline ? static_cast<size_t>(newline - data) + 1 : length;
+        }
+        starts.assign(1, segmentBegin);
+        for (size_t pos = segmentBegin; pos < segmentEnd;) {
+            const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', segmentEnd - pos));
+            if (!newline) {
+                break;
+            }
+            pos = static_cast<size_t>(newline - data) + 1;
+            if (pos < segmentEnd || segmentEnd == length) {
+                starts.push_back(pos);
+            }
+        }
+
+        // 从最严重的级别开始查找，已归类的行不再被较轻的级别覆盖；命中后直接跳到下一行
+        levels.assign(starts.size(), -1);
+        for (size_t level = 0; level < kLogLevelCount; level++) {
+            for (const TextSearch& search : keywords.searches[level]) {
+                size_t pos = segmentBegin;
+                while ((pos = search.find(data, segmentEnd, pos)) != std::string::npos) {
+                    size_t index = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), pos) -
+                                                       starts.begin()) - 1;
+                    if (levels[index] < 0) {
+                        levels[index] = static_cast<int8_t>(level);
+                    }
+                    if (index + 1 >= starts.size()) {
+                        break;
+                    }
+                    pos = starts[index + 1];
+                }
+            }
+        }
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (levels[i] >= 0) {
+                histogram.add(line + i, static_cast<size_t>(levels[i]), 1);
+            }
+        }
+
+        if (segmentEnd == length) {
+            lastLineStart = starts.back();
+            lastLevel = levels.back();
+            return line + starts.size() - 1;
+        }
+        line += starts.size();
+        segmentBegin = segmentEnd;
+    }
+}
@@ -0,0 +1,231 @@
+#ifndef LEVEL_HISTOGRAM_H
+#define LEVEL_HISTOGRAM_H
+
+#include "TextSearch.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 日志级别（按严重程度从高到低，一行出现多个级别时取最严重的）
+ */
+enum class LogLevel { Error, Warn, Info, Debug };
+
+const size_t kLogLevelCount = 4;
+
+/**
+ * 一个分桶内各级别的行数
+ */
+struct LevelBucket {
+    uint32_t counts[kLogLevelCount];
+};
+
+/**
+ * 日志级别分布（概览条）
+ * 在后台线程中用 SIMD 查找内核逐个查找各级别的关键字（全字匹配），按行归类后累加到按行号划分的分桶中。
+ * 分桶数有上限，行数超过 分桶数 × 每桶行数 时把相邻两个桶合并、每桶行数加倍，
+ * 因此内存只与分桶数有关，与文档大小无关。
+ *
+ * 跟随模式下追加到末尾的内容在界面线程中直接归类（只涉及新增的行和原来的最后一行）；
+ * 其他编辑无法只靠分桶撤销，改为在后台重新扫描
+ */
+class LevelHistogram {
+public:
+    /**
+     * 构造函数
+     * @param maxBuckets 分桶数上限（至少为 2）
+     */
+    explicit LevelHistogram(size_t maxBuckets = 512);
+    ~LevelHistogram();
+
+    LevelHistogram(const LevelHistogram&) = delete;
+    LevelHistogram& operator=(const LevelHistogram&) = delete;
+
+    /**
+     * 设置编辑器实例，订阅其范围编辑并开始扫描
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 设置一个级别的关键字并重新扫描
+     * @param level 级别
+     * @param keywords 逗号分隔的关键字（区分大小写，全字匹配），为空时不统计该级别
+     */
+    void setKeywords(LogLevel level, const std::string& keywords);
+
+    /**
+     * 取走后台扫描的结果（在界面线程中调用，通常在收到更新回调之后）
+     * @return 是否有新结果
+     */
+    bool collect();
+
+    /**
+     * 等待后台扫描结束并取走结果
+     */
+    void waitForIdle();
+
+    /**
+     * 结果是否已反映当前文档
+     * @return 是否完成
+     */
+    bool isComplete() const;
+
+    /**
+     * 获取已使用的分桶数
+     * @return 分桶数（扫描完成前为 0）
+     */
+    size_t getBucketCount() const;
+
+    /**
+     * 获取每个分桶包含的行数
+     * @return 行数（2 的幂）
+     */
+    size_t getLinesPerBucket() const;
+
+    /**
+     * 获取分桶
+     * @param index 下标，第 index 个分桶包含行 [index × 每桶行数, (index + 1) × 每桶行数)
+     * @return 分桶
+     */
+    const LevelBucket& getBucket(size_t index) const;
+
+    /**
+     * 获取某个级别的总行数
+     * @param level 级别
+     * @return 行数
+     */
+    size_t getTotal(LogLevel level) const;
+
+    /**
+     * 设置扫描结果送达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setHistogramReadyCallback(std::function<void()> callback);
+
+private:
+    /**
+     * 编译后的关键字，按级别分组
+     */
+    struct KeywordSet {
+        std::vector<TextSearch> searches[kLogLevelCount];
+    };
+
+    /**
+     * 分桶统计
+     */
+    struct Histogram {
+        std::vector<LevelBucket> buckets;
+        size_t linesPerBucket;
+        size_t maxBuckets;
+        uint64_t totals[kLogLevelCount];
+
+        /**
+         * 在一行上增加或减少一个级别的计数
+         * @param line 行号
+         * @param level 级别下标
+         * @param delta 增量（+1 或 -1）
+         */
+        void add(size_t line, size_t level, int delta);
+    };
+
+    /**
+     * 提交给后台线程的扫描任务
+     */
+    struct Job {
+        std::shared_ptr<const KeywordSet> keywords;
+        std::shared_ptr<const std::string> text;
+        uint64_t generation;
+    };
+
+    /**
+     * 扫描结果
+     */
+    struct Result {
+        Histogram histogram;
+        size_t scannedLength;  // 扫描的快照长度
+        size_t lastLine;       // 快照最后一行的行号
+        size_t lastLineStart;  // 快照最后一行的起始偏移
+        int lastLevel;         // 快照最后一行的级别，没有级别时为 -1
+    };
+
+    size_t maxBuckets_;  // 分桶数上限（构造后不变，后台线程也会读取）
+
+    // 界面线程状态
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    std::string keywords_[kLogLevelCount];
+    std::shared_ptr<const KeywordSet> compiled_;
+    uint64_t generation_;
+    bool complete_;
+    Histogram histogram_;
+    size_t lastLine_;       // 最后一行的行号（追加时会变长，需要重新归类）
+    size_t lastLineStart_;  // 最后一行的起始偏移
+    int lastLevel_;         // 最后一行已计入的级别
+
+    // 线程间共享状态
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    std::unique_ptr<Job> pendingJob_;
+    std::atomic<bool> cancelled_;
+    bool busy_;
+    bool stopWorker_;
+    bool hasResult_;
+    uint64_t resultGeneration_;
+    std::unique_ptr<Result> result_;
+    std::mutex callbackMutex_;
+    std::function<void()> histogramReadyCallback_;
+    std::thread worker_;
+
+    /**
+     * 清空统计并对文档快照提交一次后台扫描
+     */
+    void startScan();
+
+    /**
+     * 处理范围编辑：追加到末尾时直接归类新增的行，其他编辑重新扫描
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 重新归类最后一行及之后追加的内容
+     */
+    void classifyTail();
+
+    /**
+     * 后台线程主循环
+     */
+    void workerLoop();
+
+    /**
+     * 归类 [begin, length) 内的各行并累加到统计中（按段处理，额外内存与段大小有关）
+     * @param keywords 关键字
+     * @param data 内容
+     * @param length 内容长度
+     * @param begin 起始偏移，必须是行首
+     * @param firstLine begin 所在行的行号
+     * @param histogram 统计
+     * @param lastLineStart 输出最后一行的起始偏移
+     * @param lastLevel 输出最后一行的级别
+     * @param cancelled 取消标志，可为空
+     * @return 最后一行的行号，被取消时返回 npos
+     */
+    static size_t classify(const KeywordSet& keywords, const char* data, size_t length, size_t begin,
+                           size_t firstLine, Histogram& histogram, size_t& lastLineStart, int& lastLevel,
+                           const std::atomic<bool>* cancelled);
+};
+
+#endif // LEVEL_HISTOGRAM_H
@@ -0,0 +1,350 @@
+#include "LineFilter.h"
+#include "Editor.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 插入超过此大小（如打开文件、整体替换）时改为在后台重新扫描
+const size_t kRescanThreshold = 1 << 20;
+
+// 并行扫描时每段的最小字节数
+const size_t kMinChunkSize = 1 << 20;
+
+}  // namespace
+
+LineFilter::LineFilter()
+    : editListenerId_(0), generation_(0), complete_(true), damaged_(false), damageFirst_(0), damageLast_(0),
+      cancelled_(false), busy_(false), stopWorker_(false), hasResult_(false), resultGeneration_(0) {
+    worker_ = std::thread(&LineFilter::workerLoop, this);
+}
+
+LineFilter::~LineFilter() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+        cancelled_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void LineFilter::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    startScan();
+}
+
+bool LineFilter::addRule(const LineFilterRule& rule) {
+    SearchPattern pattern;
+    if (rule.pattern.empty() || !pattern.compile(rule.pattern, rule.caseSensitive, rule.regex)) {
+        return false;
+    }
+    rules_.push_back(rule);
+    startScan();
+    return true;
+}
+
+void LineFilter::removeLastRule() {
+    if (!rules_.empty()) {
+        rules_.pop_back();
+        startScan();
+    }
+}
+
+void LineFilter::clearRules() {
+    rules_.clear();
+    startScan();
+}
+
+const std::vector<LineFilterRule>& LineFilter::getRules() const {
+    return rules_;
+}
+
+bool LineFilter::collect() {
+    std::vector<size_t> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hasResult_) {
+            return false;
+        }
+        hasResult_ = false;
+        if (resultGeneration_ != generation_) {
+            return false;
+        }
+        result.swap(result_);
+    }
+    // 结果对应提交时的快照，补上扫描期间的编辑
+    lines_.swap(result);
+    for (const TextEdit& edit : pendingEdits_) {
+        shiftLines(edit);
+    }
+    pendingEdits_.clear();
+    repairDamage();
+    complete_ = true;
+    return true;
+}
+
+void LineFilter::waitForIdle() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCondition_.wait(lock, [this]() { return !pendingJob_ && !busy_; });
+    }
+    collect();
+}
+
+bool LineFilter::isComplete() const {
+    return complete_;
+}
+
+size_t LineFilter::getMatchCount() const {
+    return complete_ ? lines_.size() : 0;
+}
+
+size_t LineFilter::getMatchedLine(size_t index) const {
+    return lines_[index];
+}
+
+size_t LineFilter::findIndex(size_t line) const {
+    if (!complete_) {
+        return 0;
+    }
+    return static_cast<size_t>(std::lower_bound(lines_.begin(), lines_.end(), line) - lines_.begin());
+}
+
+void LineFilter::setLinesReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    linesReadyCallback_ = callback;
+}
+
+void LineFilter::startScan() {
+    auto compiled = std::make_shared<RuleList>();
+    for (const LineFilterRule& rule : rules_) {
+        compiled->push_back(CompiledRule{SearchPattern(), rule.exclude});
+        compiled->back().pattern.compile(rule.pattern, rule.caseSensitive, rule.regex);
+    }
+    compiled_ = rules_.empty() ? nullptr : compiled;
+
+    generation_++;
+    lines_.clear();
+    pendingEdits_.clear();
+    damaged_ = false;
+    complete_ = !compiled_ || !editor_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    hasResult_ = false;
+    if (complete_) {
+        pendingJob_.reset();
+        return;
+    }
+    pendingJob_ = std::make_unique<Job>(
+        Job{compiled_, std::make_shared<const std::string>(editor_->getContentView()), generation_});
+    workCondition_.notify_one();
+}
+
+void LineFilter::handleEdit(const TextEdit& edit) {
+    if (!compiled_) {
+        return;
+    }
+    // 删除只需平移行号（保留上限丢弃开头的大段内容也是如此），只有插入的内容需要重新判断
+    if (edit.insertedLength > kRescanThreshold) {
+        startScan();
+        return;
+    }
+    if (!complete_) {
+        pendingEdits_.push_back(edit);
+        return;
+    }
+    shiftLines(edit);
+    repairDamage();
+}
+
+void LineFilter::shiftLines(const TextEdit& edit) {
+    size_t first = edit.startLine;
+    size_t removedLast = first + edit.removedLineBreaks;
+    size_t insertedLast = first + edit.insertedLineBreaks;
+
+    // 编辑涉及的行（首行到删除区间的末行）的结果直接删除，之后的行号整体平移
+    auto begin = std::lower_bound(lines_.begin(), lines_.end(), first);
+    auto end = std::upper_bound(begin, lines_.end(), removedLast);
+    begin = lines_.erase(begin, end);
+    for (auto it = begin; it != lines_.end(); ++it) {
+        *it = *it - edit.removedLineBreaks + edit.insertedLineBreaks;
+    }
+
+    if (damaged_) {
+        damageFirst_ = damageFirst_ <= first ? damageFirst_
+                       : damageFirst_ > removedLast ? damageFirst_ - edit.removedLineBreaks + edit.insertedLineBreaks
+                                                    : first;
+        damageLast_ = damageLast_ < first ? damageLast_
+                      : damageLast_ > removedLast ? damageLast_ - edit.removedLineBreaks + edit.insertedLineBreaks
+                                                  : insertedLast;
+        damageFirst_ = std::min(damageFirst_, first);
+        damageLast_ = std::max(damageLast_, insertedLast);
+    } else {
+        damageFirst_ = first;
+        damageLast_ = insertedLast;
+        damaged_ = true;
+    }
+}
+
+void LineFilter::repairDamage() {
+    if (!damaged_ || !editor_ || !compiled_) {
+        return;
+    }
+    damaged_ = false;
+    std::string_view text = editor_->getContentView();
+    const LineIndex& index = editor_->getLineIndex();
+    size_t lineCount = index.getLineCount();
+    size_t first = std::min(damageFirst_, lineCount - 1);
+    size_t last = std::min(damageLast_, lineCount - 1);
+    size_t begin = index.getLineStart(first);
+    size_t end = last + 1 < lineCount ? index.getLineStart(last + 1) : text.size();
+
+    std::vector<size_t> found;
+    evaluate(*compiled_, text.data(), text.size(), begin, end, first, found);
+    auto from = std::lower_bound(lines_.begin(), lines_.end(), first);
+    auto to = std::upper_bound(from, lines_.end(), last);
+    from = lines_.erase(from, to);
+    lines_.insert(from, found.begin(), found.end());
+}
+
+void LineFilter::workerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCondition_.wait(lock, [this]() { return stopWorker_ || pendingJob_; });
+            if (stopWorker_) {
+                return;
+            }
+            job = std::move(pendingJob_);
+            cancelled_ = false;
+            busy_ = true;
+        }
+
+        std::vector<size_t> lines;
+        if (scan(*job->rules, *job->text, lines)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                result_.swap(lines);
+                resultGeneration_ = job->generation;
+                hasResult_ = true;
+            }
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (linesReadyCallback_) {
+                linesReadyCallback_();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        idleCondition_.notify_all();
+    }
+}
+
+bool LineFilter::scan(const RuleList& rules, const std::string& text, std::vector<size_t>& lines) {
+    // 按换行切段：每段结束于换行之后，段内的行号从 0 开始，汇总时再加上前面各段的行数
+    const char* data = text.data();
+    size_t length = text.size();
+    size_t chunkSize = std::max(kMinChunkSize, length / (pool_.getThreadCount() * 4) + 1);
+    std::vector<size_t> boundaries{0};
+    while (boundaries.back() < length) {
+        size_t boundary = std::min(length, boundaries.back() + chunkSize);
+        if (boundary < length) {
+            const char* newline = static_cast<const char*>(std::memchr(data + boundary, '\n', length - boundary));
+            boundary = newline ? static_cast<size_t>(newline - data) + 1 : length;
+        }
+        boundaries.push_back(boundary);
+    }
+    if (boundaries.size() == 1) {
+        boundaries.push_back(0);  // 空文档也有一行
+    }
+
+    size_t chunkCount = boundaries.size() - 1;
+    std::vector<std::vector<size_t>> chunkLines(chunkCount);
+    std::vector<size_t> chunkLineCounts(chunkCount, 0);
+    for (size_t i = 0; i < chunkCount; i++) {
+        pool_.submit([&, i]() {
+            if (!cancelled_) {
+                chunkLineCounts[i] =
+                    evaluate(rules, data, length, boundaries[i], boundaries[i + 1], 0, chunkLines[i]);
+            }
+        });
+    }
+    pool_.wait();
+    if (cancelled_) {
+        return false;
+    }
+
+    size_t firstLine = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        for (size_t line : chunkLines[i]) {
+            lines.push_back(firstLine + line);
+        }
+        firstLine += chunkLineCounts[i];
+    }
+    return true;
+}
+
+size_t LineFilter::evaluate(const RuleList& rules, const char* data, size_t length, size_t begin, size_t end,
+                            size_t firstLine, std::vector<size_t>& lines) {
+    // 收集范围内各行的起始位置；范围在文档末尾结束时，最后一个换行之后的（可能为空的）行也属于本范围
+    std::vector<size_t> starts{begin};
+    for (size_t pos = begin; pos < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', end - pos));
+        if (!newline) {
+            break;
+        }
+        pos = static_cast<size_t>(newline - data) + 1;
+        if (pos < end || end == length) {
+            starts.push_back(pos);
+        }
+    }
+
+    // 每个条件在整段上查找，命中后直接跳到下一行，不逐行调用查找
+    size_t includeRules = 0;
+    std::vector<uint16_t> includeHits(starts.size(), 0);
+    std::vector<uint8_t> excluded(starts.size(), 0);
+    for (const CompiledRule& rule : rules) {
+        includeRules += rule.exclude ? 0 : 1;
+        size_t from = begin;
+        size_t matchStart = 0;
+        size_t matchLength = 0;
+        while (from <= end && rule.pattern.findNext(data, end, from, matchStart, matchLength)) {
+            if (matchStart == end && end < length) {
+                break;  // 空匹配落在下一段的行首
+            }
+            size_t line = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), matchStart) -
+                                              starts.begin()) - 1;
+            if (rule.exclude) {
+                excluded[line] = 1;
+            } else {
+                includeHits[line]++;
+            }
+            if (line + 1 >= starts.size()) {
+                break;
+            }
+            from = starts[line + 1];
+        }
+    }
+
+    for (size_t i = 0; i < starts.size(); i++) {
+        if (includeHits[i] == includeRules && !excluded[i]) {
+            lines.push_back(firstLine + i);
+        }
+    }
+    return starts.size();
+}
@@ -0,0 +1,220 @@
+#ifndef LINE_FILTER_H
+#define LINE_FILTER_H
+
+#include "SearchPattern.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 行过滤条件
+ */
+struct LineFilterRule {
+    std::string pattern;  // 查找文本或正则表达式
+    bool caseSensitive;   // 是否区分大小写
+    bool regex;           // 是否为正则表达式
+    bool exclude;         // 为 true 时去掉匹配的行，否则只保留匹配的行
+};
+
+/**
+ * 行过滤索引（grep 视图）
+ * 多个条件依次叠加：一行必须匹配所有保留条件，且不匹配任何排除条件。
+ * 结果是按顺序排列的行号，过滤视图按下标取行号再从编辑器中取行文本，不复制内容。
+ *
+ * 设置条件后在后台线程中对文档快照扫描：按换行把文档切成多段，在线程池中并行求出各段内的匹配行，
+ * 再按各段的行数依次换算为全局行号。之后每次编辑只平移受影响行之后的行号，并重新判断编辑涉及的行，
+ * 跟随模式下追加到末尾的内容因此只判断新增的行；扫描期间发生的编辑在结果送达时依次补上
+ */
+class LineFilter {
+public:
+    LineFilter();
+    ~LineFilter();
+
+    LineFilter(const LineFilter&) = delete;
+    LineFilter& operator=(const LineFilter&) = delete;
+
+    /**
+     * 设置编辑器实例，订阅其范围编辑
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 叠加一个条件并重新扫描
+     * @param rule 条件
+     * @return 是否成功（查找文本为空或正则表达式语法错误时返回 false，条件不变）
+     */
+    bool addRule(const LineFilterRule& rule);
+
+    /**
+     * 去掉最后一个条件并重新扫描
+     */
+    void removeLastRule();
+
+    /**
+     * 去掉全部条件
+     */
+    void clearRules();
+
+    /**
+     * 获取当前条件
+     * @return 条件列表
+     */
+    const std::vector<LineFilterRule>& getRules() const;
+
+    /**
+     * 取走后台扫描的结果（在界面线程中调用，通常在收到更新回调之后）
+     * @return 是否有新结果
+     */
+    bool collect();
+
+    /**
+     * 等待后台扫描结束并取走结果
+     */
+    void waitForIdle();
+
+    /**
+     * 结果是否已反映当前文档
+     * @return 扫描完成（或没有条件）时返回 true
+     */
+    bool isComplete() const;
+
+    /**
+     * 获取匹配的行数
+     * @return 行数（扫描完成前为 0）
+     */
+    size_t getMatchCount() const;
+
+    /**
+     * 获取第 index 个匹配行的行号
+     * @param index 下标
+     * @return 行号（从0开始）
+     */
+    size_t getMatchedLine(size_t index) const;
+
+    /**
+     * 查找行号不小于 line 的第一个匹配行
+     * @param line 行号
+     * @return 下标，不存在时返回匹配行数
+     */
+    size_t findIndex(size_t line) const;
+
+    /**
+     * 设置扫描结果送达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setLinesReadyCallback(std::function<void()> callback);
+
+private:
+    /**
+     * 编译后的条件
+     */
+    struct CompiledRule {
+        SearchPattern pattern;
+        bool exclude;
+    };
+
+    using RuleList = std::vector<CompiledRule>;
+
+    /**
+     * 提交给后台线程的扫描任务
+     */
+    struct Job {
+        std::shared_ptr<const RuleList> rules;
+        std::shared_ptr<const std::string> text;
+        uint64_t generation;
+    };
+
+    // 界面线程状态
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    std::vector<LineFilterRule> rules_;
+    std::shared_ptr<const RuleList> compiled_;
+    uint64_t generation_;
+    bool complete_;
+    std::vector<size_t> lines_;            // 匹配行的行号（递增）
+    std::vector<TextEdit> pendingEdits_;  // 扫描期间的编辑，结果送达后补上
+    bool damaged_;                        // 以下行范围（含两端）尚未重新判断
+    size_t damageFirst_;
+    size_t damageLast_;
+
+    // 线程间共享状态
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    std::unique_ptr<Job> pendingJob_;
+    std::atomic<bool> cancelled_;  // 取消正在进行的扫描
+    bool busy_;
+    bool stopWorker_;
+    bool hasResult_;
+    uint64_t resultGeneration_;
+    std::vector<size_t> result_;
+    std::mutex callbackMutex_;
+    std::function<void()> linesReadyCallback_;
+    ThreadPool pool_;
+    std::thread worker_;
+
+    /**
+     * 按当前条件重新编译，清空结果并对文档快照提交一次后台扫描
+     */
+    void startScan();
+
+    /**
+     * 处理范围编辑（插入过多内容时改为重新扫描）
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 按编辑平移行号，删除被编辑行的结果，并把编辑涉及的行并入待重新判断的范围
+     * @param edit 编辑描述
+     */
+    void shiftLines(const TextEdit& edit);
+
+    /**
+     * 在当前内容上重新判断待重新判断的行
+     */
+    void repairDamage();
+
+    /**
+     * 后台线程主循环
+     */
+    void workerLoop();
+
+    /**
+     * 并行扫描整段内容
+     * @param rules 条件
+     * @param text 内容
+     * @param lines 输出匹配行的行号
+     * @return 是否完整扫描（被取消时返回 false）
+     */
+    bool scan(const RuleList& rules, const std::string& text, std::vector<size_t>& lines);
+
+    /**
+     * 判断起始位置在 [begin, end) 内的各行（end 为文档长度时包括末尾的空行）
+     * @param rules 条件
+     * @param data 内容
+     * @param length 内容长度
+     * @param begin 起始偏移，必须是行首
+     * @param end 结束偏移，必须是行首或文档长度
+     * @param firstLine begin 所在行的行号
+     * @param lines 追加匹配行的行号
+     * @return 起始位置在范围内的行数
+     */
+    static size_t evaluate(const RuleList& rules, const char* data, size_t length, size_t begin, size_t end,
+                           size_t firstLine, std::vector<size_t>& lines);
+};
+
+#endif // LINE_FILTER_H
@@ -0,0 +1,118 @@
+#include "LineIndex.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// memchr 在主流 C 库中已经向量化，逐个定位换行符即可
+template <typename Visitor>
+void forEachLineBreak(const char* data, size_t length, Visitor visit) {
+    const char* cursor = data;
+    const char* end = data + length;
+    while (cursor < end) {
+        const void* hit = std::memchr(cursor, '\n', static_cast<size_t>(end - cursor));
+        if (!hit) {
+            break;
+        }
+        const char* newline = static_cast<const char*>(hit);
+        visit(static_cast<size_t>(newline - data));
+        cursor = newline + 1;
+    }
+}
+
+}  // namespace
+
+LineIndex::LineIndex() : lineStarts_(1, 0), first_(0), base_(0), length_(0) {}
+
+void LineIndex::rebuild(const char* data, size_t length) {
+    lineStarts_.assign(1, 0);
+    first_ = 0;
+    base_ = 0;
+    length_ = length;
+    forEachLineBreak(data, length, [this](size_t offset) { lineStarts_.push_back(offset + 1); });
+}
+
+void LineIndex::applyEdit(size_t position, size_t removedLength, const char* insertedData, size_t insertedLength) {
+    position = std::min(position, length_);
+    removedLength = std::min(removedLength, length_ - position);
+
+    // 删除起始于被替换区间内的行（在记录坐标中比较）
+    size_t stored = position + base_;
+    auto first = std::upper_bound(lineStarts_.begin() + first_, lineStarts_.end(), stored);
+    auto last = std::upper_bound(first, lineStarts_.end(), stored + removedLength);
+
+    std::vector<size_t> inserted;
+    forEachLineBreak(insertedData, insertedLength,
+                     [&inserted, stored](size_t offset) { inserted.push_back(stored + offset + 1); });
+
+    // 后续行整体平移
+    for (auto it = last; it != lineStarts_.end(); ++it) {
+        *it = *it - removedLength + insertedLength;
+    }
+
+    size_t firstIndex = static_cast<size_t>(first - lineStarts_.begin());
+    size_t lastIndex = static_cast<size_t>(last - lineStarts_.begin());
+    size_t removedCount = lastIndex - firstIndex;
+    size_t common = std::min(removedCount, inserted.size());
+
+    std::copy(inserted.begin(), inserted.begin() + common, lineStarts_.begin() + firstIndex);
+    if (removedCount > common) {
+        lineStarts_.erase(lineStarts_.begin() + firstIndex + common, lineStarts_.begin() + lastIndex);
+    } else if (inserted.size() > common) {
+        lineStarts_.insert(lineStarts_.begin() + lastIndex, inserted.begin() + common, inserted.end());
+    }
+
+    length_ = length_ - removedLength + insertedLength;
+}
+
+size_t LineIndex::dropFront(size_t length) {
+    length = std::min(length, length_);
+    // 截断位置所在的行成为新的第 0 行（不在行首时其剩余部分从 0 开始）
+    auto it = std::upper_bound(lineStarts_.begin() + first_, lineStarts_.end(), base_ + length);
+    size_t keep = static_cast<size_t>(it - lineStarts_.begin()) - 1;
+    size_t dropped = keep - first_;
+    first_ = keep;
+    base_ += length;
+    length_ -= length;
+    lineStarts_[first_] = base_;
+
+    if (first_ > lineStarts_.size() - first_) {
+        lineStarts_.erase(lineStarts_.begin(), lineStarts_.begin() + first_);
+        for (size_t& start : lineStarts_) {
+            start -= base_;
+        }
+        first_ = 0;
+        base_ = 0;
+    }
+    return dropped;
+}
+
+size_t LineIndex::getLineCount() const {
+    return lineStarts_.size() - first_;
+}
+
+size_t LineIndex::getLength() const {
+    return length_;
+}
+
+size_t LineIndex::getLineStart(size_t line) const {
+    return line < getLineCount() ? lineStarts_[first_ + line] - base_ : length_;
+}
+
+size_t LineIndex::getLineEnd(size_t line) const {
+    if (line + 1 < getLineCount()) {
+        return lineStarts_[first_ + line + 1] - base_ - 1;
+    }
+    return length_;
+}
+
+size_t LineIndex::getLineOfOffset(size_t offset) const {
+    auto it = std::upper_bound(lineStarts_.begin() + first_, lineStarts_.end(), offset + base_);
+    return static_cast<size_t>(it - lineStarts_.begin()) - first_ - 1;
+}
+
+size_t LineIndex::countLineBreaks(const char* data, size_t length) {
+    size_t count = 0;
+    forEachLineBreak(data, length, [&count](size_t) { ++count; });
+    return count;
+}
@@ -0,0 +1,90 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * 行索引
+ * 记录每一行起始偏移，支持按编辑范围增量更新
+ * 行号在本类中从 0 开始
+ *
+ * 丢弃开头若干行（日志保留上限）时不改写其余各行的记录：只移动首行下标并累加基准偏移，
+ * 已丢弃的记录超过有效记录数时才整体压缩一次，均摊为常数时间
+ */
+class LineIndex {
+public:
+    LineIndex();
+
+    /**
+     * 根据完整文本重建索引
+     * @param data 文本起始地址
+     * @param length 文本长度
+     */
+    void rebuild(const char* data, size_t length);
+
+    /**
+     * 应用一次范围编辑
+     * @param position 编辑起始偏移
+     * @param removedLength 被删除的字节数
+     * @param insertedData 插入文本起始地址
+     * @param insertedLength 插入的字节数
+     */
+    void applyEdit(size_t position, size_t removedLength, const char* insertedData, size_t insertedLength);
+
+    /**
+     * 丢弃开头的若干整行
+     * @param length 丢弃的字节数，通常是某一行的起始偏移（否则所在行的剩余部分成为第 0 行）
+     * @return 丢弃的完整行数
+     */
+    size_t dropFront(size_t length);
+
+    /**
+     * 获取行数（空文本也算一行）
+     * @return 行数
+     */
+    size_t getLineCount() const;
+
+    /**
+     * 获取文本总长度
+     * @return 字节数
+     */
+    size_t getLength() const;
+
+    /**
+     * 获取行起始偏移
+     * @param line 行号（从0开始）
+     * @return 起始偏移，行号越界时返回文本长度
+     */
+    size_t getLineStart(size_t line) const;
+
+    /**
+     * 获取行结束偏移（不含换行符）
+     * @param line 行号（从0开始）
+     * @return 结束偏移
+     */
+    size_t getLineEnd(size_t line) const;
+
+    /**
+     * 查找偏移所在的行
+     * @param offset 字节偏移
+     * @return 行号（从0开始）
+     */
+    size_t getLineOfOffset(size_t offset) const;
+
+    /**
+     * 统计一段文本中的换行符数量
+     * @param data 文本起始地址
+     * @param length 文本长度
+     * @return 换行符数量
+     */
+    static size_t countLineBreaks(const char* data, size_t length);
+
+private:
+    std::vector<size_t> lineStarts_;  // 从 first_ 开始有效，lineStarts_[first_] 恒为 base_
+    size_t first_;                    // 已丢弃的记录数
+    size_t base_;                     // 记录中的偏移减去 base_ 才是文本中的偏移
+    size_t length_;
+};
+
+#endif // LINE_INDEX_H
@@ -0,0 +1,280 @@
+#include "LogMerger.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+
+// 解析时间戳时每行读取的字节数
+const size_t kTimestampBytes = 256;
+
+// 没有时间戳的行最多向前沿用多少行，超出时视为没有时间
+const uint64_t kInheritLines = 1024;
+
+// 每个来源最多缓存的行时间数，超出时清空
+const size_t kMaxCachedTimes = 65536;
+
+}  // namespace
+
+bool LogMerger::Key::operator<(const Key& other) const {
+    if (time != other.time) {
+        return time < other.time;
+    }
+    if (source != other.source) {
+        return source < other.source;
+    }
+    return line < other.line;
+}
+
+bool LogMerger::Key::operator>(const Key& other) const {
+    return other < *this;
+}
+
+LogMerger::LogMerger(uint64_t stepLimit) : stepLimit_(stepLimit), anchorValid_(false), anchorRow_(0) {}
+
+LogMerger::~LogMerger() {
+    clear();
+}
+
+bool LogMerger::addSource(const std::string& path, size_t memoryLimit) {
+    Source source;
+    source.document = std::make_unique<PagedDocument>();
+    if (!source.document->open(path, memoryLimit)) {
+        return false;
+    }
+    std::string head;
+    source.document->read(0, 64 * 1024, head);
+    source.format = TimestampIndex::detectFormat(head.data(), head.size());
+    std::string last;
+    uint64_t size = source.document->getSize();
+    source.endsWithNewline = size == 0 || (source.document->read(size - 1, 1, last) && last == "\n");
+    if (indexProgressCallback_) {
+        source.document->setIndexProgressCallback(indexProgressCallback_);
+    }
+    sources_.push_back(std::move(source));
+    anchorValid_ = false;
+    return true;
+}
+
+void LogMerger::clear() {
+    for (Source& source : sources_) {
+        source.document->setIndexProgressCallback(nullptr);
+        source.document->close();
+    }
+    sources_.clear();
+    anchorValid_ = false;
+}
+
+size_t LogMerger::getSourceCount() const {
+    return sources_.size();
+}
+
+std::string LogMerger::getSourcePath(size_t source) const {
+    return source < sources_.size() ? sources_[source].document->getPath() : "";
+}
+
+TimestampFormat LogMerger::getSourceFormat(size_t source) const {
+    return source < sources_.size() ? sources_[source].format : TimestampFormat::None;
+}
+
+uint64_t LogMerger::getLineCount() const {
+    uint64_t count = 0;
+    for (size_t i = 0; i < sources_.size(); i++) {
+        count += sourceLineCount(i);
+    }
+    return count;
+}
+
+bool LogMerger::isIndexComplete() const {
+    return std::all_of(sources_.begin(), sources_.end(),
+                       [](const Source& source) { return source.document->isIndexComplete(); });
+}
+
+void LogMerger::waitForIndex() {
+    for (Source& source : sources_) {
+        source.document->waitForIndex();
+    }
+}
+
+bool LogMerger::getLines(uint64_t row, size_t count, std::vector<MergedLine>& lines, size_t maxBytes) {
+    lines.clear();
+    if (sources_.empty() || row >= getLineCount()) {
+        return false;
+    }
+
+    // 在上一次定位的位置附近时逐行移动，否则按时间二分
+    std::vector<uint64_t> cursors;
+    uint64_t distance = row >= anchorRow_ ? row - anchorRow_ : anchorRow_ - row;
+    if (!anchorValid_ || distance > stepLimit_) {
+        seek(row, cursors);
+    } else {
+        cursors = anchorCursors_;
+        if (step(cursors, distance, row >= anchorRow_, nullptr, 0) != distance) {
+            seek(row, cursors);
+        }
+    }
+    anchorValid_ = true;
+    anchorRow_ = std::accumulate(cursors.begin(), cursors.end(), uint64_t(0));
+    anchorCursors_ = cursors;
+
+    step(cursors, count, true, &lines, maxBytes);
+    return !lines.empty();
+}
+
+void LogMerger::setIndexProgressCallback(std::function<void()> callback) {
+    indexProgressCallback_ = callback;
+    for (Source& source : sources_) {
+        source.document->setIndexProgressCallback(callback);
+    }
+}
+
+uint64_t LogMerger::sourceLineCount(size_t source) const {
+    uint64_t count = sources_[source].document->getLineCount();
+    return sources_[source].endsWithNewline && count > 0 ? count - 1 : count;
+}
+
+bool LogMerger::lineTime(size_t source, uint64_t line, int64_t& time) {
+    if (line >= sourceLineCount(source)) {
+        return false;
+    }
+    Source& entry = sources_[source];
+    auto cached = entry.times.find(line);
+    if (cached != entry.times.end()) {
+        time = cached->second;
+        return true;
+    }
+
+    int64_t result = std::numeric_limits<int64_t>::min();
+    if (entry.format != TimestampFormat::None) {
+        std::string text;
+        for (uint64_t current = line;; current--) {
+            auto it = entry.times.find(current);
+            if (it != entry.times.end()) {
+                result = it->second;
+                break;
+            }
+            if (!entry.document->getLine(current, text, kTimestampBytes)) {
+                if (current == line) {
+                    return false;
+                }
+                break;
+            }
+            int64_t parsed = 0;
+            if (TimestampIndex::parseTimestamp(text.data(), text.size(), entry.format, parsed)) {
+                result = parsed;
+                break;
+            }
+            if (current == 0 || line - current >= kInheritLines) {
+                break;
+            }
+        }
+    }
+    if (entry.times.size() >= kMaxCachedTimes) {
+        entry.times.clear();
+    }
+    entry.times[line] = result;
+    time = result;
+    return true;
+}
+
+uint64_t LogMerger::lowerBound(size_t source, int64_t time) {
+    uint64_t low = 0;
+    uint64_t high = sourceLineCount(source);
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        int64_t middleTime = 0;
+        if (!lineTime(source, middle, middleTime)) {
+            high = middle;
+        } else if (middleTime < time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void LogMerger::seek(uint64_t row, std::vector<uint64_t>& cursors) {
+    auto countBefore = [this](int64_t time) {
+        uint64_t count = 0;
+        for (size_t i = 0; i < sources_.size(); i++) {
+            count += lowerBound(i, time);
+        }
+        return count;
+    };
+
+    // 最晚的时间 t：早于 t 的行数之和不超过 row（早于最小值的行数为 0）
+    int64_t low = std::numeric_limits<int64_t>::min();
+    int64_t high = std::numeric_limits<int64_t>::max();
+    while (low < high) {
+        uint64_t span = static_cast<uint64_t>(high) - static_cast<uint64_t>(low);
+        int64_t middle = static_cast<int64_t>(static_cast<uint64_t>(low) + span / 2 + 1);
+        if (countBefore(middle) <= row) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    // 时间为 t 的行按来源顺序排列，依次补齐
+    cursors.assign(sources_.size(), 0);
+    uint64_t remaining = row;
+    for (size_t i = 0; i < sources_.size(); i++) {
+        cursors[i] = lowerBound(i, low);
+        remaining -= std::min(remaining, cursors[i]);
+    }
+    for (size_t i = 0; i < sources_.size() && remaining > 0; i++) {
+        uint64_t end = low == std::numeric_limits<int64_t>::max() ? sourceLineCount(i) : lowerBound(i, low + 1);
+        uint64_t taken = std::min(remaining, end - cursors[i]);
+        cursors[i] += taken;
+        remaining -= taken;
+    }
+}
+
+uint64_t LogMerger::step(std::vector<uint64_t>& cursors, uint64_t steps, bool forward,
+                         std::vector<MergedLine>* lines, size_t maxBytes) {
+    uint64_t moved = 0;
+    int64_t time = 0;
+    if (forward) {
+        // 小顶堆：各来源的下一行
+        std::priority_queue<Key, std::vector<Key>, std::greater<Key>> heads;
+        for (size_t i = 0; i < sources_.size(); i++) {
+            if (lineTime(i, cursors[i], time)) {
+                heads.push({time, i, cursors[i]});
+            }
+        }
+        while (moved < steps && !heads.empty()) {
+            Key head = heads.top();
+            heads.pop();
+            if (lines) {
+                MergedLine line{head.source, head.line, std::string()};
+                sources_[head.source].document->getLine(head.line, line.text, maxBytes);
+                lines->push_back(std::move(line));
+            }
+            cursors[head.source]++;
+            moved++;
+            if (lineTime(head.source, cursors[head.source], time)) {
+                heads.push({time, head.source, cursors[head.source]});
+            }
+        }
+    } else {
+        // 大顶堆：各来源的上一行
+        std::priority_queue<Key> heads;
+        for (size_t i = 0; i < sources_.size(); i++) {
+            if (cursors[i] > 0 && lineTime(i, cursors[i] - 1, time)) {
+                heads.push({time, i, cursors[i] - 1});
+            }
+        }
+        while (moved < steps && !heads.empty()) {
+            Key head = heads.top();
+            heads.pop();
+            cursors[head.source]--;
+            moved++;
+            if (cursors[head.source] > 0 && lineTime(head.source, cursors[head.source] - 1, time)) {
+                heads.push({time, head.source, cursors[head.source] - 1});
+            }
+        }
+    }
+    return moved;
+}
@@ -0,0 +1,186 @@
+#ifndef LOG_MERGER_H
+#define LOG_MERGER_H
+
+#include "PagedDocument.h"
+#include "TimestampIndex.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 合并视图中的一行
+ */
+struct MergedLine {
+    size_t source;  // 来源序号
+    uint64_t line;  // 在来源中的行号（从0开始）
+    std::string text;
+};
+
+/**
+ * 按时间戳合并多个日志（只读）
+ * 每个来源用分页文档打开，合并结果不生成：合并视图中的位置用每个来源的游标（已合并的行数）表示，
+ * 行号是各游标之和。在上一次定位的位置附近移动时，用堆从各来源的当前行中逐行取最早（向前移动时取最晚）的一行；
+ * 距离较远时按时间二分：找到最晚的时间 t，使各来源中早于 t 的行数之和不超过目标行号，再按来源顺序补齐同一时刻的行。
+ * 两种方式使用同一个顺序：时间、来源序号、行号。
+ *
+ * 没有时间戳的行（堆栈、多行消息）沿用前面最近一行的时间戳，与它所属的日志行排在一起；
+ * 假定每个来源内部按时间顺序写入
+ */
+class LogMerger {
+public:
+    /**
+     * 构造函数
+     * @param stepLimit 与上一次定位的位置相距不超过此行数时逐行移动，否则按时间二分定位
+     */
+    explicit LogMerger(uint64_t stepLimit = 4096);
+    ~LogMerger();
+
+    LogMerger(const LogMerger&) = delete;
+    LogMerger& operator=(const LogMerger&) = delete;
+
+    /**
+     * 添加来源（以分页模式打开，开始在后台建立行索引）
+     * @param path 文件路径
+     * @param memoryLimit 该来源的块缓存和行索引内存上限（字节）
+     * @return 是否成功
+     */
+    bool addSource(const std::string& path, size_t memoryLimit);
+
+    /**
+     * 关闭全部来源
+     */
+    void clear();
+
+    /**
+     * 获取来源数量
+     * @return 来源数量
+     */
+    size_t getSourceCount() const;
+
+    /**
+     * 获取来源的文件路径
+     * @param source 来源序号
+     * @return 文件路径
+     */
+    std::string getSourcePath(size_t source) const;
+
+    /**
+     * 获取来源的时间戳格式
+     * @param source 来源序号
+     * @return 时间戳格式（未识别时该来源的行都排在最前）
+     */
+    TimestampFormat getSourceFormat(size_t source) const;
+
+    /**
+     * 获取合并后的行数（各来源的行数之和，不含文件末尾换行之后的空行）
+     * 行索引完整前是估算值
+     * @return 行数
+     */
+    uint64_t getLineCount() const;
+
+    /**
+     * 各来源的行索引是否都已完整
+     * @return 是否完整
+     */
+    bool isIndexComplete() const;
+
+    /**
+     * 等待各来源的行索引建立完成
+     */
+    void waitForIndex();
+
+    /**
+     * 读取合并视图中从指定行开始的若干行
+     * @param row 起始行号（从0开始）
+     * @param count 最多读取的行数
+     * @param lines 输出的行
+     * @param maxBytes 每行最多读取的字节数，超出的部分被截断
+     * @return 是否读到了行
+     */
+    bool getLines(uint64_t row, size_t count, std::vector<MergedLine>& lines, size_t maxBytes);
+
+    /**
+     * 设置索引进度回调（任一来源的扫描前进时调用，在后台线程中）
+     * @param callback 回调函数
+     */
+    void setIndexProgressCallback(std::function<void()> callback);
+
+private:
+    /**
+     * 来源
+     */
+    struct Source {
+        std::unique_ptr<PagedDocument> document;
+        TimestampFormat format;
+        bool endsWithNewline;                        // 文件以换行结尾，最后的空行不计入
+        std::unordered_map<uint64_t, int64_t> times;  // 已解析的行时间
+    };
+
+    /**
+     * 合并顺序的键：时间、来源序号、行号
+     */
+    struct Key {
+        int64_t time;
+        size_t source;
+        uint64_t line;
+
+        bool operator<(const Key& other) const;
+        bool operator>(const Key& other) const;
+    };
+
+    uint64_t stepLimit_;
+    std::vector<Source> sources_;
+    std::function<void()> indexProgressCallback_;
+    // 上一次定位的位置
+    bool anchorValid_;
+    uint64_t anchorRow_;
+    std::vector<uint64_t> anchorCursors_;
+
+    /**
+     * 获取来源的行数（不含末尾换行之后的空行）
+     * @param source 来源序号
+     * @return 行数
+     */
+    uint64_t sourceLineCount(size_t source) const;
+
+    /**
+     * 获取一行用于排序的时间（没有时间戳时向前沿用最近的时间戳）
+     * @param source 来源序号
+     * @param line 行号
+     * @param time 输出时间，前面都没有时间戳时为最小值
+     * @return 是否成功（行号超出来源时返回 false）
+     */
+    bool lineTime(size_t source, uint64_t line, int64_t& time);
+
+    /**
+     * 查找来源中第一个时间不早于 time 的行
+     * @param source 来源序号
+     * @param time 时间
+     * @return 行号（都更早时为行数）
+     */
+    uint64_t lowerBound(size_t source, int64_t time);
+
+    /**
+     * 按时间二分定位到合并视图中的行
+     * @param row 行号
+     * @param cursors 输出各来源的游标
+     */
+    void seek(uint64_t row, std::vector<uint64_t>& cursors);
+
+    /**
+     * 用堆从当前位置逐行移动
+     * @param cursors 各来源的游标（就地更新）
+     * @param steps 移动的行数
+     * @param forward 是否向后移动
+     * @param lines 向后移动时输出经过的行（为空指针时不输出）
+     * @param maxBytes 每行最多读取的字节数
+     * @return 实际移动的行数
+     */
+    uint64_t step(std::vector<uint64_t>& cursors, uint64_t steps, bool forward, std::vector<MergedLine>* lines,
+                  size_t maxBytes);
+};
+
+#endif // LOG_MERGER_H
@@ -0,0 +1,126 @@
+#include "LongLineIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/**
+ * 是否为 UTF-8 续字节
+ */
+inline bool isContinuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+}  // namespace
+
+LongLineIndex::LongLineIndex(size_t segmentBytes)
+    : segmentBytes_(std::max<size_t>(segmentBytes, 16)), length_(0), columnCount_(0) {}
+
+void LongLineIndex::clear() {
+    offsets_.clear();
+    columns_.clear();
+    length_ = 0;
+    columnCount_ = 0;
+}
+
+void LongLineIndex::append(const char* data, size_t length) {
+    size_t position = 0;
+    while (position < length) {
+        // 当前段已满时，新段从下一个字符的首字节开始
+        uint64_t segmentEnd = offsets_.empty() ? length_ : offsets_.back() + segmentBytes_;
+        if (length_ + position >= segmentEnd && !isContinuation(data[position])) {
+            offsets_.push_back(length_ + position);
+            columns_.push_back(columnCount_);
+            segmentEnd = offsets_.back() + segmentBytes_;
+        }
+        size_t end = static_cast<size_t>(std::min<uint64_t>(length, segmentEnd - length_));
+        if (end <= position) {
+            // 段已满但仍在字符中间，逐字节前进到下一个首字节
+            end = position + 1;
+        }
+        columnCount_ += countColumns(data + position, end - position);
+        position = end;
+    }
+    length_ += length;
+}
+
+uint64_t LongLineIndex::getLength() const {
+    return length_;
+}
+
+uint64_t LongLineIndex::getColumnCount() const {
+    return columnCount_;
+}
+
+size_t LongLineIndex::getSegmentCount() const {
+    return offsets_.size();
+}
+
+uint64_t LongLineIndex::getSegmentOffset(size_t index) const {
+    return offsets_[index];
+}
+
+uint64_t LongLineIndex::getSegmentColumn(size_t index) const {
+    return columns_[index];
+}
+
+size_t LongLineIndex::getSegmentLength(size_t index) const {
+    uint64_t end = index + 1 < offsets_.size() ? offsets_[index + 1] : length_;
+    return static_cast<size_t>(end - offsets_[index]);
+}
+
+size_t LongLineIndex::findSegmentByColumn(uint64_t column) const {
+    if (columns_.empty()) {
+        return 0;
+    }
+    // 列号相同的段（只有续字节时不会出现）取最后一个
+    auto it = std::upper_bound(columns_.begin(), columns_.end(), column);
+    return it == columns_.begin() ? 0 : static_cast<size_t>(it - columns_.begin()) - 1;
+}
+
+size_t LongLineIndex::findSegmentByOffset(uint64_t offset) const {
+    if (offsets_.empty()) {
+        return 0;
+    }
+    auto it = std::upper_bound(offsets_.begin(), offsets_.end(), offset);
+    return it == offsets_.begin() ? 0 : static_cast<size_t>(it - offsets_.begin()) - 1;
+}
+
+size_t LongLineIndex::skipColumns(const char* data, size_t length, uint64_t columns) {
+    size_t position = 0;
+    while (position < length) {
+        if (!isContinuation(data[position])) {
+            if (columns == 0) {
+                return position;
+            }
+            columns--;
+        }
+        position++;
+    }
+    return length;
+}
+
+uint64_t LongLineIndex::countColumns(const char* data, size_t length) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        count += isContinuation(data[i]) ? 0 : 1;
+    }
+    return count;
+}
+
+bool LongLineIndex::hasLineLongerThan(std::string_view data, uint64_t limit) {
+    const char* position = data.data();
+    const char* end = position + data.size();
+    while (position < end) {
+        const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        if (static_cast<uint64_t>((newline ? newline : end) - position) > limit) {
+            return true;
+        }
+        if (!newline) {
+            break;
+        }
+        position = newline + 1;
+    }
+    return false;
+}
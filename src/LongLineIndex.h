@@ -0,0 +1,124 @@
+#ifndef LONG_LINE_INDEX_H
+#define LONG_LINE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 超长行的分段索引（压缩后的 JSON、整段输出在一行里的日志）
+ * 把一行按字节数切成若干显示段（不切开 UTF-8 字符），每段记录起始字节偏移和起始列号（字符数），
+ * 显示时按水平滚动位置找到可见的段，只对这一段排版；列号与字节偏移之间的换算也先按段定位，
+ * 段内再逐字符计算，不必从行首数起。
+ *
+ * 内容可以分批追加，分页文档中的行不必整行读入内存
+ */
+class LongLineIndex {
+public:
+    /**
+     * 构造函数
+     * @param segmentBytes 每段的字节数（至少 16）
+     */
+    explicit LongLineIndex(size_t segmentBytes = 4096);
+
+    /**
+     * 清空索引
+     */
+    void clear();
+
+    /**
+     * 追加行的下一部分内容
+     * @param data 数据
+     * @param length 长度
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * 获取已索引的字节数
+     * @return 字节数
+     */
+    uint64_t getLength() const;
+
+    /**
+     * 获取已索引的列数（字符数）
+     * @return 列数
+     */
+    uint64_t getColumnCount() const;
+
+    /**
+     * 获取段数
+     * @return 段数（空行为 0）
+     */
+    size_t getSegmentCount() const;
+
+    /**
+     * 获取段的起始字节偏移
+     * @param index 段序号
+     * @return 相对行首的偏移
+     */
+    uint64_t getSegmentOffset(size_t index) const;
+
+    /**
+     * 获取段的起始列号
+     * @param index 段序号
+     * @return 列号（从0开始）
+     */
+    uint64_t getSegmentColumn(size_t index) const;
+
+    /**
+     * 获取段的字节数
+     * @param index 段序号
+     * @return 字节数
+     */
+    size_t getSegmentLength(size_t index) const;
+
+    /**
+     * 查找包含指定列的段
+     * @param column 列号（超出时返回最后一段）
+     * @return 段序号
+     */
+    size_t findSegmentByColumn(uint64_t column) const;
+
+    /**
+     * 查找包含指定字节偏移的段
+     * @param offset 相对行首的偏移（超出时返回最后一段）
+     * @return 段序号
+     */
+    size_t findSegmentByOffset(uint64_t offset) const;
+
+    /**
+     * 跳过若干个字符
+     * @param data 数据（从字符起始处开始）
+     * @param length 长度
+     * @param columns 跳过的字符数
+     * @return 跳过之后的字节偏移（不足时返回 length）
+     */
+    static size_t skipColumns(const char* data, size_t length, uint64_t columns);
+
+    /**
+     * 计算字符数
+     * @param data 数据
+     * @param length 长度
+     * @return 字符数（按 UTF-8 首字节计数）
+     */
+    static uint64_t countColumns(const char* data, size_t length);
+
+    /**
+     * 检查内容中是否有超过指定长度的行（文件读入后用来决定是否改用分页视图按段显示）
+     * @param data 内容
+     * @param limit 行长上限（字节）
+     * @return 是否有行超过上限
+     */
+    static bool hasLineLongerThan(std::string_view data, uint64_t limit);
+
+private:
+    size_t segmentBytes_;
+    std::vector<uint64_t> offsets_;  // 各段起始字节偏移
+    std::vector<uint64_t> columns_;  // 各段起始列号
+    uint64_t length_;
+    uint64_t columnCount_;
+};
+
+#endif // LONG_LINE_INDEX_H
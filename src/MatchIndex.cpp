@@ -0,0 +1,387 @@
+#include "MatchIndex.h"
+#include "Editor.h"
+#include "UnicodeText.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 后台扫描每处理这么多字节检查一次取消标志
+const size_t kScanChunk = 1 << 20;
+
+// 单次编辑超过此大小（如打开文件、整体替换）时改为在后台重新扫描
+const size_t kRescanThreshold = 1 << 20;
+
+bool startsBefore(const MatchSpan& span, size_t offset) {
+    return span.start < offset;
+}
+
+}  // namespace
+
+MatchIndex::MatchIndex()
+    : editListenerId_(0), generation_(0), complete_(true), damaged_(false), damageStart_(0), damageEnd_(0),
+      cancelled_(false), busy_(false), stopWorker_(false), hasResult_(false), resultGeneration_(0) {
+    worker_ = std::thread(&MatchIndex::workerLoop, this);
+}
+
+MatchIndex::~MatchIndex() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+        cancelled_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void MatchIndex::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    if (pattern_) {
+        startScan();
+    }
+}
+
+bool MatchIndex::setQuery(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord) {
+    auto compiled = std::make_shared<SearchPattern>();
+    bool valid = !pattern.empty() && compiled->compile(pattern, caseSensitive, regex, wholeWord);
+    // 上一次的结果完整且新查找文本只是追加了字符时，只验证旧匹配
+    std::shared_ptr<const std::vector<MatchSpan>> candidates;
+    if (valid && pattern_ && complete_ && canRefine(*pattern_, *compiled)) {
+        candidates = std::make_shared<const std::vector<MatchSpan>>(std::move(matches_));
+    }
+    pattern_ = valid ? compiled : nullptr;
+    startScan(candidates);
+    return valid || pattern.empty();
+}
+
+bool MatchIndex::collect() {
+    std::vector<MatchSpan> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hasResult_) {
+            return false;
+        }
+        hasResult_ = false;
+        if (resultGeneration_ != generation_) {
+            return false;
+        }
+        result.swap(result_);
+    }
+    // 结果对应提交时的快照，补上扫描期间的编辑
+    matches_.swap(result);
+    for (const TextEdit& edit : pendingEdits_) {
+        shiftMatches(edit);
+    }
+    pendingEdits_.clear();
+    repairDamage();
+    complete_ = true;
+    return true;
+}
+
+void MatchIndex::waitForIdle() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCondition_.wait(lock, [this]() { return !pendingJob_ && !busy_; });
+    }
+    collect();
+}
+
+bool MatchIndex::isComplete() const {
+    return complete_;
+}
+
+size_t MatchIndex::getMatchCount() const {
+    return complete_ ? matches_.size() : 0;
+}
+
+const MatchSpan& MatchIndex::getMatch(size_t index) const {
+    return matches_[index];
+}
+
+bool MatchIndex::findNext(size_t offset, size_t& index) const {
+    if (!complete_ || matches_.empty()) {
+        return false;
+    }
+    auto it = std::lower_bound(matches_.begin(), matches_.end(), offset, startsBefore);
+    index = it == matches_.end() ? 0 : static_cast<size_t>(it - matches_.begin());
+    return true;
+}
+
+bool MatchIndex::findPrevious(size_t offset, size_t& index) const {
+    if (!complete_ || matches_.empty()) {
+        return false;
+    }
+    auto it = std::lower_bound(matches_.begin(), matches_.end(), offset, startsBefore);
+    index = it == matches_.begin() ? matches_.size() - 1 : static_cast<size_t>(it - matches_.begin()) - 1;
+    return true;
+}
+
+std::vector<MatchSpan> MatchIndex::getMatchesInRange(size_t start, size_t end) const {
+    std::vector<MatchSpan> result;
+    if (!complete_) {
+        return result;
+    }
+    auto it = std::lower_bound(matches_.begin(), matches_.end(), start, startsBefore);
+    if (it != matches_.begin() && std::prev(it)->start + std::prev(it)->length > start) {
+        --it;
+    }
+    for (; it != matches_.end() && it->start < end; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+void MatchIndex::setMatchesReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    matchesReadyCallback_ = callback;
+}
+
+bool MatchIndex::scan(const SearchPattern& pattern, const char* data, size_t length, std::vector<MatchSpan>& matches,
+                      const std::atomic<bool>* cancelled) {
+    // 分块扫描以便及时响应取消：块边界取在换行之后（正则按行匹配不会跨过），
+    // 普通文本多给出模式串长度减一的字节，保证起点在块内的匹配完整；
+    // 全字匹配再多给出一个字符（最多 4 字节），使匹配之后的字符可见
+    size_t overlap = pattern.isRegex() ? 0 : pattern.getPattern().size() - 1 + (pattern.isWholeWord() ? 4 : 0);
+    size_t from = 0;
+    while (from < length) {
+        if (cancelled && *cancelled) {
+            return false;
+        }
+        size_t boundary = std::min(length, from + kScanChunk);
+        if (boundary < length) {
+            const char* newline = static_cast<const char*>(std::memchr(data + boundary, '\n', length - boundary));
+            boundary = newline ? static_cast<size_t>(newline - data) + 1 : length;
+        }
+        size_t limit = std::min(length, boundary + overlap);
+        size_t matchStart = 0;
+        size_t matchLength = 0;
+        while (from < boundary && pattern.findNext(data, limit, from, matchStart, matchLength) &&
+               matchStart < boundary) {
+            if (matchLength == 0) {
+                from = matchStart + 1;
+                continue;
+            }
+            matches.push_back(MatchSpan{matchStart, matchLength});
+            from = matchStart + matchLength;
+        }
+        from = std::max(from, boundary);
+    }
+    return true;
+}
+
+bool MatchIndex::refine(const SearchPattern& pattern, const char* data, size_t length,
+                        const std::vector<MatchSpan>& candidates, std::vector<MatchSpan>& matches,
+                        const std::atomic<bool>* cancelled) {
+    // 新查找文本更长，相邻的旧匹配验证后可能重叠，按从前向后的规则只保留前一个
+    size_t patternLength = pattern.getPattern().size();
+    size_t end = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (cancelled && (i & 0xffff) == 0 && *cancelled) {
+            return false;
+        }
+        size_t start = candidates[i].start;
+        if (start >= end && pattern.matchesAt(data, length, start)) {
+            matches.push_back(MatchSpan{start, patternLength});
+            end = start + patternLength;
+        }
+    }
+    return true;
+}
+
+bool MatchIndex::canRefine(const SearchPattern& previous, const SearchPattern& next) {
+    // 全字匹配时旧匹配不是新匹配的超集（"foo" 不匹配 "foobar" 中的 foo）
+    if (previous.isRegex() || next.isRegex() || previous.isWholeWord() || next.isWholeWord() ||
+        previous.isCaseSensitive() != next.isCaseSensitive()) {
+        return false;
+    }
+    // 忽略大小写时比较折叠后的形式（折叠不改变字节数，逐字节比较即可）
+    bool caseSensitive = next.isCaseSensitive();
+    const std::string before = caseSensitive ? previous.getPattern() : UnicodeText::foldString(previous.getPattern());
+    const std::string after = caseSensitive ? next.getPattern() : UnicodeText::foldString(next.getPattern());
+    if (after.size() <= before.size() || !std::equal(before.begin(), before.end(), after.begin())) {
+        return false;
+    }
+    // 旧查找文本的真前缀同时也是后缀时，旧匹配会跳过部分出现位置，不能只验证旧匹配
+    for (size_t border = 1; border < before.size(); border++) {
+        if (std::equal(before.begin(), before.begin() + border, before.end() - border)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MatchIndex::startScan(std::shared_ptr<const std::vector<MatchSpan>> candidates) {
+    generation_++;
+    matches_.clear();
+    pendingEdits_.clear();
+    damaged_ = false;
+    complete_ = !pattern_ || !editor_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    hasResult_ = false;
+    if (complete_) {
+        pendingJob_.reset();
+        return;
+    }
+    pendingJob_ = std::make_unique<Job>(
+        Job{pattern_, std::make_shared<const std::string>(editor_->getContentView()), candidates, generation_});
+    workCondition_.notify_one();
+}
+
+void MatchIndex::handleEdit(const TextEdit& edit) {
+    if (!pattern_) {
+        return;
+    }
+    if (edit.removedLength + edit.insertedLength > kRescanThreshold) {
+        startScan();
+        return;
+    }
+    if (!complete_) {
+        pendingEdits_.push_back(edit);
+        return;
+    }
+    shiftMatches(edit);
+    repairDamage();
+}
+
+void MatchIndex::shiftMatches(const TextEdit& edit) {
+    size_t position = edit.position;
+    size_t removedEnd = position + edit.removedLength;
+    size_t insertedEnd = position + edit.insertedLength;
+
+    // 起点落在被删除区间内的匹配直接删除，之后的匹配整体平移
+    auto first = std::lower_bound(matches_.begin(), matches_.end(), position, startsBefore);
+    auto last = std::lower_bound(first, matches_.end(), removedEnd, startsBefore);
+    first = matches_.erase(first, last);
+    for (auto it = first; it != matches_.end(); ++it) {
+        it->start = it->start - edit.removedLength + edit.insertedLength;
+    }
+
+    if (damaged_) {
+        damageStart_ = damageStart_ <= position ? damageStart_
+                       : damageStart_ >= removedEnd ? damageStart_ - edit.removedLength + edit.insertedLength
+                                                    : position;
+        damageEnd_ = damageEnd_ < position ? damageEnd_
+                     : damageEnd_ >= removedEnd ? damageEnd_ - edit.removedLength + edit.insertedLength
+                                                : insertedEnd;
+        damageStart_ = std::min(damageStart_, position);
+        damageEnd_ = std::max(damageEnd_, insertedEnd);
+    } else {
+        damageStart_ = position;
+        damageEnd_ = insertedEnd;
+        damaged_ = true;
+    }
+}
+
+void MatchIndex::repairDamage() {
+    if (!damaged_ || !editor_ || !pattern_) {
+        return;
+    }
+    damaged_ = false;
+    std::string_view text = editor_->getContentView();
+    const char* data = text.data();
+    size_t length = text.size();
+
+    // 重新查找的窗口：普通文本向前后各延伸模式串长度减一，正则表达式扩展到整行
+    size_t windowStart = std::min(damageStart_, length);
+    size_t windowEnd = std::min(damageEnd_, length);
+    if (pattern_->isRegex()) {
+        while (windowStart > 0 && data[windowStart - 1] != '\n') {
+            windowStart--;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(data + windowEnd, '\n', length - windowEnd));
+        windowEnd = newline ? static_cast<size_t>(newline - data) : length;
+    } else {
+        // 窗口终点也延后：被删除的原有匹配可能一直延伸到这里；
+        // 全字匹配时编辑还会改变前后一个字符处的单词边界
+        size_t overlap = pattern_->getPattern().size() - 1 + (pattern_->isWholeWord() ? 4 : 0);
+        windowStart = windowStart > overlap ? windowStart - overlap : 0;
+        windowEnd = std::min(length, windowEnd + overlap);
+    }
+
+    size_t first = static_cast<size_t>(
+        std::lower_bound(matches_.begin(), matches_.end(), windowStart, startsBefore) - matches_.begin());
+    size_t from = windowStart;
+    if (first > 0) {
+        from = std::max(from, matches_[first - 1].start + matches_[first - 1].length);
+    }
+
+    // 过了窗口之后，只要原有匹配在当前位置也没有跨过（两次扫描处于相同状态）即可停止，
+    // 其后的原有匹配保持不变
+    std::vector<MatchSpan> found;
+    size_t last = first;
+    while (true) {
+        if (from >= windowEnd) {
+            last = static_cast<size_t>(
+                std::lower_bound(matches_.begin() + last, matches_.end(), from, startsBefore) - matches_.begin());
+            if (last == first || matches_[last - 1].start + matches_[last - 1].length <= from) {
+                break;
+            }
+        }
+        size_t matchStart = 0;
+        size_t matchLength = 0;
+        if (from >= length || !pattern_->findNext(data, length, from, matchStart, matchLength)) {
+            last = matches_.size();
+            break;
+        }
+        if (matchLength == 0) {
+            from = matchStart + 1;
+            continue;
+        }
+        found.push_back(MatchSpan{matchStart, matchLength});
+        from = matchStart + matchLength;
+    }
+    matches_.erase(matches_.begin() + first, matches_.begin() + last);
+    matches_.insert(matches_.begin() + first, found.begin(), found.end());
+}
+
+void MatchIndex::workerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCondition_.wait(lock, [this]() { return stopWorker_ || pendingJob_; });
+            if (stopWorker_) {
+                return;
+            }
+            job = std::move(pendingJob_);
+            cancelled_ = false;
+            busy_ = true;
+        }
+
+        std::vector<MatchSpan> matches;
+        const std::string& text = *job->text;
+        bool finished = job->candidates
+                            ? refine(*job->pattern, text.data(), text.size(), *job->candidates, matches, &cancelled_)
+                            : scan(*job->pattern, text.data(), text.size(), matches, &cancelled_);
+        if (finished) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                result_.swap(matches);
+                resultGeneration_ = job->generation;
+                hasResult_ = true;
+            }
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (matchesReadyCallback_) {
+                matchesReadyCallback_();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        idleCondition_.notify_all();
+    }
+}
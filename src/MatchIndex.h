@@ -0,0 +1,227 @@
+#ifndef MATCH_INDEX_H
+#define MATCH_INDEX_H
+
+#include "SearchPattern.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 一处匹配
+ */
+struct MatchSpan {
+    size_t start;   // 起始偏移
+    size_t length;  // 长度（字节）
+};
+
+/**
+ * 当前查找条件的匹配索引
+ * 按从前向后、互不重叠的规则（与替换一致）记录文档中的全部匹配，按偏移有序，
+ * 因此跳到下一个/上一个匹配和“第 n 个，共 m 个”都是一次二分查找。
+ *
+ * 设置查找条件后在后台线程中对文档快照完整扫描，新的查找条件会取消尚未完成的扫描。
+ * 之后每次编辑只平移受影响位置之后的匹配，并在编辑位置前后各延伸一个模式串长度
+ * （正则表达式为所在的整行）的窗口内重新查找；窗口之后继续查找直到与原有匹配重新对齐。
+ * 扫描期间发生的编辑先记录下来，结果送达时依次补上。
+ *
+ * 边输入边查找时，如果新的普通文本查找条件是在上一个的末尾追加字符，新匹配必然从旧匹配的位置开始，
+ * 因此只需逐个验证旧匹配（要求旧查找文本不能与自身重叠，此时旧匹配就是全部出现位置）；
+ * 查找文本缩短、改变或为正则表达式时才重新完整扫描
+ */
+class MatchIndex {
+public:
+    MatchIndex();
+    ~MatchIndex();
+
+    MatchIndex(const MatchIndex&) = delete;
+    MatchIndex& operator=(const MatchIndex&) = delete;
+
+    /**
+     * 设置编辑器实例，订阅其范围编辑
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 设置查找条件并开始后台扫描（能够在上一次结果上缩小范围时只做验证），查找文本为空时清空索引
+     * @param pattern 查找文本或正则表达式
+     * @param caseSensitive 是否区分大小写
+     * @param regex 是否为正则表达式
+     * @param wholeWord 是否全字匹配
+     * @return 是否成功（正则表达式语法错误时返回 false，索引被清空）
+     */
+    bool setQuery(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord = false);
+
+    /**
+     * 取走后台扫描的结果（在界面线程中调用，通常在收到更新回调之后）
+     * @return 是否有新结果
+     */
+    bool collect();
+
+    /**
+     * 等待后台扫描结束并取走结果
+     */
+    void waitForIdle();
+
+    /**
+     * 索引是否已反映当前文档的全部匹配
+     * @return 扫描完成时返回 true；查找条件为空时也返回 true
+     */
+    bool isComplete() const;
+
+    /**
+     * 获取匹配总数
+     * @return 匹配数（扫描完成前为 0）
+     */
+    size_t getMatchCount() const;
+
+    /**
+     * 获取第 index 个匹配
+     * @param index 下标
+     * @return 匹配
+     */
+    const MatchSpan& getMatch(size_t index) const;
+
+    /**
+     * 查找起始位置不小于 offset 的第一个匹配，到末尾后从头开始
+     * @param offset 偏移
+     * @param index 输出匹配下标
+     * @return 是否存在匹配
+     */
+    bool findNext(size_t offset, size_t& index) const;
+
+    /**
+     * 查找起始位置小于 offset 的最后一个匹配，到开头后从末尾开始
+     * @param offset 偏移
+     * @param index 输出匹配下标
+     * @return 是否存在匹配
+     */
+    bool findPrevious(size_t offset, size_t& index) const;
+
+    /**
+     * 获取与区间相交的匹配（用于高亮可见区域）
+     * @param start 区间起始
+     * @param end 区间结束
+     * @return 匹配列表
+     */
+    std::vector<MatchSpan> getMatchesInRange(size_t start, size_t end) const;
+
+    /**
+     * 设置扫描结果送达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setMatchesReadyCallback(std::function<void()> callback);
+
+    /**
+     * 在一段内容中扫描全部匹配（长度为 0 的正则匹配不计入）
+     * @param pattern 查找条件
+     * @param data 内容
+     * @param length 长度
+     * @param matches 输出匹配
+     * @param cancelled 取消标志，可为 nullptr
+     * @return 是否完整扫描（被取消时返回 false）
+     */
+    static bool scan(const SearchPattern& pattern, const char* data, size_t length, std::vector<MatchSpan>& matches,
+                     const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * 在上一个查找条件的匹配中验证新的查找条件（仅普通文本），保留互不重叠的匹配
+     * @param pattern 新的查找条件
+     * @param data 内容
+     * @param length 长度
+     * @param candidates 上一个查找条件的匹配
+     * @param matches 输出匹配
+     * @param cancelled 取消标志，可为 nullptr
+     * @return 是否完整验证（被取消时返回 false）
+     */
+    static bool refine(const SearchPattern& pattern, const char* data, size_t length,
+                       const std::vector<MatchSpan>& candidates, std::vector<MatchSpan>& matches,
+                       const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * 判断新的查找条件能否在旧查找条件的结果上缩小范围
+     * @param previous 旧查找条件
+     * @param next 新查找条件
+     * @return 是否可以只验证旧匹配
+     */
+    static bool canRefine(const SearchPattern& previous, const SearchPattern& next);
+
+private:
+    /**
+     * 提交给后台线程的扫描任务
+     */
+    struct Job {
+        std::shared_ptr<const SearchPattern> pattern;
+        std::shared_ptr<const std::string> text;
+        std::shared_ptr<const std::vector<MatchSpan>> candidates;  // 不为空时只验证这些位置
+        uint64_t generation;
+    };
+
+    // 界面线程状态
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    std::shared_ptr<const SearchPattern> pattern_;
+    uint64_t generation_;
+    bool complete_;
+    std::vector<MatchSpan> matches_;
+    std::vector<TextEdit> pendingEdits_;  // 扫描期间的编辑，结果送达后补上
+    bool damaged_;                        // 以下区间内的匹配尚未重新查找
+    size_t damageStart_;
+    size_t damageEnd_;
+
+    // 线程间共享状态
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    std::unique_ptr<Job> pendingJob_;
+    std::atomic<bool> cancelled_;  // 取消正在进行的扫描
+    bool busy_;
+    bool stopWorker_;
+    bool hasResult_;
+    uint64_t resultGeneration_;
+    std::vector<MatchSpan> result_;
+    std::mutex callbackMutex_;
+    std::function<void()> matchesReadyCallback_;
+    std::thread worker_;
+
+    /**
+     * 清空索引，对当前文档快照提交一次后台扫描（取消尚未完成的扫描）
+     * @param candidates 上一个查找条件的匹配，不为空时只验证这些位置
+     */
+    void startScan(std::shared_ptr<const std::vector<MatchSpan>> candidates = nullptr);
+
+    /**
+     * 处理范围编辑（过大的编辑改为重新扫描）
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 按编辑平移匹配，删除被删除区间内的匹配，并把编辑位置并入待重新查找的区间
+     * @param edit 编辑描述
+     */
+    void shiftMatches(const TextEdit& edit);
+
+    /**
+     * 在待重新查找的区间内重新查找，并继续到与原有匹配重新对齐为止
+     */
+    void repairDamage();
+
+    /**
+     * 后台线程主循环
+     */
+    void workerLoop();
+};
+
+#endif // MATCH_INDEX_H
@@ -0,0 +1,612 @@
+#include "PagedDocument.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 行索引最初的采样间隔（行数），采样点超过上限后加倍
+const uint64_t kInitialSampleInterval = 64;
+
+// 扫描每前进这么多块通知一次进度
+const unsigned kProgressSteps = 64;
+
+}  // namespace
+
+PagedDocument::PagedDocument()
+    : fd_(-1), size_(0), blockSize_(0), maxBlocks_(0), maxSamples_(0), prefetchBlocks_(0),
+      sampleInterval_(kInitialSampleInterval), scannedOffset_(0), scannedLines_(0), indexComplete_(true),
+      anchorLine_(0), anchorOffset_(0), lastBlock_(0), direction_(1), findGeneration_(0), finding_(false),
+      findReady_(false), findFound_(false), findResult_(0), busy_(false), stopWorker_(false) {}
+
+PagedDocument::~PagedDocument() {
+    close();
+}
+
+bool PagedDocument::open(const std::string& path, size_t memoryLimit, size_t blockSize) {
+    close();
+#ifdef _WIN32
+    std::cerr << "Paged documents are not supported on this platform" << std::endl;
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        std::cerr << "Failed to stat " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    path_ = path;
+    fd_ = fd;
+    size_ = static_cast<uint64_t>(info.st_size);
+    blockSize_ = std::max<size_t>(blockSize, 512);
+    size_t indexBudget = memoryLimit / 8;
+    maxSamples_ = std::max<size_t>(indexBudget / sizeof(uint64_t), 16);
+    maxBlocks_ = std::max<size_t>((memoryLimit - indexBudget) / blockSize_, 4);
+    prefetchBlocks_ = maxBlocks_ / 4;
+    scanBuffer_.resize(blockSize_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.assign(1, 0);
+    sampleInterval_ = kInitialSampleInterval;
+    scannedOffset_ = 0;
+    scannedLines_ = 0;
+    indexComplete_ = size_ == 0;
+    anchorLine_ = 0;
+    anchorOffset_ = 0;
+    lastBlock_ = std::numeric_limits<uint64_t>::max();  // 第一次访问视为向后翻看
+    direction_ = 1;
+    stopWorker_ = false;
+    worker_ = std::thread(&PagedDocument::workerLoop, this);
+    return true;
+#endif
+}
+
+void PagedDocument::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+#ifndef _WIN32
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    path_.clear();
+    size_ = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.clear();
+    indexComplete_ = true;
+    blocks_.clear();
+    lru_.clear();
+    prefetchQueue_.clear();
+    findJob_.reset();
+    finding_ = false;
+    findReady_ = false;
+    busy_ = false;
+    idleCondition_.notify_all();
+}
+
+bool PagedDocument::isOpen() const {
+    return fd_ >= 0;
+}
+
+std::string PagedDocument::getPath() const {
+    return path_;
+}
+
+uint64_t PagedDocument::getSize() const {
+    return size_;
+}
+
+bool PagedDocument::isIndexComplete() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return indexComplete_;
+}
+
+uint64_t PagedDocument::getLineCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (indexComplete_ || scannedOffset_ == 0) {
+        return scannedLines_ + 1;
+    }
+    long double estimate = static_cast<long double>(scannedLines_) * size_ / scannedOffset_;
+    return std::max(scannedLines_, static_cast<uint64_t>(estimate)) + 1;
+}
+
+uint64_t PagedDocument::getSampleInterval() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sampleInterval_;
+}
+
+void PagedDocument::waitForIndex() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return indexComplete_; });
+}
+
+void PagedDocument::waitForIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return prefetchQueue_.empty() && !finding_ && !busy_; });
+}
+
+bool PagedDocument::getLineOffset(uint64_t line, uint64_t& offset) {
+    if (!isOpen()) {
+        return false;
+    }
+    ensureScanned(line, 0);
+    uint64_t base = 0;
+    uint64_t baseLine = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (line > scannedLines_) {
+            return false;
+        }
+        size_t index = static_cast<size_t>(std::min<uint64_t>(line / sampleInterval_, samples_.size() - 1));
+        baseLine = index * sampleInterval_;
+        base = samples_[index];
+        if (anchorLine_ <= line && anchorLine_ > baseLine) {
+            baseLine = anchorLine_;
+            base = anchorOffset_;
+        }
+    }
+    if (!skipLines(base, line - baseLine, offset)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    anchorLine_ = line;
+    anchorOffset_ = offset;
+    return true;
+}
+
+uint64_t PagedDocument::getLineOfOffset(uint64_t offset) {
+    if (!isOpen()) {
+        return 0;
+    }
+    offset = std::min(offset, size_);
+    ensureScanned(0, offset);
+    uint64_t base = 0;
+    uint64_t baseLine = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t index = static_cast<size_t>(std::upper_bound(samples_.begin(), samples_.end(), offset) -
+                                           samples_.begin()) - 1;
+        baseLine = index * sampleInterval_;
+        base = samples_[index];
+        if (anchorOffset_ <= offset && anchorOffset_ > base) {
+            baseLine = anchorLine_;
+            base = anchorOffset_;
+        }
+    }
+    return baseLine + countLines(base, offset);
+}
+
+bool PagedDocument::getLine(uint64_t line, std::string& text, size_t maxBytes) {
+    text.clear();
+    uint64_t position = 0;
+    if (!getLineOffset(line, position)) {
+        return false;
+    }
+    while (text.size() < maxBytes && position < size_) {
+        Block block = getBlock(position / blockSize_, false);
+        size_t within = static_cast<size_t>(position % blockSize_);
+        if (!block || within >= block->size()) {
+            return false;
+        }
+        const char* start = block->data() + within;
+        size_t length = std::min(block->size() - within, maxBytes - text.size());
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', length));
+        if (newline) {
+            text.append(start, newline);
+            break;
+        }
+        text.append(start, length);
+        position += length;
+    }
+    return true;
+}
+
+bool PagedDocument::read(uint64_t offset, size_t length, std::string& data) {
+    data.clear();
+    if (!isOpen()) {
+        return false;
+    }
+    uint64_t end = std::min(size_, offset + length);
+    for (uint64_t position = offset; position < end;) {
+        Block block = getBlock(position / blockSize_, false);
+        size_t within = static_cast<size_t>(position % blockSize_);
+        if (!block || within >= block->size()) {
+            return false;
+        }
+        size_t count = static_cast<size_t>(std::min<uint64_t>(block->size() - within, end - position));
+        data.append(block->data() + within, count);
+        position += count;
+    }
+    return true;
+}
+
+bool PagedDocument::find(const TextSearch& search, uint64_t from, bool forward, uint64_t& offset) {
+    if (!isOpen()) {
+        return false;
+    }
+    FindJob job{search, std::min(from, size_), forward, false, false, 0, {}};
+    while (!job.done) {
+        searchChunk(job);
+    }
+    if (job.found) {
+        offset = job.result;
+    }
+    return job.found;
+}
+
+void PagedDocument::startFind(const TextSearch& search, uint64_t from, bool forward) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    findJob_ = std::make_unique<FindJob>(FindJob{search, std::min(from, size_), forward, false, false, 0, {}});
+    findGeneration_++;
+    finding_ = true;
+    findReady_ = false;
+    workCondition_.notify_one();
+}
+
+bool PagedDocument::collectFind(bool& found, uint64_t& offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!findReady_) {
+        return false;
+    }
+    findReady_ = false;
+    found = findFound_;
+    offset = findResult_;
+    return true;
+}
+
+bool PagedDocument::isFinding() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finding_;
+}
+
+bool PagedDocument::isCached(uint64_t offset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blockSize_ > 0 && blocks_.count(offset / blockSize_) > 0;
+}
+
+size_t PagedDocument::getCachedBlockCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_.size();
+}
+
+size_t PagedDocument::getBlockCapacity() const {
+    return maxBlocks_;
+}
+
+void PagedDocument::setIndexProgressCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    indexProgressCallback_ = callback;
+}
+
+void PagedDocument::setFindReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    findReadyCallback_ = callback;
+}
+
+void PagedDocument::workerLoop() {
+    unsigned steps = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        workCondition_.wait(lock, [this]() {
+            return stopWorker_ || !prefetchQueue_.empty() || findJob_ || !indexComplete_;
+        });
+        if (stopWorker_) {
+            return;
+        }
+
+        if (!prefetchQueue_.empty()) {
+            uint64_t index = prefetchQueue_.front();
+            prefetchQueue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            getBlock(index, true);
+            lock.lock();
+            busy_ = false;
+            idleCondition_.notify_all();
+            continue;
+        }
+
+        if (findJob_) {
+            // 每次只前进一块，期间到达的预读请求不必等查找结束
+            std::unique_ptr<FindJob> job = std::move(findJob_);
+            uint64_t generation = findGeneration_;
+            busy_ = true;
+            lock.unlock();
+            searchChunk(*job);
+            lock.lock();
+            busy_ = false;
+            bool ready = false;
+            if (generation == findGeneration_) {
+                if (job->done) {
+                    finding_ = false;
+                    findReady_ = true;
+                    findFound_ = job->found;
+                    findResult_ = job->result;
+                    ready = true;
+                } else {
+                    findJob_ = std::move(job);
+                }
+            }
+            idleCondition_.notify_all();
+            lock.unlock();
+            if (ready) {
+                std::lock_guard<std::mutex> callbackLock(callbackMutex_);
+                if (findReadyCallback_) {
+                    findReadyCallback_();
+                }
+            }
+            continue;
+        }
+
+        lock.unlock();
+        scanStep();
+        if (++steps % kProgressSteps == 0 || isIndexComplete()) {
+            std::lock_guard<std::mutex> callbackLock(callbackMutex_);
+            if (indexProgressCallback_) {
+                indexProgressCallback_();
+            }
+        }
+    }
+}
+
+bool PagedDocument::scanStep() {
+    std::lock_guard<std::mutex> scanLock(scanMutex_);
+    uint64_t offset = 0;
+    uint64_t lines = 0;
+    uint64_t interval = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (indexComplete_) {
+            return false;
+        }
+        offset = scannedOffset_;
+        lines = scannedLines_;
+        interval = sampleInterval_;
+    }
+    size_t length = static_cast<size_t>(std::min<uint64_t>(blockSize_, size_ - offset));
+    long long count = readAt(offset, scanBuffer_.data(), length);
+
+    // 间隔只会加倍，按当前间隔取的候选点在加倍之后仍然可以按新间隔筛选
+    std::vector<std::pair<uint64_t, uint64_t>> starts;
+    const char* data = scanBuffer_.data();
+    for (const char* p = data; count > 0 && (p = static_cast<const char*>(
+                                                 std::memchr(p, '\n', static_cast<size_t>(data + count - p))));) {
+        p++;
+        if (++lines % interval == 0) {
+            starts.emplace_back(lines, offset + static_cast<uint64_t>(p - data));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& start : starts) {
+        if (start.first % sampleInterval_ != 0) {
+            continue;
+        }
+        samples_.push_back(start.second);
+        if (samples_.size() > maxSamples_) {
+            // 隔一个丢一个，间隔加倍
+            size_t kept = (samples_.size() + 1) / 2;
+            for (size_t i = 0; i < kept; i++) {
+                samples_[i] = samples_[2 * i];
+            }
+            samples_.resize(kept);
+            sampleInterval_ *= 2;
+        }
+    }
+    if (count > 0) {
+        scannedOffset_ = offset + static_cast<uint64_t>(count);
+        scannedLines_ = lines;
+    }
+    if (count <= 0 || scannedOffset_ >= size_) {
+        // 文件在打开后被截断时同样结束扫描
+        indexComplete_ = true;
+        idleCondition_.notify_all();
+    }
+    return true;
+}
+
+void PagedDocument::ensureScanned(uint64_t line, uint64_t offset) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (indexComplete_ || (scannedLines_ >= line && scannedOffset_ >= offset)) {
+                return;
+            }
+        }
+        scanStep();
+    }
+}
+
+PagedDocument::Block PagedDocument::getBlock(uint64_t index, bool prefetch) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!prefetch) {
+            schedulePrefetch(index);
+        }
+        auto it = blocks_.find(index);
+        if (it != blocks_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.position);
+            return it->second.data;
+        }
+    }
+    uint64_t offset = index * blockSize_;
+    if (offset >= size_) {
+        return nullptr;
+    }
+    size_t length = static_cast<size_t>(std::min<uint64_t>(blockSize_, size_ - offset));
+    auto data = std::make_shared<std::string>(length, '\0');
+    long long count = readAt(offset, &(*data)[0], data->size());
+    if (count < 0) {
+        return nullptr;
+    }
+    data->resize(static_cast<size_t>(count));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(index);
+    if (it != blocks_.end()) {
+        return it->second.data;  // 预读线程同时读入了同一块
+    }
+    lru_.push_front(index);
+    blocks_[index] = CachedBlock{data, lru_.begin()};
+    while (blocks_.size() > maxBlocks_) {
+        blocks_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    return data;
+}
+
+void PagedDocument::schedulePrefetch(uint64_t index) {
+    if (index == lastBlock_) {
+        return;
+    }
+    if (index == lastBlock_ + 1) {
+        direction_ = 1;
+    } else if (index + 1 == lastBlock_) {
+        direction_ = -1;
+    }
+    lastBlock_ = index;
+    prefetchQueue_.clear();
+    for (uint64_t i = 1; i <= prefetchBlocks_; i++) {
+        if (direction_ < 0 && i > index) {
+            break;
+        }
+        uint64_t next = direction_ > 0 ? index + i : index - i;
+        if (next * blockSize_ >= size_) {
+            break;
+        }
+        if (!blocks_.count(next)) {
+            prefetchQueue_.push_back(next);
+        }
+    }
+    if (!prefetchQueue_.empty()) {
+        workCondition_.notify_one();
+    }
+}
+
+bool PagedDocument::skipLines(uint64_t offset, uint64_t count, uint64_t& result) {
+    if (count == 0) {
+        result = offset;
+        return true;
+    }
+    for (uint64_t position = offset; position < size_;) {
+        Block block = getBlock(position / blockSize_, false);
+        size_t within = static_cast<size_t>(position % blockSize_);
+        if (!block || within >= block->size()) {
+            return false;
+        }
+        const char* data = block->data();
+        const char* end = data + block->size();
+        for (const char* p = data + within;
+             (p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p))));) {
+            p++;
+            if (--count == 0) {
+                result = position - within + static_cast<uint64_t>(p - data);
+                return true;
+            }
+        }
+        position += block->size() - within;
+    }
+    return false;
+}
+
+uint64_t PagedDocument::countLines(uint64_t begin, uint64_t end) {
+    uint64_t count = 0;
+    for (uint64_t position = begin; position < end;) {
+        Block block = getBlock(position / blockSize_, false);
+        size_t within = static_cast<size_t>(position % blockSize_);
+        if (!block || within >= block->size()) {
+            break;
+        }
+        size_t length = static_cast<size_t>(std::min<uint64_t>(block->size() - within, end - position));
+        count += static_cast<uint64_t>(std::count(block->data() + within, block->data() + within + length, '\n'));
+        position += length;
+    }
+    return count;
+}
+
+void PagedDocument::searchChunk(FindJob& job) {
+    size_t patternLength = job.search.getPattern().size();
+    if (patternLength == 0 || (job.forward ? job.position >= size_ : job.position == 0)) {
+        job.done = true;
+        return;
+    }
+    // 本块负责起始于 [low, high) 的匹配；缓冲区向前多读一个字节、向后多读一个模式串长度，
+    // 跨块的匹配和全字匹配的边界都能在一块之内判断
+    uint64_t low = job.forward ? job.position : job.position - std::min<uint64_t>(job.position, blockSize_);
+    uint64_t high = job.forward ? std::min<uint64_t>(size_, job.position + blockSize_) : job.position;
+    uint64_t bufferStart = low > 0 ? low - 1 : 0;
+    uint64_t bufferEnd = std::min<uint64_t>(size_, high + patternLength);
+    job.buffer.resize(static_cast<size_t>(bufferEnd - bufferStart));
+    long long count = readAt(bufferStart, &job.buffer[0], job.buffer.size());
+    if (count < 0) {
+        job.done = true;
+        return;
+    }
+    const char* data = job.buffer.data();
+    size_t length = static_cast<size_t>(count);
+    size_t from = static_cast<size_t>(low - bufferStart);
+    size_t limit = static_cast<size_t>(high - bufferStart);
+    size_t match = std::string::npos;
+    for (size_t position; (position = job.search.find(data, length, from)) != std::string::npos && position < limit;) {
+        match = position;
+        if (job.forward) {
+            break;
+        }
+        from = position + 1;  // 向前查找取本块中最后一个匹配
+    }
+    if (match != std::string::npos) {
+        job.done = true;
+        job.found = true;
+        job.result = bufferStart + match;
+        return;
+    }
+    job.position = job.forward ? high : low;
+    job.done = job.forward ? high >= size_ : low == 0;
+}
+
+long long PagedDocument::readAt(uint64_t offset, char* buffer, size_t length) const {
+#ifdef _WIN32
+    return -1;
+#else
+    size_t total = 0;
+    while (total < length) {
+        ssize_t count = ::pread(fd_, buffer + total, length - total, static_cast<off_t>(offset + total));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Failed to read " << path_ << ": " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        if (count == 0) {
+            break;
+        }
+        total += static_cast<size_t>(count);
+    }
+#ifdef POSIX_FADV_DONTNEED
+    // 内容已复制到块缓存或扫描缓冲区，不再占用页缓存
+    posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(total), POSIX_FADV_DONTNEED);
+#endif
+    return static_cast<long long>(total);
+#endif
+}
@@ -0,0 +1,328 @@
+#ifndef PAGED_DOCUMENT_H
+#define PAGED_DOCUMENT_H
+
+#include "TextSearch.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 分页只读文档（比内存还大的日志文件）
+ * 文件内容不整体载入：按固定大小的块用 pread 读取，放入有上限的 LRU 块缓存；
+ * 读过的页从操作系统页缓存中释放，扫描几十 GB 的文件也不会挤占其他进程的页缓存。
+ *
+ * 行索引是稀疏的：后台线程顺序扫描文件，每隔若干行记录一次行首偏移；采样点超过上限时隔一个丢一个、
+ * 间隔加倍，因此索引内存与文件大小无关。定位某一行时从之前最近的采样点（或上一次定位的位置）开始
+ * 在块缓存中数换行符；后台扫描尚未到达的位置在调用线程中按需扩展索引。
+ *
+ * 顺序翻看时按翻看方向在后台预读后面的块；查找在后台线程中逐块进行，不经过块缓存。
+ * 内存上限的 1/8 用于行索引，其余用于块缓存
+ */
+class PagedDocument {
+public:
+    PagedDocument();
+    ~PagedDocument();
+
+    PagedDocument(const PagedDocument&) = delete;
+    PagedDocument& operator=(const PagedDocument&) = delete;
+
+    /**
+     * 打开文件（已打开时先关闭）并开始在后台建立行索引
+     * @param path 文件路径
+     * @param memoryLimit 块缓存和行索引共用的内存上限（字节）
+     * @param blockSize 块大小（字节）
+     * @return 是否成功
+     */
+    bool open(const std::string& path, size_t memoryLimit, size_t blockSize = 256 * 1024);
+
+    /**
+     * 停止后台线程并关闭文件
+     */
+    void close();
+
+    /**
+     * 是否已打开文件
+     * @return 是否已打开
+     */
+    bool isOpen() const;
+
+    /**
+     * 获取文件路径
+     * @return 文件路径
+     */
+    std::string getPath() const;
+
+    /**
+     * 获取文件大小（打开时的大小）
+     * @return 字节数
+     */
+    uint64_t getSize() const;
+
+    /**
+     * 行索引是否已覆盖整个文件
+     * @return 是否完整
+     */
+    bool isIndexComplete() const;
+
+    /**
+     * 获取行数（与编辑器一致：末尾换行之后还有一个空行）
+     * 索引完整前按已扫描部分的平均行长估算
+     * @return 行数
+     */
+    uint64_t getLineCount() const;
+
+    /**
+     * 获取行索引的采样间隔
+     * @return 相邻采样点之间的行数
+     */
+    uint64_t getSampleInterval() const;
+
+    /**
+     * 等待行索引建立完成
+     */
+    void waitForIndex();
+
+    /**
+     * 等待预读和后台查找结束
+     */
+    void waitForIdle();
+
+    /**
+     * 获取一行的起始偏移
+     * @param line 行号（从0开始）
+     * @param offset 输出偏移
+     * @return 是否成功（行号超出文件时返回 false）
+     */
+    bool getLineOffset(uint64_t line, uint64_t& offset);
+
+    /**
+     * 获取偏移所在的行号
+     * @param offset 偏移（超出文件时按文件末尾计算）
+     * @return 行号
+     */
+    uint64_t getLineOfOffset(uint64_t offset);
+
+    /**
+     * 读取一行的内容（不含换行符）
+     * @param line 行号（从0开始）
+     * @param text 输出内容
+     * @param maxBytes 最多读取的字节数，超出的部分被截断
+     * @return 是否成功
+     */
+    bool getLine(uint64_t line, std::string& text, size_t maxBytes);
+
+    /**
+     * 通过块缓存读取一段内容
+     * @param offset 起始偏移
+     * @param length 最多读取的字节数
+     * @param data 输出内容（到达文件末尾时可能短于 length）
+     * @return 是否成功
+     */
+    bool read(uint64_t offset, size_t length, std::string& data);
+
+    /**
+     * 在当前线程中查找
+     * @param search 查找内核
+     * @param from 向后查找时的起始偏移；向前查找时匹配必须开始于 from 之前
+     * @param forward 是否向后查找
+     * @param offset 输出匹配位置
+     * @return 是否找到
+     */
+    bool find(const TextSearch& search, uint64_t from, bool forward, uint64_t& offset);
+
+    /**
+     * 在后台线程中查找（取代尚未完成的查找），完成后通过 collectFind() 取走结果
+     * @param search 查找内核
+     * @param from 起始偏移，含义同 find()
+     * @param forward 是否向后查找
+     */
+    void startFind(const TextSearch& search, uint64_t from, bool forward);
+
+    /**
+     * 取走后台查找的结果
+     * @param found 输出是否找到
+     * @param offset 输出匹配位置
+     * @return 是否有结果
+     */
+    bool collectFind(bool& found, uint64_t& offset);
+
+    /**
+     * 后台查找是否正在进行
+     * @return 是否正在查找
+     */
+    bool isFinding() const;
+
+    /**
+     * 检查包含指定偏移的块是否在缓存中
+     * @param offset 偏移
+     * @return 是否在缓存中
+     */
+    bool isCached(uint64_t offset) const;
+
+    /**
+     * 获取缓存中的块数
+     * @return 块数
+     */
+    size_t getCachedBlockCount() const;
+
+    /**
+     * 获取块缓存的容量
+     * @return 块数
+     */
+    size_t getBlockCapacity() const;
+
+    /**
+     * 设置索引进度回调（扫描每前进一段以及完成时调用）
+     * 回调在后台线程中调用；本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setIndexProgressCallback(std::function<void()> callback);
+
+    /**
+     * 设置查找结果送达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collectFind()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setFindReadyCallback(std::function<void()> callback);
+
+private:
+    using Block = std::shared_ptr<const std::string>;
+
+    /**
+     * 缓存中的块
+     */
+    struct CachedBlock {
+        Block data;
+        std::list<uint64_t>::iterator position;  // 在 LRU 链表中的位置
+    };
+
+    /**
+     * 查找任务（逐块推进）
+     */
+    struct FindJob {
+        TextSearch search;
+        uint64_t position;  // 向后查找时为下一块的起始偏移，向前查找时为下一块的结束偏移
+        bool forward;
+        bool done;
+        bool found;
+        uint64_t result;
+        std::string buffer;
+    };
+
+    std::string path_;
+    int fd_;
+    uint64_t size_;
+    size_t blockSize_;
+    size_t maxBlocks_;   // 块缓存容量
+    size_t maxSamples_;  // 行索引采样点上限
+    size_t prefetchBlocks_;
+
+    mutable std::mutex mutex_;  // 保护以下状态
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    // 行索引：samples_[i] 是第 i × sampleInterval_ 行的起始偏移
+    std::vector<uint64_t> samples_;
+    uint64_t sampleInterval_;
+    uint64_t scannedOffset_;  // 已扫描到的偏移
+    uint64_t scannedLines_;   // [0, scannedOffset_) 中的换行符数量
+    bool indexComplete_;
+    uint64_t anchorLine_;     // 上一次定位的行及其偏移，顺序翻看时不必回到采样点
+    uint64_t anchorOffset_;
+    // 块缓存：链表头部是最近使用的块
+    std::unordered_map<uint64_t, CachedBlock> blocks_;
+    std::list<uint64_t> lru_;
+    uint64_t lastBlock_;
+    int direction_;
+    std::deque<uint64_t> prefetchQueue_;
+    // 后台查找
+    std::unique_ptr<FindJob> findJob_;
+    uint64_t findGeneration_;
+    bool finding_;
+    bool findReady_;
+    bool findFound_;
+    uint64_t findResult_;
+    bool busy_;  // 正在预读或查找（扫描行索引不算）
+    bool stopWorker_;
+
+    std::mutex scanMutex_;  // 同一时间只有一个线程扩展行索引
+    std::vector<char> scanBuffer_;
+    std::mutex callbackMutex_;
+    std::function<void()> indexProgressCallback_;
+    std::function<void()> findReadyCallback_;
+    std::thread worker_;
+
+    /**
+     * 后台线程主循环：预读优先，其次是查找，空闲时扫描行索引
+     */
+    void workerLoop();
+
+    /**
+     * 把行索引向后扩展一块
+     * @return 是否扩展了（索引已完整时返回 false）
+     */
+    bool scanStep();
+
+    /**
+     * 按需扩展行索引，直到覆盖指定的行或偏移
+     * @param line 行号
+     * @param offset 偏移
+     */
+    void ensureScanned(uint64_t line, uint64_t offset);
+
+    /**
+     * 从缓存中取块，不在缓存中时读取并放入缓存
+     * @param index 块序号
+     * @param prefetch 是否为预读（预读不影响翻看方向）
+     * @return 块内容，读取失败时为空
+     */
+    Block getBlock(uint64_t index, bool prefetch);
+
+    /**
+     * 记录翻看位置，按翻看方向安排预读（需持有锁）
+     * @param index 刚访问的块序号
+     */
+    void schedulePrefetch(uint64_t index);
+
+    /**
+     * 从 offset 开始在块缓存中数换行符，找到第 count 个换行符之后的偏移
+     * @param offset 起始偏移
+     * @param count 换行符数量
+     * @param result 输出偏移
+     * @return 是否找到
+     */
+    bool skipLines(uint64_t offset, uint64_t count, uint64_t& result);
+
+    /**
+     * 在块缓存中数 [begin, end) 内的换行符
+     * @param begin 起始偏移
+     * @param end 结束偏移
+     * @return 换行符数量
+     */
+    uint64_t countLines(uint64_t begin, uint64_t end);
+
+    /**
+     * 查找任务前进一块
+     * @param job 查找任务
+     */
+    void searchChunk(FindJob& job);
+
+    /**
+     * 直接读取文件（不经过块缓存），读完后从页缓存中释放
+     * @param offset 起始偏移
+     * @param buffer 缓冲区
+     * @param length 读取的字节数
+     * @return 读到的字节数，出错时返回 -1
+     */
+    long long readAt(uint64_t offset, char* buffer, size_t length) const;
+};
+
+#endif // PAGED_DOCUMENT_H
@@ -0,0 +1,561 @@
+#include "ProjectSymbolIndex.h"
+#include "ConfigManager.h"
+#include "SyntaxLexer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <chrono>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kIndexMagic[8] = {'L', 'P', 'S', 'Y', 'M', 'B', 'L', '\0'};
+const uint32_t kIndexVersion = 1;
+const size_t kIndexBatchSize = 256;  // 每批并行解析的文件数
+
+/**
+ * 索引文件头，之后依次是文件记录、符号记录和字符串区（按本机字节序存储）
+ */
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fileCount;
+    uint64_t symbolCount;
+    uint32_t rootLength;  // 根目录保存在字符串区开头
+    uint32_t reserved;
+    uint64_t filesOffset;
+    uint64_t symbolsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+/**
+ * 写入索引前的符号，名称指向旧索引文件或新解析的结果
+ */
+struct PendingSymbol {
+    std::string_view name;
+    std::string_view container;
+    uint32_t fileId;
+    uint32_t line;
+    uint32_t column;
+    uint8_t kind;
+};
+
+#ifndef _WIN32
+/**
+ * 取纳秒精度的修改时间，同一秒内的多次保存也能区分
+ */
+int64_t modificationTime(const struct stat& info) {
+#ifdef __APPLE__
+    return int64_t(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    return int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+}  // namespace
+
+ProjectSymbolIndex::ProjectSymbolIndex()
+    : mapping_(nullptr),
+      mappingSize_(0),
+      files_(nullptr),
+      fileCount_(0),
+      symbols_(nullptr),
+      symbolCount_(0),
+      strings_(nullptr),
+      stringsSize_(0),
+      ready_(false),
+      stopping_(false) {}
+
+ProjectSymbolIndex::~ProjectSymbolIndex() {
+    close();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+}
+
+std::string ProjectSymbolIndex::defaultIndexPath(const std::string& root) {
+    std::string directory = ConfigManager::getUserConfigDirectory();
+    if (directory.empty()) {
+        return "";
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.symbols",
+                  static_cast<unsigned long long>(std::hash<std::string>()(root)));
+    return (std::filesystem::path(directory) / "index" / name).string();
+}
+
+void ProjectSymbolIndex::setOptions(const FileSearchOptions& options) {
+    options_ = options;
+}
+
+void ProjectSymbolIndex::open(const std::string& root, const std::string& indexPath) {
+    close();
+    stopping_ = false;
+    // 先用已有的索引文件回答查询，刷新完成后切换到新文件
+    load(root, indexPath);
+    worker_ = std::thread([this]() {
+        if (refresh()) {
+            ready_ = true;
+        }
+    });
+}
+
+void ProjectSymbolIndex::close() {
+    stopping_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    ready_ = false;
+}
+
+bool ProjectSymbolIndex::isReady() const {
+    return ready_;
+}
+
+const std::string& ProjectSymbolIndex::getRoot() const {
+    return root_;
+}
+
+bool ProjectSymbolIndex::load(const std::string& root, const std::string& indexPath) {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+    root_ = root;
+    indexPath_ = indexPath;
+    return mapIndex();
+}
+
+bool ProjectSymbolIndex::refresh() {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    if (root_.empty() || indexPath_.empty()) {
+        return false;
+    }
+    std::vector<std::string> paths;
+    lister_.listFiles({root_}, options_, paths);
+    if (stopping_) {
+        return false;
+    }
+
+    // 只有持有 updateMutex_ 的线程会重新映射，以下读取的旧索引在写入新文件前保持有效
+    std::vector<uint32_t> keptIds;
+    std::vector<PendingFile> changed;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::unordered_map<std::string_view, uint32_t> oldIds;
+        oldIds.reserve(fileCount_);
+        for (uint32_t i = 0; i < fileCount_; i++) {
+            oldIds.emplace(std::string_view(strings_ + files_[i].pathOffset, files_[i].pathLength), i);
+        }
+        std::unordered_map<std::string, bool> supported;
+        for (std::string& path : paths) {
+            std::string language = LanguageRules::detectLanguage(path);
+            auto it = supported.find(language);
+            if (it == supported.end()) {
+                it = supported.emplace(language, SymbolExtractor(language).isSupported()).first;
+            }
+            if (!it->second) {
+                continue;
+            }
+            PendingFile file{std::move(path), language, 0, 0, {}};
+            if (!statFile(file.path, file.size, file.mtime)) {
+                continue;
+            }
+            auto old = oldIds.find(file.path);
+            if (old != oldIds.end() && files_[old->second].size == file.size &&
+                files_[old->second].mtime == file.mtime) {
+                keptIds.push_back(old->second);
+            } else {
+                changed.push_back(std::move(file));
+            }
+        }
+        if (mapping_ && changed.empty() && keptIds.size() == fileCount_) {
+            return true;
+        }
+    }
+
+    // 分批并行解析，每批之间检查是否需要中止
+    std::vector<char> readable(changed.size(), 0);
+    uint64_t maxFileSize = options_.maxFileSize;
+    for (size_t start = 0; start < changed.size(); start += kIndexBatchSize) {
+        if (stopping_) {
+            return false;
+        }
+        size_t end = std::min(changed.size(), start + kIndexBatchSize);
+        for (size_t i = start; i < end; i++) {
+            pool_.submit([&changed, &readable, i, maxFileSize]() {
+                readable[i] = extractSymbols(changed[i], maxFileSize) ? 1 : 0;
+            });
+        }
+        pool_.wait();
+    }
+
+    std::vector<FileRecord> records;
+    std::vector<PendingSymbol> pending;
+    std::string strings = root_;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        // 文件按路径排序后编号，同名符号按文件和行排列
+        std::vector<std::pair<std::string_view, size_t>> order;  // 小于 changed.size() 的是新解析的文件
+        for (size_t i = 0; i < changed.size(); i++) {
+            if (readable[i]) {
+                order.emplace_back(changed[i].path, i);
+            }
+        }
+        for (uint32_t oldId : keptIds) {
+            order.emplace_back(std::string_view(strings_ + files_[oldId].pathOffset, files_[oldId].pathLength),
+                               changed.size() + oldId);
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<uint32_t> newIds(fileCount_, UINT32_MAX);
+        for (const auto& entry : order) {
+            uint32_t fileId = static_cast<uint32_t>(records.size());
+            if (entry.second < changed.size()) {
+                const PendingFile& file = changed[entry.second];
+                records.push_back(FileRecord{file.size, file.mtime, strings.size(),
+                                             static_cast<uint32_t>(file.path.size()), 0});
+                for (const Symbol& symbol : file.symbols) {
+                    pending.push_back(PendingSymbol{symbol.name, symbol.container, fileId,
+                                                    static_cast<uint32_t>(symbol.line),
+                                                    static_cast<uint32_t>(symbol.column),
+                                                    static_cast<uint8_t>(symbol.kind)});
+                }
+            } else {
+                const FileRecord& file = files_[entry.second - changed.size()];
+                newIds[entry.second - changed.size()] = fileId;
+                records.push_back(FileRecord{file.size, file.mtime, strings.size(), file.pathLength, 0});
+            }
+            strings.append(entry.first.data(), entry.first.size());
+        }
+        for (uint64_t i = 0; i < symbolCount_; i++) {
+            const SymbolRecord& symbol = symbols_[i];
+            if (newIds[symbol.fileId] != UINT32_MAX) {
+                pending.push_back(PendingSymbol{nameOf(symbol),
+                                                std::string_view(strings_ + symbol.containerOffset,
+                                                                 symbol.containerLength),
+                                                newIds[symbol.fileId], symbol.line, symbol.column, symbol.kind});
+            }
+        }
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const PendingSymbol& a, const PendingSymbol& b) {
+        if (a.name != b.name) {
+            return a.name < b.name;
+        }
+        return a.fileId != b.fileId ? a.fileId < b.fileId : a.line < b.line;
+    });
+    // 排序后同名符号相邻，名称只存一份
+    std::vector<SymbolRecord> symbols;
+    symbols.reserve(pending.size());
+    std::unordered_map<std::string_view, uint64_t> containers;
+    for (size_t i = 0; i < pending.size(); i++) {
+        const PendingSymbol& symbol = pending[i];
+        SymbolRecord record;
+        std::memset(&record, 0, sizeof(record));
+        if (i > 0 && pending[i - 1].name == symbol.name) {
+            record.nameOffset = symbols.back().nameOffset;
+        } else {
+            record.nameOffset = strings.size();
+            strings.append(symbol.name.data(), symbol.name.size());
+        }
+        record.nameLength = static_cast<uint32_t>(symbol.name.size());
+        if (!symbol.container.empty()) {
+            auto inserted = containers.emplace(symbol.container, strings.size());
+            if (inserted.second) {
+                strings.append(symbol.container.data(), symbol.container.size());
+            }
+            record.containerOffset = inserted.first->second;
+        }
+        record.containerLength = static_cast<uint32_t>(symbol.container.size());
+        record.fileId = symbol.fileId;
+        record.line = symbol.line;
+        record.column = symbol.column;
+        record.kind = symbol.kind;
+        symbols.push_back(record);
+    }
+
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kIndexMagic, sizeof(header.magic));
+    header.version = kIndexVersion;
+    header.fileCount = static_cast<uint32_t>(records.size());
+    header.symbolCount = symbols.size();
+    header.rootLength = static_cast<uint32_t>(root_.size());
+    header.filesOffset = sizeof(IndexHeader);
+    header.symbolsOffset = header.filesOffset + records.size() * sizeof(FileRecord);
+    header.stringsOffset = header.symbolsOffset + symbols.size() * sizeof(SymbolRecord);
+    header.stringsSize = strings.size();
+
+    std::error_code error;
+    std::filesystem::path target(indexPath_);
+    std::filesystem::create_directories(target.parent_path(), error);
+    std::string temporaryPath = indexPath_ + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write symbol index: " << temporaryPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(FileRecord));
+        file.write(reinterpret_cast<const char*>(symbols.data()), symbols.size() * sizeof(SymbolRecord));
+        file.write(strings.data(), strings.size());
+        if (!file) {
+            std::cerr << "Failed to write symbol index: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+    // 名称可能仍指向旧映射，必须在写完新文件之后才能解除映射
+    pending.clear();
+    std::filesystem::rename(temporaryPath, target, error);
+    if (error) {
+        std::cerr << "Failed to replace symbol index " << indexPath_ << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+    return mapIndex();
+}
+
+std::vector<ProjectSymbol> ProjectSymbolIndex::findDefinitions(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<ProjectSymbol> result;
+    const SymbolRecord* end = symbols_ + symbolCount_;
+    const SymbolRecord* it = std::lower_bound(symbols_, end, name, [this](const SymbolRecord& record,
+                                                                          const std::string& value) {
+        return nameOf(record) < value;
+    });
+    for (; it != end && nameOf(*it) == name; ++it) {
+        result.push_back(toSymbol(*it));
+    }
+    return result;
+}
+
+std::vector<ProjectSymbol> ProjectSymbolIndex::findByPrefix(const std::string& prefix, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<ProjectSymbol> result;
+    const SymbolRecord* end = symbols_ + symbolCount_;
+    const SymbolRecord* it = std::lower_bound(symbols_, end, prefix, [this](const SymbolRecord& record,
+                                                                            const std::string& value) {
+        return nameOf(record) < value;
+    });
+    for (; it != end && result.size() < limit && nameOf(*it).substr(0, prefix.size()) == prefix; ++it) {
+        result.push_back(toSymbol(*it));
+    }
+    return result;
+}
+
+size_t ProjectSymbolIndex::getSymbolCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return static_cast<size_t>(symbolCount_);
+}
+
+size_t ProjectSymbolIndex::getFileCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return fileCount_;
+}
+
+void ProjectSymbolIndex::reset() {
+    if (mapping_) {
+#ifdef _WIN32
+        delete[] mapping_;
+#else
+        ::munmap(const_cast<char*>(mapping_), mappingSize_);
+#endif
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    files_ = nullptr;
+    fileCount_ = 0;
+    symbols_ = nullptr;
+    symbolCount_ = 0;
+    strings_ = nullptr;
+    stringsSize_ = 0;
+}
+
+bool ProjectSymbolIndex::mapIndex() {
+    if (indexPath_.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    std::ifstream file(indexPath_, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(file.tellg());
+    if (size < sizeof(IndexHeader)) {
+        return false;
+    }
+    char* data = new char[size];
+    file.seekg(0);
+    file.read(data, size);
+    mapping_ = data;
+    mappingSize_ = size;
+#else
+    int fd = ::open(indexPath_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(IndexHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map symbol index: " << indexPath_ << std::endl;
+        return false;
+    }
+    mapping_ = static_cast<const char*>(data);
+    mappingSize_ = size;
+#endif
+
+    // 校验各区的位置，损坏或版本不符的索引文件直接丢弃
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(mapping_);
+    bool valid = std::memcmp(header->magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                 header->version == kIndexVersion && header->filesOffset == sizeof(IndexHeader) &&
+                 header->symbolsOffset == header->filesOffset + uint64_t(header->fileCount) * sizeof(FileRecord) &&
+                 header->symbolCount <= mappingSize_ / sizeof(SymbolRecord) &&
+                 header->stringsOffset == header->symbolsOffset + header->symbolCount * sizeof(SymbolRecord) &&
+                 header->stringsOffset + header->stringsSize == mappingSize_ &&
+                 header->rootLength <= header->stringsSize;
+    if (!valid || std::string(mapping_ + header->stringsOffset, header->rootLength) != root_) {
+        reset();
+        return false;
+    }
+    files_ = reinterpret_cast<const FileRecord*>(mapping_ + header->filesOffset);
+    fileCount_ = header->fileCount;
+    symbols_ = reinterpret_cast<const SymbolRecord*>(mapping_ + header->symbolsOffset);
+    symbolCount_ = header->symbolCount;
+    strings_ = mapping_ + header->stringsOffset;
+    stringsSize_ = header->stringsSize;
+
+    for (uint32_t i = 0; i < fileCount_; i++) {
+        if (files_[i].pathOffset + files_[i].pathLength > stringsSize_) {
+            reset();
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < symbolCount_; i++) {
+        const SymbolRecord& record = symbols_[i];
+        if (record.fileId >= fileCount_ || record.nameOffset + record.nameLength > stringsSize_ ||
+            record.containerOffset + record.containerLength > stringsSize_ ||
+            (i > 0 && nameOf(symbols_[i - 1]) > nameOf(record))) {
+            reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+ProjectSymbol ProjectSymbolIndex::toSymbol(const SymbolRecord& record) const {
+    const FileRecord& file = files_[record.fileId];
+    return ProjectSymbol{std::string(nameOf(record)),
+                         std::string(strings_ + record.containerOffset, record.containerLength),
+                         static_cast<SymbolKind>(record.kind),
+                         std::string(strings_ + file.pathOffset, file.pathLength),
+                         record.line,
+                         record.column};
+}
+
+std::string_view ProjectSymbolIndex::nameOf(const SymbolRecord& record) const {
+    return std::string_view(strings_ + record.nameOffset, record.nameLength);
+}
+
+bool ProjectSymbolIndex::extractSymbols(PendingFile& file, uint64_t maxFileSize) {
+    // 每个线程为每种语言保留一个提取器，避免每个文件重新构造词法规则
+    static thread_local std::unordered_map<std::string, std::unique_ptr<SymbolExtractor>> extractors;
+    file.symbols.clear();
+    std::string content;
+#ifdef _WIN32
+    if (!statFile(file.path, file.size, file.mtime)) {
+        return false;
+    }
+    if (file.size > maxFileSize) {
+        return true;
+    }
+    std::ifstream stream(file.path, std::ios::binary);
+    if (!stream.is_open()) {
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+#else
+    int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    file.size = static_cast<uint64_t>(info.st_size);
+    file.mtime = modificationTime(info);
+    if (file.size > maxFileSize) {
+        ::close(fd);
+        return true;
+    }
+    content.resize(static_cast<size_t>(file.size));
+    size_t total = 0;
+    while (total < content.size()) {
+        ssize_t count = ::read(fd, &content[total], content.size() - total);
+        if (count <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(count);
+    }
+    ::close(fd);
+    content.resize(total);
+#endif
+    if (FileSearcher::isBinary(content.data(), content.size())) {
+        return true;
+    }
+
+    std::unique_ptr<SymbolExtractor>& extractor = extractors[file.language];
+    if (!extractor) {
+        extractor.reset(new SymbolExtractor(file.language));
+    }
+    extractor->extract(content, file.symbols);
+    return true;
+}
+
+bool ProjectSymbolIndex::statFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+#ifdef _WIN32
+    std::error_code error;
+    std::filesystem::path filePath(path);
+    if (!std::filesystem::is_regular_file(filePath, error)) {
+        return false;
+    }
+    size = std::filesystem::file_size(filePath, error);
+    auto time = std::filesystem::last_write_time(filePath, error);
+    mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    return !error;
+#else
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    mtime = modificationTime(info);
+    return true;
+#endif
+}
@@ -0,0 +1,224 @@
+#ifndef PROJECT_SYMBOL_INDEX_H
+#define PROJECT_SYMBOL_INDEX_H
+
+#include "FileSearcher.h"
+#include "SymbolExtractor.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * 工作区中的符号定义
+ */
+struct ProjectSymbol {
+    std::string name;       // 名称
+    std::string container;  // 所属类名（没有则为空）
+    SymbolKind kind;        // 类型
+    std::string path;       // 所在文件
+    size_t line;            // 声明所在行（从0开始）
+    size_t column;          // 名称所在列（字节）
+};
+
+/**
+ * 工作区符号索引（用于跨文件转到定义）
+ * 与 ctags 类似：用编辑器的符号提取器（基于语法高亮的词法规则）在线程池中并行解析工作区内的源文件，
+ * 把全部符号按名称排序写入索引文件。查询时通过 mmap 直接在文件中二分查找，不需要把符号表载入内存。
+ *
+ * 索引文件同时记录每个文件的大小和修改时间，刷新时只重新解析发生变化的文件，
+ * 其余文件的符号从旧索引中原样复制
+ */
+class ProjectSymbolIndex {
+public:
+    ProjectSymbolIndex();
+    ~ProjectSymbolIndex();
+
+    ProjectSymbolIndex(const ProjectSymbolIndex&) = delete;
+    ProjectSymbolIndex& operator=(const ProjectSymbolIndex&) = delete;
+
+    /**
+     * 获取目录对应的默认索引文件路径（用户配置目录下的 index 子目录）
+     * @param root 工作区根目录
+     * @return 索引文件路径
+     */
+    static std::string defaultIndexPath(const std::string& root);
+
+    /**
+     * 设置遍历工作区时使用的选项（目录过滤、符号链接和文件大小上限）
+     * @param options 选项
+     */
+    void setOptions(const FileSearchOptions& options);
+
+    /**
+     * 打开工作区索引：同步载入已有的索引文件，然后在后台刷新
+     * @param root 工作区根目录
+     * @param indexPath 索引文件路径
+     */
+    void open(const std::string& root, const std::string& indexPath);
+
+    /**
+     * 停止后台刷新
+     */
+    void close();
+
+    /**
+     * 后台刷新是否已完成，完成后查询结果反映磁盘上的当前内容
+     * @return 是否就绪
+     */
+    bool isReady() const;
+
+    /**
+     * 获取工作区根目录
+     * @return 根目录
+     */
+    const std::string& getRoot() const;
+
+    /**
+     * 载入索引文件（根目录不一致或文件损坏时返回 false，索引保持为空）
+     * @param root 工作区根目录
+     * @param indexPath 索引文件路径
+     * @return 是否载入成功
+     */
+    bool load(const std::string& root, const std::string& indexPath);
+
+    /**
+     * 遍历根目录，重新解析大小或修改时间变化的文件，有变化时写入新的索引文件并重新映射
+     * @return 是否成功（被 close() 中止或写入失败时返回 false）
+     */
+    bool refresh();
+
+    /**
+     * 查找名称完全相同的符号
+     * @param name 名称
+     * @return 符号（按文件和行排序）
+     */
+    std::vector<ProjectSymbol> findDefinitions(const std::string& name) const;
+
+    /**
+     * 查找名称以 prefix 开头的符号
+     * @param prefix 前缀
+     * @param limit 最多返回的数量
+     * @return 符号（按名称排序）
+     */
+    std::vector<ProjectSymbol> findByPrefix(const std::string& prefix, size_t limit) const;
+
+    /**
+     * 获取索引中的符号数
+     * @return 符号数
+     */
+    size_t getSymbolCount() const;
+
+    /**
+     * 获取索引中的文件数
+     * @return 文件数
+     */
+    size_t getFileCount() const;
+
+private:
+    /**
+     * 索引文件中的符号记录（按名称、文件、行排序）
+     */
+    struct SymbolRecord {
+        uint64_t nameOffset;  // 在字符串区中的偏移
+        uint64_t containerOffset;
+        uint32_t nameLength;
+        uint32_t containerLength;
+        uint32_t fileId;
+        uint32_t line;
+        uint32_t column;
+        uint8_t kind;
+        uint8_t reserved[3];
+    };
+
+    /**
+     * 索引文件中的文件记录
+     */
+    struct FileRecord {
+        uint64_t size;
+        int64_t mtime;
+        uint64_t pathOffset;
+        uint32_t pathLength;
+        uint32_t reserved;
+    };
+
+    /**
+     * 待解析的文件
+     */
+    struct PendingFile {
+        std::string path;
+        std::string language;
+        uint64_t size;
+        int64_t mtime;
+        std::vector<Symbol> symbols;
+    };
+
+    FileSearchOptions options_;
+    std::string root_;
+    std::string indexPath_;
+
+    mutable std::shared_mutex mutex_;  // 保护以下映射状态
+    const char* mapping_;
+    size_t mappingSize_;
+    const FileRecord* files_;
+    uint32_t fileCount_;
+    const SymbolRecord* symbols_;
+    uint64_t symbolCount_;
+    const char* strings_;
+    uint64_t stringsSize_;
+
+    std::mutex updateMutex_;  // 串行化载入和刷新
+    std::atomic<bool> ready_;
+    std::atomic<bool> stopping_;
+    FileSearcher lister_;
+    ThreadPool pool_;
+    std::thread worker_;
+
+    /**
+     * 解除索引文件映射（需持有写锁）
+     */
+    void reset();
+
+    /**
+     * 映射并校验索引文件（需持有写锁）
+     * @return 是否成功
+     */
+    bool mapIndex();
+
+    /**
+     * 把记录转换为符号（需持有读锁）
+     * @param record 符号记录
+     * @return 符号
+     */
+    ProjectSymbol toSymbol(const SymbolRecord& record) const;
+
+    /**
+     * 获取记录中的名称（需持有读锁）
+     * @param record 符号记录
+     * @return 名称
+     */
+    std::string_view nameOf(const SymbolRecord& record) const;
+
+    /**
+     * 读取文件并提取符号
+     * @param file 待解析的文件，输出实际的大小、修改时间和符号
+     * @param maxFileSize 文件大小上限（超过时不提取符号）
+     * @return 是否能读取
+     */
+    static bool extractSymbols(PendingFile& file, uint64_t maxFileSize);
+
+    /**
+     * 获取文件大小和修改时间
+     * @param path 文件路径
+     * @param size 输出大小
+     * @param mtime 输出修改时间（纳秒）
+     * @return 是否为可访问的普通文件
+     */
+    static bool statFile(const std::string& path, uint64_t& size, int64_t& mtime);
+};
+
+#endif // PROJECT_SYMBOL_INDEX_H
@@ -0,0 +1,261 @@
+#include "SearchPattern.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+inline bool isAsciiAlnum(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/**
+ * 跳过从 pos 开始的字符类 [...]，返回其后的位置
+ */
+size_t skipCharacterClass(const std::string& regex, size_t pos) {
+    size_t i = pos + 1;
+    if (i < regex.size() && regex[i] == '^') {
+        i++;
+    }
+    if (i < regex.size() && regex[i] == ']') {
+        i++;
+    }
+    while (i < regex.size() && regex[i] != ']') {
+        i += regex[i] == '\\' ? 2 : 1;
+    }
+    return i + 1;
+}
+
+/**
+ * 跳过从 pos 开始的分组 (...)，返回其后的位置
+ */
+size_t skipGroup(const std::string& regex, size_t pos) {
+    int depth = 0;
+    size_t i = pos;
+    while (i < regex.size()) {
+        char c = regex[i];
+        if (c == '\\') {
+            i += 2;
+            continue;
+        }
+        if (c == '[') {
+            i = skipCharacterClass(regex, i);
+            continue;
+        }
+        if (c == '(') {
+            depth++;
+        } else if (c == ')' && --depth == 0) {
+            return i + 1;
+        }
+        i++;
+    }
+    return i;
+}
+
+}  // namespace
+
+SearchPattern::SearchPattern() : caseSensitive_(true), regex_(false), wholeWord_(false) {}
+
+bool SearchPattern::compile(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord) {
+    pattern_ = pattern;
+    caseSensitive_ = caseSensitive;
+    regex_ = regex;
+    wholeWord_ = wholeWord;
+    literals_.clear();
+    if (pattern.empty()) {
+        return false;
+    }
+
+    if (!regex) {
+        literals_.push_back(pattern);
+        literalSearch_.setPattern(pattern, caseSensitive, wholeWord);
+        return true;
+    }
+
+    try {
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (!caseSensitive) {
+            flags |= std::regex::icase;
+        }
+        compiled_.assign(pattern, flags);
+    } catch (const std::regex_error& e) {
+        std::cerr << "Invalid regular expression '" << pattern << "': " << e.what() << std::endl;
+        return false;
+    }
+    literals_ = extractRequiredLiterals(pattern);
+    std::string longest;
+    for (const std::string& literal : literals_) {
+        if (literal.size() > longest.size()) {
+            longest = literal;
+        }
+    }
+    literalSearch_.setPattern(longest, caseSensitive);
+    return true;
+}
+
+const std::string& SearchPattern::getPattern() const {
+    return pattern_;
+}
+
+bool SearchPattern::isRegex() const {
+    return regex_;
+}
+
+bool SearchPattern::isCaseSensitive() const {
+    return caseSensitive_;
+}
+
+bool SearchPattern::isWholeWord() const {
+    return wholeWord_;
+}
+
+const std::vector<std::string>& SearchPattern::getRequiredLiterals() const {
+    return literals_;
+}
+
+bool SearchPattern::findNext(const char* data, size_t length, size_t from, size_t& matchStart,
+                             size_t& matchLength) const {
+    if (!regex_) {
+        size_t pos = literalSearch_.find(data, length, from);
+        if (pos == std::string::npos) {
+            return false;
+        }
+        matchStart = pos;
+        matchLength = literalSearch_.getPattern().size();
+        return true;
+    }
+
+    // 不是完整单词的正则匹配跳过，从下一个字节继续查找
+    size_t pos = from;
+    while (findRegex(data, length, pos, matchStart, matchLength)) {
+        if (!wholeWord_ || TextSearch::isWholeWord(data, length, matchStart, matchLength)) {
+            return true;
+        }
+        pos = matchStart + 1;
+    }
+    return false;
+}
+
+bool SearchPattern::findRegex(const char* data, size_t length, size_t from, size_t& matchStart,
+                              size_t& matchLength) const {
+    bool prefilter = !literalSearch_.getPattern().empty();
+    size_t pos = from;
+    while (pos <= length) {
+        size_t start = pos;
+        if (prefilter) {
+            // 先找到含有必需字面量的行，正则只在这一行上运行
+            size_t hit = literalSearch_.find(data, length, pos);
+            if (hit == std::string::npos) {
+                return false;
+            }
+            size_t lineStart = hit;
+            while (lineStart > pos && data[lineStart - 1] != '\n') {
+                lineStart--;
+            }
+            start = lineStart;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(data + start, '\n', length - start));
+        size_t lineEnd = newline ? static_cast<size_t>(newline - data) : length;
+
+        // 从行中间开始时告诉正则引擎前一个字符可用，使 ^ 和 \b 的判断正确
+        auto flags = std::regex_constants::match_default;
+        if (start > 0 && data[start - 1] != '\n') {
+            flags |= std::regex_constants::match_prev_avail;
+        }
+        std::cmatch match;
+        if (std::regex_search(data + start, data + lineEnd, match, compiled_, flags)) {
+            matchStart = start + static_cast<size_t>(match.position(0));
+            matchLength = static_cast<size_t>(match.length(0));
+            return true;
+        }
+        pos = lineEnd + 1;
+    }
+    return false;
+}
+
+bool SearchPattern::matchesAt(const char* data, size_t length, size_t position) const {
+    size_t size = literalSearch_.getPattern().size();
+    return !regex_ && size > 0 && position <= length && length - position >= size &&
+           literalSearch_.matchesAt(data + position) &&
+           (!wholeWord_ || TextSearch::isWholeWord(data, length, position, size));
+}
+
+std::vector<std::string> SearchPattern::extractRequiredLiterals(const std::string& regex) {
+    std::vector<std::string> result;
+    std::string current;
+    bool lastWasLiteral = false;
+    auto flush = [&]() {
+        if (!current.empty()) {
+            result.push_back(current);
+            current.clear();
+        }
+        lastWasLiteral = false;
+    };
+
+    size_t i = 0;
+    while (i < regex.size()) {
+        char c = regex[i];
+        switch (c) {
+        case '\\': {
+            char next = i + 1 < regex.size() ? regex[i + 1] : '\0';
+            if (next == 't') {
+                current.push_back('\t');
+                lastWasLiteral = true;
+            } else if (next != '\0' && !isAsciiAlnum(next)) {
+                current.push_back(next);
+                lastWasLiteral = true;
+            } else {
+                // \d、\w、\b、反向引用等不是固定字符
+                flush();
+            }
+            i += 2;
+            break;
+        }
+        case '[':
+            flush();
+            i = skipCharacterClass(regex, i);
+            break;
+        case '(':
+            flush();
+            i = skipGroup(regex, i);
+            break;
+        case '|':
+            return {};
+        case '*':
+        case '?':
+            // 前一个字符可以不出现
+            if (lastWasLiteral) {
+                current.pop_back();
+            }
+            flush();
+            i++;
+            break;
+        case '+':
+            flush();
+            i++;
+            break;
+        case '{': {
+            size_t close = regex.find('}', i);
+            if (lastWasLiteral && i + 1 < regex.size() && regex[i + 1] == '0') {
+                current.pop_back();
+            }
+            flush();
+            i = close == std::string::npos ? regex.size() : close + 1;
+            break;
+        }
+        case '.':
+        case '^':
+        case '$':
+        case ')':
+            flush();
+            i++;
+            break;
+        default:
+            current.push_back(c);
+            lastWasLiteral = true;
+            i++;
+            break;
+        }
+    }
+    flush();
+    return result;
+}
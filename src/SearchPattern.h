@@ -0,0 +1,109 @@
+#ifndef SEARCH_PATTERN_H
+#define SEARCH_PATTERN_H
+
+#include "TextSearch.h"
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * 编译后的查找条件
+ * 普通文本直接交给 TextSearch；正则表达式按行匹配（与 grep 一致），
+ * 并先用 TextSearch 查找其中必须出现的字面量，只在含有该字面量的行上运行正则。
+ * 全字匹配对两种查找条件都在找到匹配后检查单词边界（TextSearch::isWholeWord）
+ */
+class SearchPattern {
+public:
+    SearchPattern();
+
+    /**
+     * 编译查找条件
+     * @param pattern 查找文本或正则表达式（ECMAScript 语法）
+     * @param caseSensitive 是否区分大小写
+     * @param regex 是否为正则表达式
+     * @param wholeWord 是否全字匹配
+     * @return 是否成功（为空或正则表达式语法错误时返回 false）
+     */
+    bool compile(const std::string& pattern, bool caseSensitive, bool regex, bool wholeWord = false);
+
+    /**
+     * 获取原始查找条件
+     * @return 查找文本或正则表达式
+     */
+    const std::string& getPattern() const;
+
+    /**
+     * 是否为正则表达式
+     * @return 是否为正则表达式
+     */
+    bool isRegex() const;
+
+    /**
+     * 是否区分大小写
+     * @return 是否区分大小写
+     */
+    bool isCaseSensitive() const;
+
+    /**
+     * 是否全字匹配
+     * @return 是否全字匹配
+     */
+    bool isWholeWord() const;
+
+    /**
+     * 获取所有匹配都必须包含的字面量（普通文本即其本身）
+     * @return 字面量列表，为空表示无法确定
+     */
+    const std::vector<std::string>& getRequiredLiterals() const;
+
+    /**
+     * 查找下一个匹配
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param from 开始查找位置
+     * @param matchStart 输出匹配位置
+     * @param matchLength 输出匹配长度（正则表达式可能为 0）
+     * @return 是否找到
+     */
+    bool findNext(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const;
+
+    /**
+     * 检查普通文本是否恰好出现在指定位置（正则表达式总是返回 false）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param position 位置
+     * @return 是否匹配
+     */
+    bool matchesAt(const char* data, size_t length, size_t position) const;
+
+    /**
+     * 从正则表达式中提取必须出现的字面量
+     * 只分析顶层的普通字符序列，分组、字符类和元字符都视为断开；
+     * 顶层含有选择分支时无法确定，返回空列表
+     * @param regex 正则表达式
+     * @return 字面量列表
+     */
+    static std::vector<std::string> extractRequiredLiterals(const std::string& regex);
+
+private:
+    std::string pattern_;
+    bool caseSensitive_;
+    bool regex_;
+    bool wholeWord_;
+    std::regex compiled_;
+    TextSearch literalSearch_;  // 普通文本本身，或正则表达式中最长的必需字面量
+    std::vector<std::string> literals_;
+
+    /**
+     * 查找下一个正则匹配（不检查全字匹配）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param from 开始查找位置
+     * @param matchStart 输出匹配位置
+     * @param matchLength 输出匹配长度
+     * @return 是否找到
+     */
+    bool findRegex(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const;
+};
+
+#endif // SEARCH_PATTERN_H
@@ -0,0 +1,557 @@
+#include "SymbolExtractor.h"
+#include "LineIndex.h"
+#include <algorithm>
+
+namespace {
+
+const size_t kNoLine = static_cast<size_t>(-1);
+
+std::string_view trimLeft(std::string_view text) {
+    size_t pos = 0;
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        pos++;
+    }
+    return text.substr(pos);
+}
+
+bool endsWithBackslash(std::string_view text) {
+    size_t end = text.size();
+    while (end > 0 && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) {
+        end--;
+    }
+    return end > 0 && text[end - 1] == '\\';
+}
+
+int indentWidth(std::string_view text) {
+    int indent = 0;
+    for (char c : text) {
+        if (c == ' ') {
+            indent++;
+        } else if (c == '\t') {
+            indent = (indent / 8 + 1) * 8;
+        } else {
+            break;
+        }
+    }
+    return indent;
+}
+
+bool hasCode(const std::vector<SyntaxToken>& tokens) {
+    for (const SyntaxToken& token : tokens) {
+        if (token.type != SyntaxTokenType::Comment) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 花括号前语句的含义
+ */
+enum class BraceRole { Namespace, Class, Struct, Function, Initializer, Other };
+
+/**
+ * 根据花括号之前的语句判断花括号的含义
+ * @param text 文档内容
+ * @param pending 语句中的记号（不含注释）
+ * @param name 输出名称
+ * @param container 输出显式限定的类名
+ * @param nameToken 输出名称记号下标
+ */
+BraceRole classifyBrace(std::string_view text, const std::vector<SyntaxToken>& pending, std::string& name,
+                        std::string& container, size_t& nameToken) {
+    auto word = [&](size_t i) { return text.substr(pending[i].start, pending[i].length); };
+    auto isIdentifier = [&](size_t i) { return pending[i].type == SyntaxTokenType::Identifier; };
+    size_t count = pending.size();
+
+    // 跳过 Java 注解和 C++ 模板参数列表
+    size_t first = 0;
+    while (first < count) {
+        if (word(first) == "@" && first + 1 < count) {
+            first += 2;
+            if (first < count && word(first) == "(") {
+                int depth = 0;
+                for (; first < count; ++first) {
+                    depth += word(first) == "(" ? 1 : (word(first) == ")" ? -1 : 0);
+                    if (depth == 0) {
+                        first++;
+                        break;
+                    }
+                }
+            }
+            continue;
+        }
+        if (word(first) == "template") {
+            int depth = 0;
+            for (first++; first < count; ++first) {
+                bool closes = false;
+                for (char c : word(first)) {
+                    if (c == '<') {
+                        depth++;
+                    } else if (c == '>') {
+                        depth--;
+                        closes = true;
+                    }
+                }
+                if (closes && depth <= 0) {
+                    first++;
+                    break;
+                }
+            }
+            continue;
+        }
+        break;
+    }
+    if (first >= count) {
+        return BraceRole::Other;
+    }
+
+    size_t paren = kNoLine;
+    size_t keyword = kNoLine;
+    bool assignment = false;
+    for (size_t i = first; i < count; ++i) {
+        std::string_view w = word(i);
+        if (w == "namespace") {
+            name = i + 1 < count && isIdentifier(i + 1) ? std::string(word(i + 1)) : std::string();
+            return BraceRole::Namespace;
+        }
+        if (paren == kNoLine && pending[i].type == SyntaxTokenType::Bracket && w == "(") {
+            paren = i;
+        }
+        if (keyword == kNoLine && (w == "class" || w == "struct" || w == "union" || w == "interface" ||
+                                   w == "enum" || w == "record")) {
+            keyword = i;
+        }
+        if (paren == kNoLine && w == "=") {
+            assignment = true;
+        }
+    }
+    if (word(first) == "extern" && first + 1 < count && pending[first + 1].type == SyntaxTokenType::String) {
+        name.clear();
+        return BraceRole::Namespace;
+    }
+
+    // 构造函数初始化列表中的成员花括号初始化，如 Foo() : a_{1} {
+    if (paren != kNoLine) {
+        int depth = 0;
+        size_t close = kNoLine;
+        for (size_t i = paren; i < count && close == kNoLine; ++i) {
+            if (pending[i].type == SyntaxTokenType::Bracket) {
+                depth += word(i) == "(" ? 1 : (word(i) == ")" ? -1 : 0);
+                if (depth == 0) {
+                    close = i;
+                }
+            }
+        }
+        if (close != kNoLine && close + 1 < count && word(close + 1) == ":" && isIdentifier(count - 1)) {
+            return BraceRole::Initializer;
+        }
+    }
+
+    // 类、结构体：关键字后的最后一个标识符为名称（跳过导出宏等修饰）
+    if (keyword != kNoLine && (paren == kNoLine || keyword < paren)) {
+        std::string_view kind = word(keyword);
+        if (kind == "enum") {
+            return BraceRole::Other;
+        }
+        size_t end = keyword + 1;
+        while (end < count && isIdentifier(end)) {
+            end++;
+        }
+        if (end > keyword + 1) {
+            std::string_view next = end < count ? word(end) : std::string_view();
+            if (next.empty() || next == ":" || next[0] == '<' || next == "final" || next == "extends" ||
+                next == "implements" || next == "(") {
+                name = std::string(word(end - 1));
+                nameToken = end - 1;
+                return kind == "struct" || kind == "union" ? BraceRole::Struct : BraceRole::Class;
+            }
+        }
+    }
+
+    // 函数定义：第一个左圆括号前的标识符为名称
+    if (paren != kNoLine && paren > first && !assignment) {
+        size_t index = paren - 1;
+        if (isIdentifier(index)) {
+            name = std::string(word(index));
+        } else if (pending[index].type == SyntaxTokenType::Operator && index > first &&
+                   word(index - 1) == "operator") {
+            name = "operator" + std::string(word(index));
+            index--;
+        } else {
+            return BraceRole::Other;
+        }
+        nameToken = index;
+        container.clear();
+        if (index > first) {
+            std::string_view qualifier = word(index - 1);
+            if (qualifier == "~" || qualifier == "::~") {
+                name = "~" + name;
+                nameToken = index - 1;
+            }
+            if ((qualifier == "::" || qualifier == "::~") && index - 1 > first && isIdentifier(index - 2)) {
+                container = std::string(word(index - 2));
+            }
+        }
+        return BraceRole::Function;
+    }
+
+    // JavaScript 函数表达式和箭头函数：[const|let|var] name = ... => {
+    size_t index = first;
+    std::string_view declarator = word(index);
+    if (declarator == "const" || declarator == "let" || declarator == "var" || declarator == "static") {
+        index++;
+    }
+    if (index + 1 < count && isIdentifier(index) && word(index + 1) == "=") {
+        for (size_t i = index + 2; i < count; ++i) {
+            std::string_view w = word(i);
+            if (w == "function" || w.find("=>") != std::string_view::npos) {
+                name = std::string(word(index));
+                nameToken = index;
+                container.clear();
+                return BraceRole::Function;
+            }
+        }
+    }
+    return BraceRole::Other;
+}
+
+}  // namespace
+
+SymbolExtractor::SymbolExtractor() : mode_(Mode::None) {}
+
+SymbolExtractor::SymbolExtractor(const std::string& language) : mode_(Mode::None) {
+    setLanguage(language);
+}
+
+void SymbolExtractor::setLanguage(const std::string& language) {
+    language_ = language;
+    lexer_.setRules(LanguageRules::forLanguage(language));
+    if (language == "C" || language == "C++" || language == "Java" || language == "JavaScript") {
+        mode_ = Mode::Braces;
+    } else if (language == "Python") {
+        mode_ = Mode::Indentation;
+    } else {
+        mode_ = Mode::None;
+    }
+}
+
+const std::string& SymbolExtractor::getLanguage() const {
+    return language_;
+}
+
+bool SymbolExtractor::isSupported() const {
+    return mode_ != Mode::None;
+}
+
+size_t SymbolExtractor::scan(std::string_view text, const LineIndex& lines, size_t firstLine,
+                             std::vector<SymbolScope> scopes,
+                             const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                             std::vector<SymbolChunk>& chunks) const {
+    if (mode_ == Mode::Braces) {
+        return scanBraces(text, lines, firstLine, std::move(scopes), canResync, chunks);
+    }
+    if (mode_ == Mode::Indentation) {
+        return scanIndentation(text, lines, firstLine, std::move(scopes), canResync, chunks);
+    }
+    return lines.getLineCount();
+}
+
+size_t SymbolExtractor::scanBraces(std::string_view text, const LineIndex& lines, size_t firstLine,
+                                   std::vector<SymbolScope> scopes,
+                                   const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                                   std::vector<SymbolChunk>& chunks) const {
+    size_t lineCount = lines.getLineCount();
+    bool cFamily = language_ == "C" || language_ == "C++";
+
+    LexState lexState;
+    std::vector<SyntaxToken> tokens;
+    std::vector<SyntaxToken> pending;  // 当前语句中的记号
+    size_t otherDepth = 0;             // 函数体等非容器花括号的嵌套深度
+    size_t parenDepth = 0;
+    bool keepPending = false;          // 当前非容器花括号属于语句的一部分（初始化列表、参数中的 lambda）
+    bool inFunction = false;
+    bool directive = false;            // 预处理指令续行
+    SymbolEvent function{};
+
+    for (size_t line = firstLine; line < lineCount; ++line) {
+        bool boundary = lexState.mode == LexState::Mode::Normal && otherDepth == 0 && parenDepth == 0 &&
+                        pending.empty() && !directive;
+        if (line != firstLine && boundary && canResync(line, scopes)) {
+            return line;
+        }
+        if (line == firstLine || boundary) {
+            chunks.push_back(SymbolChunk{line, 0, kNoLine, scopes, {}});
+        }
+        SymbolChunk& chunk = chunks.back();
+        size_t base = chunk.firstLine;
+        chunk.lineCount = line - base + 1;
+
+        size_t start = lines.getLineStart(line);
+        std::string_view lineText = text.substr(start, lines.getLineEnd(line) - start);
+        LexState entry = lexState;
+        tokens.clear();
+        lexState = lexer_.tokenize(lineText.data(), lineText.size(), lexState, tokens, start);
+
+        // 预处理指令（含反斜杠续行）不参与声明识别
+        if (cFamily && (directive || (entry.mode == LexState::Mode::Normal && !trimLeft(lineText).empty() &&
+                                      trimLeft(lineText)[0] == '#'))) {
+            directive = endsWithBackslash(lineText);
+            chunk.lastContentLine = line - base;
+            continue;
+        }
+        if (entry.mode != LexState::Mode::Normal || hasCode(tokens)) {
+            chunk.lastContentLine = line - base;
+        }
+
+        for (const SyntaxToken& token : tokens) {
+            if (token.type == SyntaxTokenType::Comment) {
+                continue;
+            }
+            std::string_view word = text.substr(token.start, token.length);
+
+            if (token.type == SyntaxTokenType::Bracket) {
+                char c = word[0];
+                if (otherDepth > 0) {
+                    if (c == '{') {
+                        otherDepth++;
+                    } else if (c == '}' && --otherDepth == 0) {
+                        if (keepPending) {
+                            pending.push_back(token);
+                            keepPending = false;
+                        } else {
+                            if (inFunction) {
+                                function.endLine = line - base;
+                                chunk.events.push_back(function);
+                                inFunction = false;
+                            }
+                            pending.clear();
+                        }
+                    }
+                    continue;
+                }
+                if (c == '(' || c == '[') {
+                    parenDepth++;
+                    pending.push_back(token);
+                } else if (c == ')' || c == ']') {
+                    parenDepth = parenDepth > 0 ? parenDepth - 1 : 0;
+                    pending.push_back(token);
+                } else if (c == '{' && parenDepth > 0) {
+                    otherDepth = 1;
+                    keepPending = true;
+                } else if (c == '{') {
+                    std::string name;
+                    std::string container;
+                    size_t nameToken = 0;
+                    BraceRole role = classifyBrace(text, pending, name, container, nameToken);
+                    size_t nameLine = 0;
+                    size_t nameColumn = 0;
+                    if (role == BraceRole::Class || role == BraceRole::Struct || role == BraceRole::Function) {
+                        nameLine = lines.getLineOfOffset(pending[nameToken].start);
+                        nameColumn = pending[nameToken].start - lines.getLineStart(nameLine);
+                    }
+                    switch (role) {
+                        case BraceRole::Namespace:
+                            scopes.push_back({SymbolScope::Kind::Namespace, 0, name});
+                            pending.clear();
+                            break;
+                        case BraceRole::Class:
+                        case BraceRole::Struct: {
+                            SymbolKind kind = role == BraceRole::Class ? SymbolKind::Class : SymbolKind::Struct;
+                            scopes.push_back({role == BraceRole::Class ? SymbolScope::Kind::Class
+                                                                       : SymbolScope::Kind::Struct,
+                                              0, name});
+                            chunk.events.push_back({SymbolEvent::Type::Open, kind, nameLine - base, nameColumn,
+                                                    kNoLine, name, std::string()});
+                            pending.clear();
+                            break;
+                        }
+                        case BraceRole::Function:
+                            function = {SymbolEvent::Type::Declare, SymbolKind::Function, nameLine - base,
+                                        nameColumn, kNoLine, name, container};
+                            inFunction = true;
+                            otherDepth = 1;
+                            keepPending = false;
+                            break;
+                        case BraceRole::Initializer:
+                            pending.push_back(token);
+                            otherDepth = 1;
+                            keepPending = true;
+                            break;
+                        case BraceRole::Other:
+                            otherDepth = 1;
+                            keepPending = false;
+                            break;
+                    }
+                } else if (c == '}') {
+                    if (!scopes.empty()) {
+                        if (scopes.back().kind != SymbolScope::Kind::Namespace) {
+                            chunk.events.push_back({SymbolEvent::Type::Close, SymbolKind::Class, line - base, 0,
+                                                    line - base, std::string(), std::string()});
+                        }
+                        scopes.pop_back();
+                    }
+                    pending.clear();
+                }
+                continue;
+            }
+
+            if (otherDepth > 0) {
+                continue;
+            }
+            if (token.type == SyntaxTokenType::Operator && parenDepth == 0 &&
+                word.find(';') != std::string_view::npos) {
+                pending.clear();
+                continue;
+            }
+            // 访问说明符 public: / private: / protected:
+            if (word == ":" && pending.size() == 1) {
+                std::string_view previous = text.substr(pending[0].start, pending[0].length);
+                if (previous == "public" || previous == "private" || previous == "protected") {
+                    pending.clear();
+                    continue;
+                }
+            }
+            pending.push_back(token);
+        }
+    }
+    return lineCount;
+}
+
+size_t SymbolExtractor::scanIndentation(std::string_view text, const LineIndex& lines, size_t firstLine,
+                                        std::vector<SymbolScope> scopes,
+                                        const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                                        std::vector<SymbolChunk>& chunks) const {
+    size_t lineCount = lines.getLineCount();
+    LexState lexState;
+    std::vector<SyntaxToken> tokens;
+    size_t parenDepth = 0;
+    bool continuation = false;
+
+    for (size_t line = firstLine; line < lineCount; ++line) {
+        size_t start = lines.getLineStart(line);
+        std::string_view lineText = text.substr(start, lines.getLineEnd(line) - start);
+        bool atStatement = lexState.mode == LexState::Mode::Normal && parenDepth == 0 && !continuation;
+        LexState entry = lexState;
+        tokens.clear();
+        lexState = lexer_.tokenize(lineText.data(), lineText.size(), lexState, tokens, start);
+        bool code = hasCode(tokens);
+
+        // 只有语句起始的非空行才是分块边界
+        bool boundary = atStatement && code;
+        if (line != firstLine && boundary && canResync(line, scopes)) {
+            return line;
+        }
+        if (line == firstLine || boundary) {
+            chunks.push_back(SymbolChunk{line, 0, kNoLine, scopes, {}});
+        }
+        SymbolChunk& chunk = chunks.back();
+        size_t base = chunk.firstLine;
+        chunk.lineCount = line - base + 1;
+
+        if (boundary) {
+            int indent = indentWidth(lineText);
+            while (!scopes.empty() && scopes.back().indent >= indent) {
+                chunk.events.push_back({SymbolEvent::Type::Close, SymbolKind::Class, line - base, 0, kNoLine,
+                                        std::string(), std::string()});
+                scopes.pop_back();
+            }
+
+            size_t index = 0;
+            auto word = [&](size_t i) { return text.substr(tokens[i].start, tokens[i].length); };
+            if (index < tokens.size() && word(index) == "async") {
+                index++;
+            }
+            if (index + 1 < tokens.size() && (word(index) == "def" || word(index) == "class") &&
+                tokens[index + 1].type == SyntaxTokenType::Identifier) {
+                bool isClass = word(index) == "class";
+                std::string name(word(index + 1));
+                chunk.events.push_back({SymbolEvent::Type::Open, isClass ? SymbolKind::Class : SymbolKind::Function,
+                                        line - base, tokens[index + 1].start - start, kNoLine, name, std::string()});
+                scopes.push_back({isClass ? SymbolScope::Kind::Class : SymbolScope::Kind::Function, indent, name});
+            }
+        }
+
+        for (const SyntaxToken& token : tokens) {
+            if (token.type != SyntaxTokenType::Bracket) {
+                continue;
+            }
+            char c = text[token.start];
+            if (c == '(' || c == '[' || c == '{') {
+                parenDepth++;
+            } else if (parenDepth > 0) {
+                parenDepth--;
+            }
+        }
+        continuation = lexState.mode == LexState::Mode::Normal && endsWithBackslash(lineText) &&
+                       (tokens.empty() || tokens.back().type != SyntaxTokenType::Comment);
+        if (entry.mode != LexState::Mode::Normal || code) {
+            chunk.lastContentLine = line - base;
+        }
+    }
+    return lineCount;
+}
+
+void SymbolExtractor::assemble(const std::vector<SymbolChunk>& chunks, size_t lineCount, std::vector<Symbol>& symbols,
+                               std::vector<size_t>& parents) {
+    symbols.clear();
+    parents.clear();
+    std::vector<size_t> open;  // 尚未闭合的容器符号
+    size_t lastContentLine = 0;
+
+    auto add = [&](const SymbolEvent& event, size_t line, size_t endLine) {
+        size_t parent = open.empty() ? kNoLine : open.back();
+        Symbol symbol{event.name, event.container, event.kind, line, event.column, endLine};
+        if (symbol.kind == SymbolKind::Function) {
+            if (!symbol.container.empty()) {
+                symbol.kind = SymbolKind::Method;
+            } else if (parent != kNoLine &&
+                       (symbols[parent].kind == SymbolKind::Class || symbols[parent].kind == SymbolKind::Struct)) {
+                symbol.kind = SymbolKind::Method;
+                symbol.container = symbols[parent].name;
+            }
+        }
+        symbols.push_back(std::move(symbol));
+        parents.push_back(parent);
+        return symbols.size() - 1;
+    };
+
+    for (const SymbolChunk& chunk : chunks) {
+        for (const SymbolEvent& event : chunk.events) {
+            size_t line = chunk.firstLine + event.line;
+            switch (event.type) {
+                case SymbolEvent::Type::Declare:
+                    add(event, line, chunk.firstLine + event.endLine);
+                    break;
+                case SymbolEvent::Type::Open:
+                    open.push_back(add(event, line, line));
+                    break;
+                case SymbolEvent::Type::Close:
+                    if (!open.empty()) {
+                        symbols[open.back()].endLine =
+                            event.endLine == kNoLine ? lastContentLine : chunk.firstLine + event.endLine;
+                        open.pop_back();
+                    }
+                    break;
+            }
+        }
+        if (chunk.lastContentLine != kNoLine) {
+            lastContentLine = chunk.firstLine + chunk.lastContentLine;
+        }
+    }
+
+    // 文档结束时仍未闭合的容器延伸到最后一个内容行
+    size_t lastLine = lineCount > 0 ? lineCount - 1 : 0;
+    for (size_t index : open) {
+        symbols[index].endLine = std::max(symbols[index].line, std::min(lastContentLine, lastLine));
+    }
+}
+
+void SymbolExtractor::extract(std::string_view text, std::vector<Symbol>& symbols) const {
+    LineIndex lines;
+    lines.rebuild(text.data(), text.size());
+    std::vector<SymbolChunk> chunks;
+    scan(text, lines, 0, {}, [](size_t, const std::vector<SymbolScope>&) { return false; }, chunks);
+    std::vector<size_t> parents;
+    assemble(chunks, lines.getLineCount(), symbols, parents);
+}
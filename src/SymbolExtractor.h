@@ -0,0 +1,165 @@
+#ifndef SYMBOL_EXTRACTOR_H
+#define SYMBOL_EXTRACTOR_H
+
+#include "SyntaxLexer.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class LineIndex;
+
+/**
+ * 符号类型
+ */
+enum class SymbolKind : uint8_t {
+    Function,  // 自由函数
+    Method,    // 类或结构体的成员函数
+    Class,     // 类、接口
+    Struct     // 结构体、联合体
+};
+
+/**
+ * 符号声明
+ */
+struct Symbol {
+    std::string name;       // 名称
+    std::string container;  // 所属类名（没有则为空）
+    SymbolKind kind;        // 类型
+    size_t line;            // 声明所在行（从0开始）
+    size_t column;          // 名称所在列（字节）
+    size_t endLine;         // 定义结束行（包含）
+};
+
+/**
+ * 扫描上下文中尚未闭合的作用域
+ */
+struct SymbolScope {
+    enum class Kind : uint8_t { Namespace, Class, Struct, Function };
+
+    Kind kind;
+    int indent;        // 缩进宽度（仅 Python 使用）
+    std::string name;
+
+    bool operator==(const SymbolScope& other) const {
+        return kind == other.kind && indent == other.indent && name == other.name;
+    }
+
+    bool operator!=(const SymbolScope& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * 分块扫描产生的符号事件，行号相对于所在分块的起始行
+ */
+struct SymbolEvent {
+    enum class Type : uint8_t {
+        Declare,  // 完整的函数定义（起止行已知）
+        Open,     // 打开容器（类、结构体、Python 函数）
+        Close     // 关闭最内层容器
+    };
+
+    Type type;
+    SymbolKind kind;
+    size_t line;
+    size_t column;
+    size_t endLine;         // Declare/Close 的结束行，Close 为 npos 时表示结束于上一个内容行
+    std::string name;
+    std::string container;  // 显式限定的类名，如 Foo::bar 中的 Foo
+};
+
+/**
+ * 符号分块
+ * 分块从“语句边界”开始：该行行首不在注释、字符串、括号或函数体内部，
+ * 此时扫描状态完全由作用域栈描述，因此可以从任意分块起点恢复扫描
+ */
+struct SymbolChunk {
+    size_t firstLine;                 // 起始行
+    size_t lineCount;                 // 行数
+    size_t lastContentLine;           // 最后一个内容行（相对行号，没有则为 npos）
+    std::vector<SymbolScope> scopes;  // 起始处的作用域栈
+    std::vector<SymbolEvent> events;  // 符号事件
+};
+
+/**
+ * 符号提取器
+ * 基于 SyntaxLexer 的记号流识别函数、方法、类和结构体声明：
+ * 花括号语言（C/C++/Java/JavaScript）按语句识别，函数体整体跳过；
+ * Python 按缩进识别 def/class
+ */
+class SymbolExtractor {
+public:
+    SymbolExtractor();
+    explicit SymbolExtractor(const std::string& language);
+
+    /**
+     * 设置语言
+     * @param language 语言名称
+     */
+    void setLanguage(const std::string& language);
+
+    /**
+     * 获取语言
+     * @return 语言名称
+     */
+    const std::string& getLanguage() const;
+
+    /**
+     * 当前语言是否支持符号提取
+     * @return 是否支持
+     */
+    bool isSupported() const;
+
+    /**
+     * 从分块起点开始扫描
+     * 每到达一个新的分块边界都会询问 canResync，返回 true 时停止扫描，
+     * 调用方据此把之后的旧分块直接拼接回来
+     * @param text 文档内容
+     * @param lines 文档行索引
+     * @param firstLine 起始行（必须是分块边界）
+     * @param scopes 起始处的作用域栈
+     * @param canResync 判断能否在指定行与旧结果重新同步
+     * @param chunks 输出分块，追加到末尾
+     * @return 停止扫描的行号（扫描到文档末尾时为行数）
+     */
+    size_t scan(std::string_view text, const LineIndex& lines, size_t firstLine, std::vector<SymbolScope> scopes,
+                const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                std::vector<SymbolChunk>& chunks) const;
+
+    /**
+     * 由分块组装符号列表（按声明行升序）
+     * @param chunks 分块
+     * @param lineCount 文档行数
+     * @param symbols 输出符号
+     * @param parents 输出每个符号的外层符号下标（没有则为 npos）
+     */
+    static void assemble(const std::vector<SymbolChunk>& chunks, size_t lineCount, std::vector<Symbol>& symbols,
+                         std::vector<size_t>& parents);
+
+    /**
+     * 一次性提取整篇文档的符号
+     * @param text 文档内容
+     * @param symbols 输出符号
+     */
+    void extract(std::string_view text, std::vector<Symbol>& symbols) const;
+
+private:
+    enum class Mode : uint8_t { None, Braces, Indentation };
+
+    std::string language_;
+    Mode mode_;
+    SyntaxLexer lexer_;
+
+    size_t scanBraces(std::string_view text, const LineIndex& lines, size_t firstLine,
+                      std::vector<SymbolScope> scopes,
+                      const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                      std::vector<SymbolChunk>& chunks) const;
+    size_t scanIndentation(std::string_view text, const LineIndex& lines, size_t firstLine,
+                           std::vector<SymbolScope> scopes,
+                           const std::function<bool(size_t, const std::vector<SymbolScope>&)>& canResync,
+                           std::vector<SymbolChunk>& chunks) const;
+};
+
+#endif // SYMBOL_EXTRACTOR_H
@@ -0,0 +1,292 @@
+#include "SymbolIndex.h"
+#include "Editor.h"
+#include "LineIndex.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string toLower(const std::string& text) {
+    std::string result(text);
+    for (char& c : result) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return result;
+}
+
+}  // namespace
+
+// SymbolTable 实现
+
+SymbolTable::SymbolTable() : version_(0) {}
+
+SymbolTable::SymbolTable(std::vector<Symbol> symbols, std::vector<size_t> parents, uint64_t version)
+    : symbols_(std::move(symbols)), parents_(std::move(parents)), version_(version) {
+    names_.reserve(symbols_.size());
+    for (size_t i = 0; i < symbols_.size(); ++i) {
+        const Symbol& symbol = symbols_[i];
+        names_.emplace_back(toLower(symbol.name), i);
+        if (symbol.kind == SymbolKind::Class || symbol.kind == SymbolKind::Struct) {
+            classNames_.insert(symbol.name);
+        } else {
+            functionNames_.insert(symbol.name);
+        }
+    }
+    std::sort(names_.begin(), names_.end());
+}
+
+const std::vector<Symbol>& SymbolTable::getSymbols() const {
+    return symbols_;
+}
+
+uint64_t SymbolTable::getVersion() const {
+    return version_;
+}
+
+const Symbol* SymbolTable::findByName(const std::string& name) const {
+    std::string key = toLower(name);
+    auto it = std::lower_bound(names_.begin(), names_.end(), std::make_pair(key, size_t(0)));
+    for (; it != names_.end() && it->first == key; ++it) {
+        if (symbols_[it->second].name == name) {
+            return &symbols_[it->second];
+        }
+    }
+    return nullptr;
+}
+
+std::vector<const Symbol*> SymbolTable::findByPrefix(const std::string& prefix, size_t limit) const {
+    std::vector<const Symbol*> result;
+    std::string key = toLower(prefix);
+    auto it = std::lower_bound(names_.begin(), names_.end(), std::make_pair(key, size_t(0)));
+    for (; it != names_.end() && result.size() < limit && it->first.compare(0, key.size(), key) == 0; ++it) {
+        result.push_back(&symbols_[it->second]);
+    }
+    return result;
+}
+
+const Symbol* SymbolTable::findEnclosing(size_t line) const {
+    // 先找到最后一个起始行不晚于 line 的符号，再沿外层链向上
+    auto it = std::upper_bound(symbols_.begin(), symbols_.end(), line,
+                               [](size_t value, const Symbol& symbol) { return value < symbol.line; });
+    if (it == symbols_.begin()) {
+        return nullptr;
+    }
+    size_t index = static_cast<size_t>(it - symbols_.begin()) - 1;
+    while (index != static_cast<size_t>(-1)) {
+        if (symbols_[index].endLine >= line) {
+            return &symbols_[index];
+        }
+        index = parents_[index];
+    }
+    return nullptr;
+}
+
+bool SymbolTable::isFunctionName(const std::string& name) const {
+    return functionNames_.count(name) > 0;
+}
+
+bool SymbolTable::isClassName(const std::string& name) const {
+    return classNames_.count(name) > 0;
+}
+
+// SymbolIndex 实现
+
+SymbolIndex::SymbolIndex()
+    : editListenerId_(0), dirty_(false), fullPending_(true), dirtyFirst_(0), dirtyLast_(0), dirtyDelta_(0),
+      version_(0), busy_(false), stopWorker_(false), table_(std::make_shared<SymbolTable>()) {
+    worker_ = std::thread(&SymbolIndex::workerLoop, this);
+}
+
+SymbolIndex::~SymbolIndex() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SymbolIndex::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    fullPending_ = true;
+    flush();
+}
+
+void SymbolIndex::setLanguage(const std::string& language) {
+    language_ = language;
+    fullPending_ = true;
+    flush();
+}
+
+void SymbolIndex::flush() {
+    if (!editor_ || (!dirty_ && !fullPending_)) {
+        return;
+    }
+    Job job{std::make_shared<const std::string>(editor_->getContentView()), language_, fullPending_, dirtyFirst_,
+            dirtyLast_, dirtyDelta_, ++version_};
+    dirty_ = false;
+    fullPending_ = false;
+    dirtyDelta_ = 0;
+    submit(std::move(job));
+}
+
+void SymbolIndex::waitForIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return !pendingJob_ && !busy_; });
+}
+
+std::shared_ptr<const SymbolTable> SymbolIndex::getSymbolTable() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return table_;
+}
+
+void SymbolIndex::setSymbolsChangedCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    symbolsChangedCallback_ = callback;
+}
+
+void SymbolIndex::handleEdit(const TextEdit& edit) {
+    size_t editFirst = edit.startLine;
+    size_t editOldLast = edit.startLine + edit.removedLineBreaks;
+    size_t editNewLast = edit.startLine + edit.insertedLineBreaks;
+    if (!dirty_) {
+        dirtyFirst_ = editFirst;
+        dirtyLast_ = editNewLast;
+        dirtyDelta_ = static_cast<int64_t>(editNewLast) - static_cast<int64_t>(editOldLast);
+        dirty_ = true;
+    } else {
+        mergeDirty(dirtyFirst_, dirtyLast_, dirtyDelta_, editFirst, editOldLast, editNewLast);
+    }
+}
+
+void SymbolIndex::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pendingJob_) {
+            // 上一个快照尚未开始处理：两次变更的受影响范围依次复合
+            Job& pending = *pendingJob_;
+            if (!job.full && !pending.full) {
+                mergeDirty(pending.dirtyFirst, pending.dirtyLast, pending.delta, job.dirtyFirst,
+                           static_cast<size_t>(static_cast<int64_t>(job.dirtyLast) - job.delta), job.dirtyLast);
+            }
+            pending.full = pending.full || job.full;
+            pending.text = std::move(job.text);
+            pending.language = std::move(job.language);
+            pending.version = job.version;
+        } else {
+            pendingJob_ = std::make_unique<Job>(std::move(job));
+        }
+    }
+    workCondition_.notify_one();
+}
+
+void SymbolIndex::workerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCondition_.wait(lock, [this]() { return stopWorker_ || pendingJob_; });
+            if (stopWorker_) {
+                return;
+            }
+            job = std::move(pendingJob_);
+            busy_ = true;
+        }
+
+        process(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (symbolsChangedCallback_) {
+                symbolsChangedCallback_();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        idleCondition_.notify_all();
+    }
+}
+
+void SymbolIndex::process(const Job& job) {
+    const std::string& text = *job.text;
+    bool full = job.full || chunks_.empty();
+    if (job.language != extractor_.getLanguage()) {
+        extractor_.setLanguage(job.language);
+        full = true;
+    }
+
+    LineIndex lines;
+    lines.rebuild(text.data(), text.size());
+    size_t lineCount = lines.getLineCount();
+
+    std::vector<SymbolChunk> chunks;
+    if (!extractor_.isSupported()) {
+        chunks_.clear();
+    } else if (full) {
+        extractor_.scan(text, lines, 0, {}, [](size_t, const std::vector<SymbolScope>&) { return false; }, chunks);
+    } else {
+        // 从包含受影响首行的旧分块开始重新扫描，此前的分块原样保留
+        size_t first = std::min(job.dirtyFirst, lineCount - 1);
+        auto it = std::upper_bound(chunks_.begin(), chunks_.end(), first,
+                                   [](size_t value, const SymbolChunk& chunk) { return value < chunk.firstLine; });
+        size_t index = static_cast<size_t>(it - chunks_.begin()) - 1;
+        chunks.reserve(chunks_.size() + 16);
+        std::move(chunks_.begin(), chunks_.begin() + index, std::back_inserter(chunks));
+
+        // 越过受影响范围后，遇到起始行和作用域都与旧分块一致的边界即可复用旧结果
+        size_t candidate = index + 1;
+        size_t resyncIndex = chunks_.size();
+        auto canResync = [&](size_t line, const std::vector<SymbolScope>& scopes) {
+            if (line <= job.dirtyLast) {
+                return false;
+            }
+            size_t oldLine = static_cast<size_t>(static_cast<int64_t>(line) - job.delta);
+            while (candidate < chunks_.size() && chunks_[candidate].firstLine < oldLine) {
+                candidate++;
+            }
+            if (candidate < chunks_.size() && chunks_[candidate].firstLine == oldLine &&
+                chunks_[candidate].scopes == scopes) {
+                resyncIndex = candidate;
+                return true;
+            }
+            return false;
+        };
+        extractor_.scan(text, lines, chunks_[index].firstLine, chunks_[index].scopes, canResync, chunks);
+
+        for (size_t i = resyncIndex; i < chunks_.size(); ++i) {
+            chunks_[i].firstLine = static_cast<size_t>(static_cast<int64_t>(chunks_[i].firstLine) + job.delta);
+            chunks.push_back(std::move(chunks_[i]));
+        }
+    }
+    chunks_ = std::move(chunks);
+
+    std::vector<Symbol> symbols;
+    std::vector<size_t> parents;
+    SymbolExtractor::assemble(chunks_, lineCount, symbols, parents);
+    auto table = std::make_shared<const SymbolTable>(std::move(symbols), std::move(parents), job.version);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    table_ = std::move(table);
+}
+
+void SymbolIndex::mergeDirty(size_t& first, size_t& last, int64_t& delta, size_t editFirst, size_t editOldLast,
+                             size_t editNewLast) {
+    first = std::min(first, editFirst);
+    int64_t editDelta = static_cast<int64_t>(editNewLast) - static_cast<int64_t>(editOldLast);
+    last = last > editOldLast ? static_cast<size_t>(static_cast<int64_t>(last) + editDelta) : editNewLast;
+    delta += editDelta;
+}
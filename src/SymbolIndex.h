@@ -0,0 +1,211 @@
+#ifndef SYMBOL_INDEX_H
+#define SYMBOL_INDEX_H
+
+#include "SymbolExtractor.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 符号表
+ * 后台提取完成后发布的只读快照，可在任意线程中查询
+ */
+class SymbolTable {
+public:
+    SymbolTable();
+    SymbolTable(std::vector<Symbol> symbols, std::vector<size_t> parents, uint64_t version);
+
+    /**
+     * 获取全部符号（按声明行升序，可直接用作大纲）
+     * @return 符号列表
+     */
+    const std::vector<Symbol>& getSymbols() const;
+
+    /**
+     * 获取快照对应的文档版本
+     * @return 版本号
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * 按名称精确查找（同名时返回最靠前的声明）
+     * @param name 名称
+     * @return 符号，未找到返回 nullptr
+     */
+    const Symbol* findByName(const std::string& name) const;
+
+    /**
+     * 按名称前缀查找（不区分大小写）
+     * @param prefix 前缀
+     * @param limit 最多返回的数量
+     * @return 符号列表，按名称排序
+     */
+    std::vector<const Symbol*> findByPrefix(const std::string& prefix, size_t limit) const;
+
+    /**
+     * 查找包含指定行的最内层符号
+     * @param line 行号
+     * @return 符号，未找到返回 nullptr
+     */
+    const Symbol* findEnclosing(size_t line) const;
+
+    /**
+     * 是否为文档中声明的函数或方法名
+     * @param name 名称
+     * @return 是否声明
+     */
+    bool isFunctionName(const std::string& name) const;
+
+    /**
+     * 是否为文档中声明的类或结构体名
+     * @param name 名称
+     * @return 是否声明
+     */
+    bool isClassName(const std::string& name) const;
+
+private:
+    std::vector<Symbol> symbols_;
+    std::vector<size_t> parents_;                        // 外层符号下标
+    std::vector<std::pair<std::string, size_t>> names_;  // (小写名称, 符号下标)，按名称排序
+    std::unordered_set<std::string> functionNames_;
+    std::unordered_set<std::string> classNames_;
+    uint64_t version_;
+};
+
+/**
+ * 符号索引
+ * 在后台线程中对文档快照提取符号。编辑只记录受影响的行范围，
+ * 提交快照时工作线程从受影响的分块开始重新扫描，到达与旧结果一致的分块边界后直接复用旧分块，
+ * 因此只在改动附近做词法分析；组装符号表只遍历分块事件，不再接触文本
+ */
+class SymbolIndex {
+public:
+    SymbolIndex();
+    ~SymbolIndex();
+
+    SymbolIndex(const SymbolIndex&) = delete;
+    SymbolIndex& operator=(const SymbolIndex&) = delete;
+
+    /**
+     * 设置编辑器实例，订阅其范围编辑并提交一次完整提取
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 设置编程语言，提交一次完整提取
+     * @param language 语言名称
+     */
+    void setLanguage(const std::string& language);
+
+    /**
+     * 如有未处理的编辑，提交当前文档快照（在界面线程中调用，通常在输入停顿后）
+     */
+    void flush();
+
+    /**
+     * 等待后台线程处理完所有已提交的快照
+     */
+    void waitForIdle();
+
+    /**
+     * 获取最新的符号表
+     * @return 符号表快照（不为空）
+     */
+    std::shared_ptr<const SymbolTable> getSymbolTable() const;
+
+    /**
+     * 设置符号表更新回调
+     * 回调在后台线程中调用，界面代码需自行切换到主线程；
+     * 本函数返回后旧回调不会再被调用（因此不能在回调内部调用本函数）
+     * @param callback 回调函数
+     */
+    void setSymbolsChangedCallback(std::function<void()> callback);
+
+private:
+    /**
+     * 提交给后台线程的任务
+     */
+    struct Job {
+        std::shared_ptr<const std::string> text;
+        std::string language;
+        bool full;          // 是否完整提取
+        size_t dirtyFirst;  // 受影响的首行（新坐标）
+        size_t dirtyLast;   // 受影响的末行（新坐标）
+        int64_t delta;      // 受影响范围之后的行号变化量
+        uint64_t version;
+    };
+
+    // 界面线程状态
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    std::string language_;
+    bool dirty_;
+    bool fullPending_;
+    size_t dirtyFirst_;
+    size_t dirtyLast_;
+    int64_t dirtyDelta_;
+    uint64_t version_;
+
+    // 线程间共享状态
+    mutable std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    std::unique_ptr<Job> pendingJob_;
+    bool busy_;
+    bool stopWorker_;
+    std::shared_ptr<const SymbolTable> table_;
+    std::mutex callbackMutex_;
+    std::function<void()> symbolsChangedCallback_;
+
+    // 后台线程私有状态
+    SymbolExtractor extractor_;
+    std::vector<SymbolChunk> chunks_;
+    std::thread worker_;
+
+    /**
+     * 处理范围编辑，合并受影响的行范围
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 提交任务，与尚未开始处理的任务合并
+     * @param job 任务
+     */
+    void submit(Job job);
+
+    /**
+     * 后台线程主循环
+     */
+    void workerLoop();
+
+    /**
+     * 处理一个任务并发布符号表
+     * @param job 任务
+     */
+    void process(const Job& job);
+
+    /**
+     * 把一次编辑合并到受影响的行范围中
+     * @param first 受影响首行
+     * @param last 受影响末行
+     * @param delta 行号变化量
+     * @param editFirst 编辑首行
+     * @param editOldLast 编辑末行（编辑前坐标）
+     * @param editNewLast 编辑末行（编辑后坐标）
+     */
+    static void mergeDirty(size_t& first, size_t& last, int64_t& delta, size_t editFirst, size_t editOldLast,
+                           size_t editNewLast);
+};
+
+#endif // SYMBOL_INDEX_H
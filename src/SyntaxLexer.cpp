@@ -0,0 +1,359 @@
+#include "SyntaxLexer.h"
+#include <cstring>
+
+namespace {
+
+const char* const kCFamilyKeywords[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern",
+    "float", "for", "goto", "if", "inline", "int", "long", "register", "return", "short", "signed", "sizeof",
+    "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while"};
+
+const char* const kCppKeywords[] = {
+    "alignas", "alignof", "bool", "catch", "class", "constexpr", "const_cast", "decltype", "delete",
+    "dynamic_cast", "explicit", "export", "false", "friend", "mutable", "namespace", "new", "noexcept",
+    "nullptr", "operator", "override", "final", "private", "protected", "public", "reinterpret_cast",
+    "static_assert", "static_cast", "template", "this", "throw", "true", "try", "typeid", "typename", "using",
+    "virtual"};
+
+const char* const kJavaKeywords[] = {
+    "abstract", "assert", "boolean", "break", "byte", "case", "catch", "char", "class", "const", "continue",
+    "default", "do", "double", "else", "enum", "extends", "final", "finally", "float", "for", "if",
+    "implements", "import", "instanceof", "int", "interface", "long", "native", "new", "null", "package",
+    "private", "protected", "public", "return", "short", "static", "super", "switch", "synchronized", "this",
+    "throw", "throws", "true", "false", "try", "void", "volatile", "while", "var", "record"};
+
+const char* const kJavaScriptKeywords[] = {
+    "async", "await", "break", "case", "catch", "class", "const", "continue", "debugger", "default", "delete",
+    "do", "else", "export", "extends", "false", "finally", "for", "function", "if", "import", "in",
+    "instanceof", "let", "new", "null", "return", "static", "super", "switch", "this", "throw", "true", "try",
+    "typeof", "undefined", "var", "void", "while", "with", "yield"};
+
+const char* const kPythonKeywords[] = {
+    "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class", "continue", "def",
+    "del", "elif", "else", "except", "finally", "for", "from", "global", "if", "import", "in", "is", "lambda",
+    "nonlocal", "not", "or", "pass", "raise", "return", "try", "while", "with", "yield"};
+
+const char* const kJsonKeywords[] = {"true", "false", "null"};
+
+template <size_t N>
+void insertKeywords(std::unordered_set<std::string>& target, const char* const (&keywords)[N]) {
+    target.insert(keywords, keywords + N);
+}
+
+inline bool isIdentifierStart(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' || c >= 0x80;
+}
+
+inline bool isIdentifierChar(unsigned char c) {
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+inline bool isDigit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool isBracket(char c) {
+    return c == '(' || c == ')' || c == '[' || c == ']' || c == '{' || c == '}';
+}
+
+inline bool isOperator(char c) {
+    return std::strchr("+-*/%=<>!&|^~?:;,.@", c) != nullptr && c != '\0';
+}
+
+}  // namespace
+
+LanguageRules LanguageRules::forLanguage(const std::string& language) {
+    LanguageRules rules;
+    rules.name = language;
+
+    if (language == "C" || language == "C++") {
+        rules.lineComment = "//";
+        rules.blockCommentStart = "/*";
+        rules.blockCommentEnd = "*/";
+        rules.quotes = "\"'";
+        insertKeywords(rules.keywords, kCFamilyKeywords);
+        if (language == "C++") {
+            insertKeywords(rules.keywords, kCppKeywords);
+        }
+    } else if (language == "Java") {
+        rules.lineComment = "//";
+        rules.blockCommentStart = "/*";
+        rules.blockCommentEnd = "*/";
+        rules.quotes = "\"'";
+        insertKeywords(rules.keywords, kJavaKeywords);
+    } else if (language == "JavaScript") {
+        rules.lineComment = "//";
+        rules.blockCommentStart = "/*";
+        rules.blockCommentEnd = "*/";
+        rules.quotes = "\"'";
+        rules.multiLineQuotes = "`";
+        insertKeywords(rules.keywords, kJavaScriptKeywords);
+    } else if (language == "Python") {
+        rules.lineComment = "#";
+        rules.quotes = "\"'";
+        rules.tripleQuotes = true;
+        insertKeywords(rules.keywords, kPythonKeywords);
+    } else if (language == "JSON") {
+        rules.quotes = "\"";
+        insertKeywords(rules.keywords, kJsonKeywords);
+    } else if (language == "CSS") {
+        rules.blockCommentStart = "/*";
+        rules.blockCommentEnd = "*/";
+        rules.quotes = "\"'";
+    } else if (language == "HTML" || language == "XML") {
+        rules.blockCommentStart = "<!--";
+        rules.blockCommentEnd = "-->";
+        rules.quotes = "\"'";
+    }
+
+    return rules;
+}
+
+std::string LanguageRules::detectLanguage(const std::string& filePath) {
+    static const std::pair<const char*, const char*> kExtensions[] = {
+        {".cpp", "C++"}, {".cc", "C++"},   {".cxx", "C++"},       {".hpp", "C++"},  {".h", "C++"},
+        {".c", "C"},     {".java", "Java"}, {".js", "JavaScript"}, {".mjs", "JavaScript"},
+        {".py", "Python"}, {".json", "JSON"}, {".css", "CSS"},     {".html", "HTML"}, {".htm", "HTML"},
+        {".xml", "XML"}, {".md", "Markdown"}};
+
+    size_t dot = filePath.find_last_of('.');
+    size_t slash = filePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "Plain Text";
+    }
+    std::string extension = filePath.substr(dot);
+    for (char& c : extension) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    for (const auto& entry : kExtensions) {
+        if (extension == entry.first) {
+            return entry.second;
+        }
+    }
+    return "Plain Text";
+}
+
+SyntaxLexer::SyntaxLexer() {
+    rebuildScanners();
+}
+
+SyntaxLexer::SyntaxLexer(const LanguageRules& rules) : rules_(rules) {
+    rebuildScanners();
+}
+
+void SyntaxLexer::setRules(const LanguageRules& rules) {
+    rules_ = rules;
+    rebuildScanners();
+}
+
+const LanguageRules& SyntaxLexer::getRules() const {
+    return rules_;
+}
+
+void SyntaxLexer::addKeywords(const std::vector<std::string>& keywords) {
+    rules_.keywords.insert(keywords.begin(), keywords.end());
+}
+
+void SyntaxLexer::removeKeywords(const std::vector<std::string>& keywords) {
+    for (const auto& keyword : keywords) {
+        rules_.keywords.erase(keyword);
+    }
+}
+
+void SyntaxLexer::rebuildScanners() {
+    // 块注释内只关心结束符的首字节
+    blockCommentScanner_.setDelimiters(rules_.blockCommentEnd.empty() ? "" : rules_.blockCommentEnd.substr(0, 1));
+
+    // 字符串内关心引号、转义符，单行字符串还关心换行符
+    allQuotes_ = rules_.quotes + rules_.multiLineQuotes;
+    stringScanners_.clear();
+    for (char quote : allQuotes_) {
+        std::string delimiters(1, quote);
+        delimiters.push_back('\\');
+        if (!isMultiLineQuote(quote) || rules_.tripleQuotes) {
+            delimiters.push_back('\n');
+        }
+        stringScanners_.emplace_back(delimiters);
+    }
+}
+
+bool SyntaxLexer::matchesAt(const char* data, size_t length, size_t pos, const std::string& text) const {
+    return !text.empty() && pos + text.size() <= length && std::memcmp(data + pos, text.data(), text.size()) == 0;
+}
+
+bool SyntaxLexer::isMultiLineQuote(char quote) const {
+    return rules_.multiLineQuotes.find(quote) != std::string::npos;
+}
+
+size_t SyntaxLexer::skipBlockComment(const char* data, size_t length, size_t from, bool& closed) const {
+    const std::string& end = rules_.blockCommentEnd;
+    size_t pos = from;
+    while ((pos = blockCommentScanner_.findNext(data, length, pos)) < length) {
+        if (matchesAt(data, length, pos, end)) {
+            closed = true;
+            return pos + end.size();
+        }
+        ++pos;
+    }
+    closed = false;
+    return length;
+}
+
+size_t SyntaxLexer::skipString(const char* data, size_t length, size_t from, LexState& state) const {
+    size_t scannerIndex = allQuotes_.find(state.quote);
+    if (scannerIndex == std::string::npos) {
+        state = LexState();
+        return from;
+    }
+
+    const DelimiterScanner& scanner = stringScanners_[scannerIndex];
+    bool multiLine = state.triple || isMultiLineQuote(state.quote);
+    size_t pos = from;
+
+    while ((pos = scanner.findNext(data, length, pos)) < length) {
+        char c = data[pos];
+        if (c == '\\') {
+            pos += 2;
+            continue;
+        }
+        if (c == '\n') {
+            if (multiLine) {
+                ++pos;
+                continue;
+            }
+            // 单行字符串未闭合，在行尾结束
+            state = LexState();
+            return pos;
+        }
+        if (state.triple) {
+            if (pos + 2 < length && data[pos + 1] == c && data[pos + 2] == c) {
+                state = LexState();
+                return pos + 3;
+            }
+            ++pos;
+            continue;
+        }
+        state = LexState();
+        return pos + 1;
+    }
+
+    // 到达文本末尾（即行尾），单行字符串不延续到下一行
+    if (!multiLine) {
+        state = LexState();
+    }
+    return length;
+}
+
+LexState SyntaxLexer::tokenize(const char* data, size_t length, LexState state, std::vector<SyntaxToken>& tokens,
+                               size_t baseOffset) const {
+    std::string word;
+    size_t pos = 0;
+
+    auto emit = [&](size_t start, size_t end, SyntaxTokenType type) {
+        if (end > start) {
+            tokens.push_back({baseOffset + start, end - start, type});
+        }
+    };
+
+    // 上一段文本遗留的块注释或字符串
+    if (state.mode == LexState::Mode::BlockComment) {
+        bool closed = false;
+        pos = skipBlockComment(data, length, 0, closed);
+        emit(0, pos, SyntaxTokenType::Comment);
+        if (!closed) {
+            return state;
+        }
+        state = LexState();
+    } else if (state.mode == LexState::Mode::String) {
+        pos = skipString(data, length, 0, state);
+        emit(0, pos, SyntaxTokenType::String);
+    }
+
+    while (pos < length) {
+        unsigned char c = static_cast<unsigned char>(data[pos]);
+        size_t start = pos;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            ++pos;
+            continue;
+        }
+
+        if (matchesAt(data, length, pos, rules_.lineComment)) {
+            const void* newline = std::memchr(data + pos, '\n', length - pos);
+            pos = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) : length;
+            emit(start, pos, SyntaxTokenType::Comment);
+            continue;
+        }
+
+        if (matchesAt(data, length, pos, rules_.blockCommentStart)) {
+            bool closed = false;
+            pos = skipBlockComment(data, length, pos + rules_.blockCommentStart.size(), closed);
+            emit(start, pos, SyntaxTokenType::Comment);
+            if (!closed) {
+                state.mode = LexState::Mode::BlockComment;
+                return state;
+            }
+            continue;
+        }
+
+        if (allQuotes_.find(static_cast<char>(c)) != std::string::npos) {
+            state.mode = LexState::Mode::String;
+            state.quote = static_cast<char>(c);
+            state.triple = rules_.tripleQuotes && pos + 2 < length && data[pos + 1] == data[pos] &&
+                           data[pos + 2] == data[pos];
+            pos = skipString(data, length, pos + (state.triple ? 3 : 1), state);
+            emit(start, pos, SyntaxTokenType::String);
+            continue;
+        }
+
+        if (isDigit(c) || (c == '.' && pos + 1 < length && isDigit(static_cast<unsigned char>(data[pos + 1])))) {
+            ++pos;
+            while (pos < length) {
+                unsigned char d = static_cast<unsigned char>(data[pos]);
+                if (isIdentifierChar(d) || d == '.') {
+                    ++pos;
+                } else if ((d == '+' || d == '-') && (data[pos - 1] == 'e' || data[pos - 1] == 'E')) {
+                    ++pos;
+                } else {
+                    break;
+                }
+            }
+            emit(start, pos, SyntaxTokenType::Number);
+            continue;
+        }
+
+        if (isIdentifierStart(c)) {
+            ++pos;
+            while (pos < length && isIdentifierChar(static_cast<unsigned char>(data[pos]))) {
+                ++pos;
+            }
+            word.assign(data + start, pos - start);
+            emit(start, pos,
+                 rules_.keywords.count(word) ? SyntaxTokenType::Keyword : SyntaxTokenType::Identifier);
+            continue;
+        }
+
+        if (isBracket(static_cast<char>(c))) {
+            ++pos;
+            emit(start, pos, SyntaxTokenType::Bracket);
+            continue;
+        }
+
+        if (isOperator(static_cast<char>(c))) {
+            // 连续的操作符合并为一个记号，但注释起始符不能被吞掉
+            ++pos;
+            while (pos < length && isOperator(data[pos]) && !matchesAt(data, length, pos, rules_.lineComment) &&
+                   !matchesAt(data, length, pos, rules_.blockCommentStart)) {
+                ++pos;
+            }
+            emit(start, pos, SyntaxTokenType::Operator);
+            continue;
+        }
+
+        ++pos;
+    }
+
+    return state;
+}
@@ -0,0 +1,154 @@
+#ifndef SYNTAX_LEXER_H
+#define SYNTAX_LEXER_H
+
+#include "DelimiterScanner.h"
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * 语法记号类型
+ */
+enum class SyntaxTokenType : uint8_t {
+    Keyword,
+    Identifier,
+    String,
+    Comment,
+    Number,
+    Operator,
+    Bracket
+};
+
+/**
+ * 语法记号
+ */
+struct SyntaxToken {
+    size_t start;          // 相对于文档（或调用方给定基准）的起始偏移
+    size_t length;         // 记号长度
+    SyntaxTokenType type;  // 记号类型
+};
+
+/**
+ * 词法分析状态
+ * 用于跨行延续块注释和多行字符串
+ */
+struct LexState {
+    enum class Mode : uint8_t { Normal, BlockComment, String };
+
+    Mode mode = Mode::Normal;
+    char quote = 0;       // 处于字符串中时的引号字符
+    bool triple = false;  // 是否为三引号字符串（Python）
+
+    bool operator==(const LexState& other) const {
+        return mode == other.mode && quote == other.quote && triple == other.triple;
+    }
+
+    bool operator!=(const LexState& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * 语言词法规则
+ */
+struct LanguageRules {
+    std::string name;
+    std::string lineComment;        // 行注释起始符，如 "//"、"#"
+    std::string blockCommentStart;  // 块注释起始符，如 "/*"
+    std::string blockCommentEnd;    // 块注释结束符，如 "*/"
+    std::string quotes;             // 字符串引号
+    std::string multiLineQuotes;    // 允许跨行的字符串引号，如 JavaScript 的 "`"
+    bool tripleQuotes = false;      // 是否支持三引号多行字符串
+    std::unordered_set<std::string> keywords;
+
+    /**
+     * 获取内置语言规则
+     * @param language 语言名称（与配置文件 [FileAssociations] 中的名称一致）
+     * @return 语言规则，未知语言返回不含任何规则的纯文本规则
+     */
+    static LanguageRules forLanguage(const std::string& language);
+
+    /**
+     * 根据文件扩展名推断语言
+     * @param filePath 文件路径
+     * @return 语言名称，无法识别时返回 "Plain Text"
+     */
+    static std::string detectLanguage(const std::string& filePath);
+};
+
+/**
+ * 语法高亮词法分析器
+ * 在字符串和注释内部借助 DelimiterScanner 按 64 字节块跳跃，
+ * 使大段注释、长字符串、内嵌 base64 数据的处理受内存带宽而非分支限制
+ */
+class SyntaxLexer {
+public:
+    SyntaxLexer();
+    explicit SyntaxLexer(const LanguageRules& rules);
+
+    /**
+     * 设置语言规则
+     * @param rules 语言规则
+     */
+    void setRules(const LanguageRules& rules);
+
+    /**
+     * 获取语言规则
+     * @return 语言规则
+     */
+    const LanguageRules& getRules() const;
+
+    /**
+     * 添加关键字
+     * @param keywords 关键字列表
+     */
+    void addKeywords(const std::vector<std::string>& keywords);
+
+    /**
+     * 移除关键字
+     * @param keywords 关键字列表
+     */
+    void removeKeywords(const std::vector<std::string>& keywords);
+
+    /**
+     * 对一段文本进行词法分析
+     * 文本必须在行边界结束（可以是单行，也可以是整篇文档）
+     * @param data 文本起始地址
+     * @param length 文本长度
+     * @param state 起始状态（上一段文本结束时的状态）
+     * @param tokens 输出记号，追加到末尾
+     * @param baseOffset 记号偏移的基准值
+     * @return 文本结束时的状态
+     */
+    LexState tokenize(const char* data, size_t length, LexState state, std::vector<SyntaxToken>& tokens,
+                      size_t baseOffset = 0) const;
+
+private:
+    LanguageRules rules_;
+    DelimiterScanner blockCommentScanner_;
+    std::vector<DelimiterScanner> stringScanners_;  // 与 rules_.quotes + multiLineQuotes 一一对应
+    std::string allQuotes_;
+
+    /**
+     * 重建预扫描器
+     */
+    void rebuildScanners();
+
+    /**
+     * 在块注释中查找结束符
+     * @return 结束符之后的位置，如果未结束则返回 length
+     */
+    size_t skipBlockComment(const char* data, size_t length, size_t from, bool& closed) const;
+
+    /**
+     * 在字符串中查找结束引号
+     * @return 字符串之后的位置（单行字符串遇到换行时返回换行符位置）
+     */
+    size_t skipString(const char* data, size_t length, size_t from, LexState& state) const;
+
+    bool matchesAt(const char* data, size_t length, size_t pos, const std::string& text) const;
+    bool isMultiLineQuote(char quote) const;
+};
+
+#endif // SYNTAX_LEXER_H
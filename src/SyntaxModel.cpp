@@ -0,0 +1,216 @@
+#include "SyntaxModel.h"
+#include "Editor.h"
+#include <algorithm>
+
+SyntaxModel::SyntaxModel() : editListenerId_(0), nextUpdateListenerId_(1), lineStates_(1), lastUpdatedLine_(0) {
+    brackets_.replaceLines(0, 0, std::vector<std::vector<BracketToken>>(1));
+}
+
+SyntaxModel::~SyntaxModel() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+}
+
+void SyntaxModel::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    reset();
+}
+
+std::shared_ptr<Editor> SyntaxModel::getEditor() const {
+    return editor_;
+}
+
+void SyntaxModel::setLanguage(const std::string& language) {
+    lexer_.setRules(LanguageRules::forLanguage(language));
+    reset();
+}
+
+std::string SyntaxModel::getLanguage() const {
+    return lexer_.getRules().name;
+}
+
+SyntaxLexer& SyntaxModel::getLexer() {
+    return lexer_;
+}
+
+const BracketIndex& SyntaxModel::getBracketIndex() const {
+    return brackets_;
+}
+
+LexState SyntaxModel::getLineState(size_t line) const {
+    return line < lineStates_.size() ? lineStates_[line] : LexState();
+}
+
+void SyntaxModel::tokenizeLine(size_t line, std::vector<SyntaxToken>& tokens) const {
+    if (!editor_) {
+        return;
+    }
+    const LineIndex& lines = editor_->getLineIndex();
+    std::string_view content = editor_->getContentView();
+    size_t start = lines.getLineStart(line);
+    size_t end = lines.getLineEnd(line);
+    lexer_.tokenize(content.data() + start, end - start, getLineState(line), tokens, start);
+}
+
+size_t SyntaxModel::findMatchingBracket(size_t offset) const {
+    if (!editor_) {
+        return std::string::npos;
+    }
+    size_t line = 0;
+    size_t column = 0;
+    toLineColumn(offset, line, column);
+
+    BracketPosition match;
+    if (!brackets_.findMatch(line, column, match)) {
+        return std::string::npos;
+    }
+    return editor_->getLineIndex().getLineStart(match.line) + match.column;
+}
+
+bool SyntaxModel::findEnclosingBlock(size_t offset, size_t& openOffset, size_t& closeOffset) const {
+    if (!editor_) {
+        return false;
+    }
+    size_t line = 0;
+    size_t column = 0;
+    toLineColumn(offset, line, column);
+
+    BracketPosition open;
+    if (!brackets_.findEnclosingOpen(line, column, open)) {
+        return false;
+    }
+    const LineIndex& lines = editor_->getLineIndex();
+    openOffset = lines.getLineStart(open.line) + open.column;
+
+    BracketPosition close;
+    closeOffset = brackets_.findMatch(open.line, open.column, close)
+                      ? lines.getLineStart(close.line) + close.column
+                      : std::string::npos;
+    return true;
+}
+
+int64_t SyntaxModel::getBracketDepth(size_t offset) const {
+    if (!editor_) {
+        return 0;
+    }
+    size_t line = 0;
+    size_t column = 0;
+    toLineColumn(offset, line, column);
+
+    int64_t depth = brackets_.getDepthAt(line, column);
+    std::string_view content = editor_->getContentView();
+    if (offset < content.size() && BracketIndex::isClose(content[offset])) {
+        depth -= 1;
+    }
+    return depth < 0 ? 0 : depth;
+}
+
+void SyntaxModel::reset() {
+    lineStates_.clear();
+    brackets_.clear();
+
+    size_t lineCount = editor_ ? editor_->getLineIndex().getLineCount() : 1;
+    std::vector<std::vector<BracketToken>> lineBrackets(lineCount);
+    lineStates_.resize(lineCount);
+
+    LexState state;
+    for (size_t line = 0; line < lineCount; ++line) {
+        lineStates_[line] = state;
+        if (editor_) {
+            state = lexLine(line, state, lineBrackets[line]);
+        }
+    }
+    brackets_.replaceLines(0, 0, std::move(lineBrackets));
+    lastUpdatedLine_ = lineCount - 1;
+    notifyUpdated(nullptr);
+}
+
+size_t SyntaxModel::getLastUpdatedLine() const {
+    return lastUpdatedLine_;
+}
+
+size_t SyntaxModel::addUpdateListener(std::function<void(const TextEdit*)> listener) {
+    size_t listenerId = nextUpdateListenerId_++;
+    updateListeners_.emplace_back(listenerId, std::move(listener));
+    return listenerId;
+}
+
+void SyntaxModel::removeUpdateListener(size_t listenerId) {
+    updateListeners_.erase(std::remove_if(updateListeners_.begin(), updateListeners_.end(),
+                                          [listenerId](const auto& entry) { return entry.first == listenerId; }),
+                           updateListeners_.end());
+}
+
+void SyntaxModel::handleEdit(const TextEdit& edit) {
+    const LineIndex& lines = editor_->getLineIndex();
+    size_t firstLine = edit.startLine;
+    size_t lineCount = lines.getLineCount();
+
+    // 结构调整：被删除的行让位给新插入的行
+    if (firstLine >= lineStates_.size() ||
+        lineStates_.size() + edit.insertedLineBreaks != lineCount + edit.removedLineBreaks) {
+        reset();
+        return;
+    }
+    lineStates_.erase(lineStates_.begin() + firstLine + 1,
+                      lineStates_.begin() + firstLine + 1 + edit.removedLineBreaks);
+    lineStates_.insert(lineStates_.begin() + firstLine + 1, edit.insertedLineBreaks, LexState());
+
+    // 重新分析被编辑覆盖的行
+    size_t lastLine = firstLine + edit.insertedLineBreaks;
+    std::vector<std::vector<BracketToken>> lineBrackets(lastLine - firstLine + 1);
+    LexState state = lineStates_[firstLine];
+    for (size_t line = firstLine; line <= lastLine; ++line) {
+        lineStates_[line] = state;
+        state = lexLine(line, state, lineBrackets[line - firstLine]);
+    }
+    brackets_.replaceLines(firstLine, edit.removedLineBreaks + 1, std::move(lineBrackets));
+
+    // 行尾状态变化（例如新开了块注释）时继续向后传播，直到与旧状态一致
+    lastUpdatedLine_ = lastLine;
+    for (size_t line = lastLine + 1; line < lineCount && lineStates_[line] != state; ++line) {
+        lineStates_[line] = state;
+        std::vector<std::vector<BracketToken>> single(1);
+        state = lexLine(line, state, single[0]);
+        brackets_.replaceLines(line, 1, std::move(single));
+        lastUpdatedLine_ = line;
+    }
+
+    notifyUpdated(&edit);
+}
+
+LexState SyntaxModel::lexLine(size_t line, LexState state, std::vector<BracketToken>& brackets) {
+    const LineIndex& lines = editor_->getLineIndex();
+    std::string_view content = editor_->getContentView();
+    size_t start = lines.getLineStart(line);
+    size_t end = lines.getLineEnd(line);
+
+    scratchTokens_.clear();
+    state = lexer_.tokenize(content.data() + start, end - start, state, scratchTokens_);
+    for (const SyntaxToken& token : scratchTokens_) {
+        if (token.type == SyntaxTokenType::Bracket) {
+            brackets.push_back({token.start, content[start + token.start]});
+        }
+    }
+    return state;
+}
+
+void SyntaxModel::toLineColumn(size_t offset, size_t& line, size_t& column) const {
+    const LineIndex& lines = editor_->getLineIndex();
+    line = lines.getLineOfOffset(offset);
+    column = offset - lines.getLineStart(line);
+}
+
+void SyntaxModel::notifyUpdated(const TextEdit* edit) {
+    for (const auto& entry : updateListeners_) {
+        entry.second(edit);
+    }
+}
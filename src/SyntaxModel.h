@@ -0,0 +1,164 @@
+#ifndef SYNTAX_MODEL_H
+#define SYNTAX_MODEL_H
+
+#include "BracketIndex.h"
+#include "SyntaxLexer.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 语法模型
+ * 跟随编辑器的范围编辑增量维护每行的词法起始状态和括号索引：
+ * 只重新分析被编辑的行，并向后延续到词法状态与旧状态重新一致为止
+ */
+class SyntaxModel {
+public:
+    SyntaxModel();
+    ~SyntaxModel();
+
+    SyntaxModel(const SyntaxModel&) = delete;
+    SyntaxModel& operator=(const SyntaxModel&) = delete;
+
+    /**
+     * 设置编辑器实例，并订阅其范围编辑
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 获取编辑器实例
+     * @return 编辑器指针
+     */
+    std::shared_ptr<Editor> getEditor() const;
+
+    /**
+     * 设置编程语言，重新分析整篇文档
+     * @param language 语言名称
+     */
+    void setLanguage(const std::string& language);
+
+    /**
+     * 获取当前编程语言
+     * @return 语言名称
+     */
+    std::string getLanguage() const;
+
+    /**
+     * 获取词法分析器
+     * @return 词法分析器
+     */
+    SyntaxLexer& getLexer();
+
+    /**
+     * 获取括号索引
+     * @return 括号索引
+     */
+    const BracketIndex& getBracketIndex() const;
+
+    /**
+     * 获取行首的词法状态
+     * @param line 行号（从0开始）
+     * @return 词法状态
+     */
+    LexState getLineState(size_t line) const;
+
+    /**
+     * 对单行进行词法分析（用于渲染可见行）
+     * @param line 行号（从0开始）
+     * @param tokens 输出记号，偏移为文档偏移
+     */
+    void tokenizeLine(size_t line, std::vector<SyntaxToken>& tokens) const;
+
+    /**
+     * 查找与指定偏移处括号配对的括号
+     * @param offset 括号的字节偏移
+     * @return 配对括号的偏移，如果不是括号或没有配对则返回 std::string::npos
+     */
+    size_t findMatchingBracket(size_t offset) const;
+
+    /**
+     * 查找包围指定偏移的最内层代码块
+     * @param offset 字节偏移
+     * @param openOffset 输出左括号偏移
+     * @param closeOffset 输出右括号偏移（未闭合时为 std::string::npos）
+     * @return 是否找到
+     */
+    bool findEnclosingBlock(size_t offset, size_t& openOffset, size_t& closeOffset) const;
+
+    /**
+     * 获取括号的嵌套深度（用于彩虹括号着色）
+     * 左括号返回其内部深度减一，右括号返回与之配对的左括号相同的深度
+     * @param offset 括号的字节偏移
+     * @return 深度，从0开始
+     */
+    int64_t getBracketDepth(size_t offset) const;
+
+    /**
+     * 重新分析整篇文档
+     */
+    void reset();
+
+    /**
+     * 获取最近一次更新中重新分析的最后一行
+     * 词法状态变化会使重新分析延续到编辑范围之后，依赖行状态的模型需要覆盖到该行
+     * @return 行号
+     */
+    size_t getLastUpdatedLine() const;
+
+    /**
+     * 添加更新监听器
+     * 监听器在行状态和括号索引更新完成后调用，参数为空表示整篇文档已重新分析
+     * @param listener 监听函数
+     * @return 监听器编号，用于移除
+     */
+    size_t addUpdateListener(std::function<void(const TextEdit*)> listener);
+
+    /**
+     * 移除更新监听器
+     * @param listenerId 监听器编号
+     */
+    void removeUpdateListener(size_t listenerId);
+
+private:
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    std::vector<std::pair<size_t, std::function<void(const TextEdit*)>>> updateListeners_;
+    size_t nextUpdateListenerId_;
+    SyntaxLexer lexer_;
+    std::vector<LexState> lineStates_;  // 每行行首的词法状态
+    BracketIndex brackets_;
+    std::vector<SyntaxToken> scratchTokens_;
+    size_t lastUpdatedLine_;
+
+    /**
+     * 处理范围编辑
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 分析一行，提取括号
+     * @param line 行号
+     * @param state 行首状态
+     * @param brackets 输出括号
+     * @return 行尾状态
+     */
+    LexState lexLine(size_t line, LexState state, std::vector<BracketToken>& brackets);
+
+    /**
+     * 偏移转换为行列
+     */
+    void toLineColumn(size_t offset, size_t& line, size_t& column) const;
+
+    /**
+     * 通知更新监听器
+     */
+    void notifyUpdated(const TextEdit* edit);
+};
+
+#endif // SYNTAX_MODEL_H
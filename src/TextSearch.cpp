@@ -0,0 +1,351 @@
+#include "TextSearch.h"
+#include "UnicodeText.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LITEPAD_SEARCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEPAD_SEARCH_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline bool isAsciiLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// 每次比较 64 字节，候选位置以位图返回
+const size_t kBlockSize = 64;
+
+inline size_t countTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(__builtin_ctzll(mask));
+#endif
+}
+
+inline size_t countLeadingZeros(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return static_cast<size_t>(63 - index);
+#else
+    return static_cast<size_t>(__builtin_clzll(mask));
+#endif
+}
+
+#if defined(LITEPAD_SEARCH_AVX2)
+
+// 首尾字节的比较向量，整段查找期间只构造一次
+struct Kernel {
+    __m256i first;
+    __m256i last;
+    __m256i foldFirst;  // 首字节需要折叠大小写时为 0x20，否则为 0
+    __m256i foldLast;
+
+    Kernel(char firstByte, char lastByte, bool foldFirstByte, bool foldLastByte)
+        : first(_mm256_set1_epi8(firstByte)), last(_mm256_set1_epi8(lastByte)),
+          foldFirst(_mm256_set1_epi8(foldFirstByte ? 0x20 : 0)), foldLast(_mm256_set1_epi8(foldLastByte ? 0x20 : 0)) {}
+
+    uint64_t lane(const char* head, const char* tail) const {
+        __m256i a = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(head)), foldFirst);
+        __m256i b = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)), foldLast);
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    }
+
+    uint64_t mask(const char* head, const char* tail) const {
+        return lane(head, tail) | (lane(head + 32, tail + 32) << 32);
+    }
+
+    // 最高位为 1 的字节（非 ASCII）位图
+    static uint64_t nonAscii(const char* p) {
+        uint64_t low =
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))));
+        uint64_t high =
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32))));
+        return low | (high << 32);
+    }
+};
+
+#elif defined(LITEPAD_SEARCH_SSE2)
+
+struct Kernel {
+    __m128i first;
+    __m128i last;
+    __m128i foldFirst;
+    __m128i foldLast;
+
+    Kernel(char firstByte, char lastByte, bool foldFirstByte, bool foldLastByte)
+        : first(_mm_set1_epi8(firstByte)), last(_mm_set1_epi8(lastByte)),
+          foldFirst(_mm_set1_epi8(foldFirstByte ? 0x20 : 0)), foldLast(_mm_set1_epi8(foldLastByte ? 0x20 : 0)) {}
+
+    uint64_t lane(const char* head, const char* tail) const {
+        __m128i a = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(head)), foldFirst);
+        __m128i b = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)), foldLast);
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last));
+        return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+    }
+
+    uint64_t mask(const char* head, const char* tail) const {
+        return lane(head, tail) | (lane(head + 16, tail + 16) << 16) | (lane(head + 32, tail + 32) << 32) |
+               (lane(head + 48, tail + 48) << 48);
+    }
+
+    // 最高位为 1 的字节（非 ASCII）位图
+    static uint64_t nonAscii(const char* p) {
+        uint64_t mask = 0;
+        for (int i = 0; i < 4; i++) {
+            mask |= uint64_t(static_cast<uint32_t>(
+                        _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16)))))
+                    << (i * 16);
+        }
+        return mask;
+    }
+};
+
+#endif
+
+}  // namespace
+
+TextSearch::TextSearch()
+    : caseSensitive_(true), wholeWord_(false), unicode_(false), exact_(false), anchorFirst_(0), anchorLast_(0),
+      foldFirst_(false), foldLast_(false) {}
+
+TextSearch::TextSearch(const std::string& pattern, bool caseSensitive, bool wholeWord) : TextSearch() {
+    setPattern(pattern, caseSensitive, wholeWord);
+}
+
+void TextSearch::setPattern(const std::string& pattern, bool caseSensitive, bool wholeWord) {
+    caseSensitive_ = caseSensitive;
+    wholeWord_ = wholeWord;
+    pattern_ = caseSensitive ? pattern : UnicodeText::foldString(pattern);
+
+    // 找出不受大小写影响的字节（ASCII 字节，或没有大小写之分的非 ASCII 字符，如汉字）作为锚点。
+    // 折叠不改变字节数，锚点在文本中的偏移与模式串中相同，向量内核直接比较这两个位置
+    unicode_ = false;
+    anchorFirst_ = std::string::npos;
+    anchorLast_ = std::string::npos;
+    for (size_t i = 0; i < pattern_.size();) {
+        uint32_t codePoint = 0;
+        size_t size = UnicodeText::decode(pattern_.data() + i, pattern_.size() - i, codePoint);
+        bool stable = caseSensitive_ || size == 1 || !UnicodeText::hasCaseVariants(codePoint);
+        if (!stable) {
+            unicode_ = true;
+        } else {
+            if (anchorFirst_ == std::string::npos) {
+                anchorFirst_ = i;
+            }
+            anchorLast_ = i + size - 1;
+        }
+        i += size;
+    }
+    // 字母的大小写只差 0x20 这一位，或上 0x20 后即可一次比较两种写法
+    foldFirst_ = !caseSensitive_ && anchorFirst_ != std::string::npos && isAsciiLetter(pattern_[anchorFirst_]);
+    foldLast_ = !caseSensitive_ && anchorLast_ != std::string::npos && isAsciiLetter(pattern_[anchorLast_]);
+    // 锚点就是首尾字节且不超过 2 字节时，锚点命中即为匹配
+    exact_ = !unicode_ && pattern_.size() <= 2;
+}
+
+const std::string& TextSearch::getPattern() const {
+    return pattern_;
+}
+
+size_t TextSearch::getMatchLength() const {
+    return pattern_.size();
+}
+
+bool TextSearch::isCaseSensitive() const {
+    return caseSensitive_;
+}
+
+bool TextSearch::isWholeWord() const {
+    return wholeWord_;
+}
+
+size_t TextSearch::find(const char* data, size_t length, size_t from) const {
+    size_t patternLength = pattern_.size();
+    if (patternLength == 0 || from >= length || length - from < patternLength) {
+        return std::string::npos;
+    }
+
+    size_t pos = from;
+#if defined(LITEPAD_SEARCH_AVX2) || defined(LITEPAD_SEARCH_SSE2)
+    bool anchored = anchorFirst_ != std::string::npos;
+    Kernel kernel(anchored ? pattern_[anchorFirst_] : 0, anchored ? pattern_[anchorLast_] : 0, foldFirst_, foldLast_);
+    size_t tailOffset = patternLength - 1;
+    while (pos + tailOffset + kBlockSize <= length) {
+        // 没有锚点时模式串以有大小写之分的非 ASCII 字符开头，纯 ASCII 的块整块跳过
+        uint64_t mask = anchored ? kernel.mask(data + pos + anchorFirst_, data + pos + anchorLast_)
+                                 : Kernel::nonAscii(data + pos);
+        while (mask != 0) {
+            size_t candidate = pos + countTrailingZeros(mask);
+            if ((exact_ || matchesAt(data + candidate)) && isWordBounded(data, length, candidate)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+        pos += kBlockSize;
+    }
+#endif
+
+    return findScalar(data, length, pos);
+}
+
+size_t TextSearch::findLast(const char* data, size_t length, size_t from) const {
+    size_t patternLength = pattern_.size();
+    if (patternLength == 0 || from >= length || length - from < patternLength) {
+        return std::string::npos;
+    }
+
+    // 与 find 使用同一个内核，只是块从后向前移动、块内从最高位开始检查
+    size_t end = length - patternLength + 1;  // 候选起点的上界（不含）
+#if defined(LITEPAD_SEARCH_AVX2) || defined(LITEPAD_SEARCH_SSE2)
+    bool anchored = anchorFirst_ != std::string::npos;
+    Kernel kernel(anchored ? pattern_[anchorFirst_] : 0, anchored ? pattern_[anchorLast_] : 0, foldFirst_, foldLast_);
+    while (end >= from + kBlockSize) {
+        size_t pos = end - kBlockSize;
+        uint64_t mask = anchored ? kernel.mask(data + pos + anchorFirst_, data + pos + anchorLast_)
+                                 : Kernel::nonAscii(data + pos);
+        while (mask != 0) {
+            size_t bit = 63 - countLeadingZeros(mask);
+            if ((exact_ || matchesAt(data + pos + bit)) && isWordBounded(data, length, pos + bit)) {
+                return pos + bit;
+            }
+            mask &= ~(uint64_t(1) << bit);
+        }
+        end = pos;
+    }
+#endif
+
+    return findLastScalar(data, length, from, end);
+}
+
+bool TextSearch::matchesAt(const char* candidate) const {
+    if (caseSensitive_) {
+        return std::memcmp(candidate, pattern_.data(), pattern_.size()) == 0;
+    }
+    size_t length = pattern_.size();
+    for (size_t i = 0; i < length;) {
+        unsigned char c = static_cast<unsigned char>(candidate[i]);
+        if (c < 0x80 || !unicode_) {
+            if (toLowerAscii(static_cast<char>(c)) != pattern_[i]) {
+                return false;
+            }
+            i++;
+            continue;
+        }
+        // 非 ASCII 字符逐字符折叠后比较；折叠不改变字节数，字符边界与模式串对齐
+        uint32_t codePoint = 0;
+        size_t size = UnicodeText::decode(candidate + i, length - i, codePoint);
+        char folded[4];
+        if (size == 1) {
+            folded[0] = static_cast<char>(c);
+        } else {
+            UnicodeText::encode(UnicodeText::fold(codePoint), folded);
+        }
+        if (std::memcmp(folded, pattern_.data() + i, size) != 0) {
+            return false;
+        }
+        i += size;
+    }
+    return true;
+}
+
+bool TextSearch::isWordBounded(const char* data, size_t length, size_t position) const {
+    return !wholeWord_ || isWholeWord(data, length, position, pattern_.size());
+}
+
+bool TextSearch::isWholeWord(const char* data, size_t length, size_t start, size_t matchLength) {
+    if (matchLength == 0) {
+        return false;
+    }
+    // 只在匹配边缘本身是单词字符的一侧要求边界，与常见编辑器的全字匹配一致
+    size_t end = start + matchLength;
+    uint32_t first = 0;
+    UnicodeText::decode(data + start, matchLength, first);
+    if (start > 0 && UnicodeText::isWordCharacter(first) &&
+        UnicodeText::isWordCharacter(UnicodeText::decodeBefore(data, start))) {
+        return false;
+    }
+    if (end < length && UnicodeText::isWordCharacter(UnicodeText::decodeBefore(data, end))) {
+        uint32_t next = 0;
+        UnicodeText::decode(data + end, length - end, next);
+        if (UnicodeText::isWordCharacter(next)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextSearch::isCandidate(const char* p) const {
+    if (anchorFirst_ == std::string::npos) {
+        return static_cast<unsigned char>(p[0]) >= 0x80;
+    }
+    char first = p[anchorFirst_];
+    return (foldFirst_ ? static_cast<char>(first | 0x20) : first) == pattern_[anchorFirst_];
+}
+
+size_t TextSearch::findScalar(const char* data, size_t length, size_t from) const {
+    // 尾部不足一个块的部分（以及无向量指令时的全部数据）
+    size_t patternLength = pattern_.size();
+    if (from >= length || length - from < patternLength) {
+        return std::string::npos;
+    }
+    size_t lastStart = length - patternLength;
+    if (anchorFirst_ == 0 && !foldFirst_) {
+        const char* end = data + lastStart + 1;
+        const char* p = data + from;
+        while (p < end) {
+            p = static_cast<const char*>(std::memchr(p, pattern_.front(), static_cast<size_t>(end - p)));
+            if (!p) {
+                break;
+            }
+            if (matchesAt(p) && isWordBounded(data, length, static_cast<size_t>(p - data))) {
+                return static_cast<size_t>(p - data);
+            }
+            p++;
+        }
+        return std::string::npos;
+    }
+    for (size_t pos = from; pos <= lastStart; ++pos) {
+        if (isCandidate(data + pos) && matchesAt(data + pos) && isWordBounded(data, length, pos)) {
+            return pos;
+        }
+    }
+    return std::string::npos;
+}
+
+size_t TextSearch::findLastScalar(const char* data, size_t length, size_t from, size_t end) const {
+    // 开头不足一个块的部分（以及无向量指令时的全部数据）
+    for (size_t pos = end; pos > from; --pos) {
+        if (isCandidate(data + pos - 1) && matchesAt(data + pos - 1) && isWordBounded(data, length, pos - 1)) {
+            return pos - 1;
+        }
+    }
+    return std::string::npos;
+}
+
+const char* TextSearch::backendName() {
+#if defined(LITEPAD_SEARCH_AVX2)
+    return "AVX2";
+#elif defined(LITEPAD_SEARCH_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,135 @@
+#ifndef TEXT_SEARCH_H
+#define TEXT_SEARCH_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * 子串查找内核
+ * 同时比较模式串首字节和尾字节（一次 16/32 字节），只对两端都命中的候选位置逐字节验证，
+ * 在普通文本上几乎总能整块跳过。
+ *
+ * 忽略大小写时按 Unicode 简单大小写折叠比较（只包含折叠前后 UTF-8 长度相同的字符对，
+ * 因此文本不需要复制或转换，匹配长度始终等于模式串长度）。向量内核只比较不受大小写影响的字节
+ * （ASCII 字节和汉字等没有大小写之分的字符），候选位置再逐字符折叠验证；
+ * 模式串以有大小写之分的非 ASCII 字符开头且没有其它锚点时，纯 ASCII 的块整块跳过。
+ * 全字匹配在验证之后检查匹配两端的单词边界
+ */
+class TextSearch {
+public:
+    TextSearch();
+
+    /**
+     * 构造查找内核
+     * @param pattern 模式串
+     * @param caseSensitive 是否区分大小写
+     * @param wholeWord 是否全字匹配
+     */
+    explicit TextSearch(const std::string& pattern, bool caseSensitive = true, bool wholeWord = false);
+
+    /**
+     * 重新设置模式串
+     * @param pattern 模式串
+     * @param caseSensitive 是否区分大小写
+     * @param wholeWord 是否全字匹配
+     */
+    void setPattern(const std::string& pattern, bool caseSensitive = true, bool wholeWord = false);
+
+    /**
+     * 获取模式串
+     * @return 模式串
+     */
+    const std::string& getPattern() const;
+
+    /**
+     * 获取匹配的字节长度（调用方检查单词边界、计算匹配结束位置时使用，不要假定等于传入的模式串长度）
+     * @return 匹配长度
+     */
+    size_t getMatchLength() const;
+
+    /**
+     * 是否区分大小写
+     * @return 是否区分大小写
+     */
+    bool isCaseSensitive() const;
+
+    /**
+     * 是否全字匹配
+     * @return 是否全字匹配
+     */
+    bool isWholeWord() const;
+
+    /**
+     * 查找下一个匹配
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param from 开始查找位置
+     * @return 匹配位置，如果未找到（或模式串为空）则返回 std::string::npos
+     */
+    size_t find(const char* data, size_t length, size_t from = 0) const;
+
+    /**
+     * 查找最后一个匹配（从后向前扫描，不需要从头重复查找）
+     * @param data 数据起始地址
+     * @param length 数据长度（匹配必须完全落在 [from, length) 内）
+     * @param from 查找范围的起始位置
+     * @return 匹配位置，如果未找到（或模式串为空）则返回 std::string::npos
+     */
+    size_t findLast(const char* data, size_t length, size_t from = 0) const;
+
+    /**
+     * 检查指定位置是否匹配（调用方保证剩余长度不小于模式串长度，不检查全字匹配）
+     * @param candidate 候选位置
+     * @return 是否匹配
+     */
+    bool matchesAt(const char* candidate) const;
+
+    /**
+     * 检查一处匹配是否为完整的单词：匹配首字符是单词字符时要求前一个字符不是单词字符，
+     * 末字符是单词字符时要求后一个字符不是单词字符
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param start 匹配起始位置
+     * @param matchLength 匹配长度
+     * @return 是否为完整的单词（长度为 0 时返回 false）
+     */
+    static bool isWholeWord(const char* data, size_t length, size_t start, size_t matchLength);
+
+    /**
+     * 获取当前编译启用的向量指令集名称
+     * @return "AVX2"、"SSE2" 或 "scalar"
+     */
+    static const char* backendName();
+
+private:
+    std::string pattern_;  // 忽略大小写时保存折叠后的形式
+    bool caseSensitive_;
+    bool wholeWord_;
+    bool unicode_;         // 包含有大小写之分的非 ASCII 字符，需要逐字符折叠验证
+    bool exact_;           // 锚点命中即为匹配（不超过 2 字节的 ASCII 模式串）
+    size_t anchorFirst_;   // 第一个不受大小写影响的字节，没有时为 npos
+    size_t anchorLast_;    // 最后一个不受大小写影响的字节
+    bool foldFirst_;       // 首个锚点是字母且忽略大小写
+    bool foldLast_;        // 末个锚点是字母且忽略大小写
+
+    /**
+     * 检查全字匹配条件（未启用全字匹配时总是成立）
+     * @param data 数据起始地址
+     * @param length 数据长度
+     * @param position 匹配起始位置
+     * @return 是否满足
+     */
+    bool isWordBounded(const char* data, size_t length, size_t position) const;
+
+    /**
+     * 检查候选位置的首个锚点字节（没有锚点时要求是非 ASCII 字节）
+     * @param p 候选位置
+     * @return 是否可能匹配
+     */
+    bool isCandidate(const char* p) const;
+
+    size_t findScalar(const char* data, size_t length, size_t from) const;
+    size_t findLastScalar(const char* data, size_t length, size_t from, size_t end) const;
+};
+
+#endif // TEXT_SEARCH_H
@@ -0,0 +1,130 @@
+#include "ThreadPool.h"
+#include <iostream>
+
+namespace {
+
+// 当前线程所属的线程池及其序号，用于把派生的子任务放入本线程队列
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentIndex = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : queuedCount_(0), unfinishedCount_(0), nextQueue_(0), stop_(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 2;
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workCondition_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    size_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unfinishedCount_++;
+        if (currentPool == this) {
+            index = currentIndex;
+        } else {
+            index = nextQueue_;
+            nextQueue_ = (nextQueue_ + 1) % queues_.size();
+        }
+    }
+    {
+        WorkerQueue& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queuedCount_++;
+    }
+    workCondition_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return unfinishedCount_ == 0; });
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers_.size();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queuedCount_--;
+            }
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "Thread pool task failed: " << e.what() << std::endl;
+            }
+            task = nullptr;
+
+            bool idle = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                idle = --unfinishedCount_ == 0;
+            }
+            if (idle) {
+                idleCondition_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        workCondition_.wait(lock, [this]() { return stop_ || queuedCount_ > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, Task& task) {
+    {
+        WorkerQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // 从下一个线程开始依次尝试，避免所有空闲线程争抢同一个队列
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        WorkerQueue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 工作窃取线程池
+ * 每个工作线程有自己的任务队列：任务中提交的子任务放入本线程队列尾部并按后进先出执行，
+ * 保持深度优先和缓存局部性；本线程队列为空时从其他线程队列头部窃取最早提交的任务，
+ * 因此目录遍历这类不断派生子任务的负载能自动在线程间均衡
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * 构造线程池
+     * @param threadCount 工作线程数，0 表示使用硬件线程数
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * 析构线程池，尚未开始执行的任务被丢弃
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * 提交任务
+     * 在本线程池的工作线程中调用时放入当前线程的队列，否则轮流分配到各线程
+     * @param task 任务
+     */
+    void submit(Task task);
+
+    /**
+     * 等待所有已提交的任务（包括任务中派生的任务）执行完毕
+     * 不能在工作线程中调用
+     */
+    void wait();
+
+    /**
+     * 获取工作线程数
+     * @return 线程数
+     */
+    size_t getThreadCount() const;
+
+private:
+    /**
+     * 单个工作线程的任务队列
+     */
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    int64_t queuedCount_;      // 队列中尚未取出的任务数（入队与计数之间可能短暂为负）
+    size_t unfinishedCount_;   // 已提交但尚未执行完的任务数
+    size_t nextQueue_;         // 外部提交时轮流选择的队列
+    bool stop_;
+
+    /**
+     * 工作线程主循环
+     * @param index 线程序号
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * 从本线程队列尾部取任务，失败时从其他队列头部窃取
+     * @param index 线程序号
+     * @param task 输出任务
+     * @return 是否取到任务
+     */
+    bool takeTask(size_t index, Task& task);
+};
+
+#endif // THREAD_POOL_H
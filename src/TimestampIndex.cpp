@@ -0,0 +1,606 @@
+#include "TimestampIndex.h"
+#include "Editor.h"
+#include "PagedDocument.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// 只在行首这么多字节内查找时间戳（nginx 访问日志的时间在客户端地址之后）
+const size_t kMaxPrefix = 128;
+
+// 从分页文档读取一行时最多读取的字节数（时间戳可以从 kMaxPrefix 之前的任一位置开始）
+const size_t kPagedLineBytes = kMaxPrefix + 64;
+
+// 在分页文档中查找下一个换行符时每次读取的字节数
+const size_t kPagedScanBytes = 4096;
+
+// 识别格式时最多查看的行数和字节数
+const size_t kDetectLines = 64;
+const size_t kDetectBytes = 64 * 1024;
+
+const int64_t kMillisecondsPerDay = 86400000;
+
+// syslog 时间戳没有年份，统一按此年份计算（闰年，2 月 29 日也有效）
+const int kSyslogYear = 2000;
+
+const char* const kMonthNames[] = {"jan", "feb", "mar", "apr", "may", "jun",
+                                   "jul", "aug", "sep", "oct", "nov", "dec"};
+
+const TimestampFormat kFormats[] = {TimestampFormat::Iso8601, TimestampFormat::Syslog, TimestampFormat::CommonLog,
+                                    TimestampFormat::JavaLogging};
+
+/**
+ * 读取固定位数的十进制数
+ */
+bool readDigits(const char*& p, const char* end, int count, int& value) {
+    if (end - p < count) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        if (!std::isdigit(static_cast<unsigned char>(p[i]))) {
+            return false;
+        }
+        value = value * 10 + (p[i] - '0');
+    }
+    p += count;
+    return true;
+}
+
+/**
+ * 读取 1 到 2 位的十进制数
+ */
+bool readShortNumber(const char*& p, const char* end, int& value) {
+    if (!readDigits(p, end, 1, value)) {
+        return false;
+    }
+    int digit = 0;
+    if (p < end && std::isdigit(static_cast<unsigned char>(*p)) && readDigits(p, end, 1, digit)) {
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+/**
+ * 读取指定字符
+ */
+bool expect(const char*& p, const char* end, char c) {
+    if (p >= end || *p != c) {
+        return false;
+    }
+    p++;
+    return true;
+}
+
+/**
+ * 读取英文月份缩写（不区分大小写）
+ */
+bool readMonth(const char*& p, const char* end, int& month) {
+    if (end - p < 3) {
+        return false;
+    }
+    for (int i = 0; i < 12; i++) {
+        if (std::tolower(static_cast<unsigned char>(p[0])) == kMonthNames[i][0] &&
+            std::tolower(static_cast<unsigned char>(p[1])) == kMonthNames[i][1] &&
+            std::tolower(static_cast<unsigned char>(p[2])) == kMonthNames[i][2]) {
+            month = i + 1;
+            p += 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 读取时刻 H:MM:SS 或 HH:MM:SS，以及可选的小数秒（. 或 , 分隔）
+ */
+bool readClock(const char*& p, const char* end, int& hour, int& minute, int& second, int& millisecond) {
+    if (!readShortNumber(p, end, hour) || !expect(p, end, ':') || !readDigits(p, end, 2, minute) ||
+        !expect(p, end, ':') || !readDigits(p, end, 2, second)) {
+        return false;
+    }
+    millisecond = 0;
+    if (end - p >= 2 && (*p == '.' || *p == ',') && std::isdigit(static_cast<unsigned char>(p[1]))) {
+        p++;
+        int scale = 100;
+        for (; p < end && std::isdigit(static_cast<unsigned char>(*p)); p++) {
+            millisecond += (*p - '0') * scale;
+            scale /= 10;
+        }
+    }
+    return hour < 24 && minute < 60 && second <= 60;
+}
+
+bool validDate(int year, int month, int day) {
+    return year > 0 && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+/**
+ * 2024-03-05T14:32:05.123 / 2024-03-05 14:32:05,123 / 2024/03/05 14:32:05
+ */
+bool parseIso8601(const char* p, const char* end, int64_t& time) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, millisecond = 0;
+    if (!readDigits(p, end, 4, year) || p >= end || (*p != '-' && *p != '/')) {
+        return false;
+    }
+    char separator = *p++;
+    if (!readDigits(p, end, 2, month) || !expect(p, end, separator) || !readDigits(p, end, 2, day) ||
+        p >= end || (*p != 'T' && *p != ' ')) {
+        return false;
+    }
+    p++;
+    if (!readClock(p, end, hour, minute, second, millisecond) || !validDate(year, month, day)) {
+        return false;
+    }
+    time = TimestampIndex::toMilliseconds(year, month, day, hour, minute, second, millisecond);
+    return true;
+}
+
+/**
+ * Mar  5 14:32:05 / Mar 05 14:32:05
+ */
+bool parseSyslog(const char* p, const char* end, int64_t& time) {
+    int month = 0, day = 0, hour = 0, minute = 0, second = 0, millisecond = 0;
+    if (!readMonth(p, end, month) || !expect(p, end, ' ')) {
+        return false;
+    }
+    expect(p, end, ' ');
+    if (!readShortNumber(p, end, day) || !expect(p, end, ' ') ||
+        !readClock(p, end, hour, minute, second, millisecond) || !validDate(kSyslogYear, month, day)) {
+        return false;
+    }
+    time = TimestampIndex::toMilliseconds(kSyslogYear, month, day, hour, minute, second, millisecond);
+    return true;
+}
+
+/**
+ * 05/Mar/2024:14:32:05 / 05-Mar-2024 14:32:05.123
+ */
+bool parseCommonLog(const char* p, const char* end, int64_t& time) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, millisecond = 0;
+    if (!readDigits(p, end, 2, day) || p >= end || (*p != '/' && *p != '-')) {
+        return false;
+    }
+    char separator = *p++;
+    if (!readMonth(p, end, month) || !expect(p, end, separator) || !readDigits(p, end, 4, year) ||
+        p >= end || (*p != ':' && *p != ' ')) {
+        return false;
+    }
+    p++;
+    if (!readClock(p, end, hour, minute, second, millisecond) || !validDate(year, month, day)) {
+        return false;
+    }
+    time = TimestampIndex::toMilliseconds(year, month, day, hour, minute, second, millisecond);
+    return true;
+}
+
+/**
+ * Mar 05, 2024 2:32:05 PM
+ */
+bool parseJavaLogging(const char* p, const char* end, int64_t& time) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, millisecond = 0;
+    if (!readMonth(p, end, month) || !expect(p, end, ' ') || !readShortNumber(p, end, day) ||
+        !expect(p, end, ',') || !expect(p, end, ' ') || !readDigits(p, end, 4, year) || !expect(p, end, ' ') ||
+        !readClock(p, end, hour, minute, second, millisecond) || !expect(p, end, ' ') || end - p < 2 ||
+        hour < 1 || hour > 12 || !validDate(year, month, day)) {
+        return false;
+    }
+    char meridiem = static_cast<char>(std::toupper(static_cast<unsigned char>(*p)));
+    if ((meridiem != 'A' && meridiem != 'P') || std::toupper(static_cast<unsigned char>(p[1])) != 'M') {
+        return false;
+    }
+    hour = hour % 12 + (meridiem == 'P' ? 12 : 0);
+    time = TimestampIndex::toMilliseconds(year, month, day, hour, minute, second, millisecond);
+    return true;
+}
+
+/**
+ * 解析只有时刻的输入：14:32、14:32:05、14:32:05.250
+ */
+bool parseTimeOfDay(const std::string& text, int64_t& time) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    int hour = 0, minute = 0, second = 0, millisecond = 0;
+    if (!readShortNumber(p, end, hour) || !expect(p, end, ':') || !readDigits(p, end, 2, minute)) {
+        return false;
+    }
+    if (p < end) {
+        const char* clock = text.data();
+        if (!readClock(clock, end, hour, minute, second, millisecond) || clock != end) {
+            return false;
+        }
+    }
+    if (hour >= 24 || minute >= 60) {
+        return false;
+    }
+    time = ((hour * 60 + minute) * 60 + second) * 1000LL + millisecond;
+    return true;
+}
+
+/**
+ * 解析只有日期的输入：2024-03-05（当天零点）
+ */
+bool parseDate(const std::string& text, int64_t& time) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    int year = 0, month = 0, day = 0;
+    if (!readDigits(p, end, 4, year) || p >= end || (*p != '-' && *p != '/')) {
+        return false;
+    }
+    char separator = *p++;
+    if (!readDigits(p, end, 2, month) || !expect(p, end, separator) || !readDigits(p, end, 2, day) || p != end ||
+        !validDate(year, month, day)) {
+        return false;
+    }
+    time = TimestampIndex::toMilliseconds(year, month, day, 0, 0, 0, 0);
+    return true;
+}
+
+}  // namespace
+
+TimestampIndex::TimestampIndex(size_t sampleInterval)
+    : editListenerId_(0), document_(nullptr), sampleInterval_(std::max<size_t>(sampleInterval, 1)),
+      format_(TimestampFormat::None), formatDetected_(false), parsedCount_(0) {
+}
+
+TimestampIndex::~TimestampIndex() {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+    }
+}
+
+void TimestampIndex::setEditor(std::shared_ptr<Editor> editor) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+    }
+    editor_ = editor;
+    document_ = nullptr;
+    if (editor_) {
+        editListenerId_ = editor_->addEditListener([this](const TextEdit& edit) { handleEdit(edit); });
+    }
+    reset();
+}
+
+void TimestampIndex::setPagedDocument(PagedDocument* document) {
+    if (editor_) {
+        editor_->removeEditListener(editListenerId_);
+        editListenerId_ = 0;
+        editor_.reset();
+    }
+    document_ = document;
+    reset();
+}
+
+void TimestampIndex::setSampleInterval(size_t sampleInterval) {
+    sampleInterval_ = std::max<size_t>(sampleInterval, 1);
+    samples_.clear();
+    parsedCount_ = 0;
+}
+
+TimestampFormat TimestampIndex::getFormat() {
+    if (!formatDetected_ && document_) {
+        std::string head;
+        document_->read(0, kDetectBytes, head);
+        format_ = detectFormat(head.data(), head.size());
+        formatDetected_ = true;
+    } else if (!formatDetected_ && editor_) {
+        std::string_view content = editor_->getContentView();
+        format_ = detectFormat(content.data(), std::min(content.size(), kDetectBytes));
+        formatDetected_ = true;
+    }
+    return hasSource() ? format_ : TimestampFormat::None;
+}
+
+bool TimestampIndex::findLine(const std::string& query, size_t& line) {
+    size_t first = query.find_first_not_of(" \t");
+    size_t last = query.find_last_not_of(" \t");
+    if (first == std::string::npos || getFormat() == TimestampFormat::None) {
+        return false;
+    }
+    std::string text = query.substr(first, last - first + 1);
+
+    int64_t time = 0;
+    for (TimestampFormat format : kFormats) {
+        if (parseTimestamp(text.data(), text.size(), format, time)) {
+            return findLineAtTime(time, line);
+        }
+    }
+    if (parseDate(text, time)) {
+        return findLineAtTime(time, line);
+    }
+    if (!parseTimeOfDay(text, time)) {
+        return false;
+    }
+    // 只有时刻：取第一个时间戳的日期
+    Sample head{true, 0, 0};
+    if (document_) {
+        uint64_t offset = 0;
+        head.line = pagedKeyAt(0, offset, head.time) ? 0 : std::string::npos;
+    } else {
+        head = sampleAt(0);
+    }
+    if (head.line == std::string::npos) {
+        return false;
+    }
+    int64_t day = head.time / kMillisecondsPerDay * kMillisecondsPerDay;
+    if (head.time < 0 && head.time % kMillisecondsPerDay != 0) {
+        day -= kMillisecondsPerDay;
+    }
+    time += day;
+    if (time < head.time) {
+        time += kMillisecondsPerDay;
+    }
+    return findLineAtTime(time, line);
+}
+
+bool TimestampIndex::findLineAtTime(int64_t time, size_t& line) {
+    if (document_ && getFormat() != TimestampFormat::None) {
+        return findPagedLineAtTime(time, line);
+    }
+    if (!editor_ || getFormat() == TimestampFormat::None) {
+        return false;
+    }
+    size_t lineCount = editor_->getLineIndex().getLineCount();
+    size_t sampleCount = (lineCount + sampleInterval_ - 1) / sampleInterval_;
+    Sample head = sampleAt(0);
+    if (head.line == std::string::npos) {
+        return false;
+    }
+    if (head.time >= time) {
+        line = head.line;
+        return true;
+    }
+
+    // 找到第一个键不早于目标时间的采样点，目标行在它与前一个采样点的键之间
+    size_t low = 1;
+    size_t high = sampleCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        Sample sample = sampleAt(middle);
+        if (sample.line != std::string::npos && sample.time < time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    size_t from = sampleAt(low - 1).line;
+    size_t to = lineCount - 1;
+    if (low < sampleCount && sampleAt(low).line != std::string::npos) {
+        to = sampleAt(low).line;
+    }
+    for (size_t current = from; current <= to; current++) {
+        int64_t lineTime = 0;
+        if (getLineTime(current, lineTime) && lineTime >= time) {
+            line = current;
+            return true;
+        }
+    }
+    line = lineCount - 1;
+    return true;
+}
+
+bool TimestampIndex::getLineTime(size_t line, int64_t& time) {
+    if (document_ && getFormat() != TimestampFormat::None) {
+        std::string text;
+        return document_->getLine(line, text, kPagedLineBytes) &&
+               parseTimestamp(text.data(), text.size(), format_, time);
+    }
+    if (!editor_ || getFormat() == TimestampFormat::None) {
+        return false;
+    }
+    const LineIndex& lines = editor_->getLineIndex();
+    if (line >= lines.getLineCount()) {
+        return false;
+    }
+    size_t start = lines.getLineStart(line);
+    size_t end = lines.getLineEnd(line);
+    return parseTimestamp(editor_->getContentView().data() + start, end - start, format_, time);
+}
+
+size_t TimestampIndex::getParsedSampleCount() const {
+    return parsedCount_;
+}
+
+TimestampFormat TimestampIndex::detectFormat(const char* data, size_t length) {
+    size_t hits[sizeof(kFormats) / sizeof(kFormats[0])] = {};
+    size_t pos = 0;
+    for (size_t count = 0; count < kDetectLines && pos < length; count++) {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', length - pos));
+        size_t end = newline ? static_cast<size_t>(newline - data) : length;
+        for (size_t i = 0; i < sizeof(kFormats) / sizeof(kFormats[0]); i++) {
+            int64_t time = 0;
+            hits[i] += parseTimestamp(data + pos, end - pos, kFormats[i], time) ? 1 : 0;
+        }
+        pos = end + 1;
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < sizeof(kFormats) / sizeof(kFormats[0]); i++) {
+        best = hits[i] > hits[best] ? i : best;
+    }
+    return hits[best] > 0 ? kFormats[best] : TimestampFormat::None;
+}
+
+bool TimestampIndex::parseTimestamp(const char* data, size_t length, TimestampFormat format, int64_t& time) {
+    // 时间戳必须从单词开头开始，避免把较长数字的后半部分当作年份或日期
+    const char* end = data + length;
+    const char* limit = data + std::min(length, kMaxPrefix);
+    bool numeric = format == TimestampFormat::Iso8601 || format == TimestampFormat::CommonLog;
+    for (const char* p = data; p < limit; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if ((numeric ? !std::isdigit(c) : !std::isalpha(c)) ||
+            (p > data && std::isalnum(static_cast<unsigned char>(p[-1])))) {
+            continue;
+        }
+        bool parsed = false;
+        switch (format) {
+            case TimestampFormat::Iso8601:
+                parsed = parseIso8601(p, end, time);
+                break;
+            case TimestampFormat::Syslog:
+                parsed = parseSyslog(p, end, time);
+                break;
+            case TimestampFormat::CommonLog:
+                parsed = parseCommonLog(p, end, time);
+                break;
+            case TimestampFormat::JavaLogging:
+                parsed = parseJavaLogging(p, end, time);
+                break;
+            case TimestampFormat::None:
+                return false;
+        }
+        if (parsed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t TimestampIndex::toMilliseconds(int year, int month, int day, int hour, int minute, int second,
+                                       int millisecond) {
+    // 公历日期换算为从 1970-01-01 起的天数（以 3 月为一年的开始，闰日落在年末）
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yearOfEra = y - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = era * 146097 + dayOfEra - 719468;
+    return ((days * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL + millisecond;
+}
+
+void TimestampIndex::handleEdit(const TextEdit& edit) {
+    // 开头的行变化（如重新载入或按保留上限丢弃开头的行）后格式和所有采样点都可能变化
+    if (edit.startLine == 0) {
+        reset();
+        return;
+    }
+    // 采样行在编辑行之后的采样点行号已经平移，全部丢弃
+    size_t keep = std::min(samples_.size(), edit.startLine / sampleInterval_ + 1);
+    for (size_t i = keep; i < samples_.size(); i++) {
+        parsedCount_ -= samples_[i].parsed ? 1 : 0;
+    }
+    samples_.resize(keep);
+    // 键位于编辑行或之后的采样点（键是向后查找得到的）也要丢弃；键随下标递增，遇到更早的键即可停止
+    for (size_t i = keep; i > 0 && parsedCount_ > 0; i--) {
+        Sample& sample = samples_[i - 1];
+        if (!sample.parsed) {
+            continue;
+        }
+        if (sample.line != std::string::npos && sample.line < edit.startLine) {
+            break;
+        }
+        sample.parsed = false;
+        parsedCount_--;
+    }
+}
+
+void TimestampIndex::reset() {
+    samples_.clear();
+    parsedCount_ = 0;
+    formatDetected_ = false;
+    format_ = TimestampFormat::None;
+}
+
+bool TimestampIndex::hasSource() const {
+    return editor_ || document_;
+}
+
+bool TimestampIndex::pagedKeyAt(uint64_t offset, uint64_t& lineOffset, int64_t& time) {
+    uint64_t size = document_->getSize();
+    std::string chunk;
+    // 前一个字节不是换行符时跳到下一个行首
+    uint64_t position = offset;
+    if (position > 0 && !(document_->read(position - 1, 1, chunk) && chunk == "\n")) {
+        for (;;) {
+            if (position >= size || !document_->read(position, kPagedScanBytes, chunk) || chunk.empty()) {
+                return false;
+            }
+            size_t newline = chunk.find('\n');
+            if (newline != std::string::npos) {
+                position += newline + 1;
+                break;
+            }
+            position += chunk.size();
+        }
+    }
+    // 没有时间戳的行（堆栈等）属于前面的日志行，继续向后找
+    while (position < size) {
+        if (!document_->read(position, kPagedLineBytes, chunk) || chunk.empty()) {
+            return false;
+        }
+        size_t newline = chunk.find('\n');
+        if (parseTimestamp(chunk.data(), newline == std::string::npos ? chunk.size() : newline, format_, time)) {
+            lineOffset = position;
+            return true;
+        }
+        while (newline == std::string::npos) {
+            position += chunk.size();
+            if (position >= size || !document_->read(position, kPagedScanBytes, chunk) || chunk.empty()) {
+                return false;
+            }
+            newline = chunk.find('\n');
+        }
+        position += newline + 1;
+    }
+    return false;
+}
+
+bool TimestampIndex::findPagedLineAtTime(int64_t time, size_t& line) {
+    uint64_t keyOffset = 0;
+    int64_t keyTime = 0;
+    if (!pagedKeyAt(0, keyOffset, keyTime)) {
+        return false;
+    }
+    // 从偏移 o 之后找到的第一个时间戳随 o 单调不减：二分出第一个不早于目标时间的位置
+    uint64_t low = 0;
+    uint64_t high = document_->getSize();
+    uint64_t found = high;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (pagedKeyAt(middle, keyOffset, keyTime) && keyTime >= time) {
+            found = keyOffset;
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    // 行索引尚未覆盖结果位置时在当前线程中按需扩展
+    line = static_cast<size_t>(document_->getLineOfOffset(found));
+    return true;
+}
+
+const TimestampIndex::Sample& TimestampIndex::sampleAt(size_t index) {
+    if (index < samples_.size() && samples_[index].parsed) {
+        return samples_[index];
+    }
+    // 从采样行向后逐行解析，遇到已解析的采样点时直接沿用它的键
+    size_t lineCount = editor_->getLineIndex().getLineCount();
+    Sample found{true, std::string::npos, 0};
+    size_t last = index;
+    for (size_t block = index; block * sampleInterval_ < lineCount; block++) {
+        last = block;
+        if (block < samples_.size() && samples_[block].parsed) {
+            found = samples_[block];
+            break;
+        }
+        size_t end = std::min(lineCount, (block + 1) * sampleInterval_);
+        bool hit = false;
+        for (size_t line = block * sampleInterval_; line < end && !hit; line++) {
+            hit = getLineTime(line, found.time);
+            found.line = hit ? line : found.line;
+        }
+        if (hit) {
+            break;
+        }
+    }
+    if (samples_.size() <= last) {
+        samples_.resize(last + 1, Sample{false, std::string::npos, 0});
+    }
+    for (size_t block = index; block <= last; block++) {
+        parsedCount_ += samples_[block].parsed ? 0 : 1;
+        samples_[block] = found;
+    }
+    return samples_[index];
+}
@@ -0,0 +1,198 @@
+#ifndef TIMESTAMP_INDEX_H
+#define TIMESTAMP_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Editor;
+class PagedDocument;
+struct TextEdit;
+
+/**
+ * 日志时间戳格式
+ */
+enum class TimestampFormat {
+    None,        // 未识别
+    Iso8601,     // 2024-03-05T14:32:05.123、2024-03-05 14:32:05,123（log4j/logback）、2024/03/05 14:32:05（nginx 错误日志）
+    Syslog,      // Mar  5 14:32:05（没有年份）
+    CommonLog,   // 05/Mar/2024:14:32:05（nginx/Apache 访问日志）、05-Mar-2024 14:32:05.123（Tomcat）
+    JavaLogging  // Mar 05, 2024 2:32:05 PM（java.util.logging）
+};
+
+/**
+ * 稀疏时间戳索引（跳转到时间）
+ * 日志按时间顺序写入，因此每隔 K 行取一个采样点，采样点的键是从该行开始的第一个时间戳。
+ * 采样点只在二分查找访问到时才解析并缓存，跳转时先在采样点上二分，再在相邻两个采样点之间逐行查找，
+ * 只需解析 O(log(n/K) + K) 行，不必解析整个文件。
+ *
+ * 时间戳按日志中的本地时间比较，忽略时区；syslog 格式没有年份，只在同一年内比较。
+ * 编辑后丢弃受影响的采样点（跟随模式追加到末尾时只涉及最后几个），下次查找时重新解析。
+ *
+ * 以分页模式打开的大文件也可以作为来源。分页文档的行索引在后台建立，建立完成前行数只是估算值，
+ * 因此改为按字节偏移二分：从某个偏移之后的第一个行首开始向后找第一个时间戳，
+ * 经过块缓存只读取 O(log(文件大小)) 处，最后才把结果偏移换算为行号
+ */
+class TimestampIndex {
+public:
+    /**
+     * 构造函数
+     * @param sampleInterval 采样间隔（行数）
+     */
+    explicit TimestampIndex(size_t sampleInterval = 256);
+    ~TimestampIndex();
+
+    TimestampIndex(const TimestampIndex&) = delete;
+    TimestampIndex& operator=(const TimestampIndex&) = delete;
+
+    /**
+     * 设置编辑器实例，订阅其范围编辑
+     * @param editor 编辑器指针
+     */
+    void setEditor(std::shared_ptr<Editor> editor);
+
+    /**
+     * 设置分页文档作为来源（取代编辑器；分页文档只读，不需要订阅编辑）
+     * @param document 分页文档（为空指针时清除来源），调用方保证其生命周期
+     */
+    void setPagedDocument(PagedDocument* document);
+
+    /**
+     * 设置采样间隔，丢弃已解析的采样点
+     * @param sampleInterval 采样间隔（行数，至少为 1）
+     */
+    void setSampleInterval(size_t sampleInterval);
+
+    /**
+     * 获取文档的时间戳格式（第一次调用时根据开头若干行识别）
+     * @return 时间戳格式
+     */
+    TimestampFormat getFormat();
+
+    /**
+     * 按用户输入的时间查找行
+     * 输入可以是任一支持的格式，也可以只有时刻（14:32、14:32:05、14:32:05.250），
+     * 只有时刻时使用文档中第一个时间戳的日期（早于第一个时间戳时取下一天）
+     * @param query 输入的时间
+     * @param line 输出行号（从0开始）
+     * @return 是否成功（输入无法解析或文档中没有时间戳时返回 false）
+     */
+    bool findLine(const std::string& query, size_t& line);
+
+    /**
+     * 查找时间戳不早于指定时间的第一行
+     * @param time 时间（毫秒）
+     * @param line 输出行号（从0开始），所有时间戳都更早时为最后一行
+     * @return 是否成功（文档中没有时间戳时返回 false）
+     */
+    bool findLineAtTime(int64_t time, size_t& line);
+
+    /**
+     * 获取一行的时间戳
+     * @param line 行号（从0开始）
+     * @param time 输出时间（毫秒）
+     * @return 该行是否带有时间戳
+     */
+    bool getLineTime(size_t line, int64_t& time);
+
+    /**
+     * 获取已解析的采样点数
+     * @return 采样点数
+     */
+    size_t getParsedSampleCount() const;
+
+    /**
+     * 根据开头若干行识别时间戳格式（取识别成功次数最多的格式）
+     * @param data 内容
+     * @param length 内容长度
+     * @return 时间戳格式
+     */
+    static TimestampFormat detectFormat(const char* data, size_t length);
+
+    /**
+     * 在一行的开头部分查找并解析指定格式的时间戳
+     * @param data 行内容
+     * @param length 行长度（不含换行符）
+     * @param format 时间戳格式
+     * @param time 输出时间（从 1970-01-01 起的毫秒数，按本地时间计算）
+     * @return 是否找到
+     */
+    static bool parseTimestamp(const char* data, size_t length, TimestampFormat format, int64_t& time);
+
+    /**
+     * 把日期和时刻换算为毫秒数
+     * @param year 年
+     * @param month 月（1-12）
+     * @param day 日
+     * @param hour 时
+     * @param minute 分
+     * @param second 秒
+     * @param millisecond 毫秒
+     * @return 从 1970-01-01 起的毫秒数
+     */
+    static int64_t toMilliseconds(int year, int month, int day, int hour, int minute, int second, int millisecond);
+
+private:
+    /**
+     * 采样点：从采样行开始的第一个时间戳
+     */
+    struct Sample {
+        bool parsed;   // 是否已解析
+        size_t line;   // 时间戳所在行，之后都没有时间戳时为 npos
+        int64_t time;  // 时间戳
+    };
+
+    std::shared_ptr<Editor> editor_;
+    size_t editListenerId_;
+    PagedDocument* document_;
+    size_t sampleInterval_;
+    TimestampFormat format_;
+    bool formatDetected_;
+    std::vector<Sample> samples_;  // 按需增长，超出部分视为未解析
+    size_t parsedCount_;
+
+    /**
+     * 处理范围编辑：丢弃键可能在编辑范围内或之后的采样点
+     * @param edit 编辑描述
+     */
+    void handleEdit(const TextEdit& edit);
+
+    /**
+     * 丢弃全部采样点并在下次使用时重新识别格式
+     */
+    void reset();
+
+    /**
+     * 是否设置了来源
+     * @return 是否有编辑器或分页文档
+     */
+    bool hasSource() const;
+
+    /**
+     * 在分页文档中从 offset 之后的第一个行首（offset 本身是行首时就从它开始）向后查找第一个时间戳
+     * @param offset 偏移
+     * @param lineOffset 输出时间戳所在行的起始偏移
+     * @param time 输出时间戳
+     * @return 是否找到（之后都没有时间戳时返回 false）
+     */
+    bool pagedKeyAt(uint64_t offset, uint64_t& lineOffset, int64_t& time);
+
+    /**
+     * 在分页文档中查找时间戳不早于指定时间的第一行（按字节偏移二分）
+     * @param time 时间（毫秒）
+     * @param line 输出行号，所有时间戳都更早时为最后一行
+     * @return 是否成功
+     */
+    bool findPagedLineAtTime(int64_t time, size_t& line);
+
+    /**
+     * 获取采样点的键（未解析时从采样行开始向后逐行解析，
+     * 一整段都没有时间戳时沿用下一个采样点的键）
+     * @param index 采样点下标
+     * @return 采样点
+     */
+    const Sample& sampleAt(size_t index);
+};
+
+#endif // TIMESTAMP_INDEX_H
@@ -0,0 +1,509 @@
+#include "Transcoder.h"
+#include "AtomicFileWriter.h"
+#include "Gb18030Table.h"
+#include "UnicodeText.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LITEPAD_TRANSCODER_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// 打开和保存时每次转换的字节数
+const size_t kChunkBytes = 1024 * 1024;
+
+// 一个字符在任一编码中的最大字节数
+const size_t kMaxSequence = 4;
+
+// BMP 以外的码位在 GB18030 四字节区中的起始线性序号（0x90308130）
+const uint32_t kGb18030SupplementaryLinear = 189000;
+
+// Windows-1252 中 0x80-0x9F 对应的码位（未定义的五个字节映射到同值的 C1 控制字符，保证一一对应）
+const uint16_t kWindows1252High[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+inline size_t countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<size_t>(index);
+#else
+    return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+}
+
+/**
+ * 从开头起连续 ASCII 字节的个数
+ */
+inline size_t asciiRun(const unsigned char* data, size_t length) {
+    size_t pos = 0;
+#if defined(LITEPAD_TRANSCODER_SSE2)
+    while (pos + 16 <= length) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+        if (mask != 0) {
+            return pos + countTrailingZeros(mask);
+        }
+        pos += 16;
+    }
+#endif
+    while (pos < length && data[pos] < 0x80) {
+        pos++;
+    }
+    return pos;
+}
+
+/**
+ * 解码一个完整的 UTF-8 字符
+ * @return 字节数；不完整时为 0；无效时为 SIZE_MAX
+ */
+inline size_t decodeUtf8(const unsigned char* data, size_t length, uint32_t& codePoint) {
+    unsigned char lead = data[0];
+    size_t size = lead < 0x80 ? 1 : lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (size == 0) {
+        return SIZE_MAX;
+    }
+    if (size > length) {
+        // 已有的后续字节有误时不必等下一段
+        for (size_t i = 1; i < length; i++) {
+            if ((data[i] & 0xC0) != 0x80) {
+                return SIZE_MAX;
+            }
+        }
+        return 0;
+    }
+    return UnicodeText::decode(reinterpret_cast<const char*>(data), size, codePoint) == size ? size : SIZE_MAX;
+}
+
+inline void appendUtf8(uint32_t codePoint, std::string& output) {
+    char buffer[4];
+    output.append(buffer, UnicodeText::encode(codePoint, buffer));
+}
+
+inline void appendUtf16(uint32_t unit, bool bigEndian, std::string& output) {
+    char bytes[2];
+    bytes[bigEndian ? 1 : 0] = static_cast<char>(unit & 0xFF);
+    bytes[bigEndian ? 0 : 1] = static_cast<char>(unit >> 8);
+    output.append(bytes, 2);
+}
+
+/**
+ * GB18030 四字节区的线性序号转为码位
+ * @return 是否为有效的序号
+ */
+bool gb18030LinearToCodePoint(uint32_t linear, uint32_t& codePoint) {
+    if (linear < kGb18030BmpLinearCount) {
+        const Gb18030Range* end = kGb18030Ranges + kGb18030RangeCount;
+        const Gb18030Range* range = std::upper_bound(kGb18030Ranges, end, linear,
+            [](uint32_t value, const Gb18030Range& entry) { return value < entry.linear; });
+        if (range == kGb18030Ranges) {
+            return false;
+        }
+        --range;
+        codePoint = range->codePoint + (linear - range->linear);
+        return codePoint < 0xD800 || codePoint > 0xDFFF;
+    }
+    if (linear >= kGb18030SupplementaryLinear && linear < kGb18030SupplementaryLinear + 0x100000) {
+        codePoint = 0x10000 + (linear - kGb18030SupplementaryLinear);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * BMP 码位到 GB18030 双字节编码的反查表（0 表示不在双字节区）
+ */
+const std::vector<uint16_t>& gb18030ReverseTable() {
+    static const std::vector<uint16_t> table = [] {
+        std::vector<uint16_t> reverse(0x10000, 0);
+        for (size_t i = 0; i < kGb18030TwoByteCount; i++) {
+            size_t lead = 0x81 + i / 190;
+            size_t trail = i % 190;
+            trail += trail < 63 ? 0x40 : 0x41;
+            reverse[kGb18030TwoByte[i]] = static_cast<uint16_t>((lead << 8) | trail);
+        }
+        return reverse;
+    }();
+    return table;
+}
+
+void appendGb18030(uint32_t codePoint, const std::vector<uint16_t>& reverse, std::string& output) {
+    uint32_t linear;
+    if (codePoint >= 0x10000) {
+        linear = kGb18030SupplementaryLinear + (codePoint - 0x10000);
+    } else {
+        uint16_t twoByte = reverse[codePoint];
+        if (twoByte != 0) {
+            char bytes[2] = {static_cast<char>(twoByte >> 8), static_cast<char>(twoByte & 0xFF)};
+            output.append(bytes, 2);
+            return;
+        }
+        const Gb18030Range* end = kGb18030Ranges + kGb18030RangeCount;
+        const Gb18030Range* range = std::upper_bound(kGb18030Ranges, end, codePoint,
+            [](uint32_t value, const Gb18030Range& entry) { return value < entry.codePoint; });
+        --range;  // 第一个分段从 U+0080 开始，ASCII 不会走到这里
+        linear = range->linear + (codePoint - range->codePoint);
+    }
+    char bytes[4];
+    bytes[3] = static_cast<char>(0x30 + linear % 10);
+    linear /= 10;
+    bytes[2] = static_cast<char>(0x81 + linear % 126);
+    linear /= 126;
+    bytes[1] = static_cast<char>(0x30 + linear % 10);
+    bytes[0] = static_cast<char>(0x81 + linear / 10);
+    output.append(bytes, 4);
+}
+
+bool encodeWindows1252(uint32_t codePoint, char& byte) {
+    if (codePoint < 0x80 || (codePoint >= 0xA0 && codePoint <= 0xFF)) {
+        byte = static_cast<char>(codePoint);
+        return true;
+    }
+    for (size_t i = 0; i < 32; i++) {
+        if (kWindows1252High[i] == codePoint) {
+            byte = static_cast<char>(0x80 + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+Transcoder::Transcoder(TextEncoding encoding) : encoding_(encoding) {}
+
+bool Transcoder::supports(TextEncoding encoding) {
+    return encoding == TextEncoding::Utf16LE || encoding == TextEncoding::Utf16BE ||
+           encoding == TextEncoding::Gb18030 || encoding == TextEncoding::Windows1252;
+}
+
+void Transcoder::reset() {
+    pending_.clear();
+}
+
+bool Transcoder::decode(const char* data, size_t length, std::string& output, bool final) {
+    return process(data, length, output, final, false);
+}
+
+bool Transcoder::encode(const char* data, size_t length, std::string& output, bool final) {
+    return process(data, length, output, final, true);
+}
+
+bool Transcoder::process(const char* data, size_t length, std::string& output, bool final, bool encoding) {
+    auto some = [this, encoding, &output](const char* bytes, size_t size, size_t& consumed) {
+        const unsigned char* input = reinterpret_cast<const unsigned char*>(bytes);
+        return encoding ? encodeSome(input, size, output, consumed) : decodeSome(input, size, output, consumed);
+    };
+
+    size_t consumed = 0;
+    if (!pending_.empty()) {
+        // 上一段末尾的字符最多再需要 kMaxSequence 个字节
+        size_t taken = std::min(length, kMaxSequence);
+        std::string joined = pending_ + std::string(data, taken);
+        if (!some(joined.data(), joined.size(), consumed)) {
+            return false;
+        }
+        if (consumed < pending_.size()) {
+            if (taken < length) {
+                return false;
+            }
+            pending_ = joined.substr(consumed);
+            return !final;
+        }
+        data += consumed - pending_.size();
+        length -= consumed - pending_.size();
+        pending_.clear();
+    }
+
+    if (!some(data, length, consumed)) {
+        return false;
+    }
+    pending_.assign(data + consumed, length - consumed);
+    return !final || pending_.empty();
+}
+
+bool Transcoder::decodeSome(const unsigned char* data, size_t length, std::string& output,
+                            size_t& consumed) const {
+    size_t pos = 0;
+    switch (encoding_) {
+    case TextEncoding::Utf16LE:
+    case TextEncoding::Utf16BE: {
+        bool bigEndian = encoding_ == TextEncoding::Utf16BE;
+        while (pos + 2 <= length) {
+#if defined(LITEPAD_TRANSCODER_SSE2)
+            // 8 个码元都小于 0x80 时取出低字节整段追加
+            const __m128i asciiMask = _mm_set1_epi16(static_cast<short>(bigEndian ? 0x80FF : 0xFF80));
+            const __m128i zero = _mm_setzero_si128();
+            while (pos + 16 <= length) {
+                __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i high = _mm_cmpeq_epi16(_mm_and_si128(units, asciiMask), zero);
+                if (_mm_movemask_epi8(high) != 0xFFFF) {
+                    break;
+                }
+                if (bigEndian) {
+                    units = _mm_srli_epi16(units, 8);
+                }
+                char bytes[16];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), _mm_packus_epi16(units, units));
+                output.append(bytes, 8);
+                pos += 16;
+            }
+            if (pos + 2 > length) {
+                break;
+            }
+#endif
+            uint32_t unit = bigEndian ? (data[pos] << 8) | data[pos + 1] : data[pos] | (data[pos + 1] << 8);
+            if (unit >= 0xDC00 && unit <= 0xDFFF) {
+                return false;
+            }
+            if (unit >= 0xD800 && unit <= 0xDBFF) {
+                if (pos + 4 > length) {
+                    break;
+                }
+                uint32_t low = bigEndian ? (data[pos + 2] << 8) | data[pos + 3] : data[pos + 2] | (data[pos + 3] << 8);
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                appendUtf8(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00), output);
+                pos += 4;
+            } else {
+                appendUtf8(unit, output);
+                pos += 2;
+            }
+        }
+        break;
+    }
+    case TextEncoding::Gb18030:
+        while (pos < length) {
+            size_t run = asciiRun(data + pos, length - pos);
+            output.append(reinterpret_cast<const char*>(data + pos), run);
+            pos += run;
+            if (pos >= length) {
+                break;
+            }
+            unsigned char lead = data[pos];
+            if (lead == 0x80 || lead == 0xFF) {
+                return false;
+            }
+            if (pos + 2 > length) {
+                break;
+            }
+            unsigned char second = data[pos + 1];
+            if (second >= 0x30 && second <= 0x39) {
+                if (pos + 4 > length) {
+                    if (pos + 3 == length && (data[pos + 2] < 0x81 || data[pos + 2] == 0xFF)) {
+                        return false;
+                    }
+                    break;
+                }
+                unsigned char third = data[pos + 2];
+                unsigned char fourth = data[pos + 3];
+                if (third < 0x81 || third == 0xFF || fourth < 0x30 || fourth > 0x39) {
+                    return false;
+                }
+                uint32_t linear =
+                    (((lead - 0x81) * 10 + (second - 0x30)) * 126 + (third - 0x81)) * 10 + (fourth - 0x30);
+                uint32_t codePoint = 0;
+                if (!gb18030LinearToCodePoint(linear, codePoint)) {
+                    return false;
+                }
+                appendUtf8(codePoint, output);
+                pos += 4;
+            } else {
+                size_t trail;
+                if (second >= 0x40 && second <= 0x7E) {
+                    trail = second - 0x40;
+                } else if (second >= 0x80 && second <= 0xFE) {
+                    trail = second - 0x41;
+                } else {
+                    return false;
+                }
+                appendUtf8(kGb18030TwoByte[(lead - 0x81) * 190 + trail], output);
+                pos += 2;
+            }
+        }
+        break;
+    case TextEncoding::Windows1252:
+        while (pos < length) {
+            size_t run = asciiRun(data + pos, length - pos);
+            output.append(reinterpret_cast<const char*>(data + pos), run);
+            pos += run;
+            if (pos < length) {
+                unsigned char byte = data[pos++];
+                appendUtf8(byte < 0xA0 ? kWindows1252High[byte - 0x80] : byte, output);
+            }
+        }
+        break;
+    default:
+        return false;
+    }
+    consumed = pos;
+    return true;
+}
+
+bool Transcoder::encodeSome(const unsigned char* data, size_t length, std::string& output,
+                            size_t& consumed) const {
+    bool bigEndian = encoding_ == TextEncoding::Utf16BE;
+    bool utf16 = bigEndian || encoding_ == TextEncoding::Utf16LE;
+    const std::vector<uint16_t>* reverse = encoding_ == TextEncoding::Gb18030 ? &gb18030ReverseTable() : nullptr;
+    if (!utf16 && !reverse && encoding_ != TextEncoding::Windows1252) {
+        return false;
+    }
+
+    size_t pos = 0;
+    while (pos < length) {
+        size_t run = asciiRun(data + pos, length - pos);
+        if (!utf16) {
+            output.append(reinterpret_cast<const char*>(data + pos), run);
+            pos += run;
+        } else {
+            size_t end = pos + run;
+#if defined(LITEPAD_TRANSCODER_SSE2)
+            // 每个字节补一个零字节成为码元
+            const __m128i zero = _mm_setzero_si128();
+            while (pos + 16 <= end) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                char units[32];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(units),
+                                 bigEndian ? _mm_unpacklo_epi8(zero, bytes) : _mm_unpacklo_epi8(bytes, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(units + 16),
+                                 bigEndian ? _mm_unpackhi_epi8(zero, bytes) : _mm_unpackhi_epi8(bytes, zero));
+                output.append(units, 32);
+                pos += 16;
+            }
+#endif
+            for (; pos < end; pos++) {
+                appendUtf16(data[pos], bigEndian, output);
+            }
+        }
+        if (pos >= length) {
+            break;
+        }
+
+        uint32_t codePoint = 0;
+        size_t size = decodeUtf8(data + pos, length - pos, codePoint);
+        if (size == 0) {
+            break;
+        }
+        if (size == SIZE_MAX) {
+            return false;
+        }
+        if (utf16) {
+            if (codePoint >= 0x10000) {
+                appendUtf16(0xD800 + ((codePoint - 0x10000) >> 10), bigEndian, output);
+                appendUtf16(0xDC00 + ((codePoint - 0x10000) & 0x3FF), bigEndian, output);
+            } else {
+                appendUtf16(codePoint, bigEndian, output);
+            }
+        } else if (reverse) {
+            appendGb18030(codePoint, *reverse, output);
+        } else {
+            char byte;
+            if (!encodeWindows1252(codePoint, byte)) {
+                return false;
+            }
+            output.push_back(byte);
+        }
+        pos += size;
+    }
+    consumed = pos;
+    return true;
+}
+
+bool Transcoder::decodeFile(const std::string& path, const DetectedEncoding& encoding, std::string& content) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    std::streamoff size = file.tellg();
+    file.seekg(static_cast<std::streamoff>(encoding.bomLength));
+
+    // UTF-8 结果与原文件大小相近（UTF-16 的 ASCII 减半，GB18030 的汉字多一半），按原大小预留
+    content.clear();
+    content.reserve(size > 0 ? static_cast<size_t>(size) : 0);
+    Transcoder decoder(encoding.encoding);
+    std::vector<char> chunk(kChunkBytes);
+    while (true) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        size_t count = static_cast<size_t>(file.gcount());
+        bool final = count < chunk.size();
+        if (!decoder.decode(chunk.data(), count, content, final)) {
+            content.clear();
+            return false;
+        }
+        if (final) {
+            break;
+        }
+    }
+    return !file.bad();
+}
+
+bool Transcoder::decodeBuffer(std::string_view data, const DetectedEncoding& encoding, std::string& content) {
+    data.remove_prefix(std::min(encoding.bomLength, data.size()));
+    content.clear();
+    content.reserve(data.size());
+    Transcoder decoder(encoding.encoding);
+    for (size_t offset = 0;; offset += kChunkBytes) {
+        size_t count = std::min(kChunkBytes, data.size() - offset);
+        bool final = offset + count >= data.size();
+        if (!decoder.decode(data.data() + offset, count, content, final)) {
+            content.clear();
+            return false;
+        }
+        if (final) {
+            return true;
+        }
+    }
+}
+
+bool Transcoder::encodeFile(const std::string& path, const DetectedEncoding& encoding, std::string_view content) {
+    AtomicFileWriter writer;
+    if (!writer.open(path)) {
+        std::cerr << "Failed to save file: " << path << " (" << writer.getError() << ")" << std::endl;
+        return false;
+    }
+    if (encoding.bomLength > 0) {
+        if (encoding.encoding == TextEncoding::Utf16LE) {
+            writer.write("\xFF\xFE", 2);
+        } else if (encoding.encoding == TextEncoding::Utf16BE) {
+            writer.write("\xFE\xFF", 2);
+        }
+    }
+
+    Transcoder encoder(encoding.encoding);
+    std::string chunk;
+    for (size_t offset = 0;; offset += kChunkBytes) {
+        size_t count = std::min(kChunkBytes, content.size() - offset);
+        bool final = offset + count >= content.size();
+        chunk.clear();
+        if (!encoder.encode(content.data() + offset, count, chunk, final)) {
+            std::cerr << "Cannot encode content as " << EncodingDetector::getName(encoding.encoding) << ": " << path
+                      << std::endl;
+            writer.discard();
+            return false;
+        }
+        writer.write(chunk.data(), chunk.size());
+        if (final) {
+            break;
+        }
+    }
+    if (!writer.commit()) {
+        std::cerr << "Failed to save file: " << path << " (" << writer.getError() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
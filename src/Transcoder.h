@@ -0,0 +1,124 @@
+#ifndef TRANSCODER_H
+#define TRANSCODER_H
+
+#include "EncodingDetector.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * 流式编码转换：UTF-16（LE/BE）、GB18030（包括 GBK、GB2312）、Windows-1252 与内部的 UTF-8 互相转换
+ * 内容可以在任意字节处分段送入，段末不完整的字符留到下一段；打开和保存文件时按块转换，
+ * 除了结果本身不需要整份文件大小的中间缓冲区。
+ *
+ * GB18030 双字节区查表，四字节区按分段表计算；UTF-8 到 GB18030 的反查表在第一次编码时建立。
+ * 连续的 ASCII 在两种编码中字节相同（UTF-16 中是补零的码元），用 SSE2 一次判断 16 字节后整段复制。
+ * 各映射都是一一对应的，无法解码的字节（孤立的代理码元、无效的 GB18030 序列）作为错误返回，
+ * 因此解码成功的内容原样编码回去与原文件逐字节相同
+ */
+class Transcoder {
+public:
+    /**
+     * 构造函数
+     * @param encoding 原编码
+     */
+    explicit Transcoder(TextEncoding encoding);
+
+    /**
+     * 是否支持该编码的转换
+     * @param encoding 编码
+     * @return 是否支持
+     */
+    static bool supports(TextEncoding encoding);
+
+    /**
+     * 丢弃尚未完成的字符，重新开始
+     */
+    void reset();
+
+    /**
+     * 把一段原编码的内容解码为 UTF-8，追加到 output
+     * @param data 内容
+     * @param length 长度
+     * @param output 输出
+     * @param final 是否为最后一段（此时末尾不完整的字符是错误）
+     * @return 是否成功（遇到无法解码的字节时返回 false）
+     */
+    bool decode(const char* data, size_t length, std::string& output, bool final);
+
+    /**
+     * 把一段 UTF-8 内容编码为原编码，追加到 output
+     * @param data 内容
+     * @param length 长度
+     * @param output 输出
+     * @param final 是否为最后一段
+     * @return 是否成功（内容不是有效的 UTF-8 或有原编码无法表示的字符时返回 false）
+     */
+    bool encode(const char* data, size_t length, std::string& output, bool final);
+
+    /**
+     * 按块读取文件并解码（跳过字节顺序标记）
+     * @param path 文件路径
+     * @param encoding 检测到的编码
+     * @param content 输出的 UTF-8 内容
+     * @return 是否成功
+     */
+    static bool decodeFile(const std::string& path, const DetectedEncoding& encoding, std::string& content);
+
+    /**
+     * 按块解码内存中的内容（跳过字节顺序标记）
+     * @param data 内容
+     * @param encoding 检测到的编码
+     * @param content 输出的 UTF-8 内容
+     * @return 是否成功
+     */
+    static bool decodeBuffer(std::string_view data, const DetectedEncoding& encoding, std::string& content);
+
+    /**
+     * 按块编码并写入文件（原文件有字节顺序标记时同样写入）
+     * 经 AtomicFileWriter 写入：全部成功后再替换目标文件，编码失败时目标文件保持不变，
+     * 权限、所有者和链接保持原样
+     * @param path 文件路径
+     * @param encoding 原编码
+     * @param content UTF-8 内容
+     * @return 是否成功
+     */
+    static bool encodeFile(const std::string& path, const DetectedEncoding& encoding, std::string_view content);
+
+private:
+    TextEncoding encoding_;
+    std::string pending_;  // 上一段末尾不完整的字符
+
+    /**
+     * 解码尽可能多的完整字符
+     * @param data 内容
+     * @param length 长度
+     * @param output 输出
+     * @param consumed 输出已处理的字节数（其后是不完整的字符）
+     * @return 是否成功
+     */
+    bool decodeSome(const unsigned char* data, size_t length, std::string& output, size_t& consumed) const;
+
+    /**
+     * 编码尽可能多的完整字符
+     * @param data 内容
+     * @param length 长度
+     * @param output 输出
+     * @param consumed 输出已处理的字节数（其后是不完整的字符）
+     * @return 是否成功
+     */
+    bool encodeSome(const unsigned char* data, size_t length, std::string& output, size_t& consumed) const;
+
+    /**
+     * 先用下一段的开头补全上一段末尾的字符，再处理下一段
+     * @param data 内容
+     * @param length 长度
+     * @param output 输出
+     * @param final 是否为最后一段
+     * @param encoding 是否为编码方向
+     * @return 是否成功
+     */
+    bool process(const char* data, size_t length, std::string& output, bool final, bool encoding);
+};
+
+#endif // TRANSCODER_H
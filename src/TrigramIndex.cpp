@@ -0,0 +1,772 @@
+#include "TrigramIndex.h"
+#include "ConfigManager.h"
+#include "UnicodeText.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <chrono>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kIndexMagic[8] = {'L', 'P', 'T', 'R', 'I', 'G', 'R', '\0'};
+const uint32_t kIndexVersion = 1;
+const size_t kIndexBatchSize = 256;           // 每批并行提取的文件数
+const size_t kReadWindow = 1024 * 1024;       // 读取文件的窗口大小
+const size_t kTrigramSpace = size_t(1) << 24;  // 三元组取值范围
+const unsigned kWatchLatency = 500;           // 合并文件变化的延迟（毫秒）
+
+/**
+ * 索引文件头，之后依次是文件记录、三元组目录、编号列表和字符串区（按本机字节序存储）
+ */
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fileCount;
+    uint32_t trigramCount;
+    uint32_t rootLength;  // 根目录保存在字符串区开头
+    uint64_t filesOffset;
+    uint64_t directoryOffset;
+    uint64_t postingsOffset;
+    uint64_t postingsSize;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+/**
+ * 索引文件中的文件记录
+ */
+struct FileRecord {
+    uint64_t size;
+    int64_t mtime;
+    uint64_t pathOffset;  // 在字符串区中的偏移
+    uint32_t pathLength;
+    uint32_t reserved;
+};
+
+#ifndef _WIN32
+/**
+ * 取纳秒精度的修改时间，同一秒内的多次保存也能区分
+ */
+int64_t modificationTime(const struct stat& info) {
+#ifdef __APPLE__
+    return int64_t(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    return int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+inline uint8_t foldByte(uint8_t c) {
+    return static_cast<uint8_t>(c - 'A') < 26 ? static_cast<uint8_t>(c | 0x20) : c;
+}
+
+void appendVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * 解码差值 + varint 编码的编号列表，追加到 ids
+ */
+void decodePostings(const uint8_t* p, const uint8_t* end, uint32_t count, std::vector<uint32_t>& ids) {
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < count && p < end; i++) {
+        uint32_t value = 0;
+        int shift = 0;
+        while (p < end && (*p & 0x80) && shift < 28) {
+            value |= static_cast<uint32_t>(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p == end) {
+            return;
+        }
+        value |= static_cast<uint32_t>(*p++) << shift;
+        id = i == 0 ? value : id + value;
+        ids.push_back(id);
+    }
+}
+
+}  // namespace
+
+TrigramIndex::TrigramIndex()
+    : mapping_(nullptr),
+      mappingSize_(0),
+      directory_(nullptr),
+      directoryCount_(0),
+      postings_(nullptr),
+      postingsSize_(0),
+      baseFileCount_(0),
+      liveCount_(0),
+      dirty_(false),
+      ready_(false),
+      stopping_(false) {}
+
+TrigramIndex::~TrigramIndex() {
+    close();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+}
+
+std::string TrigramIndex::defaultIndexPath(const std::string& root) {
+    std::string directory = ConfigManager::getUserConfigDirectory();
+    if (directory.empty()) {
+        return "";
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.trigram",
+                  static_cast<unsigned long long>(std::hash<std::string>()(root)));
+    return (std::filesystem::path(directory) / "index" / name).string();
+}
+
+void TrigramIndex::setOptions(const FileSearchOptions& options) {
+    options_ = options;
+}
+
+void TrigramIndex::open(const std::string& root, const std::string& indexPath) {
+    close();
+    stopping_ = false;
+    // 没有可用的索引文件时从空索引开始，由后台刷新建立
+    load(root, indexPath);
+
+    worker_ = std::thread([this]() {
+        // 先开始监视再刷新，刷新期间发生的变化也不会遗漏
+        watcher_.setLatency(kWatchLatency);
+        watcher_.setCallback([this](const std::vector<FileChange>& changes) {
+            std::vector<std::string> paths;
+            for (const FileChange& change : changes) {
+                if (change.type == FileChange::Type::Overflow) {
+                    refresh();
+                    return;
+                }
+                paths.push_back(change.path);
+            }
+            updateFiles(paths);
+
+            // 增量部分较大时合并进索引文件
+            size_t overlayFiles = 0;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                overlayFiles = files_.size() - baseFileCount_;
+            }
+            if (overlayFiles > std::max<size_t>(1024, baseFileCount_ / 4)) {
+                save();
+            }
+        });
+        watcher_.watchTree(root_, options_.excludedDirectories);
+
+        refresh();
+        if (stopping_) {
+            return;
+        }
+        bool dirty = false;
+        {
+            std::lock_guard<std::mutex> lock(updateMutex_);
+            dirty = dirty_;
+        }
+        if (dirty) {
+            save();
+        }
+        ready_ = true;
+    });
+}
+
+void TrigramIndex::close() {
+    stopping_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    watcher_.stop();
+    ready_ = false;
+
+    bool dirty = false;
+    {
+        std::lock_guard<std::mutex> lock(updateMutex_);
+        dirty = dirty_;
+    }
+    if (dirty) {
+        save();
+    }
+}
+
+bool TrigramIndex::isReady() const {
+    return ready_;
+}
+
+const std::string& TrigramIndex::getRoot() const {
+    return root_;
+}
+
+bool TrigramIndex::load(const std::string& root, const std::string& indexPath) {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+    root_ = root;
+    indexPath_ = indexPath;
+    dirty_ = false;
+    return mapIndex();
+}
+
+void TrigramIndex::refresh() {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    if (root_.empty()) {
+        return;
+    }
+    std::vector<std::string> paths;
+    lister_.listFiles({root_}, options_, paths);
+    if (stopping_) {
+        return;
+    }
+
+    std::vector<PendingFile> changed;
+    std::unordered_set<std::string> seen;
+    seen.reserve(paths.size());
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (std::string& path : paths) {
+            PendingFile file{path, 0, 0, {}};
+            if (!statFile(path, file.size, file.mtime)) {
+                continue;
+            }
+            seen.insert(path);
+            auto it = pathIds_.find(path);
+            if (it == pathIds_.end() || files_[it->second].size != file.size ||
+                files_[it->second].mtime != file.mtime) {
+                changed.push_back(std::move(file));
+            }
+        }
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const FileEntry& entry : files_) {
+            if (entry.live && seen.find(entry.path) == seen.end()) {
+                removeFile(entry.path);
+            }
+        }
+    }
+    indexFiles(changed);
+}
+
+void TrigramIndex::updateFiles(const std::vector<std::string>& paths) {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    std::vector<PendingFile> changed;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (const std::string& path : paths) {
+            PendingFile file{path, 0, 0, {}};
+            if (!statFile(path, file.size, file.mtime)) {
+                removeFile(path);
+                continue;
+            }
+            auto it = pathIds_.find(path);
+            if (it == pathIds_.end() || files_[it->second].size != file.size ||
+                files_[it->second].mtime != file.mtime) {
+                changed.push_back(std::move(file));
+            }
+        }
+    }
+    indexFiles(changed);
+}
+
+bool TrigramIndex::save() {
+    std::lock_guard<std::mutex> update(updateMutex_);
+    if (indexPath_.empty()) {
+        return false;
+    }
+
+    // 写入者只有持有 updateMutex_ 的线程，读锁下生成的快照在重新载入前不会变化
+    std::vector<FileRecord> records;
+    std::vector<DirectoryEntry> directory;
+    std::vector<uint8_t> postings;
+    std::string strings = root_;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        // 有效文件按原顺序重新编号，编号列表映射后仍然有序
+        std::vector<uint32_t> newIds(files_.size(), UINT32_MAX);
+        for (size_t i = 0; i < files_.size(); i++) {
+            const FileEntry& entry = files_[i];
+            if (!entry.live) {
+                continue;
+            }
+            newIds[i] = static_cast<uint32_t>(records.size());
+            records.push_back(FileRecord{entry.size, entry.mtime, strings.size(),
+                                         static_cast<uint32_t>(entry.path.size()), 0});
+            strings += entry.path;
+        }
+
+        std::vector<uint32_t> trigrams;
+        trigrams.reserve(directoryCount_ + overlay_.size());
+        for (uint32_t i = 0; i < directoryCount_; i++) {
+            trigrams.push_back(directory_[i].trigram);
+        }
+        for (const auto& entry : overlay_) {
+            trigrams.push_back(entry.first);
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        std::vector<uint32_t> ids;
+        for (uint32_t trigram : trigrams) {
+            ids.clear();
+            collectPostings(trigram, ids);
+            DirectoryEntry entry{trigram, 0, postings.size()};
+            uint32_t last = 0;
+            for (uint32_t id : ids) {
+                uint32_t newId = newIds[id];
+                if (newId == UINT32_MAX) {
+                    continue;
+                }
+                appendVarint(postings, entry.count == 0 ? newId : newId - last);
+                last = newId;
+                entry.count++;
+            }
+            if (entry.count > 0) {
+                directory.push_back(entry);
+            }
+        }
+    }
+
+    IndexHeader header;
+    std::memcpy(header.magic, kIndexMagic, sizeof(header.magic));
+    header.version = kIndexVersion;
+    header.fileCount = static_cast<uint32_t>(records.size());
+    header.trigramCount = static_cast<uint32_t>(directory.size());
+    header.rootLength = static_cast<uint32_t>(root_.size());
+    header.filesOffset = sizeof(IndexHeader);
+    header.directoryOffset = header.filesOffset + records.size() * sizeof(FileRecord);
+    header.postingsOffset = header.directoryOffset + directory.size() * sizeof(DirectoryEntry);
+    header.postingsSize = postings.size();
+    header.stringsOffset = header.postingsOffset + postings.size();
+    header.stringsSize = strings.size();
+
+    std::error_code error;
+    std::filesystem::path target(indexPath_);
+    std::filesystem::create_directories(target.parent_path(), error);
+    std::string temporaryPath = indexPath_ + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write index file: " << temporaryPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(FileRecord));
+        file.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(DirectoryEntry));
+        file.write(reinterpret_cast<const char*>(postings.data()), postings.size());
+        file.write(strings.data(), strings.size());
+        if (!file) {
+            std::cerr << "Failed to write index file: " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+    // 先写临时文件再替换，写到一半时崩溃不会留下损坏的索引
+    std::filesystem::rename(temporaryPath, target, error);
+    if (error) {
+        std::cerr << "Failed to replace index file " << indexPath_ << ": " << error.message() << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    reset();
+    dirty_ = false;
+    return mapIndex();
+}
+
+std::vector<std::string> TrigramIndex::findCandidates(const SearchPattern& pattern, bool* usedIndex) const {
+    std::vector<uint32_t> trigrams;
+    for (const std::string& literal : pattern.getRequiredLiterals()) {
+        if (pattern.isCaseSensitive()) {
+            appendTrigrams(literal.data(), literal.size(), trigrams);
+            continue;
+        }
+        // 索引只折叠 ASCII 字母，忽略大小写时有大小写之分的非 ASCII 字符（如 Ä/ä）在文件中可能是另一种写法，
+        // 只使用不含这些字符的片段中的三元组
+        size_t runStart = 0;
+        for (size_t i = 0; i <= literal.size();) {
+            uint32_t codePoint = 0;
+            size_t size =
+                i < literal.size() ? UnicodeText::decode(literal.data() + i, literal.size() - i, codePoint) : 1;
+            if (i == literal.size() || (size > 1 && UnicodeText::hasCaseVariants(codePoint))) {
+                appendTrigrams(literal.data() + runStart, i - runStart, trigrams);
+                runStart = i + size;
+            }
+            i += size;
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> result;
+    if (usedIndex) {
+        *usedIndex = !trigrams.empty();
+    }
+    if (trigrams.empty()) {
+        result.reserve(liveCount_);
+        for (const FileEntry& entry : files_) {
+            if (entry.live) {
+                result.push_back(entry.path);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // 从最短的列表开始求交集，交集很快变小
+    std::vector<std::pair<size_t, uint32_t>> order;
+    order.reserve(trigrams.size());
+    for (uint32_t trigram : trigrams) {
+        order.emplace_back(postingCount(trigram), trigram);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> merged;
+    collectPostings(order[0].second, ids);
+    for (size_t i = 1; i < order.size() && !ids.empty(); i++) {
+        next.clear();
+        collectPostings(order[i].second, next);
+        merged.clear();
+        std::set_intersection(ids.begin(), ids.end(), next.begin(), next.end(), std::back_inserter(merged));
+        ids.swap(merged);
+    }
+
+    for (uint32_t id : ids) {
+        if (id < files_.size() && files_[id].live) {
+            result.push_back(files_[id].path);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t TrigramIndex::getFileCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return liveCount_;
+}
+
+void TrigramIndex::reset() {
+    if (mapping_) {
+#ifdef _WIN32
+        delete[] mapping_;
+#else
+        ::munmap(const_cast<char*>(mapping_), mappingSize_);
+#endif
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    directory_ = nullptr;
+    directoryCount_ = 0;
+    postings_ = nullptr;
+    postingsSize_ = 0;
+    baseFileCount_ = 0;
+    liveCount_ = 0;
+    files_.clear();
+    pathIds_.clear();
+    overlay_.clear();
+}
+
+bool TrigramIndex::mapIndex() {
+    if (indexPath_.empty()) {
+        return false;
+    }
+#ifdef _WIN32
+    std::ifstream file(indexPath_, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(file.tellg());
+    if (size < sizeof(IndexHeader)) {
+        return false;
+    }
+    char* data = new char[size];
+    file.seekg(0);
+    file.read(data, size);
+    mapping_ = data;
+    mappingSize_ = size;
+#else
+    int fd = ::open(indexPath_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(IndexHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map index file: " << indexPath_ << std::endl;
+        return false;
+    }
+    mapping_ = static_cast<const char*>(data);
+    mappingSize_ = size;
+#endif
+
+    // 校验各区的位置，损坏或版本不符的索引文件直接丢弃
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(mapping_);
+    bool valid = std::memcmp(header->magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                 header->version == kIndexVersion && header->filesOffset == sizeof(IndexHeader) &&
+                 header->directoryOffset == header->filesOffset + uint64_t(header->fileCount) * sizeof(FileRecord) &&
+                 header->postingsOffset ==
+                     header->directoryOffset + uint64_t(header->trigramCount) * sizeof(DirectoryEntry) &&
+                 header->stringsOffset == header->postingsOffset + header->postingsSize &&
+                 header->stringsOffset + header->stringsSize == mappingSize_ &&
+                 header->rootLength <= header->stringsSize;
+    const char* strings = mapping_ + (valid ? header->stringsOffset : 0);
+    if (!valid || std::string(strings, header->rootLength) != root_) {
+        reset();
+        return false;
+    }
+
+    const FileRecord* records = reinterpret_cast<const FileRecord*>(mapping_ + header->filesOffset);
+    files_.reserve(header->fileCount);
+    pathIds_.reserve(header->fileCount);
+    for (uint32_t i = 0; i < header->fileCount; i++) {
+        const FileRecord& record = records[i];
+        if (record.pathOffset + record.pathLength > header->stringsSize) {
+            reset();
+            return false;
+        }
+        files_.push_back(FileEntry{std::string(strings + record.pathOffset, record.pathLength), record.size,
+                                   record.mtime, true});
+        pathIds_[files_.back().path] = i;
+    }
+    directory_ = reinterpret_cast<const DirectoryEntry*>(mapping_ + header->directoryOffset);
+    directoryCount_ = header->trigramCount;
+    postings_ = reinterpret_cast<const uint8_t*>(mapping_ + header->postingsOffset);
+    postingsSize_ = header->postingsSize;
+    for (uint32_t i = 0; i < directoryCount_; i++) {
+        if (directory_[i].offset >= postingsSize_ || (i > 0 && directory_[i - 1].trigram >= directory_[i].trigram)) {
+            reset();
+            return false;
+        }
+    }
+    baseFileCount_ = header->fileCount;
+    liveCount_ = header->fileCount;
+    return true;
+}
+
+void TrigramIndex::indexFiles(std::vector<PendingFile>& files) {
+    uint64_t maxFileSize = options_.maxFileSize;
+    for (size_t start = 0; start < files.size() && !stopping_; start += kIndexBatchSize) {
+        size_t end = std::min(files.size(), start + kIndexBatchSize);
+        std::vector<char> readable(end - start, 0);
+        for (size_t i = start; i < end; i++) {
+            pool_.submit([&files, &readable, i, start, maxFileSize]() {
+                readable[i - start] = extractTrigrams(files[i], maxFileSize) ? 1 : 0;
+            });
+        }
+        pool_.wait();
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (size_t i = start; i < end; i++) {
+            PendingFile& file = files[i];
+            removeFile(file.path);
+            if (!readable[i - start]) {
+                continue;
+            }
+            uint32_t id = static_cast<uint32_t>(files_.size());
+            files_.push_back(FileEntry{file.path, file.size, file.mtime, true});
+            pathIds_[file.path] = id;
+            liveCount_++;
+            for (uint32_t trigram : file.trigrams) {
+                OverlayPosting& posting = overlay_[trigram];
+                appendVarint(posting.bytes, posting.count == 0 ? id : id - posting.last);
+                posting.last = id;
+                posting.count++;
+            }
+            std::vector<uint32_t>().swap(file.trigrams);
+        }
+        dirty_ = true;
+    }
+}
+
+void TrigramIndex::removeFile(const std::string& path) {
+    auto it = pathIds_.find(path);
+    if (it == pathIds_.end()) {
+        return;
+    }
+    files_[it->second].live = false;
+    pathIds_.erase(it);
+    liveCount_--;
+    dirty_ = true;
+}
+
+void TrigramIndex::collectPostings(uint32_t trigram, std::vector<uint32_t>& ids) const {
+    // 增量部分的编号都不小于 baseFileCount_，接在索引文件部分之后仍然有序
+    const DirectoryEntry* entry = findDirectoryEntry(trigram);
+    if (entry) {
+        decodePostings(postings_ + entry->offset, postings_ + postingsSize_, entry->count, ids);
+    }
+    auto it = overlay_.find(trigram);
+    if (it != overlay_.end()) {
+        const std::vector<uint8_t>& bytes = it->second.bytes;
+        decodePostings(bytes.data(), bytes.data() + bytes.size(), it->second.count, ids);
+    }
+}
+
+size_t TrigramIndex::postingCount(uint32_t trigram) const {
+    size_t count = 0;
+    const DirectoryEntry* entry = findDirectoryEntry(trigram);
+    if (entry) {
+        count += entry->count;
+    }
+    auto it = overlay_.find(trigram);
+    if (it != overlay_.end()) {
+        count += it->second.count;
+    }
+    return count;
+}
+
+const TrigramIndex::DirectoryEntry* TrigramIndex::findDirectoryEntry(uint32_t trigram) const {
+    const DirectoryEntry* end = directory_ + directoryCount_;
+    const DirectoryEntry* it = std::lower_bound(
+        directory_, end, trigram, [](const DirectoryEntry& entry, uint32_t value) { return entry.trigram < value; });
+    return it != end && it->trigram == trigram ? it : nullptr;
+}
+
+bool TrigramIndex::extractTrigrams(PendingFile& file, uint64_t maxFileSize) {
+    // 线程本地的位图用于去重，处理完一个文件后只清除用到的位
+    static thread_local std::vector<uint64_t> seen(kTrigramSpace / 64, 0);
+    static thread_local std::vector<char> buffer;
+    std::vector<uint32_t> all;
+    file.trigrams.clear();
+
+#ifdef _WIN32
+    if (!statFile(file.path, file.size, file.mtime)) {
+        return false;
+    }
+    if (file.size > maxFileSize) {
+        return true;
+    }
+    std::ifstream stream(file.path, std::ios::binary);
+    if (!stream.is_open()) {
+        return false;
+    }
+    buffer.resize(kReadWindow + 2);
+    size_t carry = 0;
+    bool first = true;
+    while (stream) {
+        stream.read(buffer.data() + carry, kReadWindow);
+        size_t count = static_cast<size_t>(stream.gcount());
+        if (count == 0) {
+            break;
+        }
+#else
+    int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    file.size = static_cast<uint64_t>(info.st_size);
+    file.mtime = modificationTime(info);
+    if (file.size > maxFileSize) {
+        ::close(fd);
+        return true;
+    }
+    buffer.resize(kReadWindow + 2);
+    size_t carry = 0;
+    bool first = true;
+    uint64_t offset = 0;
+    while (true) {
+        ssize_t read = ::pread(fd, buffer.data() + carry, kReadWindow, static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read < 0) {
+            ::close(fd);
+            return false;
+        }
+        if (read == 0) {
+            break;
+        }
+        size_t count = static_cast<size_t>(read);
+        offset += count;
+#endif
+        if (first && FileSearcher::isBinary(buffer.data(), count)) {
+            // 二进制文件只记录大小和修改时间，不参与查找
+            break;
+        }
+        first = false;
+        // 保留上一窗口末尾两个字节，跨窗口的三元组不会丢失
+        size_t total = carry + count;
+        all.clear();
+        appendTrigrams(buffer.data(), total, all);
+        for (uint32_t trigram : all) {
+            uint64_t bit = uint64_t(1) << (trigram & 63);
+            uint64_t& word = seen[trigram >> 6];
+            if (!(word & bit)) {
+                word |= bit;
+                file.trigrams.push_back(trigram);
+            }
+        }
+        carry = std::min<size_t>(total, 2);
+        std::memmove(buffer.data(), buffer.data() + total - carry, carry);
+    }
+#ifndef _WIN32
+    ::close(fd);
+#endif
+
+    for (uint32_t trigram : file.trigrams) {
+        seen[trigram >> 6] = 0;
+    }
+    return true;
+}
+
+void TrigramIndex::appendTrigrams(const char* data, size_t length, std::vector<uint32_t>& trigrams) {
+    if (length < 3) {
+        return;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    uint32_t window = (uint32_t(foldByte(bytes[0])) << 8) | foldByte(bytes[1]);
+    for (size_t i = 2; i < length; i++) {
+        window = ((window << 8) | foldByte(bytes[i])) & 0xffffff;
+        trigrams.push_back(window);
+    }
+}
+
+bool TrigramIndex::statFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+#ifdef _WIN32
+    std::error_code error;
+    std::filesystem::path filePath(path);
+    if (!std::filesystem::is_regular_file(filePath, error)) {
+        return false;
+    }
+    size = std::filesystem::file_size(filePath, error);
+    auto time = std::filesystem::last_write_time(filePath, error);
+    mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    return !error;
+#else
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    mtime = modificationTime(info);
+    return true;
+#endif
+}
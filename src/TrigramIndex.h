@@ -0,0 +1,248 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include "FileSearcher.h"
+#include "FileWatcher.h"
+#include "SearchPattern.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 工作区三元组索引
+ * 记录每个文件中出现过的所有三字节序列（ASCII 字母统一为小写），查找时先用查找条件中
+ * 必须出现的字面量求出候选文件，再只对候选文件做真正的匹配。
+ *
+ * 索引文件保存在用户配置目录下，通过 mmap 载入：三元组目录按值排序，
+ * 每个三元组的文件编号列表以差值 + varint 压缩存储，载入时不需要解码。
+ * 之后的修改（新增、修改、删除的文件）记在内存中的增量部分：旧编号标记为失效，
+ * 新内容分配新编号；保存时把两部分合并压缩成新的索引文件。
+ * 打开后在后台线程中对比文件大小和修改时间，只重新索引变化的文件，
+ * 然后用 FileWatcher 监视目录树，持续更新
+ */
+class TrigramIndex {
+public:
+    TrigramIndex();
+    ~TrigramIndex();
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    /**
+     * 获取目录对应的默认索引文件路径（用户配置目录下的 index 子目录）
+     * @param root 工作区根目录
+     * @return 索引文件路径
+     */
+    static std::string defaultIndexPath(const std::string& root);
+
+    /**
+     * 设置建立索引时使用的选项（目录过滤、符号链接和文件大小上限）
+     * @param options 选项
+     */
+    void setOptions(const FileSearchOptions& options);
+
+    /**
+     * 打开工作区索引：同步载入已有的索引文件，然后在后台刷新、保存并开始监视
+     * @param root 工作区根目录
+     * @param indexPath 索引文件路径
+     */
+    void open(const std::string& root, const std::string& indexPath);
+
+    /**
+     * 停止后台刷新和监视，有未保存的修改时保存
+     */
+    void close();
+
+    /**
+     * 后台刷新是否已完成，完成后查询结果反映磁盘上的当前内容
+     * @return 是否就绪
+     */
+    bool isReady() const;
+
+    /**
+     * 获取工作区根目录
+     * @return 根目录
+     */
+    const std::string& getRoot() const;
+
+    /**
+     * 载入索引文件（根目录不一致或文件损坏时返回 false，索引保持为空）
+     * @param root 工作区根目录
+     * @param indexPath 索引文件路径
+     * @return 是否载入成功
+     */
+    bool load(const std::string& root, const std::string& indexPath);
+
+    /**
+     * 遍历根目录，重新索引大小或修改时间变化的文件，移除已不存在的文件
+     */
+    void refresh();
+
+    /**
+     * 重新检查指定文件（新增、修改或删除）
+     * @param paths 文件路径
+     */
+    void updateFiles(const std::vector<std::string>& paths);
+
+    /**
+     * 把当前索引合并保存到索引文件，并重新载入
+     * @return 是否成功
+     */
+    bool save();
+
+    /**
+     * 求可能匹配的候选文件
+     * @param pattern 已编译的查找条件
+     * @param usedIndex 输出是否用到了索引（没有长度不小于 3 的必需字面量时返回全部文件），可为 nullptr
+     * @return 候选文件路径（按路径排序）
+     */
+    std::vector<std::string> findCandidates(const SearchPattern& pattern, bool* usedIndex = nullptr) const;
+
+    /**
+     * 获取已索引的文件数
+     * @return 文件数
+     */
+    size_t getFileCount() const;
+
+private:
+    /**
+     * 已索引的文件，编号即下标
+     */
+    struct FileEntry {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+        bool live;  // 被更新或删除后为 false
+    };
+
+    /**
+     * 增量部分中一个三元组的文件编号列表
+     */
+    struct OverlayPosting {
+        std::vector<uint8_t> bytes;  // 差值 + varint
+        uint32_t last;               // 最后一个编号
+        uint32_t count;
+    };
+
+    /**
+     * 索引文件中三元组目录的一项
+     */
+    struct DirectoryEntry {
+        uint32_t trigram;
+        uint32_t count;
+        uint64_t offset;  // 在编号列表区中的偏移
+    };
+
+    /**
+     * 待索引的文件
+     */
+    struct PendingFile {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+        std::vector<uint32_t> trigrams;
+    };
+
+    FileSearchOptions options_;
+    std::string root_;
+    std::string indexPath_;
+
+    mutable std::shared_mutex mutex_;  // 保护以下查询用到的状态
+    std::vector<FileEntry> files_;
+    std::unordered_map<std::string, uint32_t> pathIds_;  // 路径到当前有效编号
+    std::unordered_map<uint32_t, OverlayPosting> overlay_;
+    const char* mapping_;
+    size_t mappingSize_;
+    const DirectoryEntry* directory_;
+    uint32_t directoryCount_;
+    const uint8_t* postings_;
+    uint64_t postingsSize_;
+    uint32_t baseFileCount_;  // 编号小于此值的文件来自索引文件
+    size_t liveCount_;
+
+    std::mutex updateMutex_;  // 串行化刷新、更新和保存
+    bool dirty_;
+    std::atomic<bool> ready_;
+    std::atomic<bool> stopping_;
+    FileSearcher lister_;
+    ThreadPool pool_;
+    FileWatcher watcher_;
+    std::thread worker_;
+
+    /**
+     * 解除索引文件映射并清空全部状态（需持有写锁）
+     */
+    void reset();
+
+    /**
+     * 映射索引文件并载入文件列表（需持有写锁）
+     * @return 是否成功
+     */
+    bool mapIndex();
+
+    /**
+     * 并行提取文件的三元组并加入增量部分（需持有 updateMutex_）
+     * @param files 待索引的文件
+     */
+    void indexFiles(std::vector<PendingFile>& files);
+
+    /**
+     * 标记文件失效（需持有写锁）
+     * @param path 文件路径
+     */
+    void removeFile(const std::string& path);
+
+    /**
+     * 解码一个三元组的全部文件编号（索引文件部分和增量部分，结果有序）
+     * @param trigram 三元组
+     * @param ids 输出编号
+     */
+    void collectPostings(uint32_t trigram, std::vector<uint32_t>& ids) const;
+
+    /**
+     * 估计一个三元组的编号数量，用于决定求交集的顺序
+     * @param trigram 三元组
+     * @return 编号数量
+     */
+    size_t postingCount(uint32_t trigram) const;
+
+    /**
+     * 在索引文件的三元组目录中查找
+     * @param trigram 三元组
+     * @return 目录项，不存在时返回 nullptr
+     */
+    const DirectoryEntry* findDirectoryEntry(uint32_t trigram) const;
+
+    /**
+     * 读取文件并提取三元组（二进制或过大的文件返回空列表）
+     * @param file 待索引的文件，输出实际的大小、修改时间和三元组
+     * @param maxFileSize 文件大小上限
+     * @return 是否能读取
+     */
+    static bool extractTrigrams(PendingFile& file, uint64_t maxFileSize);
+
+    /**
+     * 把一段数据中的三元组追加到列表
+     * @param data 数据
+     * @param length 长度
+     * @param trigrams 输出三元组（未去重）
+     */
+    static void appendTrigrams(const char* data, size_t length, std::vector<uint32_t>& trigrams);
+
+    /**
+     * 获取文件大小和修改时间
+     * @param path 文件路径
+     * @param size 输出大小
+     * @param mtime 输出修改时间（纳秒）
+     * @return 是否为可访问的普通文件
+     */
+    static bool statFile(const std::string& path, uint64_t& size, int64_t& mtime);
+};
+
+#endif // TRIGRAM_INDEX_H
@@ -0,0 +1,464 @@
+#include "UnicodeText.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+/**
+ * 折叠区间：[first, last] 内与 first 相差 stride 整数倍的码位加上 delta
+ * 由 Unicode 14.0 的大小写数据生成，只保留折叠前后 UTF-8 字节数相同的字符
+ */
+struct FoldRange {
+    uint32_t first;
+    uint32_t last;
+    int32_t delta;
+    uint32_t stride;
+};
+
+const FoldRange kFoldRanges[] = {
+    {0x00B5, 0x00B5, 775, 1},
+    {0x00C0, 0x00D6, 32, 1},
+    {0x00D8, 0x00DE, 32, 1},
+    {0x0100, 0x012E, 1, 2},
+    {0x0132, 0x0136, 1, 2},
+    {0x0139, 0x0147, 1, 2},
+    {0x014A, 0x0176, 1, 2},
+    {0x0178, 0x0178, -121, 1},
+    {0x0179, 0x017D, 1, 2},
+    {0x0181, 0x0181, 210, 1},
+    {0x0182, 0x0184, 1, 2},
+    {0x0186, 0x0186, 206, 1},
+    {0x0187, 0x0187, 1, 1},
+    {0x0189, 0x018A, 205, 1},
+    {0x018B, 0x018B, 1, 1},
+    {0x018E, 0x018E, 79, 1},
+    {0x018F, 0x018F, 202, 1},
+    {0x0190, 0x0190, 203, 1},
+    {0x0191, 0x0191, 1, 1},
+    {0x0193, 0x0193, 205, 1},
+    {0x0194, 0x0194, 207, 1},
+    {0x0196, 0x0196, 211, 1},
+    {0x0197, 0x0197, 209, 1},
+    {0x0198, 0x0198, 1, 1},
+    {0x019C, 0x019C, 211, 1},
+    {0x019D, 0x019D, 213, 1},
+    {0x019F, 0x019F, 214, 1},
+    {0x01A0, 0x01A4, 1, 2},
+    {0x01A6, 0x01A6, 218, 1},
+    {0x01A7, 0x01A7, 1, 1},
+    {0x01A9, 0x01A9, 218, 1},
+    {0x01AC, 0x01AC, 1, 1},
+    {0x01AE, 0x01AE, 218, 1},
+    {0x01AF, 0x01AF, 1, 1},
+    {0x01B1, 0x01B2, 217, 1},
+    {0x01B3, 0x01B5, 1, 2},
+    {0x01B7, 0x01B7, 219, 1},
+    {0x01B8, 0x01B8, 1, 1},
+    {0x01BC, 0x01BC, 1, 1},
+    {0x01C4, 0x01C4, 2, 1},
+    {0x01C5, 0x01C5, 1, 1},
+    {0x01C7, 0x01C7, 2, 1},
+    {0x01C8, 0x01C8, 1, 1},
+    {0x01CA, 0x01CA, 2, 1},
+    {0x01CB, 0x01DB, 1, 2},
+    {0x01DE, 0x01EE, 1, 2},
+    {0x01F1, 0x01F1, 2, 1},
+    {0x01F2, 0x01F4, 1, 2},
+    {0x01F6, 0x01F6, -97, 1},
+    {0x01F7, 0x01F7, -56, 1},
+    {0x01F8, 0x021E, 1, 2},
+    {0x0220, 0x0220, -130, 1},
+    {0x0222, 0x0232, 1, 2},
+    {0x023B, 0x023B, 1, 1},
+    {0x023D, 0x023D, -163, 1},
+    {0x0241, 0x0241, 1, 1},
+    {0x0243, 0x0243, -195, 1},
+    {0x0244, 0x0244, 69, 1},
+    {0x0245, 0x0245, 71, 1},
+    {0x0246, 0x024E, 1, 2},
+    {0x0345, 0x0345, 116, 1},
+    {0x0370, 0x0372, 1, 2},
+    {0x0376, 0x0376, 1, 1},
+    {0x037F, 0x037F, 116, 1},
+    {0x0386, 0x0386, 38, 1},
+    {0x0388, 0x038A, 37, 1},
+    {0x038C, 0x038C, 64, 1},
+    {0x038E, 0x038F, 63, 1},
+    {0x0391, 0x03A1, 32, 1},
+    {0x03A3, 0x03AB, 32, 1},
+    {0x03C2, 0x03C2, 1, 1},
+    {0x03CF, 0x03CF, 8, 1},
+    {0x03D0, 0x03D0, -30, 1},
+    {0x03D1, 0x03D1, -25, 1},
+    {0x03D5, 0x03D5, -15, 1},
+    {0x03D6, 0x03D6, -22, 1},
+    {0x03D8, 0x03EE, 1, 2},
+    {0x03F0, 0x03F0, -54, 1},
+    {0x03F1, 0x03F1, -48, 1},
+    {0x03F4, 0x03F4, -60, 1},
+    {0x03F5, 0x03F5, -64, 1},
+    {0x03F7, 0x03F7, 1, 1},
+    {0x03F9, 0x03F9, -7, 1},
+    {0x03FA, 0x03FA, 1, 1},
+    {0x03FD, 0x03FF, -130, 1},
+    {0x0400, 0x040F, 80, 1},
+    {0x0410, 0x042F, 32, 1},
+    {0x0460, 0x0480, 1, 2},
+    {0x048A, 0x04BE, 1, 2},
+    {0x04C0, 0x04C0, 15, 1},
+    {0x04C1, 0x04CD, 1, 2},
+    {0x04D0, 0x052E, 1, 2},
+    {0x0531, 0x0556, 48, 1},
+    {0x10A0, 0x10C5, 7264, 1},
+    {0x10C7, 0x10C7, 7264, 1},
+    {0x10CD, 0x10CD, 7264, 1},
+    {0x13F8, 0x13FD, -8, 1},
+    {0x1C88, 0x1C88, 35267, 1},
+    {0x1C90, 0x1CBA, -3008, 1},
+    {0x1CBD, 0x1CBF, -3008, 1},
+    {0x1E00, 0x1E94, 1, 2},
+    {0x1E9B, 0x1E9B, -58, 1},
+    {0x1EA0, 0x1EFE, 1, 2},
+    {0x1F08, 0x1F0F, -8, 1},
+    {0x1F18, 0x1F1D, -8, 1},
+    {0x1F28, 0x1F2F, -8, 1},
+    {0x1F38, 0x1F3F, -8, 1},
+    {0x1F48, 0x1F4D, -8, 1},
+    {0x1F59, 0x1F5F, -8, 2},
+    {0x1F68, 0x1F6F, -8, 1},
+    {0x1F88, 0x1F8F, -8, 1},
+    {0x1F98, 0x1F9F, -8, 1},
+    {0x1FA8, 0x1FAF, -8, 1},
+    {0x1FB8, 0x1FB9, -8, 1},
+    {0x1FBA, 0x1FBB, -74, 1},
+    {0x1FBC, 0x1FBC, -9, 1},
+    {0x1FC8, 0x1FCB, -86, 1},
+    {0x1FCC, 0x1FCC, -9, 1},
+    {0x1FD8, 0x1FD9, -8, 1},
+    {0x1FDA, 0x1FDB, -100, 1},
+    {0x1FE8, 0x1FE9, -8, 1},
+    {0x1FEA, 0x1FEB, -112, 1},
+    {0x1FEC, 0x1FEC, -7, 1},
+    {0x1FF8, 0x1FF9, -128, 1},
+    {0x1FFA, 0x1FFB, -126, 1},
+    {0x1FFC, 0x1FFC, -9, 1},
+    {0x2132, 0x2132, 28, 1},
+    {0x2160, 0x216F, 16, 1},
+    {0x2183, 0x2183, 1, 1},
+    {0x24B6, 0x24CF, 26, 1},
+    {0x2C00, 0x2C2F, 48, 1},
+    {0x2C60, 0x2C60, 1, 1},
+    {0x2C63, 0x2C63, -3814, 1},
+    {0x2C67, 0x2C6B, 1, 2},
+    {0x2C72, 0x2C72, 1, 1},
+    {0x2C75, 0x2C75, 1, 1},
+    {0x2C80, 0x2CE2, 1, 2},
+    {0x2CEB, 0x2CED, 1, 2},
+    {0x2CF2, 0x2CF2, 1, 1},
+    {0xA640, 0xA66C, 1, 2},
+    {0xA680, 0xA69A, 1, 2},
+    {0xA722, 0xA72E, 1, 2},
+    {0xA732, 0xA76E, 1, 2},
+    {0xA779, 0xA77B, 1, 2},
+    {0xA77D, 0xA77D, -35332, 1},
+    {0xA77E, 0xA786, 1, 2},
+    {0xA78B, 0xA78B, 1, 1},
+    {0xA790, 0xA792, 1, 2},
+    {0xA796, 0xA7A8, 1, 2},
+    {0xA7B3, 0xA7B3, 928, 1},
+    {0xA7B4, 0xA7C2, 1, 2},
+    {0xA7C4, 0xA7C4, -48, 1},
+    {0xA7C6, 0xA7C6, -35384, 1},
+    {0xA7C7, 0xA7C9, 1, 2},
+    {0xA7D0, 0xA7D0, 1, 1},
+    {0xA7D6, 0xA7D8, 1, 2},
+    {0xA7F5, 0xA7F5, 1, 1},
+    {0xAB70, 0xABBF, -38864, 1},
+    {0xFF21, 0xFF3A, 32, 1},
+    {0x10400, 0x10427, 40, 1},
+    {0x104B0, 0x104D3, 40, 1},
+    {0x10570, 0x1057A, 39, 1},
+    {0x1057C, 0x1058A, 39, 1},
+    {0x1058C, 0x10592, 39, 1},
+    {0x10594, 0x10595, 39, 1},
+    {0x10C80, 0x10CB2, 64, 1},
+    {0x118A0, 0x118BF, 32, 1},
+    {0x16E40, 0x16E5F, 32, 1},
+    {0x1E900, 0x1E921, 34, 1},
+};
+
+/**
+ * 折叠结果所在的区间（用于判断一个小写字符是否有大写形式）
+ */
+struct TargetRange {
+    uint32_t first;
+    uint32_t last;
+    uint32_t stride;
+};
+
+const TargetRange kTargetRanges[] = {
+    {0x00E0, 0x00F6, 1},
+    {0x00F8, 0x00FF, 1},
+    {0x0101, 0x012F, 2},
+    {0x0133, 0x0137, 2},
+    {0x013A, 0x0148, 2},
+    {0x014B, 0x0177, 2},
+    {0x017A, 0x0180, 2},
+    {0x0183, 0x0185, 2},
+    {0x0188, 0x0188, 1},
+    {0x018C, 0x018C, 1},
+    {0x0192, 0x0192, 1},
+    {0x0195, 0x0195, 1},
+    {0x0199, 0x019A, 1},
+    {0x019E, 0x019E, 1},
+    {0x01A1, 0x01A5, 2},
+    {0x01A8, 0x01A8, 1},
+    {0x01AD, 0x01AD, 1},
+    {0x01B0, 0x01B0, 1},
+    {0x01B4, 0x01B6, 2},
+    {0x01B9, 0x01B9, 1},
+    {0x01BD, 0x01BF, 2},
+    {0x01C6, 0x01C6, 1},
+    {0x01C9, 0x01C9, 1},
+    {0x01CC, 0x01DC, 2},
+    {0x01DD, 0x01EF, 2},
+    {0x01F3, 0x01F5, 2},
+    {0x01F9, 0x021F, 2},
+    {0x0223, 0x0233, 2},
+    {0x023C, 0x023C, 1},
+    {0x0242, 0x0242, 1},
+    {0x0247, 0x024F, 2},
+    {0x0253, 0x0254, 1},
+    {0x0256, 0x0257, 1},
+    {0x0259, 0x025B, 2},
+    {0x0260, 0x0260, 1},
+    {0x0263, 0x0263, 1},
+    {0x0268, 0x0269, 1},
+    {0x026F, 0x026F, 1},
+    {0x0272, 0x0272, 1},
+    {0x0275, 0x0275, 1},
+    {0x0280, 0x0280, 1},
+    {0x0283, 0x0283, 1},
+    {0x0288, 0x028C, 1},
+    {0x0292, 0x0292, 1},
+    {0x0371, 0x0373, 2},
+    {0x0377, 0x0377, 1},
+    {0x037B, 0x037D, 1},
+    {0x03AC, 0x03AF, 1},
+    {0x03B1, 0x03C1, 1},
+    {0x03C3, 0x03CE, 1},
+    {0x03D7, 0x03EF, 2},
+    {0x03F2, 0x03F3, 1},
+    {0x03F8, 0x03F8, 1},
+    {0x03FB, 0x03FB, 1},
+    {0x0430, 0x045F, 1},
+    {0x0461, 0x0481, 2},
+    {0x048B, 0x04BF, 2},
+    {0x04C2, 0x04CE, 2},
+    {0x04CF, 0x052F, 2},
+    {0x0561, 0x0586, 1},
+    {0x10D0, 0x10FA, 1},
+    {0x10FD, 0x10FF, 1},
+    {0x13A0, 0x13F5, 1},
+    {0x1D79, 0x1D79, 1},
+    {0x1D7D, 0x1D7D, 1},
+    {0x1D8E, 0x1D8E, 1},
+    {0x1E01, 0x1E95, 2},
+    {0x1EA1, 0x1EFF, 2},
+    {0x1F00, 0x1F07, 1},
+    {0x1F10, 0x1F15, 1},
+    {0x1F20, 0x1F27, 1},
+    {0x1F30, 0x1F37, 1},
+    {0x1F40, 0x1F45, 1},
+    {0x1F51, 0x1F57, 2},
+    {0x1F60, 0x1F67, 1},
+    {0x1F70, 0x1F7D, 1},
+    {0x1F80, 0x1F87, 1},
+    {0x1F90, 0x1F97, 1},
+    {0x1FA0, 0x1FA7, 1},
+    {0x1FB0, 0x1FB1, 1},
+    {0x1FB3, 0x1FB3, 1},
+    {0x1FC3, 0x1FC3, 1},
+    {0x1FD0, 0x1FD1, 1},
+    {0x1FE0, 0x1FE1, 1},
+    {0x1FE5, 0x1FE5, 1},
+    {0x1FF3, 0x1FF3, 1},
+    {0x214E, 0x214E, 1},
+    {0x2170, 0x217F, 1},
+    {0x2184, 0x2184, 1},
+    {0x24D0, 0x24E9, 1},
+    {0x2C30, 0x2C5F, 1},
+    {0x2C61, 0x2C61, 1},
+    {0x2C68, 0x2C6C, 2},
+    {0x2C73, 0x2C73, 1},
+    {0x2C76, 0x2C76, 1},
+    {0x2C81, 0x2CE3, 2},
+    {0x2CEC, 0x2CEE, 2},
+    {0x2CF3, 0x2CF3, 1},
+    {0x2D00, 0x2D25, 1},
+    {0x2D27, 0x2D27, 1},
+    {0x2D2D, 0x2D2D, 1},
+    {0xA641, 0xA66D, 2},
+    {0xA681, 0xA69B, 2},
+    {0xA723, 0xA72F, 2},
+    {0xA733, 0xA76F, 2},
+    {0xA77A, 0xA77C, 2},
+    {0xA77F, 0xA787, 2},
+    {0xA78C, 0xA78C, 1},
+    {0xA791, 0xA793, 2},
+    {0xA794, 0xA794, 1},
+    {0xA797, 0xA7A9, 2},
+    {0xA7B5, 0xA7C3, 2},
+    {0xA7C8, 0xA7CA, 2},
+    {0xA7D1, 0xA7D1, 1},
+    {0xA7D7, 0xA7D9, 2},
+    {0xA7F6, 0xA7F6, 1},
+    {0xAB53, 0xAB53, 1},
+    {0xFF41, 0xFF5A, 1},
+    {0x10428, 0x1044F, 1},
+    {0x104D8, 0x104FB, 1},
+    {0x10597, 0x105A1, 1},
+    {0x105A3, 0x105B1, 1},
+    {0x105B3, 0x105B9, 1},
+    {0x105BB, 0x105BC, 1},
+    {0x10CC0, 0x10CF2, 1},
+    {0x118C0, 0x118DF, 1},
+    {0x16E60, 0x16E7F, 1},
+    {0x1E922, 0x1E943, 1},
+};
+
+/**
+ * 非 ASCII 的分隔字符区间：Latin-1 标点、通用标点、箭头与数学符号、制表符、CJK 标点、全角标点等
+ */
+const TargetRange kSeparatorRanges[] = {
+    {0x0080, 0x00BF, 1}, {0x00D7, 0x00D7, 1}, {0x00F7, 0x00F7, 1}, {0x2000, 0x206F, 1},
+    {0x2190, 0x2BFF, 1}, {0x3000, 0x303F, 1}, {0xFE30, 0xFE4F, 1}, {0xFF00, 0xFF0F, 1},
+    {0xFF1A, 0xFF20, 1}, {0xFF3B, 0xFF40, 1}, {0xFF5B, 0xFF65, 1},
+};
+
+// ASCII 单词字符表：字母、数字、下划线
+struct AsciiWordTable {
+    bool word[128];
+
+    AsciiWordTable() : word() {
+        for (int c = 0; c < 128; c++) {
+            word[c] = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+    }
+};
+
+const AsciiWordTable kAsciiWords;
+
+template <typename Range, size_t N>
+const Range* findRange(const Range (&ranges)[N], uint32_t codePoint) {
+    const Range* it = std::upper_bound(std::begin(ranges), std::end(ranges), codePoint,
+                                       [](uint32_t value, const Range& range) { return value < range.first; });
+    if (it == std::begin(ranges)) {
+        return nullptr;
+    }
+    --it;
+    if (codePoint > it->last || (codePoint - it->first) % it->stride != 0) {
+        return nullptr;
+    }
+    return it;
+}
+
+}  // namespace
+
+size_t UnicodeText::decode(const char* data, size_t length, uint32_t& codePoint) {
+    unsigned char lead = static_cast<unsigned char>(data[0]);
+    codePoint = lead;
+    size_t size = lead < 0x80 ? 1 : lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (size <= 1 || size > length) {
+        return 1;
+    }
+    uint32_t value = lead & (0x7F >> size);
+    for (size_t i = 1; i < size; i++) {
+        unsigned char next = static_cast<unsigned char>(data[i]);
+        if ((next & 0xC0) != 0x80) {
+            return 1;
+        }
+        value = (value << 6) | (next & 0x3F);
+    }
+    // 拒绝过长编码和代理区，保证解码再编码得到相同的字节
+    static const uint32_t kMinimum[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (value < kMinimum[size] || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) {
+        return 1;
+    }
+    codePoint = value;
+    return size;
+}
+
+size_t UnicodeText::encode(uint32_t codePoint, char* output) {
+    if (codePoint < 0x80) {
+        output[0] = static_cast<char>(codePoint);
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        output[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        output[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        output[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        output[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        output[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    output[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+    output[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    output[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    output[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+uint32_t UnicodeText::fold(uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        return codePoint >= 'A' && codePoint <= 'Z' ? codePoint + ('a' - 'A') : codePoint;
+    }
+    const FoldRange* range = findRange(kFoldRanges, codePoint);
+    return range ? static_cast<uint32_t>(static_cast<int32_t>(codePoint) + range->delta) : codePoint;
+}
+
+bool UnicodeText::hasCaseVariants(uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        return (codePoint | 0x20) >= 'a' && (codePoint | 0x20) <= 'z';
+    }
+    return findRange(kFoldRanges, codePoint) != nullptr || findRange(kTargetRanges, codePoint) != nullptr;
+}
+
+std::string UnicodeText::foldString(const std::string& text) {
+    std::string result(text);
+    for (size_t i = 0; i < result.size();) {
+        uint32_t codePoint = 0;
+        size_t size = decode(result.data() + i, result.size() - i, codePoint);
+        if (size == 1) {
+            char c = result[i];
+            result[i] = c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+        } else {
+            encode(fold(codePoint), &result[i]);
+        }
+        i += size;
+    }
+    return result;
+}
+
+bool UnicodeText::isWordCharacter(uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        return kAsciiWords.word[codePoint];
+    }
+    return findRange(kSeparatorRanges, codePoint) == nullptr;
+}
+
+uint32_t UnicodeText::decodeBefore(const char* data, size_t position) {
+    // 最多回退 3 个后续字节找到首字节；不构成完整字符时按单个字节处理
+    size_t start = position - 1;
+    while (start > 0 && position - start < 4 && (static_cast<unsigned char>(data[start]) & 0xC0) == 0x80) {
+        start--;
+    }
+    uint32_t codePoint = 0;
+    if (decode(data + start, position - start, codePoint) != position - start) {
+        codePoint = static_cast<unsigned char>(data[position - 1]);
+    }
+    return codePoint;
+}
@@ -0,0 +1,70 @@
+#ifndef UNICODE_TEXT_H
+#define UNICODE_TEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * UTF-8 文本的字符级工具：解码、简单大小写折叠和单词字符分类
+ * 只收录折叠前后 UTF-8 字节数相同的大小写对（覆盖拉丁、希腊、西里尔、亚美尼亚、格鲁吉亚、
+ * 全角拉丁字母等），因此折叠不改变文本长度，查找时可以直接按字节偏移比较，不需要复制文档。
+ * 开尔文符号 K、长 s 等折叠后字节数变化的字符保持原样
+ */
+class UnicodeText {
+public:
+    /**
+     * 解码一个 UTF-8 字符
+     * @param data 数据
+     * @param length 剩余长度
+     * @param codePoint 输出码位（无效序列输出该字节本身）
+     * @return 字符的字节数（无效序列为 1）
+     */
+    static size_t decode(const char* data, size_t length, uint32_t& codePoint);
+
+    /**
+     * 编码一个码位
+     * @param codePoint 码位
+     * @param output 输出缓冲区（至少 4 字节）
+     * @return 字节数
+     */
+    static size_t encode(uint32_t codePoint, char* output);
+
+    /**
+     * 简单大小写折叠（折叠为小写形式）
+     * @param codePoint 码位
+     * @return 折叠后的码位
+     */
+    static uint32_t fold(uint32_t codePoint);
+
+    /**
+     * 字符是否有其他大小写形式（自身会被折叠，或有其他字符折叠为它）
+     * @param codePoint 码位
+     * @return 是否区分大小写
+     */
+    static bool hasCaseVariants(uint32_t codePoint);
+
+    /**
+     * 折叠整段文本（长度不变，无效的 UTF-8 字节保持原样）
+     * @param text 文本
+     * @return 折叠后的文本
+     */
+    static std::string foldString(const std::string& text);
+
+    /**
+     * 字符是否属于单词（字母、数字、下划线以及除标点、空白和符号区以外的非 ASCII 字符）
+     * @param codePoint 码位
+     * @return 是否为单词字符
+     */
+    static bool isWordCharacter(uint32_t codePoint);
+
+    /**
+     * 解码 position 之前的一个字符
+     * @param data 数据
+     * @param position 位置（大于 0）
+     * @return 码位
+     */
+    static uint32_t decodeBefore(const char* data, size_t position);
+};
+
+#endif // UNICODE_TEXT_H
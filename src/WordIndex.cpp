@@ -0,0 +1,436 @@
+#include "WordIndex.h"
+#include "Editor.h"
+#include "LineIndex.h"
+#include <algorithm>
+#include <string_view>
+
+namespace {
+
+// 单次编辑超过此大小（如打开文件、整体替换）时改为在后台重新分词
+const size_t kRebuildThreshold = 1 << 20;
+
+// 超过此长度的单词（如 base64 数据）不计入索引
+const size_t kMaxWordLength = 64;
+
+// 少于此长度的单词不需要补全
+const size_t kMinWordLength = 2;
+
+// 新单词少于此数量时逐个二分插入有序数组，否则排序后归并
+const size_t kInsertLimit = 32;
+
+// 次数为 0 的单词超过此数量（且多于有效单词）时回收编号
+const size_t kCompactThreshold = 4096;
+
+bool isWordByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+}  // namespace
+
+WordIndex::WordIndex() : nextDocumentId_(1), unusedWords_(0), busy_(false), stopWorker_(false) {
+    worker_ = std::thread(&WordIndex::workerLoop, this);
+}
+
+WordIndex::~WordIndex() {
+    for (auto& entry : documents_) {
+        entry.second.editor->removeEditListener(entry.second.editListenerId);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopWorker_ = true;
+    }
+    workCondition_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+size_t WordIndex::addDocument(std::shared_ptr<Editor> editor) {
+    size_t documentId = nextDocumentId_++;
+    Document& document = documents_[documentId];
+    document.editor = editor;
+    document.generation = 0;
+    document.ready = false;
+    document.dirty = false;
+    document.editListenerId =
+        editor->addEditListener([this, documentId](const TextEdit& edit) { handleEdit(documentId, edit); });
+    startBuild(documentId, document);
+    return documentId;
+}
+
+void WordIndex::removeDocument(size_t documentId) {
+    auto it = documents_.find(documentId);
+    if (it == documents_.end()) {
+        return;
+    }
+    it->second.editor->removeEditListener(it->second.editListenerId);
+    releaseLines(it->second);
+    documents_.erase(it);
+    flushWords();
+    std::lock_guard<std::mutex> lock(mutex_);
+    pendingJobs_.erase(std::remove_if(pendingJobs_.begin(), pendingJobs_.end(),
+                                      [documentId](const Job& job) { return job.documentId == documentId; }),
+                       pendingJobs_.end());
+}
+
+bool WordIndex::collect() {
+    std::vector<Result> results;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results.swap(results_);
+    }
+    bool changed = false;
+    std::vector<uint32_t> mapping;
+    for (Result& result : results) {
+        auto it = documents_.find(result.documentId);
+        if (it == documents_.end() || it->second.generation != result.generation) {
+            continue;
+        }
+        // 结果中的编号换成索引中的编号，每个不同的单词只查找一次
+        Document& document = it->second;
+        mapping.resize(result.words.size());
+        for (size_t i = 0; i < result.words.size(); i++) {
+            mapping[i] = addWord(result.words[i].data(), result.words[i].size(), result.counts[i]);
+        }
+        for (std::vector<uint32_t>& line : result.lines) {
+            for (uint32_t& id : line) {
+                id = mapping[id];
+            }
+        }
+        document.lines.swap(result.lines);
+        document.ready = true;
+        // 补上分词期间的编辑
+        if (document.dirty) {
+            document.dirty = false;
+            int64_t oldLast = static_cast<int64_t>(document.dirtyLast) - document.dirtyDelta;
+            if (oldLast < static_cast<int64_t>(document.dirtyFirst) ||
+                oldLast >= static_cast<int64_t>(document.lines.size())) {
+                releaseLines(document);
+                startBuild(it->first, document);
+            } else {
+                replaceLines(document, document.dirtyFirst, static_cast<size_t>(oldLast), document.dirtyLast);
+            }
+        }
+        changed = true;
+    }
+    if (changed) {
+        flushWords();
+    }
+    return changed;
+}
+
+void WordIndex::waitForIdle() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCondition_.wait(lock, [this]() { return pendingJobs_.empty() && !busy_; });
+    }
+    collect();
+}
+
+bool WordIndex::isReady() const {
+    for (const auto& entry : documents_) {
+        if (!entry.second.ready) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<WordCandidate> WordIndex::complete(const std::string& prefix, size_t limit) const {
+    std::vector<WordCandidate> candidates;
+    if (limit == 0) {
+        return candidates;
+    }
+    auto it = std::lower_bound(sorted_.begin(), sorted_.end(), prefix,
+                               [this](uint32_t id, const std::string& value) { return words_[id].text < value; });
+    std::vector<uint32_t> matches;
+    for (; it != sorted_.end(); ++it) {
+        const Word& word = words_[*it];
+        if (word.text.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        if (word.count > 0 && word.text.size() > prefix.size()) {
+            matches.push_back(*it);
+        }
+    }
+    auto better = [this](uint32_t a, uint32_t b) {
+        const Word& left = words_[a];
+        const Word& right = words_[b];
+        if (left.count != right.count) {
+            return left.count > right.count;
+        }
+        if (left.text.size() != right.text.size()) {
+            return left.text.size() < right.text.size();
+        }
+        return left.text < right.text;
+    };
+    size_t count = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), better);
+    candidates.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        candidates.push_back({words_[matches[i]].text, words_[matches[i]].count});
+    }
+    return candidates;
+}
+
+uint32_t WordIndex::getCount(const std::string& word) const {
+    auto it = ids_.find(word);
+    return it == ids_.end() ? 0 : words_[it->second].count;
+}
+
+size_t WordIndex::getWordCount() const {
+    return ids_.size() - unusedWords_;
+}
+
+void WordIndex::setWordsReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    wordsReadyCallback_ = std::move(callback);
+}
+
+void WordIndex::tokenize(const char* data, size_t length, const std::function<void(const char*, size_t)>& onWord) {
+    size_t i = 0;
+    while (i < length) {
+        if (!isWordByte(static_cast<unsigned char>(data[i]))) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < length && isWordByte(static_cast<unsigned char>(data[i]))) {
+            i++;
+        }
+        size_t wordLength = i - start;
+        if (!(data[start] >= '0' && data[start] <= '9') && wordLength >= kMinWordLength &&
+            wordLength <= kMaxWordLength) {
+            onWord(data + start, wordLength);
+        }
+    }
+}
+
+void WordIndex::startBuild(size_t documentId, Document& document) {
+    document.generation++;
+    document.ready = false;
+    document.dirty = false;
+    document.lines.clear();
+    Job job{documentId, document.generation, std::make_shared<const std::string>(document.editor->getContent())};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(pendingJobs_.begin(), pendingJobs_.end(),
+                               [documentId](const Job& pending) { return pending.documentId == documentId; });
+        if (it != pendingJobs_.end()) {
+            *it = std::move(job);
+        } else {
+            pendingJobs_.push_back(std::move(job));
+        }
+    }
+    workCondition_.notify_one();
+}
+
+void WordIndex::handleEdit(size_t documentId, const TextEdit& edit) {
+    auto it = documents_.find(documentId);
+    if (it == documents_.end()) {
+        return;
+    }
+    Document& document = it->second;
+    if (edit.removedLength + edit.insertedLength > kRebuildThreshold) {
+        releaseLines(document);
+        flushWords();
+        startBuild(documentId, document);
+        return;
+    }
+
+    size_t oldLast = edit.startLine + edit.removedLineBreaks;
+    size_t newLast = edit.startLine + edit.insertedLineBreaks;
+    if (!document.ready) {
+        // 与 SymbolIndex 相同的行范围合并规则
+        if (!document.dirty) {
+            document.dirty = true;
+            document.dirtyFirst = edit.startLine;
+            document.dirtyLast = newLast;
+            document.dirtyDelta = static_cast<int64_t>(newLast) - static_cast<int64_t>(oldLast);
+        } else {
+            int64_t editDelta = static_cast<int64_t>(newLast) - static_cast<int64_t>(oldLast);
+            document.dirtyFirst = std::min(document.dirtyFirst, edit.startLine);
+            document.dirtyLast = document.dirtyLast > oldLast
+                                     ? static_cast<size_t>(static_cast<int64_t>(document.dirtyLast) + editDelta)
+                                     : newLast;
+            document.dirtyDelta += editDelta;
+        }
+        return;
+    }
+    if (oldLast >= document.lines.size()) {
+        releaseLines(document);
+        flushWords();
+        startBuild(documentId, document);
+        return;
+    }
+    replaceLines(document, edit.startLine, oldLast, newLast);
+    flushWords();
+}
+
+void WordIndex::replaceLines(Document& document, size_t first, size_t oldLast, size_t newLast) {
+    for (size_t line = first; line <= oldLast; line++) {
+        for (uint32_t id : document.lines[line]) {
+            removeWord(id);
+        }
+    }
+
+    const LineIndex& lineIndex = document.editor->getLineIndex();
+    std::string_view content = document.editor->getContentView();
+    std::vector<std::vector<uint32_t>> replacement(newLast - first + 1);
+    for (size_t line = first; line <= newLast && line < lineIndex.getLineCount(); line++) {
+        size_t start = lineIndex.getLineStart(line);
+        size_t end = lineIndex.getLineEnd(line);
+        std::vector<uint32_t>& ids = replacement[line - first];
+        tokenize(content.data() + start, end - start,
+                 [this, &ids](const char* word, size_t length) { ids.push_back(addWord(word, length, 1)); });
+    }
+
+    // 只替换受影响的行，其余行的向量原地移动
+    auto begin = document.lines.begin() + static_cast<std::ptrdiff_t>(first);
+    size_t oldCount = oldLast - first + 1;
+    size_t common = std::min(oldCount, replacement.size());
+    std::move(replacement.begin(), replacement.begin() + static_cast<std::ptrdiff_t>(common), begin);
+    if (replacement.size() > oldCount) {
+        document.lines.insert(begin + static_cast<std::ptrdiff_t>(oldCount),
+                              std::make_move_iterator(replacement.begin() + static_cast<std::ptrdiff_t>(common)),
+                              std::make_move_iterator(replacement.end()));
+    } else if (oldCount > replacement.size()) {
+        document.lines.erase(begin + static_cast<std::ptrdiff_t>(common),
+                             begin + static_cast<std::ptrdiff_t>(oldCount));
+    }
+}
+
+void WordIndex::releaseLines(Document& document) {
+    for (const std::vector<uint32_t>& line : document.lines) {
+        for (uint32_t id : line) {
+            removeWord(id);
+        }
+    }
+    document.lines.clear();
+}
+
+uint32_t WordIndex::addWord(const char* data, size_t length, uint32_t count) {
+    std::string text(data, length);
+    auto it = ids_.find(text);
+    if (it != ids_.end()) {
+        Word& word = words_[it->second];
+        if (word.count == 0) {
+            unusedWords_--;
+        }
+        word.count += count;
+        return it->second;
+    }
+    uint32_t id;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+        words_[id].text = text;
+        words_[id].count = count;
+    } else {
+        id = static_cast<uint32_t>(words_.size());
+        words_.push_back({text, count});
+    }
+    ids_.emplace(std::move(text), id);
+    added_.push_back(id);
+    return id;
+}
+
+void WordIndex::removeWord(uint32_t id) {
+    if (--words_[id].count == 0) {
+        unusedWords_++;
+    }
+}
+
+void WordIndex::flushWords() {
+    auto byText = [this](uint32_t a, uint32_t b) { return words_[a].text < words_[b].text; };
+    if (added_.size() <= kInsertLimit) {
+        for (uint32_t id : added_) {
+            sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(), id, byText), id);
+        }
+    } else {
+        std::sort(added_.begin(), added_.end(), byText);
+        size_t middle = sorted_.size();
+        sorted_.insert(sorted_.end(), added_.begin(), added_.end());
+        std::inplace_merge(sorted_.begin(), sorted_.begin() + static_cast<std::ptrdiff_t>(middle), sorted_.end(),
+                           byText);
+    }
+    added_.clear();
+
+    // 删除单词只把次数减到 0，积累较多后一次性回收；过滤保持原有顺序，不需要重新排序
+    if (unusedWords_ > kCompactThreshold && unusedWords_ > ids_.size() - unusedWords_) {
+        sorted_.erase(std::remove_if(sorted_.begin(), sorted_.end(),
+                                     [this](uint32_t id) {
+                                         Word& word = words_[id];
+                                         if (word.count > 0) {
+                                             return false;
+                                         }
+                                         ids_.erase(word.text);
+                                         std::string().swap(word.text);
+                                         freeIds_.push_back(id);
+                                         return true;
+                                     }),
+                      sorted_.end());
+        unusedWords_ = 0;
+    }
+}
+
+void WordIndex::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCondition_.wait(lock, [this]() { return stopWorker_ || !pendingJobs_.empty(); });
+            if (stopWorker_) {
+                return;
+            }
+            job = std::move(pendingJobs_.front());
+            pendingJobs_.pop_front();
+            busy_ = true;
+        }
+
+        Result result;
+        build(job, result);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.push_back(std::move(result));
+        }
+        {
+            std::lock_guard<std::mutex> lock(callbackMutex_);
+            if (wordsReadyCallback_) {
+                wordsReadyCallback_();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        idleCondition_.notify_all();
+    }
+}
+
+void WordIndex::build(const Job& job, Result& result) {
+    result.documentId = job.documentId;
+    result.generation = job.generation;
+    const std::string& text = *job.text;
+    std::unordered_map<std::string_view, uint32_t> local;
+    std::vector<uint32_t>* line = &result.lines.emplace_back();
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find('\n', start);
+        size_t lineEnd = end == std::string::npos ? text.size() : end;
+        tokenize(text.data() + start, lineEnd - start, [&](const char* word, size_t length) {
+            auto inserted = local.emplace(std::string_view(word, length), static_cast<uint32_t>(result.words.size()));
+            if (inserted.second) {
+                result.words.emplace_back(word, length);
+                result.counts.push_back(0);
+            }
+            result.counts[inserted.first->second]++;
+            line->push_back(inserted.first->second);
+        });
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+        line = &result.lines.emplace_back();
+    }
+}
@@ -0,0 +1,239 @@
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Editor;
+struct TextEdit;
+
+/**
+ * 补全候选
+ */
+struct WordCandidate {
+    std::string word;  // 单词
+    uint32_t count;    // 在全部文档中出现的次数
+};
+
+/**
+ * 单词补全索引
+ * 统计所有打开文档中每个标识符（字母、数字、下划线和非 ASCII 字节组成，不以数字开头）的出现次数。
+ * 单词按字节序存放在有序数组中，前缀查询是一次二分查找加一段连续扫描，再按出现次数取前 K 个。
+ *
+ * 每个文档先在后台线程中对快照完整分词，之后每次编辑只重新切分受影响的行：
+ * 每行保存其中单词的编号，编辑时先减去旧行的计数，再加上新行的计数。
+ * 分词期间发生的编辑先合并为一个行范围，结果送达后一次补上
+ */
+class WordIndex {
+public:
+    WordIndex();
+    ~WordIndex();
+
+    WordIndex(const WordIndex&) = delete;
+    WordIndex& operator=(const WordIndex&) = delete;
+
+    /**
+     * 加入一个文档，订阅其范围编辑并开始后台分词
+     * @param editor 编辑器指针
+     * @return 文档编号
+     */
+    size_t addDocument(std::shared_ptr<Editor> editor);
+
+    /**
+     * 移除文档，并从索引中减去其中的单词
+     * @param documentId 文档编号
+     */
+    void removeDocument(size_t documentId);
+
+    /**
+     * 取走后台分词的结果（在界面线程中调用，通常在收到更新回调之后）
+     * @return 是否有新结果
+     */
+    bool collect();
+
+    /**
+     * 等待后台分词结束并取走结果
+     */
+    void waitForIdle();
+
+    /**
+     * 是否所有文档都已分词完成
+     * @return 是否完成
+     */
+    bool isReady() const;
+
+    /**
+     * 查询以 prefix 开头的单词（区分大小写，不包含 prefix 本身）
+     * @param prefix 前缀
+     * @param limit 最多返回的数量
+     * @return 按出现次数从多到少排列的候选（次数相同时较短的在前）
+     */
+    std::vector<WordCandidate> complete(const std::string& prefix, size_t limit) const;
+
+    /**
+     * 获取单词的出现次数
+     * @param word 单词
+     * @return 出现次数
+     */
+    uint32_t getCount(const std::string& word) const;
+
+    /**
+     * 获取索引中不同单词的数量
+     * @return 单词数
+     */
+    size_t getWordCount() const;
+
+    /**
+     * 设置分词结果送达回调
+     * 回调在后台线程中调用，界面代码需切换到主线程后调用 collect()；
+     * 本函数返回后旧回调不会再被调用
+     * @param callback 回调函数
+     */
+    void setWordsReadyCallback(std::function<void()> callback);
+
+    /**
+     * 依次找出一段文本中的单词
+     * @param data 文本
+     * @param length 长度
+     * @param onWord 接收每个单词的起始位置和长度
+     */
+    static void tokenize(const char* data, size_t length, const std::function<void(const char*, size_t)>& onWord);
+
+private:
+    /**
+     * 索引中的单词
+     */
+    struct Word {
+        std::string text;
+        uint32_t count;
+    };
+
+    /**
+     * 一个文档的分词状态
+     */
+    struct Document {
+        std::shared_ptr<Editor> editor;
+        size_t editListenerId;
+        uint64_t generation;
+        bool ready;
+        std::vector<std::vector<uint32_t>> lines;  // 每行中单词的编号
+        bool dirty;                                // 分词期间编辑过的行范围（编辑后坐标）
+        size_t dirtyFirst;
+        size_t dirtyLast;
+        int64_t dirtyDelta;
+    };
+
+    /**
+     * 提交给后台线程的分词任务
+     */
+    struct Job {
+        size_t documentId;
+        uint64_t generation;
+        std::shared_ptr<const std::string> text;
+    };
+
+    /**
+     * 后台分词结果，单词编号只在本结果内有效
+     */
+    struct Result {
+        size_t documentId;
+        uint64_t generation;
+        std::vector<std::string> words;
+        std::vector<uint32_t> counts;
+        std::vector<std::vector<uint32_t>> lines;
+    };
+
+    // 界面线程状态
+    std::map<size_t, Document> documents_;
+    size_t nextDocumentId_;
+    std::vector<Word> words_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<uint32_t> sorted_;   // 按单词排序的编号（可能包含次数为 0 的单词）
+    std::vector<uint32_t> added_;    // 尚未并入 sorted_ 的新单词
+    std::vector<uint32_t> freeIds_;  // 可以复用的编号
+    size_t unusedWords_;             // 次数为 0 但仍占用编号的单词数
+
+    // 线程间共享状态
+    std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable idleCondition_;
+    std::deque<Job> pendingJobs_;
+    bool busy_;
+    bool stopWorker_;
+    std::vector<Result> results_;
+    std::mutex callbackMutex_;
+    std::function<void()> wordsReadyCallback_;
+    std::thread worker_;
+
+    /**
+     * 对文档当前内容提交一次后台分词（替换该文档尚未开始的任务）
+     * @param documentId 文档编号
+     * @param document 文档
+     */
+    void startBuild(size_t documentId, Document& document);
+
+    /**
+     * 处理范围编辑（过大的编辑改为重新分词）
+     * @param documentId 文档编号
+     * @param edit 编辑描述
+     */
+    void handleEdit(size_t documentId, const TextEdit& edit);
+
+    /**
+     * 用当前内容重新切分一段行
+     * @param document 文档
+     * @param first 首行
+     * @param oldLast 末行（编辑前坐标）
+     * @param newLast 末行（编辑后坐标）
+     */
+    void replaceLines(Document& document, size_t first, size_t oldLast, size_t newLast);
+
+    /**
+     * 从索引中减去文档的全部单词
+     * @param document 文档
+     */
+    void releaseLines(Document& document);
+
+    /**
+     * 单词出现次数加一，新单词分配编号
+     * @param data 单词
+     * @param length 长度
+     * @param count 增加的次数
+     * @return 编号
+     */
+    uint32_t addWord(const char* data, size_t length, uint32_t count);
+
+    /**
+     * 单词出现次数减一
+     * @param id 编号
+     */
+    void removeWord(uint32_t id);
+
+    /**
+     * 把新单词并入有序数组，并在次数为 0 的单词过多时回收编号
+     */
+    void flushWords();
+
+    /**
+     * 后台线程主循环
+     */
+    void workerLoop();
+
+    /**
+     * 对整段文本分词
+     * @param job 任务
+     * @param result 输出结果
+     */
+    static void build(const Job& job, Result& result);
+};
+
+#endif // WORD_INDEX_H
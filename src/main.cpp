@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include "MainWindow.h"
 #include "ConfigManager.h"
+#include "BatchEditor.h"
 
 #ifdef MACOS
 #include "platform/macos/MacOSEventLoop.h"
@@ -17,6 +18,11 @@
  * @return 程序退出码
  */
 int main(int argc, char* argv[]) {
+    // 批量查找替换模式：不加载配置，不创建窗口
+    if (BatchEditor::isBatchCommand(argc, argv)) {
+        return BatchEditor::runCommandLine(argc, argv);
+    }
+    
     try {
         
         // 初始化配置管理器
@@ -3,7 +3,110 @@
 #ifdef LINUX
 
 #include <gtk/gtk.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "Editor.h"
+#include "ConfigManager.h"
+#include "SyntaxModel.h"
+#include "FoldingModel.h"
+#include "SymbolIndex.h"
+#include "FileSearcher.h"
+#include "TrigramIndex.h"
+#include "FuzzyMatcher.h"
+#include "MatchIndex.h"
+#include "WordIndex.h"
+#include "ProjectSymbolIndex.h"
+#include "FileFollower.h"
+#include "GzipReader.h"
+#include "PagedDocument.h"
+#include "LongLineIndex.h"
+#include "LogMerger.h"
+#include "EncodingDetector.h"
+#include "LineFilter.h"
+#include "TimestampIndex.h"
+#include "LevelHistogram.h"
+#include "TextSearch.h"
+
+namespace {
+
+// 彩虹括号按嵌套深度循环使用的颜色
+const char* const kRainbowColors[] = {"#0431fa", "#319331", "#7b3814", "#a626a4", "#0184bc", "#c18401"};
+const size_t kRainbowColorCount = sizeof(kRainbowColors) / sizeof(kRainbowColors[0]);
+
+// 行号栏右侧折叠标记所占宽度
+const int kFoldMarkerWidth = 14;
+
+// 停止输入多久后提交符号提取（毫秒）
+const guint kSymbolFlushDelay = 300;
+
+// 符号列表中显示的类型名称，顺序与 SymbolKind 一致
+const char* const kSymbolKindNames[] = {"函数", "方法", "类", "结构体"};
+
+// 符号列表的列
+enum SymbolColumn { SYMBOL_COLUMN_NAME, SYMBOL_COLUMN_KIND, SYMBOL_COLUMN_LINE, SYMBOL_COLUMN_COLUMN };
+
+// 在文件中查找结果列表的列
+enum SearchColumn { SEARCH_COLUMN_LOCATION, SEARCH_COLUMN_TEXT, SEARCH_COLUMN_PATH, SEARCH_COLUMN_LINE,
+                    SEARCH_COLUMN_COLUMN };
+
+// 滚动条旁日志级别概览条的宽度
+const int kOverviewWidth = 10;
+
+// 概览条中各日志级别的颜色，顺序与 LogLevel 一致
+const double kLevelColors[kLogLevelCount][3] = {{0.86, 0.15, 0.15}, {0.95, 0.62, 0.05}, {0.35, 0.6, 0.85},
+                                                {0.7, 0.7, 0.7}};
+
+// 过滤视图中每行最多显示的字节数，超长的行只取开头
+const size_t kFilterLineBytes = 1024;
+
+// 分页视图中每行最多显示的字节数
+const size_t kPagedLineBytes = 4096;
+
+// 分页视图最多保留的超长行分段索引数，超出时全部清空
+const size_t kMaxLongLineIndexes = 16;
+
+// 扩展超长行分段索引时每次读取的字节数
+const size_t kLongLineReadBytes = 1 << 20;
+
+// 合并视图中各来源标签的颜色（循环使用）
+const char* const kSourceColors[] = {"#0451a5", "#a31515", "#098658", "#795e26", "#af00db", "#0184bc"};
+const size_t kSourceColorCount = sizeof(kSourceColors) / sizeof(kSourceColors[0]);
+
+// 结果列表最多显示的行数，超出部分只计数，避免列表过长拖慢界面
+const size_t kMaxSearchRows = 20000;
+
+/**
+ * 转换为可在 GTK 控件中显示的 UTF-8 文本（非法字节被替换）
+ */
+std::string displayText(const std::string& text) {
+    gchar* valid = g_utf8_make_valid(text.c_str(), static_cast<gssize>(text.size()));
+    std::string result(valid);
+    g_free(valid);
+    return result;
+}
+
+void onSymbolRowActivated(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column, gpointer dialog) {
+    gtk_dialog_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+}
+
+}  // namespace
+
+// 补全菜单中显示的最多候选数
+const size_t kCompletionItems = 12;
+
+// 快速打开列表中显示的最多条目数
+const size_t kQuickOpenRows = 50;
+
+// 快速打开列表的列
+enum QuickOpenColumn { QUICK_OPEN_COLUMN_PATH, QUICK_OPEN_COLUMN_INDEX };
 
 // LinuxWindow::Impl 类实现
 class LinuxWindow::Impl {
@@ -21,300 +124,3184 @@ public:
     std::shared_ptr<PluginManager> pluginManager;
     std::shared_ptr<ConfigManager> configManager;
     
+    // 语法模型（括号索引）
+    SyntaxModel syntaxModel;
+    GtkTextTag* bracketMatchTag;
+    std::vector<GtkTextTag*> rainbowTags;
+    guint rainbowIdleId;
+    
+    // 代码折叠（依赖语法模型，必须在其后声明以保证先于语法模型析构）
+    FoldingModel foldingModel;
+    GtkTextTag* foldedTag;
+    guint foldIdleId;
+    
+    // 符号索引（后台提取，用于函数/类名高亮和转到符号）
+    SymbolIndex symbolIndex;
+    GtkTextTag* functionTag;
+    GtkTextTag* classNameTag;
+    guint symbolFlushId;
+    std::atomic<bool> symbolsReadyPending;
+    
+    // 查找栏：匹配索引在后台建立，编辑后只在改动附近重新查找
+    MatchIndex matchIndex;
+    GtkWidget* findBar;
+    GtkWidget* findEntry;
+    GtkWidget* findCaseCheck;
+    GtkWidget* findWordCheck;
+    GtkWidget* findCountLabel;
+    GtkTextTag* findMatchTag;
+    std::atomic<bool> matchesReadyPending;
+    
+    // 单词补全：索引在后台建立，编辑后只重新切分改动的行
+    WordIndex wordIndex;
+    size_t wordDocumentId;
+    GtkWidget* completionMenu;
+    std::atomic<bool> wordsReadyPending;
+    
+    // 跟随文件增长：追加的字节在监视线程中读出，主线程空闲回调追加到末尾
+    FileFollower follower;
+    GtkTextMark* followEndMark;  // 始终位于末尾（右重力），用于滚动到底部
+    std::atomic<bool> followPending;
+    
+    // 压缩日志：在后台线程中流式解压（同时建立检查点索引），解出的内容由主线程空闲回调追加，文档只读
+    GzipReader gzipReader;
+    std::atomic<bool> gzipPending;
+    
+    // 分页只读模式：超过阈值的大文件不载入编辑器，分页视图只绘制可见的几行（按行号从块缓存中读取）
+    PagedDocument pagedDocument;
+    GtkWidget* editorScroll;  // 文本视图所在的滚动窗口，分页模式下隐藏
+    GtkWidget* pagedArea;
+    GtkWidget* pagedView;
+    GtkAdjustment* pagedAdjustment;  // 以行为单位
+    uint64_t pagedCurrentLine;        // 高亮的行（跳转或查找的结果）
+    uint64_t pagedMatchOffset;        // 上一次查找结果，下一次从这里继续
+    bool pagedHasMatch;
+    std::atomic<bool> pagedIndexPending;
+    std::atomic<bool> pagedFindPending;
+    
+    // 超长行：按段建立列号索引（随水平滚动按需向后扩展），绘制时只读取并排版从滚动列开始的一段
+    struct PagedLongLine {
+        LongLineIndex index;
+        uint64_t offset;  // 行首偏移
+        bool complete;    // 索引是否已到行尾
+    };
+    std::unordered_map<uint64_t, PagedLongLine> pagedLongLines;
+    GtkAdjustment* pagedColumnAdjustment;  // 以列为单位
+    uint64_t pagedColumnCount;             // 已知的最大列数（水平滚动范围）
+    size_t longLineSegmentBytes;
+    
+    // 按时间合并多个日志：复用分页视图，绘制时只在可见的几行附近合并，每行带来源标签
+    LogMerger logMerger;
+    
+    // 行过滤：匹配行号在后台并行求出，过滤视图只绘制可见的几行（按行号从编辑器中取文本）
+    LineFilter lineFilter;
+    GtkWidget* filterPanel;
+    GtkWidget* filterEntry;
+    GtkWidget* filterExcludeCheck;
+    GtkWidget* filterRegexCheck;
+    GtkWidget* filterCaseCheck;
+    GtkWidget* filterStatusLabel;
+    GtkWidget* filterView;
+    GtkAdjustment* filterAdjustment;  // 以匹配行为单位
+    std::atomic<bool> filtersReadyPending;
+    
+    // 跳转到时间：每隔若干行采样的稀疏时间戳索引，跳转时才按需解析；分页文档按字节偏移二分
+    TimestampIndex timestampIndex;
+    TimestampIndex pagedTimestampIndex;
+    
+    // 日志级别概览条：分桶统计在后台建立，追加的行在主线程中直接归类
+    LevelHistogram levelHistogram;
+    GtkWidget* overviewStrip;
+    std::atomic<bool> histogramReadyPending;
+    
+    // 在文件中查找：结果在工作线程中送出，暂存后由主线程空闲回调批量加入列表
+    GtkWidget* searchDialog;
+    GtkWidget* searchEntry;
+    GtkWidget* searchFolderEntry;
+    GtkWidget* searchCaseCheck;
+    GtkWidget* searchRegexCheck;
+    GtkWidget* searchWordCheck;
+    GtkWidget* searchIndexCheck;
+    GtkWidget* searchButton;
+    GtkWidget* searchStatusLabel;
+    GtkListStore* searchStore;
+    size_t searchRowCount;
+    std::mutex searchMutex;
+    std::vector<FileSearchMatch> searchPending;
+    bool searchFinished;
+    FileSearchStats searchStats;
+    std::atomic<bool> searchIdlePending;
+    std::string searchNote;  // 附加在结果统计后的说明（是否使用了索引）
+    TrigramIndex trigramIndex;  // 查找目录的三元组索引，在后台建立并随文件变化更新
+    ProjectSymbolIndex projectSymbols;  // 工作区符号索引（转到定义）
+    std::unique_ptr<FileSearcher> fileSearcher;  // 回调引用上面的成员，必须最后声明以最先析构
+    
+    // 快速打开：文件列表在后台线程中收集，完成后由主线程空闲回调交给模糊匹配器
+    GtkWidget* quickOpenDialog;
+    GtkWidget* quickOpenEntry;
+    GtkWidget* quickOpenList;
+    GtkWidget* quickOpenStatusLabel;
+    GtkListStore* quickOpenStore;
+    FuzzyMatcher quickOpenMatcher;
+    std::string quickOpenRoot;      // 匹配器中文件列表对应的目录
+    std::string quickOpenLoading;   // 正在收集的目录
+    std::mutex quickOpenMutex;
+    std::vector<std::string> quickOpenFiles;  // 收集完成的文件列表（相对路径）
+    std::thread quickOpenLoader;
+    
     Impl() : window(nullptr), vbox(nullptr), textView(nullptr), 
-             textBuffer(nullptr), statusBar(nullptr) {}
-};
-
-LinuxWindow::LinuxWindow() : pImpl(std::make_unique<Impl>()) {
-    width_ = 800;
-    height_ = 600;
-    x_ = 100;
-    y_ = 100;
-    title_ = "LitePad";
-}
-
-LinuxWindow::~LinuxWindow() {
-    if (pImpl->window) {
-        gtk_widget_destroy(pImpl->window);
+             textBuffer(nullptr), statusBar(nullptr), bracketMatchTag(nullptr), rainbowIdleId(0),
+             foldedTag(nullptr), foldIdleId(0), functionTag(nullptr), classNameTag(nullptr),
+             symbolFlushId(0), symbolsReadyPending(false), findBar(nullptr), findEntry(nullptr),
+             findCaseCheck(nullptr), findWordCheck(nullptr), findCountLabel(nullptr), findMatchTag(nullptr),
+             matchesReadyPending(false),
+             wordDocumentId(0), completionMenu(nullptr), wordsReadyPending(false), followEndMark(nullptr),
+             followPending(false), gzipPending(false), editorScroll(nullptr), pagedArea(nullptr), pagedView(nullptr),
+             pagedAdjustment(nullptr), pagedCurrentLine(0), pagedMatchOffset(0), pagedHasMatch(false),
+             pagedIndexPending(false), pagedFindPending(false), pagedColumnAdjustment(nullptr), pagedColumnCount(0),
+             longLineSegmentBytes(4096), filterPanel(nullptr), filterEntry(nullptr),
+             filterExcludeCheck(nullptr),
+             filterRegexCheck(nullptr), filterCaseCheck(nullptr), filterStatusLabel(nullptr), filterView(nullptr),
+             filterAdjustment(nullptr), filtersReadyPending(false), overviewStrip(nullptr),
+             histogramReadyPending(false),
+             searchDialog(nullptr), searchEntry(nullptr),
+             searchFolderEntry(nullptr), searchCaseCheck(nullptr), searchRegexCheck(nullptr), searchWordCheck(nullptr),
+             searchIndexCheck(nullptr), searchButton(nullptr),
+             searchStatusLabel(nullptr), searchStore(nullptr), searchRowCount(0), searchFinished(false),
+             searchStats{0, 0, 0, 0, 0, false}, searchIdlePending(false), quickOpenDialog(nullptr),
+             quickOpenEntry(nullptr), quickOpenList(nullptr), quickOpenStatusLabel(nullptr), quickOpenStore(nullptr) {
+        foldingModel.setSyntaxModel(&syntaxModel);
     }
-}
-
-void LinuxWindow::show() {
-    if (!pImpl->window) {
-        // 创建主窗口
-        pImpl->window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-        gtk_window_set_title(GTK_WINDOW(pImpl->window), title_.c_str());
-        gtk_window_set_default_size(GTK_WINDOW(pImpl->window), width_, height_);
-        gtk_window_move(GTK_WINDOW(pImpl->window), x_, y_);
+    
+    /**
+     * 文本迭代器转换为编辑器字节偏移
+     */
+    size_t offsetAt(const GtkTextIter* iter) const {
+        const LineIndex& lines = editor->getLineIndex();
+        return lines.getLineStart(gtk_text_iter_get_line(iter)) + gtk_text_iter_get_line_index(iter);
+    }
+    
+    /**
+     * 编辑器字节偏移转换为文本迭代器
+     */
+    void iterAt(size_t offset, GtkTextIter* iter) const {
+        const LineIndex& lines = editor->getLineIndex();
+        size_t line = lines.getLineOfOffset(offset);
+        gtk_text_buffer_get_iter_at_line_index(textBuffer, iter, static_cast<gint>(line),
+                                               static_cast<gint>(offset - lines.getLineStart(line)));
+    }
+    
+    /**
+     * 编辑器内容是否与文本缓冲区同步（两者字节数一致）
+     */
+    bool isSynchronized() const {
+        GtkTextIter end;
+        gtk_text_buffer_get_end_iter(textBuffer, &end);
+        return editor && offsetAt(&end) == editor->getContentView().size();
+    }
+    
+    /**
+     * 查找光标处（或光标前一个字符处）的括号及其配对括号
+     */
+    bool bracketAtCursor(size_t& bracket, size_t& match) const {
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(textBuffer, &cursor, gtk_text_buffer_get_insert(textBuffer));
+        std::string_view content = editor->getContentView();
+        size_t offset = offsetAt(&cursor);
         
-        // 创建垂直布局容器
-        pImpl->vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        gtk_container_add(GTK_CONTAINER(pImpl->window), pImpl->vbox);
+        for (size_t candidate : {offset, offset - 1}) {
+            if (candidate < content.size() &&
+                (BracketIndex::isOpen(content[candidate]) || BracketIndex::isClose(content[candidate]))) {
+                size_t partner = syntaxModel.findMatchingBracket(candidate);
+                if (partner != std::string::npos) {
+                    bracket = candidate;
+                    match = partner;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    /**
+     * 更新括号配对高亮
+     */
+    void updateBracketMatch() {
+        if (!bracketMatchTag || !isSynchronized()) {
+            return;
+        }
+        GtkTextIter start, end;
+        gtk_text_buffer_get_bounds(textBuffer, &start, &end);
+        gtk_text_buffer_remove_tag(textBuffer, bracketMatchTag, &start, &end);
         
-        // 创建文本编辑器
-        pImpl->textView = gtk_text_view_new();
-        pImpl->textBuffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(pImpl->textView));
+        if (configManager && !configManager->getBool("Editor.bracket_matching", true)) {
+            return;
+        }
+        size_t bracket = 0;
+        size_t match = 0;
+        if (!bracketAtCursor(bracket, match)) {
+            return;
+        }
+        for (size_t offset : {bracket, match}) {
+            iterAt(offset, &start);
+            iterAt(offset + 1, &end);
+            gtk_text_buffer_apply_tag(textBuffer, bracketMatchTag, &start, &end);
+        }
+    }
+    
+    /**
+     * 为可见区域内的括号按嵌套深度着色
+     */
+    void updateRainbowBrackets() {
+        if (rainbowTags.empty() || !isSynchronized()) {
+            return;
+        }
+        GdkRectangle visible;
+        GtkTextIter top, bottom;
+        gtk_text_view_get_visible_rect(GTK_TEXT_VIEW(textView), &visible);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &top, visible.y, nullptr);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &bottom, visible.y + visible.height, nullptr);
+        gtk_text_iter_forward_to_line_end(&bottom);
         
-        // 创建滚动窗口
-        GtkWidget* scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
-        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
-                                     GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-        gtk_container_add(GTK_CONTAINER(scrolledWindow), pImpl->textView);
+        for (GtkTextTag* tag : rainbowTags) {
+            gtk_text_buffer_remove_tag(textBuffer, tag, &top, &bottom);
+        }
         
-        // 创建状态栏
-        pImpl->statusBar = gtk_statusbar_new();
+        const BracketIndex& brackets = syntaxModel.getBracketIndex();
+        const LineIndex& lines = editor->getLineIndex();
+        size_t firstLine = static_cast<size_t>(gtk_text_iter_get_line(&top));
+        size_t lastLine = static_cast<size_t>(gtk_text_iter_get_line(&bottom));
         
-        // 将组件添加到主容器
-        gtk_box_pack_start(GTK_BOX(pImpl->vbox), scrolledWindow, TRUE, TRUE, 0);
-        gtk_box_pack_start(GTK_BOX(pImpl->vbox), pImpl->statusBar, FALSE, FALSE, 0);
+        // 只需一次 O(log n) 查询得到首行深度，之后逐个括号累加
+        int64_t depth = brackets.getDepthAt(firstLine, 0);
+        for (size_t line = firstLine; line <= lastLine; ++line) {
+            for (const BracketToken& token : brackets.getLineBrackets(line)) {
+                bool open = BracketIndex::isOpen(token.ch);
+                if (!open) {
+                    depth--;
+                }
+                size_t colorIndex = static_cast<size_t>(depth < 0 ? 0 : depth) % rainbowTags.size();
+                GtkTextIter start, end;
+                iterAt(lines.getLineStart(line) + token.column, &start);
+                end = start;
+                gtk_text_iter_forward_char(&end);
+                gtk_text_buffer_apply_tag(textBuffer, rainbowTags[colorIndex], &start, &end);
+                if (open) {
+                    depth++;
+                }
+            }
+        }
+    }
+    
+    /**
+     * 按符号表为可见区域内的函数名和类名着色
+     * 类名直接匹配；函数名要求后面紧跟左括号，避免把同名变量也着色
+     */
+    void updateSymbolHighlight() {
+        if (!functionTag || !classNameTag || !isSynchronized()) {
+            return;
+        }
+        GdkRectangle visible;
+        GtkTextIter top, bottom;
+        gtk_text_view_get_visible_rect(GTK_TEXT_VIEW(textView), &visible);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &top, visible.y, nullptr);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &bottom, visible.y + visible.height, nullptr);
+        gtk_text_iter_forward_to_line_end(&bottom);
+        gtk_text_buffer_remove_tag(textBuffer, functionTag, &top, &bottom);
+        gtk_text_buffer_remove_tag(textBuffer, classNameTag, &top, &bottom);
         
-        // 连接信号
-        g_signal_connect(pImpl->window, "delete-event", G_CALLBACK(onDeleteEvent), this);
-        g_signal_connect(pImpl->window, "destroy", G_CALLBACK(onDestroy), this);
-        g_signal_connect(pImpl->textBuffer, "changed", G_CALLBACK(onTextChanged), this);
+        std::shared_ptr<const SymbolTable> table = symbolIndex.getSymbolTable();
+        if (table->getSymbols().empty()) {
+            return;
+        }
+        std::string_view content = editor->getContentView();
+        size_t firstLine = static_cast<size_t>(gtk_text_iter_get_line(&top));
+        size_t lastLine = static_cast<size_t>(gtk_text_iter_get_line(&bottom));
+        std::vector<SyntaxToken> tokens;
+        for (size_t line = firstLine; line <= lastLine; ++line) {
+            syntaxModel.tokenizeLine(line, tokens);
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                if (tokens[i].type != SyntaxTokenType::Identifier) {
+                    continue;
+                }
+                std::string name(content.substr(tokens[i].start, tokens[i].length));
+                GtkTextTag* tag = nullptr;
+                if (table->isClassName(name)) {
+                    tag = classNameTag;
+                } else if (table->isFunctionName(name)) {
+                    size_t next = tokens[i].start + tokens[i].length;
+                    while (next < content.size() && (content[next] == ' ' || content[next] == '\t')) {
+                        next++;
+                    }
+                    if (next < content.size() && content[next] == '(') {
+                        tag = functionTag;
+                    }
+                }
+                if (tag) {
+                    GtkTextIter start, end;
+                    iterAt(tokens[i].start, &start);
+                    iterAt(tokens[i].start + tokens[i].length, &end);
+                    gtk_text_buffer_apply_tag(textBuffer, tag, &start, &end);
+                }
+            }
+        }
+    }
+    
+    /**
+     * 高亮可见区域内的全部查找匹配
+     */
+    void updateFindHighlight() {
+        if (!findMatchTag || !isSynchronized()) {
+            return;
+        }
+        GdkRectangle visible;
+        GtkTextIter top, bottom;
+        gtk_text_view_get_visible_rect(GTK_TEXT_VIEW(textView), &visible);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &top, visible.y, nullptr);
+        gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(textView), &bottom, visible.y + visible.height, nullptr);
+        gtk_text_iter_forward_to_line_end(&bottom);
+        gtk_text_buffer_remove_tag(textBuffer, findMatchTag, &top, &bottom);
+        if (!gtk_widget_get_visible(findBar)) {
+            return;
+        }
+        for (const MatchSpan& match : matchIndex.getMatchesInRange(offsetAt(&top), offsetAt(&bottom))) {
+            GtkTextIter start, end;
+            iterAt(match.start, &start);
+            iterAt(match.start + match.length, &end);
+            gtk_text_buffer_apply_tag(textBuffer, findMatchTag, &start, &end);
+        }
+    }
+    
+    /**
+     * 更新查找栏中的“第 n 个，共 m 个”（选区正好是某个匹配时显示序号）
+     */
+    void updateFindCount() {
+        if (!findCountLabel) {
+            return;
+        }
+        std::string text;
+        if (!matchIndex.isComplete()) {
+            text = "正在查找...";
+        } else if (gtk_entry_get_text_length(GTK_ENTRY(findEntry)) > 0) {
+            size_t count = matchIndex.getMatchCount();
+            GtkTextIter start, end;
+            size_t index = 0;
+            bool current = isSynchronized() && gtk_text_buffer_get_selection_bounds(textBuffer, &start, &end) &&
+                           matchIndex.findNext(offsetAt(&start), index) &&
+                           matchIndex.getMatch(index).start == offsetAt(&start) &&
+                           matchIndex.getMatch(index).start + matchIndex.getMatch(index).length == offsetAt(&end);
+            text = count == 0 ? "无结果"
+                   : current  ? "第 " + std::to_string(index + 1) + " 个，共 " + std::to_string(count) + " 个"
+                              : "共 " + std::to_string(count) + " 个";
+        }
+        gtk_label_set_text(GTK_LABEL(findCountLabel), text.c_str());
+    }
+    
+    /**
+     * 选中第 index 个匹配并滚动到该处
+     */
+    void selectMatch(size_t index) {
+        const MatchSpan& match = matchIndex.getMatch(index);
+        selectSpan(match.start, match.length);
+    }
+    
+    /**
+     * 选中一段文本并滚动到可见位置
+     * @param offset 起始偏移
+     * @param length 长度
+     */
+    void selectSpan(size_t offset, size_t length) {
+        const LineIndex& lines = editor->getLineIndex();
+        if (foldingModel.isLineHidden(lines.getLineOfOffset(offset))) {
+            foldingModel.unfoldAll();
+        }
+        GtkTextIter start, end;
+        iterAt(offset, &start);
+        iterAt(offset + length, &end);
+        gtk_text_buffer_select_range(textBuffer, &start, &end);
+        gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(textView), &start, 0.1, FALSE, 0.0, 0.0);
+        updateFindCount();
+    }
+    
+    /**
+     * 跳到光标之后（或之前）的匹配，到文档末尾（或开头）后回绕
+     */
+    void findAdjacent(bool forward) {
+        if (isMerged()) {
+            gtk_label_set_text(GTK_LABEL(findCountLabel), "合并视图不支持查找");
+            return;
+        }
+        if (pagedDocument.isOpen()) {
+            findPaged(forward);
+            return;
+        }
+        if (!isSynchronized()) {
+            return;
+        }
+        GtkTextIter start, end;
+        gtk_text_buffer_get_selection_bounds(textBuffer, &start, &end);
+        if (!matchIndex.isComplete()) {
+            // 索引尚在后台扫描时直接在缓冲区上查找，向前查找使用反向内核而不是从头扫描
+            std::string pattern = gtk_entry_get_text(GTK_ENTRY(findEntry));
+            bool caseSensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(findCaseCheck));
+            bool wholeWord = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(findWordCheck));
+            size_t length = editor->getContentView().size();
+            size_t offset = offsetAt(&start) + (forward && !gtk_text_iter_equal(&start, &end) ? 1 : 0);
+            size_t position = forward
+                                  ? editor->findTextInRange(pattern, offset, length, true, caseSensitive, wholeWord)
+                                  : editor->findTextBackward(pattern, offset, caseSensitive, wholeWord);
+            if (position == std::string::npos) {
+                position = editor->findTextInRange(pattern, 0, length, forward, caseSensitive, wholeWord);
+            }
+            if (position != std::string::npos) {
+                selectSpan(position, TextSearch(pattern, caseSensitive).getMatchLength());
+            }
+            return;
+        }
+        size_t index = 0;
+        bool found = forward ? matchIndex.findNext(offsetAt(&start) + (gtk_text_iter_equal(&start, &end) ? 0 : 1),
+                                                   index)
+                             : matchIndex.findPrevious(offsetAt(&start), index);
+        if (found) {
+            selectMatch(index);
+        }
+    }
+    
+    /**
+     * 在光标处弹出以光标前单词为前缀的补全菜单
+     * @param owner 窗口（菜单项回调的参数）
+     */
+    void showCompletion(LinuxWindow* owner) {
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(textBuffer, &cursor, gtk_text_buffer_get_insert(textBuffer));
+        std::string_view content = editor->getContentView();
+        size_t offset = offsetAt(&cursor);
+        size_t start = offset;
+        while (start > 0 && (std::isalnum(static_cast<unsigned char>(content[start - 1])) ||
+                             content[start - 1] == '_' || static_cast<unsigned char>(content[start - 1]) >= 0x80)) {
+            start--;
+        }
+        if (start == offset) {
+            return;
+        }
+        std::string prefix(content.substr(start, offset - start));
+        wordIndex.collect();
+        std::vector<WordCandidate> candidates = wordIndex.complete(prefix, kCompletionItems);
+        if (candidates.empty()) {
+            return;
+        }
         
-        gtk_widget_show_all(pImpl->window);
-    } else {
-        gtk_widget_show(pImpl->window);
+        if (!completionMenu) {
+            completionMenu = gtk_menu_new();
+            gtk_menu_attach_to_widget(GTK_MENU(completionMenu), textView, nullptr);
+        }
+        GList* children = gtk_container_get_children(GTK_CONTAINER(completionMenu));
+        for (GList* child = children; child; child = child->next) {
+            gtk_widget_destroy(GTK_WIDGET(child->data));
+        }
+        g_list_free(children);
+        for (const WordCandidate& candidate : candidates) {
+            GtkWidget* item = gtk_menu_item_new_with_label(candidate.word.c_str());
+            // 选中后只插入前缀之后的部分
+            g_object_set_data_full(G_OBJECT(item), "completion", g_strdup(candidate.word.c_str() + prefix.size()),
+                                   g_free);
+            g_signal_connect(item, "activate", G_CALLBACK(onCompletionActivate), owner);
+            gtk_menu_shell_append(GTK_MENU_SHELL(completionMenu), item);
+        }
+        gtk_widget_show_all(completionMenu);
+        
+        GdkRectangle location;
+        gtk_text_view_get_iter_location(GTK_TEXT_VIEW(textView), &cursor, &location);
+        gtk_text_view_buffer_to_window_coords(GTK_TEXT_VIEW(textView), GTK_TEXT_WINDOW_TEXT, location.x, location.y,
+                                              &location.x, &location.y);
+        gtk_menu_popup_at_rect(GTK_MENU(completionMenu),
+                               gtk_text_view_get_window(GTK_TEXT_VIEW(textView), GTK_TEXT_WINDOW_TEXT), &location,
+                               GDK_GRAVITY_SOUTH_WEST, GDK_GRAVITY_NORTH_WEST, nullptr);
+        gtk_menu_shell_select_first(GTK_MENU_SHELL(completionMenu), TRUE);
+    }
+    
+    /**
+     * 打开文件（已打开时不重新载入）并把光标放到指定位置
+     * @param owner 窗口
+     * @param path 文件路径
+     * @param line 行号（从0开始）
+     * @param column 行内字节偏移
+     */
+    void openLocation(LinuxWindow* owner, const std::string& path, size_t line, size_t column) {
+        if (pagedDocument.isOpen() && pagedDocument.getPath() == path) {
+            goToPagedLine(line);
+            return;
+        }
+        if (editor->getFilePath() != path) {
+            owner->handleFileDrop(path);
+            if (editor->getFilePath() != path) {
+                return;
+            }
+        }
+        
+        if (foldingModel.isLineHidden(line)) {
+            foldingModel.unfoldAll();
+        }
+        if (static_cast<gint>(line) >= gtk_text_buffer_get_line_count(textBuffer)) {
+            return;
+        }
+        GtkTextIter iter;
+        gtk_text_buffer_get_iter_at_line(textBuffer, &iter, static_cast<gint>(line));
+        if (static_cast<gint>(column) <= gtk_text_iter_get_bytes_in_line(&iter)) {
+            gtk_text_buffer_get_iter_at_line_index(textBuffer, &iter, static_cast<gint>(line),
+                                                   static_cast<gint>(column));
+        }
+        gtk_text_buffer_place_cursor(textBuffer, &iter);
+        gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(textView), &iter, 0.1, TRUE, 0.0, 0.3);
+        gtk_window_present(GTK_WINDOW(window));
+    }
+    
+    /**
+     * 跳转到光标处标识符的定义：先查当前文件的符号表，再查工作区符号索引
+     * （第一次使用时为当前文件所在目录建立，之后在后台按修改时间刷新）
+     * @param owner 窗口
+     */
+    void goToDefinition(LinuxWindow* owner) {
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(textBuffer, &cursor, gtk_text_buffer_get_insert(textBuffer));
+        std::string_view content = editor->getContentView();
+        size_t start = offsetAt(&cursor);
+        size_t end = start;
+        auto isIdentifier = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+        };
+        while (start > 0 && isIdentifier(content[start - 1])) {
+            start--;
+        }
+        while (end < content.size() && isIdentifier(content[end])) {
+            end++;
+        }
+        if (start == end) {
+            return;
+        }
+        std::string name(content.substr(start, end - start));
+        
+        const Symbol* local = symbolIndex.getSymbolTable()->findByName(name);
+        if (local) {
+            openLocation(owner, editor->getFilePath(), local->line, local->column);
+            return;
+        }
+        
+        gchar* directory = !editor->getFilePath().empty() ? g_path_get_dirname(editor->getFilePath().c_str())
+                                                          : g_get_current_dir();
+        std::string folder = directory;
+        g_free(directory);
+        if (projectSymbols.getRoot() != folder) {
+            FileSearchOptions options;
+            if (configManager) {
+                options.maxFileSize =
+                    static_cast<uint64_t>(configManager->getInt("Search.max_file_size_mb", 64)) << 20;
+            }
+            projectSymbols.setOptions(options);
+            projectSymbols.open(folder, ProjectSymbolIndex::defaultIndexPath(folder));
+        }
+        std::vector<ProjectSymbol> definitions = projectSymbols.findDefinitions(name);
+        if (definitions.empty()) {
+            owner->setStatusText(projectSymbols.isReady() ? "未找到 " + name + " 的定义" : "正在建立符号索引...");
+            return;
+        }
+        if (definitions.size() > 1) {
+            owner->setStatusText(name + " 共有 " + std::to_string(definitions.size()) + " 处定义");
+        }
+        openLocation(owner, definitions[0].path, definitions[0].line, definitions[0].column);
+    }
+    
+    /**
+     * 开始或停止跟随当前文件的增长（tail -f）
+     * @param owner 窗口
+     */
+    void toggleFollow(LinuxWindow* owner) {
+        if (follower.isFollowing()) {
+            follower.stop();
+            editor->setRetentionLimit(0, 0);
+            owner->setStatusText("已停止跟随");
+            return;
+        }
+        // 只有内容与磁盘一致时，已载入的字节数才是文件中的读取位置
+        const std::string path = editor->getFilePath();
+        if (editor->isReadOnly()) {
+            // 只读文档按原因提示：分页视图、压缩文件、无法按 UTF-8 显示的编码
+            if (pagedDocument.isOpen() || isMerged()) {
+                owner->setStatusText("分页视图不支持跟随");
+            } else if (!path.empty() && GzipReader::isGzipFile(path)) {
+                owner->setStatusText("压缩文件不支持跟随");
+            } else {
+                owner->setStatusText("不是 UTF-8 编码的文件不支持跟随");
+            }
+            return;
+        }
+        if (editor->isTranscoded()) {
+            // 转换后的 UTF-8 长度不是原文件中的读取位置，追加的内容也需要按原编码解码
+            owner->setStatusText("已转换编码的文件不支持跟随");
+            return;
+        }
+        if (path.empty() || editor->isModified()) {
+            owner->setStatusText(path.empty() ? "当前文档没有对应的文件" : "文件有未保存的修改，无法跟随");
+            return;
+        }
+        if (!follower.start(path, editor->getContentView().size())) {
+            owner->setStatusText("无法跟随 " + path);
+            return;
+        }
+        if (configManager) {
+            size_t discarded = editor->getDiscardedLineCount();
+            editor->setRetentionLimit(static_cast<size_t>(configManager->getInt("Follow.retention_mb", 0)) << 20,
+                                      static_cast<size_t>(configManager->getInt("Follow.retention_lines", 0)));
+            dropDiscardedLines(owner, discarded);
+        }
+        scrollToEnd();
+        owner->setStatusText("正在跟随 " + path);
+    }
+    
+    /**
+     * 把跟随读到的内容加入编辑器和文本缓冲区
+     * 视图原本停在底部时继续停在底部，用户向上翻看时不打扰
+     * @param owner 窗口
+     * @param update 读到的内容
+     */
+    void applyFollowUpdate(LinuxWindow* owner, const FollowUpdate& update) {
+        GtkAdjustment* adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(textView));
+        bool pinned = gtk_adjustment_get_value(adjustment) + gtk_adjustment_get_page_size(adjustment) >=
+                      gtk_adjustment_get_upper(adjustment) - 1.0;
+        if (update.reset || !isSynchronized()) {
+            editor->reloadContent(update.data);
+            owner->setTextContent(editor->getContent());
+            owner->setStatusText("文件已被截断或替换，重新载入 " + follower.getPath());
+        } else {
+            appendToDocument(owner, update.data);
+        }
+        if (pinned) {
+            scrollToEnd();
+        }
+    }
+    
+    /**
+     * 在编辑器和文本缓冲区末尾追加同样的内容
+     * 编辑器先追加（一次范围编辑），缓冲区随后追加，两者保持一致。
+     * 插入期间屏蔽内容变化回调：编辑器已经是最新内容，不必把整个缓冲区复制回去再逐字节比较，
+     * 每次追加的代价只与追加的长度有关
+     * @param owner 窗口
+     * @param data 追加的内容
+     */
+    void appendToDocument(LinuxWindow* owner, const std::string& data) {
+        size_t discarded = editor->getDiscardedLineCount();
+        editor->appendText(data);
+        dropDiscardedLines(owner, discarded);
+        GtkTextIter end;
+        gtk_text_buffer_get_end_iter(textBuffer, &end);
+        g_signal_handlers_block_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+        gtk_text_buffer_insert(textBuffer, &end, data.data(), static_cast<gint>(data.size()));
+        g_signal_handlers_unblock_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+        refreshAfterTextChange(owner);
+    }
+    
+    /**
+     * 文本变化后更新依赖内容的界面状态：括号匹配、过滤视图、概览条、着色，并推迟提交符号提取
+     * @param owner 窗口
+     */
+    void refreshAfterTextChange(LinuxWindow* owner) {
+        updateBracketMatch();
+        refreshFilterView();
+        if (overviewStrip) {
+            gtk_widget_queue_draw(overviewStrip);
+        }
+        onScrolled(nullptr, owner);
+        
+        // 连续输入时推迟提交符号提取，停顿后只提交一次快照
+        if (symbolFlushId) {
+            g_source_remove(symbolFlushId);
+        }
+        symbolFlushId = g_timeout_add(kSymbolFlushDelay, onSymbolFlush, owner);
+    }
+    
+    /**
+     * 打开文件：gzip 文件以只读的空文档打开，内容在后台解压后分批追加
+     * @param owner 窗口
+     * @param path 文件路径
+     * @return 是否打开成功
+     */
+    bool loadFile(LinuxWindow* owner, const std::string& path) {
+        follower.stop();
+        gzipReader.close();
+        closePaged();
+        uint64_t threshold = static_cast<uint64_t>(
+            std::max(1, configManager ? configManager->getInt("Paged.threshold_mb", 512) : 512)) << 20;
+        std::error_code error;
+        uint64_t size = std::filesystem::file_size(path, error);
+        if (!error && size >= threshold && !GzipReader::isGzipFile(path)) {
+            return openPaged(owner, path);
+        }
+        if (!GzipReader::isGzipFile(path)) {
+            if (!editor->openFile(path)) {
+                return false;
+            }
+            // 文本视图按整行排版，有超长行的文件改用分页视图按段显示（检查已读入的内容，不再读一遍文件）
+            uint64_t longLine = static_cast<uint64_t>(
+                std::max(1, configManager ? configManager->getInt("LongLines.threshold_kb", 1024) : 1024)) << 10;
+            if (LongLineIndex::hasLineLongerThan(editor->getContentView(), longLine)) {
+                return openPaged(owner, path);
+            }
+            return true;
+        }
+        if (!gzipReader.open(path, GzipReader::defaultIndexPath(path))) {
+            return false;
+        }
+        editor->openStreamedFile(path);
+        if (!gzipReader.startStreaming()) {
+            return false;
+        }
+        owner->setStatusText("正在解压 " + path);
+        return true;
+    }
+    
+    /**
+     * 文件打开后更新界面：语言、文本视图内容、标题，并在状态栏显示检测到的编码
+     * 已转换为 UTF-8 的内容照常编辑；无法转换的内容以只读方式显示，无法解码的字节显示为替换字符
+     * @param owner 窗口
+     * @param path 文件路径
+     */
+    void showOpenedFile(LinuxWindow* owner, const std::string& path) {
+        syntaxModel.setLanguage(LanguageRules::detectLanguage(path));
+        symbolIndex.setLanguage(LanguageRules::detectLanguage(path));
+        const DetectedEncoding& encoding = editor->getEncoding();
+        bool displayable = encoding.isUtf8Compatible() || editor->isTranscoded();
+        if (displayable) {
+            owner->setTextContent(editor->getContent());
+        } else {
+            // 显示的是替换了无效字节的副本，不能经内容变化回调写回编辑器，否则原始字节被替换
+            g_signal_handlers_block_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+            owner->setTextContent(displayText(editor->getContent()));
+            g_signal_handlers_unblock_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+            refreshAfterTextChange(owner);
+        }
+        gtk_text_view_set_editable(GTK_TEXT_VIEW(textView), !editor->isReadOnly());
+        owner->setTitle("LitePad - " + path);
+        if (pagedDocument.isOpen() || editor->getContentView().empty()) {
+            // 分页模式和后台解压时状态栏显示各自的进度
+            return;
+        }
+        std::string status = std::string("编码: ") + EncodingDetector::getName(encoding.encoding);
+        if (encoding.sampled) {
+            status += "（按文件开头检测）";
+        }
+        if (editor->isTranscoded()) {
+            status += "，保存时转换回原编码";
+        } else if (!encoding.isUtf8Compatible()) {
+            status += "，以只读方式打开";
+        }
+        owner->setStatusText(status);
+    }
+    
+    /**
+     * 以分页只读模式打开大文件：编辑器中是一个只读的空文档，文本视图换成分页视图
+     * @param owner 窗口
+     * @param path 文件路径
+     * @return 是否打开成功
+     */
+    bool openPaged(LinuxWindow* owner, const std::string& path) {
+        size_t memoryLimit = static_cast<size_t>(
+            std::max(1, configManager ? configManager->getInt("Paged.memory_mb", 64) : 64)) << 20;
+        size_t blockSize = static_cast<size_t>(
+            std::max(4, configManager ? configManager->getInt("Paged.block_kb", 256) : 256)) << 10;
+        if (!pagedDocument.open(path, memoryLimit, blockSize)) {
+            return false;
+        }
+        editor->openStreamedFile(path);
+        pagedTimestampIndex.setPagedDocument(&pagedDocument);
+        pagedCurrentLine = 0;
+        pagedHasMatch = false;
+        pagedLongLines.clear();
+        pagedColumnCount = 0;
+        longLineSegmentBytes = static_cast<size_t>(
+            std::max(16, configManager ? configManager->getInt("LongLines.segment_bytes", 4096) : 4096));
+        gtk_adjustment_set_value(pagedAdjustment, 0.0);
+        gtk_adjustment_configure(pagedColumnAdjustment, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        gtk_widget_hide(editorScroll);
+        gtk_widget_show(pagedArea);
+        gtk_widget_grab_focus(pagedView);
+        refreshPagedView(owner);
+        return true;
+    }
+    
+    /**
+     * 按时间合并多个日志，在分页视图中显示：编辑器中是一个只读的空文档
+     * @param owner 窗口
+     * @param paths 日志文件路径
+     * @return 是否打开成功
+     */
+    bool openMerged(LinuxWindow* owner, const std::vector<std::string>& paths) {
+        follower.stop();
+        gzipReader.close();
+        closePaged();
+        // 内存上限由各来源平分
+        size_t memoryLimit = (static_cast<size_t>(
+            std::max(1, configManager ? configManager->getInt("Paged.memory_mb", 64) : 64)) << 20) /
+            std::max<size_t>(paths.size(), 1);
+        for (const std::string& path : paths) {
+            if (!logMerger.addSource(path, memoryLimit)) {
+                logMerger.clear();
+                owner->setStatusText("无法打开日志: " + path);
+                return false;
+            }
+        }
+        editor->openStreamedFile("");
+        owner->setTextContent("");
+        pagedCurrentLine = 0;
+        gtk_adjustment_set_value(pagedAdjustment, 0.0);
+        gtk_adjustment_configure(pagedColumnAdjustment, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        gtk_widget_hide(editorScroll);
+        gtk_widget_show(pagedArea);
+        gtk_widget_grab_focus(pagedView);
+        refreshPagedView(owner);
+        return true;
+    }
+    
+    /**
+     * 是否正在显示合并视图
+     * @return 是否为合并视图
+     */
+    bool isMerged() const {
+        return logMerger.getSourceCount() > 0;
+    }
+    
+    /**
+     * 关闭分页文档（或合并视图），恢复文本视图
+     */
+    void closePaged() {
+        if (!pagedDocument.isOpen() && !isMerged()) {
+            return;
+        }
+        pagedTimestampIndex.setPagedDocument(nullptr);
+        pagedDocument.close();
+        logMerger.clear();
+        pagedLongLines.clear();
+        gtk_widget_hide(pagedArea);
+        gtk_widget_show(editorScroll);
+    }
+    
+    /**
+     * 分页视图的行高
+     */
+    int pagedRowHeight() const {
+        PangoLayout* layout = gtk_widget_create_pango_layout(pagedView, "0");
+        int height = 0;
+        pango_layout_get_pixel_size(layout, nullptr, &height);
+        g_object_unref(layout);
+        return std::max(height, 1);
+    }
+    
+    /**
+     * 分页视图的字符宽度（用于水平滚动的页大小）
+     */
+    int pagedCharWidth() const {
+        PangoLayout* layout = gtk_widget_create_pango_layout(pagedView, "0");
+        int width = 0;
+        pango_layout_get_pixel_size(layout, &width, nullptr);
+        g_object_unref(layout);
+        return std::max(width, 1);
+    }
+    
+    /**
+     * 取得超长行的分段索引（没有时新建）
+     * @param line 行号（从0开始）
+     * @param offset 行首偏移
+     * @return 分段索引
+     */
+    PagedLongLine& getPagedLongLine(uint64_t line, uint64_t offset) {
+        auto it = pagedLongLines.find(line);
+        if (it != pagedLongLines.end()) {
+            return it->second;
+        }
+        if (pagedLongLines.size() >= kMaxLongLineIndexes) {
+            pagedLongLines.clear();
+        }
+        PagedLongLine& entry = pagedLongLines[line];
+        entry.index = LongLineIndex(longLineSegmentBytes);
+        entry.offset = offset;
+        entry.complete = false;
+        return entry;
+    }
+    
+    /**
+     * 向后扩展超长行的分段索引，直到覆盖指定的列或行内偏移（或到达行尾）
+     * @param entry 分段索引
+     * @param column 列号
+     * @param offset 相对行首的偏移
+     */
+    void extendPagedLongLine(PagedLongLine& entry, uint64_t column, uint64_t offset) {
+        std::string data;
+        while (!entry.complete && entry.index.getColumnCount() <= column && entry.index.getLength() <= offset) {
+            if (!pagedDocument.read(entry.offset + entry.index.getLength(), kLongLineReadBytes, data) || data.empty()) {
+                entry.complete = true;
+                break;
+            }
+            size_t newline = data.find('\n');
+            entry.index.append(data.data(), std::min(newline, data.size()));
+            entry.complete = newline != std::string::npos;
+        }
+        pagedColumnCount = std::max(pagedColumnCount, entry.index.getColumnCount() + (entry.complete ? 0 : 1));
+    }
+    
+    /**
+     * 读取一行从指定列开始的可见部分（最多 kPagedLineBytes 字节）
+     * 短行直接读取；超长行先按分段索引找到列所在的段，只读取这一段之后的内容
+     * @param line 行号（从0开始）
+     * @param column 起始列号
+     * @param text 输出内容
+     * @return 是否成功（行号超出文件时返回 false）
+     */
+    bool readPagedRow(uint64_t line, uint64_t column, std::string& text) {
+        if (pagedLongLines.find(line) == pagedLongLines.end()) {
+            if (!pagedDocument.getLine(line, text, kPagedLineBytes)) {
+                return false;
+            }
+            if (text.size() < kPagedLineBytes) {
+                pagedColumnCount = std::max(pagedColumnCount, LongLineIndex::countColumns(text.data(), text.size()));
+                text.erase(0, LongLineIndex::skipColumns(text.data(), text.size(), column));
+                return true;
+            }
+        }
+        uint64_t offset = 0;
+        if (!pagedDocument.getLineOffset(line, offset)) {
+            return false;
+        }
+        PagedLongLine& entry = getPagedLongLine(line, offset);
+        extendPagedLongLine(entry, column, UINT64_MAX);
+        text.clear();
+        if (column >= entry.index.getColumnCount()) {
+            return true;
+        }
+        size_t segment = entry.index.findSegmentByColumn(column);
+        uint64_t segmentOffset = entry.index.getSegmentOffset(segment);
+        uint64_t available = entry.index.getLength() - segmentOffset;
+        std::string data;
+        if (!pagedDocument.read(entry.offset + segmentOffset, static_cast<size_t>(std::min<uint64_t>(
+                                    available, entry.index.getSegmentLength(segment) + kPagedLineBytes)), data)) {
+            return true;
+        }
+        size_t start = LongLineIndex::skipColumns(data.data(), data.size(),
+                                                  column - entry.index.getSegmentColumn(segment));
+        text = data.substr(start, kPagedLineBytes);
+        text.resize(FileFollower::completeLength(text.data(), text.size()));
+        return true;
+    }
+    
+    /**
+     * 计算行内偏移所在的列号（超长行通过分段索引定位，不必从行首数起）
+     * @param line 行号（从0开始）
+     * @param lineOffset 行首偏移
+     * @param offset 文件中的偏移
+     * @return 列号
+     */
+    uint64_t getPagedColumn(uint64_t line, uint64_t lineOffset, uint64_t offset) {
+        uint64_t relative = offset - lineOffset;
+        std::string data;
+        if (relative < kPagedLineBytes) {
+            pagedDocument.read(lineOffset, static_cast<size_t>(relative), data);
+            return LongLineIndex::countColumns(data.data(), data.size());
+        }
+        PagedLongLine& entry = getPagedLongLine(line, lineOffset);
+        extendPagedLongLine(entry, UINT64_MAX, relative);
+        size_t segment = entry.index.findSegmentByOffset(relative);
+        uint64_t segmentOffset = entry.index.getSegmentOffset(segment);
+        pagedDocument.read(lineOffset + segmentOffset, static_cast<size_t>(relative - segmentOffset), data);
+        return entry.index.getSegmentColumn(segment) + LongLineIndex::countColumns(data.data(), data.size());
+    }
+    
+    /**
+     * 更新水平滚动范围（已知的最大列数增长时）
+     */
+    void refreshPagedColumns() {
+        double columns = std::max(1, gtk_widget_get_allocated_width(pagedView) / pagedCharWidth());
+        double upper = static_cast<double>(pagedColumnCount) + columns / 2;
+        if (upper > gtk_adjustment_get_upper(pagedColumnAdjustment) ||
+            columns != gtk_adjustment_get_page_size(pagedColumnAdjustment)) {
+            gtk_adjustment_configure(pagedColumnAdjustment, gtk_adjustment_get_value(pagedColumnAdjustment), 0.0,
+                                     std::max(upper, gtk_adjustment_get_upper(pagedColumnAdjustment)), 1.0,
+                                     columns / 2, columns);
+        }
+    }
+    
+    /**
+     * 按当前行数和视图高度更新分页视图的滚动范围，并在状态栏显示索引进度
+     * @param owner 窗口
+     */
+    void refreshPagedView(LinuxWindow* owner) {
+        if (isMerged()) {
+            double count = static_cast<double>(logMerger.getLineCount());
+            double rows = std::max(1, gtk_widget_get_allocated_height(pagedView) / pagedRowHeight());
+            gtk_adjustment_configure(pagedAdjustment, std::min(gtk_adjustment_get_value(pagedAdjustment), count), 0.0,
+                                     count, 1.0, rows, rows);
+            std::string status = "按时间合并 " + std::to_string(logMerger.getSourceCount()) + " 个日志（只读，";
+            status += logMerger.isIndexComplete() ? "共 " + std::to_string(logMerger.getLineCount()) + " 行）"
+                                                  : "约 " + std::to_string(logMerger.getLineCount()) + " 行，正在建立行索引...）";
+            owner->setStatusText(status);
+            gtk_widget_queue_draw(pagedView);
+            return;
+        }
+        if (!pagedDocument.isOpen()) {
+            return;
+        }
+        double count = static_cast<double>(pagedDocument.getLineCount());
+        double rows = std::max(1, gtk_widget_get_allocated_height(pagedView) / pagedRowHeight());
+        gtk_adjustment_configure(pagedAdjustment, std::min(gtk_adjustment_get_value(pagedAdjustment), count), 0.0,
+                                 count, 1.0, rows, rows);
+        std::string status = pagedDocument.getPath() + "（只读，" + std::to_string(pagedDocument.getSize() >> 20) + " MB，";
+        status += pagedDocument.isIndexComplete()
+                      ? "共 " + std::to_string(pagedDocument.getLineCount()) + " 行）"
+                      : "约 " + std::to_string(pagedDocument.getLineCount()) + " 行，正在建立行索引...）";
+        owner->setStatusText(status);
+        gtk_widget_queue_draw(pagedView);
+    }
+    
+    /**
+     * 绘制分页视图中可见的行：“行号  内容”（内容从水平滚动列开始），高亮当前行
+     */
+    void drawPagedView(cairo_t* cr) {
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_paint(cr);
+        if (isMerged()) {
+            drawMergedView(cr);
+            return;
+        }
+        if (!pagedDocument.isOpen()) {
+            return;
+        }
+        int rowHeight = pagedRowHeight();
+        int width = gtk_widget_get_allocated_width(pagedView);
+        int height = gtk_widget_get_allocated_height(pagedView);
+        uint64_t line = static_cast<uint64_t>(gtk_adjustment_get_value(pagedAdjustment));
+        uint64_t column = static_cast<uint64_t>(gtk_adjustment_get_value(pagedColumnAdjustment));
+        std::string text;
+        for (int y = 0; y < height && readPagedRow(line, column, text); line++, y += rowHeight) {
+            if (line == pagedCurrentLine) {
+                cairo_set_source_rgb(cr, 0.91, 0.95, 1.0);
+                cairo_rectangle(cr, 0, y, width, rowHeight);
+                cairo_fill(cr);
+            }
+            text = std::to_string(line + 1) + "  " +
+                   text.substr(0, FileFollower::completeLength(text.data(), text.size()));
+            PangoLayout* layout = gtk_widget_create_pango_layout(pagedView, displayText(text).c_str());
+            cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+            cairo_move_to(cr, 4, y);
+            pango_cairo_show_layout(cr, layout);
+            g_object_unref(layout);
+        }
+        refreshPagedColumns();
+    }
+    
+    /**
+     * 绘制合并视图中可见的行：“[来源文件名:行号] 内容”，标签按来源着色，高亮当前行
+     */
+    void drawMergedView(cairo_t* cr) {
+        int rowHeight = pagedRowHeight();
+        int width = gtk_widget_get_allocated_width(pagedView);
+        int height = gtk_widget_get_allocated_height(pagedView);
+        uint64_t row = static_cast<uint64_t>(gtk_adjustment_get_value(pagedAdjustment));
+        std::vector<MergedLine> lines;
+        logMerger.getLines(row, static_cast<size_t>(height / rowHeight + 1), lines, kPagedLineBytes);
+        int y = 0;
+        for (const MergedLine& line : lines) {
+            if (row == pagedCurrentLine) {
+                cairo_set_source_rgb(cr, 0.91, 0.95, 1.0);
+                cairo_rectangle(cr, 0, y, width, rowHeight);
+                cairo_fill(cr);
+            }
+            std::string name = std::filesystem::path(logMerger.getSourcePath(line.source)).filename().string();
+            std::string tag = "[" + name + ":" + std::to_string(line.line + 1) + "]";
+            std::string text = line.text.substr(0, FileFollower::completeLength(line.text.data(), line.text.size()));
+            gchar* markup = g_markup_printf_escaped("<span foreground=\"%s\">%s</span>  %s",
+                                                    kSourceColors[line.source % kSourceColorCount],
+                                                    displayText(tag).c_str(), displayText(text).c_str());
+            PangoLayout* layout = gtk_widget_create_pango_layout(pagedView, nullptr);
+            pango_layout_set_markup(layout, markup, -1);
+            g_free(markup);
+            cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+            cairo_move_to(cr, 4, y);
+            pango_cairo_show_layout(cr, layout);
+            g_object_unref(layout);
+            row++;
+            y += rowHeight;
+        }
+    }
+    
+    /**
+     * 在分页视图中跳转到指定行（放在视图上方三分之一处）
+     * @param line 行号（从0开始）
+     */
+    void goToPagedLine(uint64_t line) {
+        pagedCurrentLine = line;
+        double rows = gtk_adjustment_get_page_size(pagedAdjustment);
+        gtk_adjustment_set_value(pagedAdjustment, std::max(0.0, static_cast<double>(line) - rows / 3));
+        gtk_widget_queue_draw(pagedView);
+    }
+    
+    /**
+     * 水平滚动到指定列（已可见时不滚动，否则放在视图左侧三分之一处）
+     * @param column 列号
+     */
+    void goToPagedColumn(uint64_t column) {
+        refreshPagedColumns();
+        double value = gtk_adjustment_get_value(pagedColumnAdjustment);
+        double page = gtk_adjustment_get_page_size(pagedColumnAdjustment);
+        double target = static_cast<double>(column);
+        if (target < value || target >= value + page) {
+            gtk_adjustment_set_value(pagedColumnAdjustment, std::max(0.0, target - page / 3));
+        }
+    }
+    
+    /**
+     * 在分页文档中从上一个结果（没有时从视图顶部）开始后台查找
+     * @param forward 是否向后查找
+     */
+    void findPaged(bool forward) {
+        std::string pattern = gtk_entry_get_text(GTK_ENTRY(findEntry));
+        if (pattern.empty()) {
+            return;
+        }
+        bool caseSensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(findCaseCheck));
+        bool wholeWord = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(findWordCheck));
+        uint64_t from = pagedMatchOffset + (forward ? 1 : 0);
+        if (!pagedHasMatch && !pagedDocument.getLineOffset(static_cast<uint64_t>(
+                                 gtk_adjustment_get_value(pagedAdjustment)), from)) {
+            from = 0;
+        }
+        pagedDocument.startFind(TextSearch(pattern, caseSensitive, wholeWord), from, forward);
+        gtk_label_set_text(GTK_LABEL(findCountLabel), "正在查找...");
+    }
+    
+    /**
+     * 打开跳转到行对话框（普通模式和分页模式都可用）
+     * @param owner 窗口
+     */
+    void showGoToLine(LinuxWindow* owner) {
+        GtkWidget* dialog = gtk_dialog_new_with_buttons("跳转到行", GTK_WINDOW(window), GTK_DIALOG_MODAL,
+                                                        "取消", GTK_RESPONSE_CANCEL,
+                                                        "跳转", GTK_RESPONSE_ACCEPT,
+                                                        NULL);
+        GtkWidget* entry = gtk_entry_new();
+        uint64_t lineCount = isMerged() ? logMerger.getLineCount()
+                             : pagedDocument.isOpen() ? pagedDocument.getLineCount() : editor->getLineCount();
+        std::string hint = "1 - " + std::to_string(std::max<uint64_t>(lineCount, 1));
+        gtk_entry_set_placeholder_text(GTK_ENTRY(entry), hint.c_str());
+        gtk_entry_set_activates_default(GTK_ENTRY(entry), TRUE);
+        gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+        gtk_container_set_border_width(GTK_CONTAINER(dialog), 6);
+        gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), entry, FALSE, FALSE, 0);
+        gtk_widget_show_all(dialog);
+        
+        if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+            std::string text = gtk_entry_get_text(GTK_ENTRY(entry));
+            char* end = nullptr;
+            unsigned long long line = std::strtoull(text.c_str(), &end, 10);
+            uint64_t offset = 0;
+            if (text.empty() || *end != '\0' || line == 0) {
+                owner->setStatusText("无效的行号: " + text);
+            } else if (isMerged()) {
+                if (line <= logMerger.getLineCount()) {
+                    goToPagedLine(line - 1);
+                } else {
+                    owner->setStatusText("超出合并视图的行数: " + text);
+                }
+            } else if (!pagedDocument.isOpen()) {
+                openLocation(owner, editor->getFilePath(), static_cast<size_t>(line - 1), 0);
+            } else if (pagedDocument.getLineOffset(line - 1, offset)) {
+                // 行索引尚未到达时按需扩展，定位之后行数也更准确
+                goToPagedLine(line - 1);
+                refreshPagedView(owner);
+            } else {
+                owner->setStatusText("超出文件的行数: " + text);
+            }
+        }
+        gtk_widget_destroy(dialog);
+    }
+    
+    /**
+     * 编辑器按保留上限丢弃了开头的行后，从文本缓冲区中删除同样的行
+     * 删除期间屏蔽内容变化回调，避免把尚未追加的中间状态写回编辑器
+     * @param owner 窗口（内容变化回调的参数）
+     * @param discardedBefore 操作之前已丢弃的行数
+     */
+    void dropDiscardedLines(LinuxWindow* owner, size_t discardedBefore) {
+        size_t dropped = editor->getDiscardedLineCount() - discardedBefore;
+        if (dropped == 0) {
+            return;
+        }
+        GtkTextIter start, cut;
+        gtk_text_buffer_get_start_iter(textBuffer, &start);
+        gtk_text_buffer_get_iter_at_line(textBuffer, &cut, static_cast<gint>(dropped));
+        g_signal_handlers_block_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+        gtk_text_buffer_delete(textBuffer, &start, &cut);
+        g_signal_handlers_unblock_by_func(textBuffer, reinterpret_cast<gpointer>(onTextChanged), owner);
+    }
+    
+    /**
+     * 滚动到文档末尾
+     */
+    void scrollToEnd() {
+        if (!followEndMark) {
+            GtkTextIter end;
+            gtk_text_buffer_get_end_iter(textBuffer, &end);
+            followEndMark = gtk_text_buffer_create_mark(textBuffer, nullptr, &end, FALSE);
+        }
+        gtk_text_view_scroll_mark_onscreen(GTK_TEXT_VIEW(textView), followEndMark);
+    }
+    
+    /**
+     * 过滤视图的行高
+     */
+    int filterRowHeight() const {
+        PangoLayout* layout = gtk_widget_create_pango_layout(filterView, "0");
+        int height = 0;
+        pango_layout_get_pixel_size(layout, nullptr, &height);
+        g_object_unref(layout);
+        return std::max(height, 1);
+    }
+    
+    /**
+     * 按匹配行数和视图高度更新滚动范围与状态文字，并重绘过滤视图
+     * 原本停在底部时继续停在底部，跟随模式下新增的匹配行随之出现
+     */
+    void refreshFilterView() {
+        if (!filterPanel || !gtk_widget_get_visible(filterPanel)) {
+            return;
+        }
+        double value = gtk_adjustment_get_value(filterAdjustment);
+        double upper = gtk_adjustment_get_upper(filterAdjustment);
+        bool pinned = upper > 0.0 && value + gtk_adjustment_get_page_size(filterAdjustment) >= upper;
+        double count = static_cast<double>(lineFilter.getMatchCount());
+        double rows = std::max(1, gtk_widget_get_allocated_height(filterView) / filterRowHeight());
+        gtk_adjustment_configure(filterAdjustment, pinned ? std::max(0.0, count - rows) : std::min(value, count),
+                                 0.0, count, 1.0, rows, rows);
+        
+        std::string text;
+        for (const LineFilterRule& rule : lineFilter.getRules()) {
+            text += (rule.exclude ? "-" : "+") + rule.pattern + "  ";
+        }
+        if (lineFilter.getRules().empty()) {
+            text = "没有过滤条件";
+        } else if (!lineFilter.isComplete()) {
+            text += "正在过滤...";
+        } else {
+            text += "共 " + std::to_string(lineFilter.getMatchCount()) + " 行";
+        }
+        gtk_label_set_text(GTK_LABEL(filterStatusLabel), displayText(text).c_str());
+        gtk_widget_queue_draw(filterView);
+    }
+    
+    /**
+     * 绘制过滤视图中可见的匹配行：“行号: 内容”
+     */
+    void drawFilterView(cairo_t* cr) {
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_paint(cr);
+        if (!editor || !isSynchronized()) {
+            return;
+        }
+        cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+        int rowHeight = filterRowHeight();
+        int height = gtk_widget_get_allocated_height(filterView);
+        std::string_view content = editor->getContentView();
+        const LineIndex& lines = editor->getLineIndex();
+        size_t count = lineFilter.getMatchCount();
+        size_t index = static_cast<size_t>(gtk_adjustment_get_value(filterAdjustment));
+        for (int y = 0; index < count && y < height; index++, y += rowHeight) {
+            size_t line = lineFilter.getMatchedLine(index);
+            size_t start = lines.getLineStart(line);
+            size_t length = std::min(lines.getLineEnd(line) - start, kFilterLineBytes);
+            std::string text = std::to_string(line + 1 + editor->getDiscardedLineCount()) + ": ";
+            text.append(content.substr(start, FileFollower::completeLength(content.data() + start, length)));
+            PangoLayout* layout = gtk_widget_create_pango_layout(filterView, displayText(text).c_str());
+            cairo_move_to(cr, 4, y);
+            pango_cairo_show_layout(cr, layout);
+            g_object_unref(layout);
+        }
+    }
+    
+    /**
+     * 绘制日志级别概览条：每个分桶按其中最严重的级别着色，该级别的行越密集颜色越深
+     */
+    void drawOverview(cairo_t* cr) {
+        int width = gtk_widget_get_allocated_width(overviewStrip);
+        int height = gtk_widget_get_allocated_height(overviewStrip);
+        cairo_set_source_rgb(cr, 0.96, 0.96, 0.96);
+        cairo_paint(cr);
+        size_t bucketCount = levelHistogram.getBucketCount();
+        if (!editor || bucketCount == 0 || height <= 0) {
+            return;
+        }
+        double lineCount = static_cast<double>(editor->getLineCount());
+        double linesPerBucket = static_cast<double>(levelHistogram.getLinesPerBucket());
+        for (size_t i = 0; i < bucketCount; i++) {
+            const LevelBucket& bucket = levelHistogram.getBucket(i);
+            size_t level = 0;
+            while (level < kLogLevelCount && bucket.counts[level] == 0) {
+                level++;
+            }
+            if (level == kLogLevelCount) {
+                continue;
+            }
+            double top = i * linesPerBucket / lineCount * height;
+            double bottom = std::min((i + 1) * linesPerBucket, lineCount) / lineCount * height;
+            double density = std::min(1.0, bucket.counts[level] / linesPerBucket * 4.0);
+            cairo_set_source_rgba(cr, kLevelColors[level][0], kLevelColors[level][1], kLevelColors[level][2],
+                                  0.35 + 0.65 * density);
+            cairo_rectangle(cr, 0, top, width, std::max(1.0, bottom - top));
+            cairo_fill(cr);
+        }
+    }
+    
+    /**
+     * 显示跳转到时间对话框，在稀疏时间戳索引上二分后跳转到不早于输入时间的第一行
+     * 分页模式下在分页文档上按字节偏移二分
+     * @param owner 窗口
+     */
+    void showTimeJump(LinuxWindow* owner) {
+        if (isMerged()) {
+            owner->setStatusText("合并视图不支持跳转到时间");
+            return;
+        }
+        bool paged = pagedDocument.isOpen();
+        TimestampIndex& index = paged ? pagedTimestampIndex : timestampIndex;
+        if (index.getFormat() == TimestampFormat::None) {
+            owner->setStatusText("未识别到时间戳格式");
+            return;
+        }
+        GtkWidget* dialog = gtk_dialog_new_with_buttons("跳转到时间", GTK_WINDOW(window), GTK_DIALOG_MODAL,
+                                                        "取消", GTK_RESPONSE_CANCEL,
+                                                        "跳转", GTK_RESPONSE_ACCEPT,
+                                                        NULL);
+        GtkWidget* entry = gtk_entry_new();
+        gtk_entry_set_placeholder_text(GTK_ENTRY(entry), "14:32:05 或 2024-03-05 14:32:05");
+        gtk_entry_set_activates_default(GTK_ENTRY(entry), TRUE);
+        gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+        gtk_container_set_border_width(GTK_CONTAINER(dialog), 6);
+        gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), entry, FALSE, FALSE, 0);
+        gtk_widget_show_all(dialog);
+        
+        if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+            std::string query = gtk_entry_get_text(GTK_ENTRY(entry));
+            size_t line = 0;
+            if (!index.findLine(query, line)) {
+                owner->setStatusText("无法识别的时间: " + query);
+            } else if (paged) {
+                // 查找时行索引可能已向后扩展，先更新滚动范围
+                refreshPagedView(owner);
+                goToPagedLine(line);
+            } else {
+                openLocation(owner, editor->getFilePath(), line, 0);
+            }
+        }
+        gtk_widget_destroy(dialog);
+    }
+    
+    /**
+     * 显示转到符号对话框，选中后跳转到声明处
+     * 列表直接取自最新的符号表，支持按名称输入搜索
+     */
+    void showSymbolList() {
+        std::shared_ptr<const SymbolTable> table = symbolIndex.getSymbolTable();
+        GtkWidget* dialog = gtk_dialog_new_with_buttons("转到符号", GTK_WINDOW(window), GTK_DIALOG_MODAL,
+                                                        "取消", GTK_RESPONSE_CANCEL,
+                                                        "跳转", GTK_RESPONSE_ACCEPT,
+                                                        NULL);
+        gtk_window_set_default_size(GTK_WINDOW(dialog), 480, 520);
+        
+        GtkListStore* store = gtk_list_store_new(4, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_UINT);
+        for (const Symbol& symbol : table->getSymbols()) {
+            std::string name = symbol.container.empty() ? symbol.name : symbol.container + "::" + symbol.name;
+            GtkTreeIter row;
+            gtk_list_store_append(store, &row);
+            gtk_list_store_set(store, &row,
+                               SYMBOL_COLUMN_NAME, name.c_str(),
+                               SYMBOL_COLUMN_KIND, kSymbolKindNames[static_cast<int>(symbol.kind)],
+                               SYMBOL_COLUMN_LINE, static_cast<guint>(symbol.line),
+                               SYMBOL_COLUMN_COLUMN, static_cast<guint>(symbol.column),
+                               -1);
+        }
+        GtkWidget* list = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+        g_object_unref(store);
+        GtkCellRenderer* renderer = gtk_cell_renderer_text_new();
+        gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW(list), -1, "名称", renderer,
+                                                    "text", SYMBOL_COLUMN_NAME, NULL);
+        gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW(list), -1, "类型", renderer,
+                                                    "text", SYMBOL_COLUMN_KIND, NULL);
+        gtk_tree_view_set_search_column(GTK_TREE_VIEW(list), SYMBOL_COLUMN_NAME);
+        g_signal_connect(list, "row-activated", G_CALLBACK(onSymbolRowActivated), dialog);
+        
+        GtkWidget* scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                       GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+        gtk_container_add(GTK_CONTAINER(scrolledWindow), list);
+        gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), scrolledWindow,
+                           TRUE, TRUE, 0);
+        gtk_widget_show_all(dialog);
+        
+        GtkTreeModel* model = nullptr;
+        GtkTreeIter row;
+        if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT &&
+            gtk_tree_selection_get_selected(gtk_tree_view_get_selection(GTK_TREE_VIEW(list)), &model, &row)) {
+            guint line = 0;
+            guint column = 0;
+            gtk_tree_model_get(model, &row, SYMBOL_COLUMN_LINE, &line, SYMBOL_COLUMN_COLUMN, &column, -1);
+            if (foldingModel.isLineHidden(line)) {
+                foldingModel.unfoldAll();
+            }
+            // 符号表可能略落后于当前文本，跳转前把位置限制在文档范围内
+            const LineIndex& lines = editor->getLineIndex();
+            if (line < lines.getLineCount()) {
+                GtkTextIter target;
+                size_t lineEnd = lines.getLineEnd(line);
+                iterAt(std::min(lines.getLineStart(line) + column, lineEnd), &target);
+                gtk_text_buffer_place_cursor(textBuffer, &target);
+                gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(textView), &target, 0.1, TRUE, 0.0, 0.3);
+            }
+        }
+        gtk_widget_destroy(dialog);
+    }
+    
+    /**
+     * 按折叠模型的隐藏行范围更新不可见标签
+     */
+    void applyFolds() {
+        if (!foldedTag || !isSynchronized()) {
+            return;
+        }
+        GtkTextIter start, end;
+        gtk_text_buffer_get_bounds(textBuffer, &start, &end);
+        gtk_text_buffer_remove_tag(textBuffer, foldedTag, &start, &end);
+        
+        // 从区域起始行的行尾隐藏到最后一行的行尾，使起始行之后紧接下一个可见行
+        for (const auto& range : foldingModel.getHiddenRanges()) {
+            gtk_text_buffer_get_iter_at_line(textBuffer, &start, static_cast<gint>(range.first - 1));
+            if (!gtk_text_iter_ends_line(&start)) {
+                gtk_text_iter_forward_to_line_end(&start);
+            }
+            gtk_text_buffer_get_iter_at_line(textBuffer, &end, static_cast<gint>(range.second));
+            if (!gtk_text_iter_ends_line(&end)) {
+                gtk_text_iter_forward_to_line_end(&end);
+            }
+            gtk_text_buffer_apply_tag(textBuffer, foldedTag, &start, &end);
+        }
+        
+        // 光标落入折叠区域时移到区域起始行
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(textBuffer, &cursor, gtk_text_buffer_get_insert(textBuffer));
+        size_t cursorLine = static_cast<size_t>(gtk_text_iter_get_line(&cursor));
+        if (foldingModel.isLineHidden(cursorLine)) {
+            const auto& ranges = foldingModel.getHiddenRanges();
+            for (const auto& range : ranges) {
+                if (cursorLine >= range.first && cursorLine <= range.second) {
+                    gtk_text_buffer_get_iter_at_line(textBuffer, &cursor, static_cast<gint>(range.first - 1));
+                    gtk_text_buffer_place_cursor(textBuffer, &cursor);
+                    break;
+                }
+            }
+        }
+        gtk_widget_queue_draw(textView);
+    }
+    
+    /**
+     * 绘制左侧行号栏和折叠标记，被折叠隐藏的行直接跳过
+     */
+    void drawGutter(cairo_t* cr) {
+        GtkTextView* view = GTK_TEXT_VIEW(textView);
+        GdkRectangle visible;
+        gtk_text_view_get_visible_rect(view, &visible);
+        int gutterWidth = gtk_text_view_get_border_window_size(view, GTK_TEXT_WINDOW_LEFT);
+        
+        cairo_set_source_rgb(cr, 0.94, 0.94, 0.94);
+        cairo_paint(cr);
+        cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
+        
+        GtkTextIter iter;
+        gtk_text_view_get_line_at_y(view, &iter, visible.y, nullptr);
+        size_t lineCount = static_cast<size_t>(gtk_text_buffer_get_line_count(textBuffer));
+        size_t line = foldingModel.nextVisibleLine(static_cast<size_t>(gtk_text_iter_get_line(&iter)));
+        bool synchronized = isSynchronized();
+        
+        while (line < lineCount) {
+            gtk_text_buffer_get_iter_at_line(textBuffer, &iter, static_cast<gint>(line));
+            gint y = 0;
+            gint height = 0;
+            gtk_text_view_get_line_yrange(view, &iter, &y, &height);
+            if (y > visible.y + visible.height) {
+                break;
+            }
+            gint windowY = 0;
+            gtk_text_view_buffer_to_window_coords(view, GTK_TEXT_WINDOW_LEFT, 0, y, nullptr, &windowY);
+            
+            // 按保留上限丢弃过开头的行时，行号仍与文件中的行号一致
+            std::string text = std::to_string(line + 1 + (editor ? editor->getDiscardedLineCount() : 0));
+            PangoLayout* layout = gtk_widget_create_pango_layout(textView, text.c_str());
+            int textWidth = 0;
+            pango_layout_get_pixel_size(layout, &textWidth, nullptr);
+            cairo_move_to(cr, gutterWidth - kFoldMarkerWidth - textWidth - 2, windowY);
+            pango_cairo_show_layout(cr, layout);
+            g_object_unref(layout);
+            
+            FoldRegion region;
+            if (synchronized && foldingModel.findRegionAt(line, region)) {
+                layout = gtk_widget_create_pango_layout(textView, region.collapsed ? "\u25b8" : "\u25be");
+                cairo_move_to(cr, gutterWidth - kFoldMarkerWidth + 2, windowY);
+                pango_cairo_show_layout(cr, layout);
+                g_object_unref(layout);
+            }
+            
+            line = foldingModel.nextVisibleLine(line + 1);
+        }
+    }
+};
+
+LinuxWindow::LinuxWindow() : pImpl(std::make_unique<Impl>()) {
+    width_ = 800;
+    height_ = 600;
+    x_ = 100;
+    y_ = 100;
+    title_ = "LitePad";
+    
+    pImpl->foldingModel.setFoldsChangedCallback([this]() {
+        if (!pImpl->foldIdleId && pImpl->textView) {
+            pImpl->foldIdleId = g_idle_add(onFoldIdle, this);
+        }
+    });
+    
+    // 符号表在后台线程中更新，切换到主线程后重新着色
+    pImpl->symbolIndex.setSymbolsChangedCallback([this]() {
+        if (!pImpl->symbolsReadyPending.exchange(true)) {
+            g_idle_add(onSymbolsReady, this);
+        }
+    });
+    
+    // 匹配索引同样在后台线程中完成，切换到主线程后取走结果
+    pImpl->matchIndex.setMatchesReadyCallback([this]() {
+        if (!pImpl->matchesReadyPending.exchange(true)) {
+            g_idle_add(onMatchesReady, this);
+        }
+    });
+    
+    pImpl->wordIndex.setWordsReadyCallback([this]() {
+        if (!pImpl->wordsReadyPending.exchange(true)) {
+            g_idle_add(onWordsReady, this);
+        }
+    });
+    
+    pImpl->follower.setDataReadyCallback([this]() {
+        if (!pImpl->followPending.exchange(true)) {
+            g_idle_add(onFollowData, this);
+        }
+    });
+    
+    pImpl->gzipReader.setDataReadyCallback([this]() {
+        if (!pImpl->gzipPending.exchange(true)) {
+            g_idle_add(onGzipData, this);
+        }
+    });
+    
+    pImpl->pagedDocument.setIndexProgressCallback([this]() {
+        if (!pImpl->pagedIndexPending.exchange(true)) {
+            g_idle_add(onPagedIndexProgress, this);
+        }
+    });
+    
+    pImpl->logMerger.setIndexProgressCallback([this]() {
+        if (!pImpl->pagedIndexPending.exchange(true)) {
+            g_idle_add(onPagedIndexProgress, this);
+        }
+    });
+    
+    pImpl->pagedDocument.setFindReadyCallback([this]() {
+        if (!pImpl->pagedFindPending.exchange(true)) {
+            g_idle_add(onPagedFindReady, this);
+        }
+    });
+    
+    pImpl->lineFilter.setLinesReadyCallback([this]() {
+        if (!pImpl->filtersReadyPending.exchange(true)) {
+            g_idle_add(onFiltersReady, this);
+        }
+    });
+    
+    pImpl->levelHistogram.setHistogramReadyCallback([this]() {
+        if (!pImpl->histogramReadyPending.exchange(true)) {
+            g_idle_add(onHistogramReady, this);
+        }
+    });
+}
+
+LinuxWindow::~LinuxWindow() {
+    if (pImpl->rainbowIdleId) {
+        g_source_remove(pImpl->rainbowIdleId);
+    }
+    if (pImpl->foldIdleId) {
+        g_source_remove(pImpl->foldIdleId);
+    }
+    pImpl->foldingModel.setFoldsChangedCallback(nullptr);
+    // 停止后台线程的回调后，再移除它们已投递但尚未执行的空闲回调
+    pImpl->symbolIndex.setSymbolsChangedCallback(nullptr);
+    pImpl->matchIndex.setMatchesReadyCallback(nullptr);
+    pImpl->wordIndex.setWordsReadyCallback(nullptr);
+    pImpl->follower.setDataReadyCallback(nullptr);
+    pImpl->follower.stop();
+    pImpl->gzipReader.setDataReadyCallback(nullptr);
+    pImpl->gzipReader.close();
+    pImpl->pagedDocument.setIndexProgressCallback(nullptr);
+    pImpl->pagedDocument.setFindReadyCallback(nullptr);
+    pImpl->pagedDocument.close();
+    pImpl->logMerger.setIndexProgressCallback(nullptr);
+    pImpl->logMerger.clear();
+    pImpl->lineFilter.setLinesReadyCallback(nullptr);
+    pImpl->levelHistogram.setHistogramReadyCallback(nullptr);
+    if (pImpl->fileSearcher) {
+        pImpl->fileSearcher->cancel();
+        pImpl->fileSearcher->wait();
+    }
+    if (pImpl->quickOpenLoader.joinable()) {
+        pImpl->quickOpenLoader.join();
+    }
+    if (pImpl->symbolFlushId) {
+        g_source_remove(pImpl->symbolFlushId);
+    }
+    while (g_idle_remove_by_data(this)) {
+    }
+    if (pImpl->window) {
+        gtk_widget_destroy(pImpl->window);
+    }
+}
+
+void LinuxWindow::show() {
+    if (!pImpl->window) {
+        // 创建主窗口
+        pImpl->window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        gtk_window_set_title(GTK_WINDOW(pImpl->window), title_.c_str());
+        gtk_window_set_default_size(GTK_WINDOW(pImpl->window), width_, height_);
+        gtk_window_move(GTK_WINDOW(pImpl->window), x_, y_);
+        
+        // 创建垂直布局容器
+        pImpl->vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+        gtk_container_add(GTK_CONTAINER(pImpl->window), pImpl->vbox);
+        
+        // 创建文本编辑器
+        pImpl->textView = gtk_text_view_new();
+        pImpl->textBuffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(pImpl->textView));
+        
+        // 创建滚动窗口
+        GtkWidget* scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                     GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+        gtk_container_add(GTK_CONTAINER(scrolledWindow), pImpl->textView);
+        pImpl->editorScroll = scrolledWindow;
+        
+        // 分页视图（打开超大文件或有超长行的文件时代替文本视图）：不创建逐行控件，
+        // 垂直滚动条按行计数，水平滚动条按列计数，绘制时只取可见的行中从滚动列开始的一段
+        pImpl->pagedArea = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+        pImpl->pagedAdjustment = gtk_adjustment_new(0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        pImpl->pagedColumnAdjustment = gtk_adjustment_new(0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        pImpl->pagedView = gtk_drawing_area_new();
+        gtk_widget_set_can_focus(pImpl->pagedView, TRUE);
+        gtk_widget_add_events(pImpl->pagedView, GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK | GDK_KEY_PRESS_MASK);
+        GtkWidget* pagedRows = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+        GtkWidget* pagedScrollbar = gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, pImpl->pagedAdjustment);
+        GtkWidget* pagedColumnScrollbar = gtk_scrollbar_new(GTK_ORIENTATION_HORIZONTAL, pImpl->pagedColumnAdjustment);
+        gtk_box_pack_start(GTK_BOX(pagedRows), pImpl->pagedView, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(pagedRows), pagedScrollbar, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->pagedArea), pagedRows, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->pagedArea), pagedColumnScrollbar, FALSE, FALSE, 0);
+        gtk_widget_show_all(pImpl->pagedArea);
+        gtk_widget_set_no_show_all(pImpl->pagedArea, TRUE);
+        gtk_widget_hide(pImpl->pagedArea);
+        
+        // 滚动条右侧的日志级别概览条，点击跳转到对应位置
+        GtkWidget* editorArea = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+        pImpl->overviewStrip = gtk_drawing_area_new();
+        gtk_widget_set_size_request(pImpl->overviewStrip, kOverviewWidth, -1);
+        gtk_widget_add_events(pImpl->overviewStrip, GDK_BUTTON_PRESS_MASK);
+        gtk_box_pack_start(GTK_BOX(editorArea), scrolledWindow, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(editorArea), pImpl->pagedArea, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(editorArea), pImpl->overviewStrip, FALSE, FALSE, 0);
+        
+        // 创建查找栏（Ctrl+F 显示）
+        pImpl->findBar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+        gtk_container_set_border_width(GTK_CONTAINER(pImpl->findBar), 2);
+        pImpl->findEntry = gtk_search_entry_new();
+        pImpl->findCaseCheck = gtk_check_button_new_with_label("区分大小写");
+        pImpl->findWordCheck = gtk_check_button_new_with_label("全字匹配");
+        pImpl->findCountLabel = gtk_label_new("");
+        GtkWidget* previousButton = gtk_button_new_from_icon_name("go-up-symbolic", GTK_ICON_SIZE_BUTTON);
+        GtkWidget* nextButton = gtk_button_new_from_icon_name("go-down-symbolic", GTK_ICON_SIZE_BUTTON);
+        GtkWidget* closeButton = gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_BUTTON);
+        gtk_widget_set_size_request(pImpl->findEntry, 280, -1);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), pImpl->findEntry, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), previousButton, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), nextButton, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), pImpl->findCaseCheck, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), pImpl->findWordCheck, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->findBar), pImpl->findCountLabel, FALSE, FALSE, 0);
+        gtk_box_pack_end(GTK_BOX(pImpl->findBar), closeButton, FALSE, FALSE, 0);
+        gtk_widget_show_all(pImpl->findBar);
+        gtk_widget_set_no_show_all(pImpl->findBar, TRUE);
+        gtk_widget_hide(pImpl->findBar);
+        
+        // 创建行过滤面板（Ctrl+Shift+L 显示）：条件栏在上，过滤视图在下
+        pImpl->filterPanel = gtk_box_new(GTK_ORIENTATION_VERTICAL, 2);
+        gtk_container_set_border_width(GTK_CONTAINER(pImpl->filterPanel), 2);
+        GtkWidget* filterBar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+        pImpl->filterEntry = gtk_entry_new();
+        gtk_entry_set_placeholder_text(GTK_ENTRY(pImpl->filterEntry), "输入条件后回车叠加");
+        pImpl->filterExcludeCheck = gtk_check_button_new_with_label("排除");
+        pImpl->filterRegexCheck = gtk_check_button_new_with_label("正则表达式");
+        pImpl->filterCaseCheck = gtk_check_button_new_with_label("区分大小写");
+        pImpl->filterStatusLabel = gtk_label_new("");
+        gtk_label_set_ellipsize(GTK_LABEL(pImpl->filterStatusLabel), PANGO_ELLIPSIZE_START);
+        GtkWidget* filterUndoButton = gtk_button_new_with_label("撤销条件");
+        GtkWidget* filterCloseButton = gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_BUTTON);
+        gtk_widget_set_size_request(pImpl->filterEntry, 240, -1);
+        gtk_box_pack_start(GTK_BOX(filterBar), pImpl->filterEntry, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filterBar), pImpl->filterExcludeCheck, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filterBar), pImpl->filterRegexCheck, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filterBar), pImpl->filterCaseCheck, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filterBar), filterUndoButton, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(filterBar), pImpl->filterStatusLabel, TRUE, TRUE, 0);
+        gtk_box_pack_end(GTK_BOX(filterBar), filterCloseButton, FALSE, FALSE, 0);
+        
+        // 过滤视图不创建逐行控件，滚动条按匹配行计数，绘制时只取可见的行
+        GtkWidget* filterArea = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+        pImpl->filterAdjustment = gtk_adjustment_new(0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
+        pImpl->filterView = gtk_drawing_area_new();
+        gtk_widget_set_size_request(pImpl->filterView, -1, 180);
+        gtk_widget_add_events(pImpl->filterView, GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK);
+        GtkWidget* filterScrollbar = gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, pImpl->filterAdjustment);
+        gtk_box_pack_start(GTK_BOX(filterArea), pImpl->filterView, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(filterArea), filterScrollbar, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->filterPanel), filterBar, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->filterPanel), filterArea, TRUE, TRUE, 0);
+        gtk_widget_show_all(pImpl->filterPanel);
+        gtk_widget_set_no_show_all(pImpl->filterPanel, TRUE);
+        gtk_widget_hide(pImpl->filterPanel);
+        
+        // 创建状态栏
+        pImpl->statusBar = gtk_statusbar_new();
+        
+        // 将组件添加到主容器
+        gtk_box_pack_start(GTK_BOX(pImpl->vbox), editorArea, TRUE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->vbox), pImpl->findBar, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->vbox), pImpl->filterPanel, FALSE, FALSE, 0);
+        gtk_box_pack_start(GTK_BOX(pImpl->vbox), pImpl->statusBar, FALSE, FALSE, 0);
+        
+        // 括号配对与彩虹括号标签
+        pImpl->bracketMatchTag = gtk_text_buffer_create_tag(pImpl->textBuffer, "bracket-match",
+                                                            "background", "#c8e1ff", NULL);
+        for (size_t i = 0; i < kRainbowColorCount; ++i) {
+            std::string name = "rainbow-" + std::to_string(i);
+            pImpl->rainbowTags.push_back(gtk_text_buffer_create_tag(pImpl->textBuffer, name.c_str(),
+                                                                    "foreground", kRainbowColors[i], NULL));
+        }
+        
+        // 代码折叠：隐藏行使用不可见标签，行号栏绘制在左侧边框窗口中
+        pImpl->foldedTag = gtk_text_buffer_create_tag(pImpl->textBuffer, "folded", "invisible", TRUE, NULL);
+        
+        // 函数名与类名标签
+        std::string functionColor = pImpl->configManager ?
+            pImpl->configManager->getString("SyntaxHighlighting.function_color", "#795e26") : "#795e26";
+        std::string classNameColor = pImpl->configManager ?
+            pImpl->configManager->getString("SyntaxHighlighting.class_name_color", "#267f99") : "#267f99";
+        pImpl->functionTag = gtk_text_buffer_create_tag(pImpl->textBuffer, "function-name",
+                                                        "foreground", functionColor.c_str(), NULL);
+        pImpl->classNameTag = gtk_text_buffer_create_tag(pImpl->textBuffer, "class-name",
+                                                         "foreground", classNameColor.c_str(), NULL);
+        pImpl->findMatchTag = gtk_text_buffer_create_tag(pImpl->textBuffer, "find-match",
+                                                         "background", "#fff2a8", NULL);
+        bool showGutter = !pImpl->configManager || pImpl->configManager->getBool("Editor.line_numbers", true);
+        if (showGutter) {
+            int gutterWidth = pImpl->configManager ? pImpl->configManager->getInt("LineNumbers.width", 60) : 60;
+            gtk_text_view_set_border_window_size(GTK_TEXT_VIEW(pImpl->textView), GTK_TEXT_WINDOW_LEFT,
+                                                 gutterWidth);
+        }
+        
+        // 连接信号
+        g_signal_connect(pImpl->window, "delete-event", G_CALLBACK(onDeleteEvent), this);
+        g_signal_connect(pImpl->window, "destroy", G_CALLBACK(onDestroy), this);
+        g_signal_connect(pImpl->textBuffer, "changed", G_CALLBACK(onTextChanged), this);
+        g_signal_connect(pImpl->textBuffer, "mark-set", G_CALLBACK(onMarkSet), this);
+        g_signal_connect(pImpl->textView, "key-press-event", G_CALLBACK(onKeyPress), this);
+        g_signal_connect(pImpl->textView, "draw", G_CALLBACK(onTextViewDraw), this);
+        g_signal_connect(pImpl->textView, "button-press-event", G_CALLBACK(onButtonPress), this);
+        g_signal_connect(gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(pImpl->textView)), "value-changed",
+                         G_CALLBACK(onScrolled), this);
+        g_signal_connect(pImpl->findEntry, "search-changed", G_CALLBACK(onFindChanged), this);
+        g_signal_connect(pImpl->findCaseCheck, "toggled", G_CALLBACK(onFindChanged), this);
+        g_signal_connect(pImpl->findWordCheck, "toggled", G_CALLBACK(onFindChanged), this);
+        g_signal_connect(pImpl->findEntry, "activate", G_CALLBACK(onFindNext), this);
+        g_signal_connect(pImpl->findEntry, "key-press-event", G_CALLBACK(onFindKeyPress), this);
+        g_signal_connect(nextButton, "clicked", G_CALLBACK(onFindNext), this);
+        g_signal_connect(previousButton, "clicked", G_CALLBACK(onFindPrevious), this);
+        g_signal_connect(closeButton, "clicked", G_CALLBACK(onFindClose), this);
+        g_signal_connect(pImpl->overviewStrip, "draw", G_CALLBACK(onOverviewDraw), this);
+        g_signal_connect(pImpl->overviewStrip, "button-press-event", G_CALLBACK(onOverviewButtonPress), this);
+        g_signal_connect(pImpl->filterEntry, "activate", G_CALLBACK(onFilterAdd), this);
+        g_signal_connect(filterUndoButton, "clicked", G_CALLBACK(onFilterUndo), this);
+        g_signal_connect(filterCloseButton, "clicked", G_CALLBACK(onFilterClose), this);
+        g_signal_connect(pImpl->filterView, "draw", G_CALLBACK(onFilterDraw), this);
+        g_signal_connect(pImpl->filterView, "size-allocate", G_CALLBACK(onFilterResize), this);
+        g_signal_connect(pImpl->filterView, "scroll-event", G_CALLBACK(onFilterScroll), this);
+        g_signal_connect(pImpl->filterView, "button-press-event", G_CALLBACK(onFilterButtonPress), this);
+        g_signal_connect(pImpl->filterAdjustment, "value-changed", G_CALLBACK(onFilterScrolled), this);
+        g_signal_connect(pImpl->pagedView, "draw", G_CALLBACK(onPagedDraw), this);
+        g_signal_connect(pImpl->pagedView, "size-allocate", G_CALLBACK(onPagedResize), this);
+        g_signal_connect(pImpl->pagedView, "scroll-event", G_CALLBACK(onPagedScroll), this);
+        g_signal_connect(pImpl->pagedView, "key-press-event", G_CALLBACK(onPagedKeyPress), this);
+        g_signal_connect(pImpl->pagedView, "button-press-event", G_CALLBACK(onPagedButtonPress), this);
+        g_signal_connect(pImpl->pagedAdjustment, "value-changed", G_CALLBACK(onPagedScrolled), this);
+        g_signal_connect(pImpl->pagedColumnAdjustment, "value-changed", G_CALLBACK(onPagedScrolled), this);
+        
+        gtk_widget_show_all(pImpl->window);
+    } else {
+        gtk_widget_show(pImpl->window);
+    }
+}
+
+void LinuxWindow::hide() {
+    if (pImpl->window) {
+        gtk_widget_hide(pImpl->window);
+    }
+}
+
+void LinuxWindow::close() {
+    if (pImpl->window) {
+        gtk_widget_destroy(pImpl->window);
+        pImpl->window = nullptr;
+    }
+}
+
+void LinuxWindow::setTitle(const std::string& title) {
+    title_ = title;
+    if (pImpl->window) {
+        gtk_window_set_title(GTK_WINDOW(pImpl->window), title.c_str());
+    }
+}
+
+std::string LinuxWindow::getTitle() const {
+    return title_;
+}
+
+void LinuxWindow::setSize(int width, int height) {
+    width_ = width;
+    height_ = height;
+    if (pImpl->window) {
+        gtk_window_resize(GTK_WINDOW(pImpl->window), width, height);
+    }
+}
+
+void LinuxWindow::getSize(int& width, int& height) const {
+    width = width_;
+    height = height_;
+}
+
+void LinuxWindow::setPosition(int x, int y) {
+    x_ = x;
+    y_ = y;
+    if (pImpl->window) {
+        gtk_window_move(GTK_WINDOW(pImpl->window), x, y);
+    }
+}
+
+void LinuxWindow::getPosition(int& x, int& y) const {
+    x = x_;
+    y = y_;
+}
+
+void LinuxWindow::maximize() {
+    if (pImpl->window) {
+        gtk_window_maximize(GTK_WINDOW(pImpl->window));
+    }
+}
+
+void LinuxWindow::minimize() {
+    if (pImpl->window) {
+        gtk_window_iconify(GTK_WINDOW(pImpl->window));
+    }
+}
+
+void LinuxWindow::restore() {
+    if (pImpl->window) {
+        gtk_window_unmaximize(GTK_WINDOW(pImpl->window));
+        gtk_window_deiconify(GTK_WINDOW(pImpl->window));
+    }
+}
+
+bool LinuxWindow::isMaximized() const {
+    // GTK+ 实现待完善
+    return false;
+}
+
+bool LinuxWindow::isMinimized() const {
+    // GTK+ 实现待完善
+    return false;
+}
+
+void LinuxWindow::newFile() {
+    if (pImpl->editor) {
+        pImpl->gzipReader.close();
+        pImpl->closePaged();
+        pImpl->editor->clear();
+        setTextContent("");
+        gtk_text_view_set_editable(GTK_TEXT_VIEW(pImpl->textView), TRUE);
+    }
+}
+
+void LinuxWindow::openFile() {
+    // 实现文件打开对话框
+    GtkWidget* dialog = gtk_file_chooser_dialog_new("打开文件",
+                                                  GTK_WINDOW(pImpl->window),
+                                                  GTK_FILE_CHOOSER_ACTION_OPEN,
+                                                  "取消", GTK_RESPONSE_CANCEL,
+                                                  "打开", GTK_RESPONSE_ACCEPT,
+                                                  NULL);
+    
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        if (pImpl->editor && filename) {
+            if (pImpl->loadFile(this, filename)) {
+                pImpl->showOpenedFile(this, filename);
+            }
+        }
+        g_free(filename);
+    }
+    
+    gtk_widget_destroy(dialog);
+}
+
+void LinuxWindow::saveFile() {
+    if (pImpl->editor) {
+        if (pImpl->editor->isReadOnly()) {
+            setStatusText("只读文档不能保存，请另存为其他文件");
+            return;
+        }
+        pImpl->editor->setContent(getTextContent());
+        pImpl->editor->saveFile();
+    }
+}
+
+void LinuxWindow::saveAs() {
+    // 实现另存为对话框
+    GtkWidget* dialog = gtk_file_chooser_dialog_new("另存为",
+                                                  GTK_WINDOW(pImpl->window),
+                                                  GTK_FILE_CHOOSER_ACTION_SAVE,
+                                                  "取消", GTK_RESPONSE_CANCEL,
+                                                  "保存", GTK_RESPONSE_ACCEPT,
+                                                  NULL);
+    
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        if (pImpl->pagedDocument.isOpen() || pImpl->isMerged()) {
+            setStatusText("分页模式下的文档不能另存为");
+        } else if (pImpl->editor && filename) {
+            pImpl->editor->setContent(getTextContent());
+            if (pImpl->editor->saveAs(filename)) {
+                setTitle("LitePad - " + std::string(filename));
+            }
+        }
+        g_free(filename);
+    }
+    
+    gtk_widget_destroy(dialog);
+}
+
+void LinuxWindow::quit() {
+    gtk_main_quit();
+}
+
+void LinuxWindow::showAbout() {
+    GtkWidget* dialog = gtk_about_dialog_new();
+    gtk_about_dialog_set_program_name(GTK_ABOUT_DIALOG(dialog), "LitePad");
+    gtk_about_dialog_set_version(GTK_ABOUT_DIALOG(dialog), "1.0.0");
+    gtk_about_dialog_set_comments(GTK_ABOUT_DIALOG(dialog), "轻量级代码编辑器");
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+}
+
+void LinuxWindow::showPluginManager() {
+    // TODO: 实现插件管理器界面
+}
+
+void LinuxWindow::showSettings() {
+    // TODO: 实现设置界面
+}
+
+void LinuxWindow::setEditor(std::shared_ptr<Editor> editor) {
+    pImpl->follower.stop();
+    pImpl->gzipReader.close();
+    pImpl->closePaged();
+    pImpl->editor = editor;
+    pImpl->syntaxModel.setEditor(editor);
+    pImpl->symbolIndex.setEditor(editor);
+    pImpl->matchIndex.setEditor(editor);
+    pImpl->lineFilter.setEditor(editor);
+    pImpl->timestampIndex.setEditor(editor);
+    pImpl->levelHistogram.setEditor(editor);
+    if (pImpl->wordDocumentId) {
+        pImpl->wordIndex.removeDocument(pImpl->wordDocumentId);
+        pImpl->wordDocumentId = 0;
+    }
+    if (editor) {
+        pImpl->wordDocumentId = pImpl->wordIndex.addDocument(editor);
+    }
+}
+
+void LinuxWindow::setPluginManager(std::shared_ptr<PluginManager> pluginManager) {
+    pImpl->pluginManager = pluginManager;
+}
+
+void LinuxWindow::setConfigManager(std::shared_ptr<ConfigManager> configManager) {
+    pImpl->configManager = configManager;
+    if (configManager) {
+        pImpl->timestampIndex.setSampleInterval(
+            static_cast<size_t>(std::max(1, configManager->getInt("Timestamp.sample_lines", 256))));
+        const char* const keys[kLogLevelCount] = {"Overview.error_keywords", "Overview.warn_keywords",
+                                                  "Overview.info_keywords", "Overview.debug_keywords"};
+        for (size_t i = 0; i < kLogLevelCount; i++) {
+            if (configManager->hasKey(keys[i])) {
+                pImpl->levelHistogram.setKeywords(static_cast<LogLevel>(i), configManager->getString(keys[i]));
+            }
+        }
+    }
+}
+
+void LinuxWindow::setTextContent(const std::string& content) {
+    if (pImpl->textBuffer) {
+        gtk_text_buffer_set_text(pImpl->textBuffer, content.c_str(), -1);
+    }
+}
+
+std::string LinuxWindow::getTextContent() const {
+    if (!pImpl->textBuffer) return "";
+    
+    GtkTextIter start, end;
+    gtk_text_buffer_get_start_iter(pImpl->textBuffer, &start);
+    gtk_text_buffer_get_end_iter(pImpl->textBuffer, &end);
+    
+    gchar* text = gtk_text_buffer_get_text(pImpl->textBuffer, &start, &end, FALSE);
+    std::string result(text);
+    g_free(text);
+    
+    return result;
+}
+
+void LinuxWindow::setTextChangedCallback(std::function<void(const std::string&)> callback) {
+    pImpl->textChangedCallback = callback;
+}
+
+void LinuxWindow::setWindowCloseCallback(std::function<bool()> callback) {
+    pImpl->windowCloseCallback = callback;
+}
+
+void LinuxWindow::setStatusText(const std::string& text) {
+    if (pImpl->statusBar) {
+        guint contextId = gtk_statusbar_get_context_id(GTK_STATUSBAR(pImpl->statusBar), "main");
+        gtk_statusbar_pop(GTK_STATUSBAR(pImpl->statusBar), contextId);
+        gtk_statusbar_push(GTK_STATUSBAR(pImpl->statusBar), contextId, text.c_str());
+    }
+}
+
+void LinuxWindow::handleFileDrop(const std::string& filePath) {
+    if (pImpl->editor) {
+        if (pImpl->loadFile(this, filePath)) {
+            pImpl->showOpenedFile(this, filePath);
+        }
+    }
+}
+
+// 静态回调函数
+gboolean LinuxWindow::onDeleteEvent(GtkWidget* widget, GdkEvent* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    if (window->pImpl->windowCloseCallback) {
+        return !window->pImpl->windowCloseCallback(); // GTK返回TRUE阻止关闭
+    }
+    return FALSE;
+}
+
+void LinuxWindow::onDestroy(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->window = nullptr;
+}
+
+void LinuxWindow::onTextChanged(GtkTextBuffer* textBuffer, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    if (window->pImpl->textChangedCallback) {
+        window->pImpl->textChangedCallback(window->getTextContent());
+    }
+    window->pImpl->refreshAfterTextChange(window);
+}
+
+void LinuxWindow::onMarkSet(GtkTextBuffer* textBuffer, GtkTextIter* location, GtkTextMark* mark, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    if (mark == gtk_text_buffer_get_insert(textBuffer)) {
+        window->pImpl->updateBracketMatch();
+        window->pImpl->updateFindCount();
+    }
+}
+
+gboolean LinuxWindow::onKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    if (event->keyval == GDK_KEY_F12 && impl->isSynchronized()) {
+        // F12：转到定义
+        impl->goToDefinition(window);
+        return TRUE;
+    }
+    if (!(event->state & GDK_CONTROL_MASK) || !impl->isSynchronized()) {
+        return FALSE;
+    }
+    
+    GtkTextIter target;
+    if (event->keyval == GDK_KEY_O) {
+        // Ctrl+Shift+O：转到符号
+        impl->showSymbolList();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_F) {
+        // Ctrl+Shift+F：在文件中查找
+        window->showFindInFiles();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_f) {
+        // Ctrl+F：查找
+        window->showFindBar();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_space) {
+        // Ctrl+Space：单词补全
+        impl->showCompletion(window);
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_T) {
+        // Ctrl+Shift+T：跟随文件增长
+        impl->toggleFollow(window);
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_g) {
+        // Ctrl+G：跳转到行
+        impl->showGoToLine(window);
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_J) {
+        // Ctrl+Shift+J：跳转到时间
+        impl->showTimeJump(window);
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_L) {
+        // Ctrl+Shift+L：行过滤
+        window->showLineFilter();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_E) {
+        // Ctrl+Shift+E：按时间合并日志
+        window->showMergedLogs();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_p) {
+        // Ctrl+P：快速打开文件
+        window->showQuickOpen();
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_m) {
+        // Ctrl+M：跳转到配对括号
+        size_t bracket = 0;
+        size_t match = 0;
+        if (!impl->bracketAtCursor(bracket, match)) {
+            return TRUE;
+        }
+        impl->iterAt(match, &target);
+    } else if (event->keyval == GDK_KEY_M) {
+        // Ctrl+Shift+M：跳转到外层代码块的左括号
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(impl->textBuffer, &cursor, gtk_text_buffer_get_insert(impl->textBuffer));
+        size_t openOffset = 0;
+        size_t closeOffset = 0;
+        if (!impl->syntaxModel.findEnclosingBlock(impl->offsetAt(&cursor), openOffset, closeOffset)) {
+            return TRUE;
+        }
+        impl->iterAt(openOffset, &target);
+    } else if (event->keyval == GDK_KEY_braceleft || event->keyval == GDK_KEY_bracketleft) {
+        // Ctrl+Shift+[：折叠/展开光标所在的区域
+        GtkTextIter cursor;
+        gtk_text_buffer_get_iter_at_mark(impl->textBuffer, &cursor, gtk_text_buffer_get_insert(impl->textBuffer));
+        impl->foldingModel.toggleFold(static_cast<size_t>(gtk_text_iter_get_line(&cursor)));
+        return TRUE;
+    } else if (event->keyval == GDK_KEY_braceright || event->keyval == GDK_KEY_bracketright) {
+        // Ctrl+Shift+]：展开全部
+        impl->foldingModel.unfoldAll();
+        return TRUE;
+    } else {
+        return FALSE;
+    }
+    
+    gtk_text_buffer_place_cursor(impl->textBuffer, &target);
+    gtk_text_view_scroll_to_iter(GTK_TEXT_VIEW(impl->textView), &target, 0.1, FALSE, 0.0, 0.0);
+    return TRUE;
+}
+
+void LinuxWindow::onScrolled(GtkAdjustment* adjustment, gpointer userData) {
+    // 滚动与编辑都会触发，合并到一次空闲回调中着色
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    if (!window->pImpl->rainbowIdleId) {
+        window->pImpl->rainbowIdleId = g_idle_add(onRainbowIdle, userData);
+    }
+}
+
+gboolean LinuxWindow::onRainbowIdle(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->rainbowIdleId = 0;
+    window->pImpl->updateRainbowBrackets();
+    window->pImpl->updateSymbolHighlight();
+    window->pImpl->updateFindHighlight();
+    return G_SOURCE_REMOVE;
+}
+
+gboolean LinuxWindow::onTextViewDraw(GtkWidget* widget, cairo_t* cr, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    GdkWindow* gutter = gtk_text_view_get_window(GTK_TEXT_VIEW(widget), GTK_TEXT_WINDOW_LEFT);
+    if (gutter && gtk_cairo_should_draw_window(cr, gutter)) {
+        cairo_save(cr);
+        gtk_cairo_transform_to_window(cr, widget, gutter);
+        window->pImpl->drawGutter(cr);
+        cairo_restore(cr);
+    }
+    return FALSE;
+}
+
+gboolean LinuxWindow::onButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    GtkTextView* view = GTK_TEXT_VIEW(widget);
+    if (event->window != gtk_text_view_get_window(view, GTK_TEXT_WINDOW_LEFT) || event->button != 1 ||
+        !impl->isSynchronized()) {
+        return FALSE;
+    }
+    
+    // 点击行号栏中的折叠标记切换折叠状态
+    gint bufferX = 0;
+    gint bufferY = 0;
+    gtk_text_view_window_to_buffer_coords(view, GTK_TEXT_WINDOW_LEFT, static_cast<gint>(event->x),
+                                          static_cast<gint>(event->y), &bufferX, &bufferY);
+    GtkTextIter iter;
+    gtk_text_view_get_line_at_y(view, &iter, bufferY, nullptr);
+    size_t line = static_cast<size_t>(gtk_text_iter_get_line(&iter));
+    FoldRegion region;
+    if (!impl->foldingModel.findRegionAt(line, region)) {
+        return FALSE;
+    }
+    impl->foldingModel.toggleFold(line);
+    return TRUE;
+}
+
+gboolean LinuxWindow::onFoldIdle(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->foldIdleId = 0;
+    window->pImpl->applyFolds();
+    return G_SOURCE_REMOVE;
+}
+
+gboolean LinuxWindow::onSymbolFlush(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->symbolFlushId = 0;
+    window->pImpl->symbolIndex.flush();
+    return G_SOURCE_REMOVE;
+}
+
+gboolean LinuxWindow::onSymbolsReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->symbolsReadyPending = false;
+    window->pImpl->updateSymbolHighlight();
+    return G_SOURCE_REMOVE;
+}
+
+void LinuxWindow::showFindBar() {
+    Impl* impl = pImpl.get();
+    if (!impl->findBar) {
+        return;
+    }
+    // 有选中文本时用它作为查找内容
+    GtkTextIter start, end;
+    if (gtk_text_buffer_get_selection_bounds(impl->textBuffer, &start, &end) &&
+        gtk_text_iter_get_line(&start) == gtk_text_iter_get_line(&end)) {
+        gchar* selected = gtk_text_buffer_get_text(impl->textBuffer, &start, &end, FALSE);
+        gtk_entry_set_text(GTK_ENTRY(impl->findEntry), selected);
+        g_free(selected);
+    }
+    gtk_widget_show(impl->findBar);
+    gtk_widget_grab_focus(impl->findEntry);
+    onScrolled(nullptr, this);
+}
+
+void LinuxWindow::onFindChanged(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    std::string pattern = gtk_entry_get_text(GTK_ENTRY(impl->findEntry));
+    bool caseSensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->findCaseCheck));
+    bool wholeWord = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->findWordCheck));
+    impl->matchIndex.setQuery(pattern, caseSensitive, false, wholeWord);
+    impl->pagedHasMatch = false;
+    impl->updateFindCount();
+    onScrolled(nullptr, userData);
+}
+
+void LinuxWindow::onFindNext(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->findAdjacent(true);
+}
+
+void LinuxWindow::onFindPrevious(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->findAdjacent(false);
+}
+
+void LinuxWindow::onFindClose(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    gtk_widget_hide(impl->findBar);
+    impl->updateFindHighlight();
+    gtk_widget_grab_focus(impl->pagedDocument.isOpen() || impl->isMerged() ? impl->pagedView : impl->textView);
+}
+
+gboolean LinuxWindow::onFindKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData) {
+    // Esc 关闭查找栏，Shift+Enter 查找上一个
+    if (event->keyval == GDK_KEY_Escape) {
+        onFindClose(widget, userData);
+        return TRUE;
+    }
+    if ((event->keyval == GDK_KEY_Return || event->keyval == GDK_KEY_KP_Enter) && (event->state & GDK_SHIFT_MASK)) {
+        onFindPrevious(widget, userData);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+gboolean LinuxWindow::onMatchesReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->matchesReadyPending = false;
+    if (window->pImpl->matchIndex.collect()) {
+        window->pImpl->updateFindCount();
+        window->pImpl->updateFindHighlight();
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean LinuxWindow::onFollowData(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->followPending = false;
+    FollowUpdate update;
+    if (impl->editor && impl->textBuffer && impl->follower.collect(update)) {
+        impl->applyFollowUpdate(window, update);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean LinuxWindow::onGzipData(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->gzipPending = false;
+    if (!impl->editor || !impl->textBuffer) {
+        return G_SOURCE_REMOVE;
+    }
+    // 先取结束标志：结束后 collect() 会取走包括末尾不完整字符在内的全部内容
+    bool finished = impl->gzipReader.isFinished();
+    std::string data;
+    if (impl->gzipReader.collect(data)) {
+        impl->appendToDocument(window, data);
+    }
+    if (finished) {
+        window->setStatusText(impl->gzipReader.hasError()
+                                  ? "压缩文件已损坏或不完整：" + impl->editor->getFilePath()
+                                  : "已解压 " + impl->editor->getFilePath() + "（" +
+                                        std::to_string(impl->editor->getLineCount()) + " 行）");
     }
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::hide() {
-    if (pImpl->window) {
-        gtk_widget_hide(pImpl->window);
+void LinuxWindow::showMergedLogs() {
+    GtkWidget* dialog = gtk_file_chooser_dialog_new("按时间合并日志",
+                                                  GTK_WINDOW(pImpl->window),
+                                                  GTK_FILE_CHOOSER_ACTION_OPEN,
+                                                  "取消", GTK_RESPONSE_CANCEL,
+                                                  "合并", GTK_RESPONSE_ACCEPT,
+                                                  NULL);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
+    
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT && pImpl->editor) {
+        std::vector<std::string> paths;
+        GSList* filenames = gtk_file_chooser_get_filenames(GTK_FILE_CHOOSER(dialog));
+        for (GSList* item = filenames; item; item = item->next) {
+            paths.push_back(static_cast<char*>(item->data));
+        }
+        g_slist_free_full(filenames, g_free);
+        if (paths.size() < 2) {
+            setStatusText("请至少选择两个日志文件");
+        } else if (pImpl->openMerged(this, paths)) {
+            setTitle("LitePad - 合并日志（" + std::to_string(paths.size()) + " 个文件）");
+        }
     }
+    
+    gtk_widget_destroy(dialog);
 }
 
-void LinuxWindow::close() {
-    if (pImpl->window) {
-        gtk_widget_destroy(pImpl->window);
-        pImpl->window = nullptr;
+void LinuxWindow::showLineFilter() {
+    Impl* impl = pImpl.get();
+    if (!impl->filterPanel) {
+        return;
     }
+    gtk_widget_show(impl->filterPanel);
+    gtk_widget_grab_focus(impl->filterEntry);
+    impl->refreshFilterView();
 }
 
-void LinuxWindow::setTitle(const std::string& title) {
-    title_ = title;
-    if (pImpl->window) {
-        gtk_window_set_title(GTK_WINDOW(pImpl->window), title.c_str());
+void LinuxWindow::onFilterAdd(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    LineFilterRule rule;
+    rule.pattern = gtk_entry_get_text(GTK_ENTRY(impl->filterEntry));
+    rule.caseSensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->filterCaseCheck));
+    rule.regex = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->filterRegexCheck));
+    rule.exclude = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->filterExcludeCheck));
+    if (rule.pattern.empty()) {
+        return;
+    }
+    if (!impl->lineFilter.addRule(rule)) {
+        window->setStatusText("正则表达式无效: " + rule.pattern);
+        return;
     }
+    gtk_entry_set_text(GTK_ENTRY(impl->filterEntry), "");
+    impl->refreshFilterView();
 }
 
-std::string LinuxWindow::getTitle() const {
-    return title_;
+void LinuxWindow::onFilterUndo(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->lineFilter.removeLastRule();
+    window->pImpl->refreshFilterView();
 }
 
-void LinuxWindow::setSize(int width, int height) {
-    width_ = width;
-    height_ = height;
-    if (pImpl->window) {
-        gtk_window_resize(GTK_WINDOW(pImpl->window), width, height);
-    }
+void LinuxWindow::onFilterClose(GtkWidget* widget, gpointer userData) {
+    // 关闭时去掉全部条件，之后的编辑不再需要重新判断
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->lineFilter.clearRules();
+    gtk_widget_hide(impl->filterPanel);
+    gtk_widget_grab_focus(impl->textView);
 }
 
-void LinuxWindow::getSize(int& width, int& height) const {
-    width = width_;
-    height = height_;
+gboolean LinuxWindow::onFilterDraw(GtkWidget* widget, cairo_t* cr, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->drawFilterView(cr);
+    return TRUE;
 }
 
-void LinuxWindow::setPosition(int x, int y) {
-    x_ = x;
-    y_ = y;
-    if (pImpl->window) {
-        gtk_window_move(GTK_WINDOW(pImpl->window), x, y);
-    }
+void LinuxWindow::onFilterResize(GtkWidget* widget, GdkRectangle* allocation, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->refreshFilterView();
 }
 
-void LinuxWindow::getPosition(int& x, int& y) const {
-    x = x_;
-    y = y_;
+void LinuxWindow::onFilterScrolled(GtkAdjustment* adjustment, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    gtk_widget_queue_draw(window->pImpl->filterView);
 }
 
-void LinuxWindow::maximize() {
-    if (pImpl->window) {
-        gtk_window_maximize(GTK_WINDOW(pImpl->window));
+gboolean LinuxWindow::onFilterScroll(GtkWidget* widget, GdkEventScroll* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    GtkAdjustment* adjustment = window->pImpl->filterAdjustment;
+    double delta = 0.0;
+    if (event->direction == GDK_SCROLL_UP) {
+        delta = -3.0;
+    } else if (event->direction == GDK_SCROLL_DOWN) {
+        delta = 3.0;
+    } else if (event->direction == GDK_SCROLL_SMOOTH) {
+        gdk_event_get_scroll_deltas(reinterpret_cast<GdkEvent*>(event), nullptr, &delta);
+        delta *= 3.0;
     }
+    double limit = gtk_adjustment_get_upper(adjustment) - gtk_adjustment_get_page_size(adjustment);
+    gtk_adjustment_set_value(adjustment, std::max(0.0, std::min(limit, gtk_adjustment_get_value(adjustment) + delta)));
+    return TRUE;
 }
 
-void LinuxWindow::minimize() {
-    if (pImpl->window) {
-        gtk_window_iconify(GTK_WINDOW(pImpl->window));
+gboolean LinuxWindow::onFilterButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData) {
+    // 点击过滤视图中的一行，在编辑器中跳转到该行
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    if (event->button != 1 || !impl->editor || !impl->isSynchronized()) {
+        return FALSE;
+    }
+    size_t index = static_cast<size_t>(gtk_adjustment_get_value(impl->filterAdjustment)) +
+                   static_cast<size_t>(event->y) / static_cast<size_t>(impl->filterRowHeight());
+    if (index < impl->lineFilter.getMatchCount()) {
+        impl->openLocation(window, impl->editor->getFilePath(), impl->lineFilter.getMatchedLine(index), 0);
     }
+    return TRUE;
 }
 
-void LinuxWindow::restore() {
-    if (pImpl->window) {
-        gtk_window_unmaximize(GTK_WINDOW(pImpl->window));
-        gtk_window_deiconify(GTK_WINDOW(pImpl->window));
+gboolean LinuxWindow::onFiltersReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->filtersReadyPending = false;
+    if (window->pImpl->lineFilter.collect()) {
+        window->pImpl->refreshFilterView();
     }
+    return G_SOURCE_REMOVE;
 }
 
-bool LinuxWindow::isMaximized() const {
-    // GTK+ 实现待完善
-    return false;
+gboolean LinuxWindow::onPagedDraw(GtkWidget* widget, cairo_t* cr, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->drawPagedView(cr);
+    return TRUE;
 }
 
-bool LinuxWindow::isMinimized() const {
-    // GTK+ 实现待完善
-    return false;
+void LinuxWindow::onPagedResize(GtkWidget* widget, GdkRectangle* allocation, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->refreshPagedView(window);
 }
 
-void LinuxWindow::newFile() {
-    if (pImpl->editor) {
-        pImpl->editor->clear();
-        setTextContent("");
-    }
+void LinuxWindow::onPagedScrolled(GtkAdjustment* adjustment, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    gtk_widget_queue_draw(window->pImpl->pagedView);
 }
 
-void LinuxWindow::openFile() {
-    // 实现文件打开对话框
-    GtkWidget* dialog = gtk_file_chooser_dialog_new("打开文件",
-                                                  GTK_WINDOW(pImpl->window),
-                                                  GTK_FILE_CHOOSER_ACTION_OPEN,
-                                                  "取消", GTK_RESPONSE_CANCEL,
-                                                  "打开", GTK_RESPONSE_ACCEPT,
-                                                  NULL);
-    
-    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
-        if (pImpl->editor && filename) {
-            if (pImpl->editor->openFile(filename)) {
-                setTextContent(pImpl->editor->getContent());
-                setTitle("LitePad - " + std::string(filename));
-            }
-        }
-        g_free(filename);
+gboolean LinuxWindow::onPagedScroll(GtkWidget* widget, GdkEventScroll* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    GtkAdjustment* adjustment = window->pImpl->pagedAdjustment;
+    double delta = 0.0;
+    double deltaX = 0.0;
+    if (event->direction == GDK_SCROLL_UP) {
+        delta = -3.0;
+    } else if (event->direction == GDK_SCROLL_DOWN) {
+        delta = 3.0;
+    } else if (event->direction == GDK_SCROLL_LEFT) {
+        deltaX = -1.0;
+    } else if (event->direction == GDK_SCROLL_RIGHT) {
+        deltaX = 1.0;
+    } else if (event->direction == GDK_SCROLL_SMOOTH) {
+        gdk_event_get_scroll_deltas(reinterpret_cast<GdkEvent*>(event), &deltaX, &delta);
+        delta *= 3.0;
     }
-    
-    gtk_widget_destroy(dialog);
+    if (event->state & GDK_SHIFT_MASK) {
+        // Shift + 滚轮水平滚动
+        deltaX += delta / 3.0;
+        delta = 0.0;
+    }
+    if (deltaX != 0.0) {
+        // 水平滚动每格移动十个字符
+        GtkAdjustment* columns = window->pImpl->pagedColumnAdjustment;
+        double columnLimit = gtk_adjustment_get_upper(columns) - gtk_adjustment_get_page_size(columns);
+        gtk_adjustment_set_value(columns, std::max(0.0, std::min(columnLimit,
+                                                             gtk_adjustment_get_value(columns) + deltaX * 10.0)));
+    }
+    double limit = gtk_adjustment_get_upper(adjustment) - gtk_adjustment_get_page_size(adjustment);
+    gtk_adjustment_set_value(adjustment, std::max(0.0, std::min(limit, gtk_adjustment_get_value(adjustment) + delta)));
+    return TRUE;
 }
 
-void LinuxWindow::saveFile() {
-    if (pImpl->editor) {
-        pImpl->editor->setContent(getTextContent());
-        pImpl->editor->saveFile();
+gboolean LinuxWindow::onPagedKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    if (event->state & GDK_CONTROL_MASK) {
+        if (event->keyval == GDK_KEY_f) {
+            window->showFindBar();
+            return TRUE;
+        } else if (event->keyval == GDK_KEY_g) {
+            impl->showGoToLine(window);
+            return TRUE;
+        } else if (event->keyval == GDK_KEY_J) {
+            impl->showTimeJump(window);
+            return TRUE;
+        } else if (event->keyval == GDK_KEY_E) {
+            window->showMergedLogs();
+            return TRUE;
+        }
+    }
+    GtkAdjustment* adjustment = impl->pagedAdjustment;
+    double value = gtk_adjustment_get_value(adjustment);
+    double page = gtk_adjustment_get_page_size(adjustment);
+    double limit = gtk_adjustment_get_upper(adjustment) - page;
+    switch (event->keyval) {
+    case GDK_KEY_Up:
+        value -= 1.0;
+        break;
+    case GDK_KEY_Down:
+        value += 1.0;
+        break;
+    case GDK_KEY_Page_Up:
+        value -= page;
+        break;
+    case GDK_KEY_Page_Down:
+        value += page;
+        break;
+    case GDK_KEY_Home:
+        value = 0.0;
+        gtk_adjustment_set_value(impl->pagedColumnAdjustment, 0.0);
+        break;
+    case GDK_KEY_End:
+        value = limit;
+        break;
+    case GDK_KEY_Left:
+    case GDK_KEY_Right: {
+        GtkAdjustment* columns = impl->pagedColumnAdjustment;
+        double step = gtk_adjustment_get_step_increment(columns) * (event->keyval == GDK_KEY_Left ? -1.0 : 1.0);
+        double columnLimit = gtk_adjustment_get_upper(columns) - gtk_adjustment_get_page_size(columns);
+        gtk_adjustment_set_value(columns,
+                                 std::max(0.0, std::min(columnLimit, gtk_adjustment_get_value(columns) + step)));
+        return TRUE;
+    }
+    default:
+        return FALSE;
     }
+    gtk_adjustment_set_value(adjustment, std::max(0.0, std::min(limit, value)));
+    return TRUE;
 }
 
-void LinuxWindow::saveAs() {
-    // 实现另存为对话框
-    GtkWidget* dialog = gtk_file_chooser_dialog_new("另存为",
-                                                  GTK_WINDOW(pImpl->window),
-                                                  GTK_FILE_CHOOSER_ACTION_SAVE,
-                                                  "取消", GTK_RESPONSE_CANCEL,
-                                                  "保存", GTK_RESPONSE_ACCEPT,
-                                                  NULL);
-    
-    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
-        if (pImpl->editor && filename) {
-            pImpl->editor->setContent(getTextContent());
-            if (pImpl->editor->saveAs(filename)) {
-                setTitle("LitePad - " + std::string(filename));
-            }
+gboolean LinuxWindow::onPagedButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData) {
+    // 点击分页视图中的一行，高亮该行（之后的查找从这里开始）
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    gtk_widget_grab_focus(widget);
+    if (event->button != 1 || (!impl->pagedDocument.isOpen() && !impl->isMerged())) {
+        return FALSE;
+    }
+    if (impl->isMerged()) {
+        // 合并视图：在状态栏显示该行的来源文件和行号
+        impl->pagedCurrentLine = static_cast<uint64_t>(gtk_adjustment_get_value(impl->pagedAdjustment)) +
+                                 static_cast<uint64_t>(event->y) / static_cast<uint64_t>(impl->pagedRowHeight());
+        std::vector<MergedLine> lines;
+        if (impl->logMerger.getLines(impl->pagedCurrentLine, 1, lines, 0)) {
+            window->setStatusText(impl->logMerger.getSourcePath(lines[0].source) + " 第 " +
+                                  std::to_string(lines[0].line + 1) + " 行");
         }
-        g_free(filename);
+        gtk_widget_queue_draw(widget);
+        return TRUE;
     }
+    impl->pagedCurrentLine = static_cast<uint64_t>(gtk_adjustment_get_value(impl->pagedAdjustment)) +
+                             static_cast<uint64_t>(event->y) / static_cast<uint64_t>(impl->pagedRowHeight());
+    uint64_t offset = 0;
+    impl->pagedHasMatch = impl->pagedDocument.getLineOffset(impl->pagedCurrentLine, offset);
+    impl->pagedMatchOffset = offset;
     
-    gtk_widget_destroy(dialog);
+    // 点击位置换算成列号：可见部分中的字符数加上水平滚动列
+    uint64_t column = static_cast<uint64_t>(gtk_adjustment_get_value(impl->pagedColumnAdjustment));
+    std::string text;
+    if (impl->pagedHasMatch && impl->readPagedRow(impl->pagedCurrentLine, column, text)) {
+        std::string prefix = std::to_string(impl->pagedCurrentLine + 1) + "  ";
+        std::string row = displayText(prefix + text);
+        PangoLayout* layout = gtk_widget_create_pango_layout(widget, row.c_str());
+        int index = 0;
+        int trailing = 0;
+        pango_layout_xy_to_index(layout, static_cast<int>((event->x - 4) * PANGO_SCALE), 0, &index, &trailing);
+        g_object_unref(layout);
+        if (static_cast<size_t>(index) >= prefix.size()) {
+            column += LongLineIndex::countColumns(row.data() + prefix.size(), index - prefix.size()) + trailing;
+        }
+        window->setStatusText("第 " + std::to_string(impl->pagedCurrentLine + 1) + " 行，第 " +
+                              std::to_string(column + 1) + " 列");
+    }
+    gtk_widget_queue_draw(widget);
+    return TRUE;
 }
 
-void LinuxWindow::quit() {
-    gtk_main_quit();
+gboolean LinuxWindow::onPagedIndexProgress(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->pagedIndexPending = false;
+    window->pImpl->refreshPagedView(window);
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::showAbout() {
-    GtkWidget* dialog = gtk_about_dialog_new();
-    gtk_about_dialog_set_program_name(GTK_ABOUT_DIALOG(dialog), "LitePad");
-    gtk_about_dialog_set_version(GTK_ABOUT_DIALOG(dialog), "1.0.0");
-    gtk_about_dialog_set_comments(GTK_ABOUT_DIALOG(dialog), "轻量级代码编辑器");
-    gtk_dialog_run(GTK_DIALOG(dialog));
-    gtk_widget_destroy(dialog);
+gboolean LinuxWindow::onPagedFindReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->pagedFindPending = false;
+    bool found = false;
+    uint64_t offset = 0;
+    if (!impl->pagedDocument.collectFind(found, offset)) {
+        return G_SOURCE_REMOVE;
+    }
+    if (!found) {
+        gtk_label_set_text(GTK_LABEL(impl->findCountLabel), "未找到");
+        return G_SOURCE_REMOVE;
+    }
+    impl->pagedMatchOffset = offset;
+    impl->pagedHasMatch = true;
+    uint64_t line = impl->pagedDocument.getLineOfOffset(offset);
+    uint64_t lineOffset = offset;
+    impl->pagedDocument.getLineOffset(line, lineOffset);
+    uint64_t column = impl->getPagedColumn(line, lineOffset, offset);
+    std::string text = "第 " + std::to_string(line + 1) + " 行，第 " + std::to_string(column + 1) + " 列";
+    gtk_label_set_text(GTK_LABEL(impl->findCountLabel), text.c_str());
+    impl->goToPagedLine(line);
+    impl->goToPagedColumn(column);
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::showPluginManager() {
-    // TODO: 实现插件管理器界面
+gboolean LinuxWindow::onOverviewDraw(GtkWidget* widget, cairo_t* cr, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->drawOverview(cr);
+    return TRUE;
 }
 
-void LinuxWindow::showSettings() {
-    // TODO: 实现设置界面
+gboolean LinuxWindow::onOverviewButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    int height = gtk_widget_get_allocated_height(widget);
+    if (event->button != 1 || !impl->editor || height <= 0 || !impl->isSynchronized()) {
+        return FALSE;
+    }
+    size_t lineCount = impl->editor->getLineCount();
+    size_t line = static_cast<size_t>(std::max(0.0, event->y) / height * lineCount);
+    impl->openLocation(window, impl->editor->getFilePath(), std::min(line, lineCount - 1), 0);
+    return TRUE;
 }
 
-void LinuxWindow::setEditor(std::shared_ptr<Editor> editor) {
-    pImpl->editor = editor;
+gboolean LinuxWindow::onHistogramReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->histogramReadyPending = false;
+    if (window->pImpl->levelHistogram.collect() && window->pImpl->overviewStrip) {
+        gtk_widget_queue_draw(window->pImpl->overviewStrip);
+    }
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::setPluginManager(std::shared_ptr<PluginManager> pluginManager) {
-    pImpl->pluginManager = pluginManager;
+gboolean LinuxWindow::onWordsReady(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    window->pImpl->wordsReadyPending = false;
+    window->pImpl->wordIndex.collect();
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::setConfigManager(std::shared_ptr<ConfigManager> configManager) {
-    pImpl->configManager = configManager;
+void LinuxWindow::onCompletionActivate(GtkMenuItem* item, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    const char* completion = static_cast<const char*>(g_object_get_data(G_OBJECT(item), "completion"));
+    if (completion && window->pImpl->isSynchronized()) {
+        gtk_text_buffer_insert_at_cursor(window->pImpl->textBuffer, completion, -1);
+    }
 }
 
-void LinuxWindow::setTextContent(const std::string& content) {
-    if (pImpl->textBuffer) {
-        gtk_text_buffer_set_text(pImpl->textBuffer, content.c_str(), -1);
+void LinuxWindow::showFindInFiles() {
+    Impl* impl = pImpl.get();
+    if (impl->searchDialog) {
+        gtk_window_present(GTK_WINDOW(impl->searchDialog));
+        return;
     }
+    
+    impl->searchDialog = gtk_dialog_new_with_buttons("在文件中查找", GTK_WINDOW(impl->window),
+                                                     GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                     "关闭", GTK_RESPONSE_CLOSE,
+                                                     NULL);
+    gtk_window_set_default_size(GTK_WINDOW(impl->searchDialog), 760, 520);
+    
+    // 查找条件
+    GtkWidget* grid = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 4);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 6);
+    gtk_container_set_border_width(GTK_CONTAINER(grid), 6);
+    impl->searchEntry = gtk_entry_new();
+    impl->searchFolderEntry = gtk_entry_new();
+    impl->searchCaseCheck = gtk_check_button_new_with_label("区分大小写");
+    impl->searchRegexCheck = gtk_check_button_new_with_label("正则表达式");
+    impl->searchWordCheck = gtk_check_button_new_with_label("全字匹配");
+    impl->searchIndexCheck = gtk_check_button_new_with_label("使用索引");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(impl->searchIndexCheck),
+                                 impl->configManager && impl->configManager->getBool("Search.use_index", true));
+    impl->searchButton = gtk_button_new_with_label("查找");
+    gtk_widget_set_hexpand(impl->searchEntry, TRUE);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("查找:"), 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), impl->searchEntry, 1, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), impl->searchButton, 2, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), gtk_label_new("目录:"), 0, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), impl->searchFolderEntry, 1, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), impl->searchCaseCheck, 2, 1, 1, 1);
+    GtkWidget* optionBox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
+    gtk_box_pack_start(GTK_BOX(optionBox), impl->searchRegexCheck, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(optionBox), impl->searchWordCheck, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(optionBox), impl->searchIndexCheck, FALSE, FALSE, 0);
+    gtk_grid_attach(GTK_GRID(grid), optionBox, 1, 2, 2, 1);
+    
+    // 默认在当前文件所在目录中查找
+    std::string folder;
+    if (impl->editor && !impl->editor->getFilePath().empty()) {
+        gchar* directory = g_path_get_dirname(impl->editor->getFilePath().c_str());
+        folder = directory;
+        g_free(directory);
+    } else {
+        gchar* directory = g_get_current_dir();
+        folder = directory;
+        g_free(directory);
+    }
+    gtk_entry_set_text(GTK_ENTRY(impl->searchFolderEntry), folder.c_str());
+    
+    // 结果列表
+    impl->searchStore = gtk_list_store_new(5, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_UINT);
+    GtkWidget* list = gtk_tree_view_new_with_model(GTK_TREE_MODEL(impl->searchStore));
+    g_object_unref(impl->searchStore);
+    GtkCellRenderer* renderer = gtk_cell_renderer_text_new();
+    gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW(list), -1, "位置", renderer,
+                                                "text", SEARCH_COLUMN_LOCATION, NULL);
+    gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW(list), -1, "内容", renderer,
+                                                "text", SEARCH_COLUMN_TEXT, NULL);
+    GtkWidget* scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(scrolledWindow), list);
+    
+    impl->searchStatusLabel = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(impl->searchStatusLabel), 0.0f);
+    
+    GtkWidget* content = gtk_dialog_get_content_area(GTK_DIALOG(impl->searchDialog));
+    gtk_box_pack_start(GTK_BOX(content), grid, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(content), scrolledWindow, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(content), impl->searchStatusLabel, FALSE, FALSE, 4);
+    
+    g_signal_connect(impl->searchEntry, "activate", G_CALLBACK(onFindInFilesStart), this);
+    g_signal_connect(impl->searchButton, "clicked", G_CALLBACK(onFindInFilesStart), this);
+    g_signal_connect(list, "row-activated", G_CALLBACK(onFindInFilesRowActivated), this);
+    g_signal_connect(impl->searchDialog, "response", G_CALLBACK(onFindInFilesResponse), this);
+    gtk_widget_show_all(impl->searchDialog);
 }
 
-std::string LinuxWindow::getTextContent() const {
-    if (!pImpl->textBuffer) return "";
+void LinuxWindow::onFindInFilesStart(GtkWidget* widget, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
     
-    GtkTextIter start, end;
-    gtk_text_buffer_get_start_iter(pImpl->textBuffer, &start);
-    gtk_text_buffer_get_end_iter(pImpl->textBuffer, &end);
+    // 查找进行中时按钮用作停止
+    if (impl->fileSearcher && impl->fileSearcher->isRunning()) {
+        impl->fileSearcher->cancel();
+        return;
+    }
+    std::string pattern = gtk_entry_get_text(GTK_ENTRY(impl->searchEntry));
+    std::string folder = gtk_entry_get_text(GTK_ENTRY(impl->searchFolderEntry));
+    if (pattern.empty() || folder.empty()) {
+        return;
+    }
     
-    gchar* text = gtk_text_buffer_get_text(pImpl->textBuffer, &start, &end, FALSE);
-    std::string result(text);
-    g_free(text);
+    if (!impl->fileSearcher) {
+        impl->fileSearcher = std::make_unique<FileSearcher>();
+    }
+    // 先等上一次查找完全结束，避免其残留结果混入
+    impl->fileSearcher->cancel();
+    impl->fileSearcher->wait();
+    {
+        std::lock_guard<std::mutex> lock(impl->searchMutex);
+        impl->searchPending.clear();
+        impl->searchFinished = false;
+    }
+    gtk_list_store_clear(impl->searchStore);
+    impl->searchRowCount = 0;
     
-    return result;
+    FileSearchOptions options;
+    options.pattern = pattern;
+    options.caseSensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->searchCaseCheck));
+    options.useRegex = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->searchRegexCheck));
+    options.wholeWord = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->searchWordCheck));
+    if (impl->configManager) {
+        options.maxFileSize = static_cast<uint64_t>(impl->configManager->getInt("Search.max_file_size_mb", 64)) << 20;
+    }
+    
+    // 索引就绪时只查找可能匹配的文件；否则本次完整扫描，索引在后台继续建立
+    std::vector<std::string> roots = {folder};
+    impl->searchNote.clear();
+    if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(impl->searchIndexCheck))) {
+        if (impl->trigramIndex.getRoot() != folder) {
+            impl->trigramIndex.setOptions(options);
+            impl->trigramIndex.open(folder, TrigramIndex::defaultIndexPath(folder));
+        }
+        SearchPattern compiled;
+        bool usedIndex = false;
+        if (!impl->trigramIndex.isReady()) {
+            impl->searchNote = "（索引正在建立，本次完整扫描）";
+        } else if (compiled.compile(pattern, options.caseSensitive, options.useRegex)) {
+            std::vector<std::string> candidates = impl->trigramIndex.findCandidates(compiled, &usedIndex);
+            if (usedIndex) {
+                roots.swap(candidates);
+                impl->searchNote = "（使用索引，" + std::to_string(roots.size()) + " 个候选文件）";
+            }
+        }
+    }
+    
+    auto post = [window]() {
+        if (!window->pImpl->searchIdlePending.exchange(true)) {
+            g_idle_add(onSearchResultsIdle, window);
+        }
+    };
+    bool started = impl->fileSearcher->start(roots, options,
+        [impl, post](std::vector<FileSearchMatch>& matches) {
+            {
+                std::lock_guard<std::mutex> lock(impl->searchMutex);
+                std::move(matches.begin(), matches.end(), std::back_inserter(impl->searchPending));
+            }
+            post();
+        },
+        [impl, post](const FileSearchStats& stats) {
+            {
+                std::lock_guard<std::mutex> lock(impl->searchMutex);
+                impl->searchFinished = true;
+                impl->searchStats = stats;
+            }
+            post();
+        });
+    if (!started) {
+        gtk_label_set_text(GTK_LABEL(impl->searchStatusLabel), "正则表达式无效");
+        return;
+    }
+    gtk_button_set_label(GTK_BUTTON(impl->searchButton), "停止");
+    gtk_label_set_text(GTK_LABEL(impl->searchStatusLabel), "正在查找...");
 }
 
-void LinuxWindow::setTextChangedCallback(std::function<void(const std::string&)> callback) {
-    pImpl->textChangedCallback = callback;
+void LinuxWindow::onFindInFilesResponse(GtkDialog* dialog, gint responseId, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    if (impl->fileSearcher) {
+        impl->fileSearcher->cancel();
+    }
+    impl->searchStore = nullptr;
+    impl->searchDialog = nullptr;
+    gtk_widget_destroy(GTK_WIDGET(dialog));
 }
 
-void LinuxWindow::setWindowCloseCallback(std::function<bool()> callback) {
-    pImpl->windowCloseCallback = callback;
+void LinuxWindow::onFindInFilesRowActivated(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column,
+                                            gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    GtkTreeModel* model = gtk_tree_view_get_model(view);
+    GtkTreeIter row;
+    if (!gtk_tree_model_get_iter(model, &row, path)) {
+        return;
+    }
+    gchar* filePath = nullptr;
+    guint line = 0;
+    guint lineIndex = 0;
+    gtk_tree_model_get(model, &row, SEARCH_COLUMN_PATH, &filePath, SEARCH_COLUMN_LINE, &line,
+                       SEARCH_COLUMN_COLUMN, &lineIndex, -1);
+    std::string target = filePath ? filePath : "";
+    g_free(filePath);
+    if (target.empty() || !impl->editor) {
+        return;
+    }
+    impl->openLocation(window, target, line, lineIndex);
 }
 
-void LinuxWindow::setStatusText(const std::string& text) {
-    if (pImpl->statusBar) {
-        guint contextId = gtk_statusbar_get_context_id(GTK_STATUSBAR(pImpl->statusBar), "main");
-        gtk_statusbar_pop(GTK_STATUSBAR(pImpl->statusBar), contextId);
-        gtk_statusbar_push(GTK_STATUSBAR(pImpl->statusBar), contextId, text.c_str());
+gboolean LinuxWindow::onSearchResultsIdle(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->searchIdlePending = false;
+    
+    std::vector<FileSearchMatch> matches;
+    bool finished = false;
+    FileSearchStats stats{0, 0, 0, 0, 0, false};
+    {
+        std::lock_guard<std::mutex> lock(impl->searchMutex);
+        matches.swap(impl->searchPending);
+        finished = impl->searchFinished;
+        stats = impl->searchStats;
+        impl->searchFinished = false;
+    }
+    if (!impl->searchStore) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    for (const FileSearchMatch& match : matches) {
+        if (impl->searchRowCount >= kMaxSearchRows) {
+            break;
+        }
+        std::string location = displayText(match.path) + ":" + std::to_string(match.line + 1);
+        std::string text = displayText(match.lineText);
+        GtkTreeIter row;
+        gtk_list_store_append(impl->searchStore, &row);
+        gtk_list_store_set(impl->searchStore, &row,
+                           SEARCH_COLUMN_LOCATION, location.c_str(),
+                           SEARCH_COLUMN_TEXT, text.c_str(),
+                           SEARCH_COLUMN_PATH, match.path.c_str(),
+                           SEARCH_COLUMN_LINE, static_cast<guint>(match.line),
+                           SEARCH_COLUMN_COLUMN, static_cast<guint>(match.column),
+                           -1);
+        impl->searchRowCount++;
+    }
+    
+    std::string status;
+    if (finished) {
+        status = "找到 " + std::to_string(stats.matchCount) + " 处匹配，扫描了 " +
+                 std::to_string(stats.filesScanned) + " 个文件，跳过 " + std::to_string(stats.filesSkipped) + " 个";
+        if (stats.cancelled) {
+            status += "（已停止）";
+        }
+        status += impl->searchNote;
+        gtk_button_set_label(GTK_BUTTON(impl->searchButton), "查找");
+    } else {
+        status = "正在查找... 已找到 " + std::to_string(impl->fileSearcher->getStats().matchCount) + " 处匹配";
     }
+    if (impl->searchRowCount >= kMaxSearchRows) {
+        status += "，只显示前 " + std::to_string(kMaxSearchRows) + " 处";
+    }
+    gtk_label_set_text(GTK_LABEL(impl->searchStatusLabel), status.c_str());
+    return G_SOURCE_REMOVE;
 }
 
-void LinuxWindow::handleFileDrop(const std::string& filePath) {
-    if (pImpl->editor) {
-        if (pImpl->editor->openFile(filePath)) {
-            setTextContent(pImpl->editor->getContent());
-            setTitle("LitePad - " + filePath);
+void LinuxWindow::showQuickOpen() {
+    Impl* impl = pImpl.get();
+    if (impl->quickOpenDialog) {
+        gtk_window_present(GTK_WINDOW(impl->quickOpenDialog));
+        return;
+    }
+    
+    impl->quickOpenDialog = gtk_dialog_new_with_buttons("快速打开", GTK_WINDOW(impl->window),
+                                                        GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                        "关闭", GTK_RESPONSE_CLOSE,
+                                                        NULL);
+    gtk_window_set_default_size(GTK_WINDOW(impl->quickOpenDialog), 600, 460);
+    impl->quickOpenEntry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(impl->quickOpenEntry), "输入文件名的部分字符");
+    
+    impl->quickOpenStore = gtk_list_store_new(2, G_TYPE_STRING, G_TYPE_UINT);
+    impl->quickOpenList = gtk_tree_view_new_with_model(GTK_TREE_MODEL(impl->quickOpenStore));
+    g_object_unref(impl->quickOpenStore);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(impl->quickOpenList), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(impl->quickOpenList), FALSE);
+    gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW(impl->quickOpenList), -1, "路径",
+                                                gtk_cell_renderer_text_new(), "text", QUICK_OPEN_COLUMN_PATH, NULL);
+    GtkWidget* scrolledWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolledWindow),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(scrolledWindow), impl->quickOpenList);
+    impl->quickOpenStatusLabel = gtk_label_new("");
+    gtk_label_set_xalign(GTK_LABEL(impl->quickOpenStatusLabel), 0.0f);
+    
+    GtkWidget* content = gtk_dialog_get_content_area(GTK_DIALOG(impl->quickOpenDialog));
+    gtk_box_pack_start(GTK_BOX(content), impl->quickOpenEntry, FALSE, FALSE, 4);
+    gtk_box_pack_start(GTK_BOX(content), scrolledWindow, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(content), impl->quickOpenStatusLabel, FALSE, FALSE, 4);
+    
+    g_signal_connect(impl->quickOpenEntry, "changed", G_CALLBACK(onQuickOpenChanged), this);
+    g_signal_connect(impl->quickOpenEntry, "activate", G_CALLBACK(onQuickOpenActivate), this);
+    g_signal_connect(impl->quickOpenList, "row-activated", G_CALLBACK(onQuickOpenRowActivated), this);
+    g_signal_connect(impl->quickOpenDialog, "response", G_CALLBACK(onQuickOpenResponse), this);
+    gtk_widget_show_all(impl->quickOpenDialog);
+    
+    // 列出当前文件所在目录（没有打开文件时为当前目录）下的全部文件；同一目录只列一次
+    std::string folder;
+    gchar* directory = impl->editor && !impl->editor->getFilePath().empty()
+                           ? g_path_get_dirname(impl->editor->getFilePath().c_str())
+                           : g_get_current_dir();
+    folder = directory;
+    g_free(directory);
+    if (folder == impl->quickOpenRoot) {
+        onQuickOpenChanged(GTK_EDITABLE(impl->quickOpenEntry), this);
+        return;
+    }
+    if (folder == impl->quickOpenLoading) {
+        gtk_label_set_text(GTK_LABEL(impl->quickOpenStatusLabel), "正在列出文件...");
+        return;
+    }
+    if (impl->quickOpenLoader.joinable()) {
+        impl->quickOpenLoader.join();
+    }
+    impl->quickOpenLoading = folder;
+    gtk_label_set_text(GTK_LABEL(impl->quickOpenStatusLabel), "正在列出文件...");
+    
+    FileSearchOptions options;
+    if (impl->configManager) {
+        options.maxFileSize = static_cast<uint64_t>(impl->configManager->getInt("Search.max_file_size_mb", 64)) << 20;
+    }
+    impl->quickOpenLoader = std::thread([this, impl, folder, options]() {
+        FileSearcher lister;
+        std::vector<std::string> files;
+        lister.listFiles({folder}, options, files);
+        // 显示和匹配都使用相对于目录的路径
+        size_t prefix = folder.size() + (folder.back() == '/' ? 0 : 1);
+        for (std::string& file : files) {
+            file.erase(0, std::min(prefix, file.size()));
         }
+        std::sort(files.begin(), files.end());
+        {
+            std::lock_guard<std::mutex> lock(impl->quickOpenMutex);
+            impl->quickOpenFiles.swap(files);
+        }
+        g_idle_add(onQuickOpenLoaded, this);
+    });
+}
+
+gboolean LinuxWindow::onQuickOpenLoaded(gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    std::vector<std::string> files;
+    {
+        std::lock_guard<std::mutex> lock(impl->quickOpenMutex);
+        files.swap(impl->quickOpenFiles);
     }
+    impl->quickOpenMatcher.setItems(files);
+    impl->quickOpenRoot = impl->quickOpenLoading;
+    impl->quickOpenLoading.clear();
+    if (impl->quickOpenDialog) {
+        onQuickOpenChanged(GTK_EDITABLE(impl->quickOpenEntry), window);
+    }
+    return G_SOURCE_REMOVE;
 }
 
-// 静态回调函数
-gboolean LinuxWindow::onDeleteEvent(GtkWidget* widget, GdkEvent* event, gpointer userData) {
+void LinuxWindow::onQuickOpenChanged(GtkEditable* editable, gpointer userData) {
     LinuxWindow* window = static_cast<LinuxWindow*>(userData);
-    if (window->pImpl->windowCloseCallback) {
-        return !window->pImpl->windowCloseCallback(); // GTK返回TRUE阻止关闭
+    Impl* impl = window->pImpl.get();
+    if (!impl->quickOpenStore || impl->quickOpenRoot.empty()) {
+        return;
     }
-    return FALSE;
+    std::string query = gtk_entry_get_text(GTK_ENTRY(editable));
+    std::vector<FuzzyMatch> matches = impl->quickOpenMatcher.match(query, kQuickOpenRows);
+    
+    gtk_list_store_clear(impl->quickOpenStore);
+    for (const FuzzyMatch& match : matches) {
+        std::string path = displayText(impl->quickOpenMatcher.getItem(match.index));
+        GtkTreeIter row;
+        gtk_list_store_append(impl->quickOpenStore, &row);
+        gtk_list_store_set(impl->quickOpenStore, &row, QUICK_OPEN_COLUMN_PATH, path.c_str(),
+                           QUICK_OPEN_COLUMN_INDEX, static_cast<guint>(match.index), -1);
+    }
+    GtkTreePath* first = gtk_tree_path_new_first();
+    gtk_tree_selection_select_path(gtk_tree_view_get_selection(GTK_TREE_VIEW(impl->quickOpenList)), first);
+    gtk_tree_path_free(first);
+    
+    std::string status = std::to_string(impl->quickOpenMatcher.getMatchCount()) + " / " +
+                         std::to_string(impl->quickOpenMatcher.getItemCount()) + " 个文件";
+    gtk_label_set_text(GTK_LABEL(impl->quickOpenStatusLabel), status.c_str());
 }
 
-void LinuxWindow::onDestroy(GtkWidget* widget, gpointer userData) {
+void LinuxWindow::onQuickOpenActivate(GtkEntry* entry, gpointer userData) {
+    // 回车打开选中的条目（默认是得分最高的第一项）
     LinuxWindow* window = static_cast<LinuxWindow*>(userData);
-    window->pImpl->window = nullptr;
+    GtkTreeView* view = GTK_TREE_VIEW(window->pImpl->quickOpenList);
+    GtkTreeModel* model = nullptr;
+    GtkTreeIter row;
+    if (gtk_tree_selection_get_selected(gtk_tree_view_get_selection(view), &model, &row)) {
+        GtkTreePath* path = gtk_tree_model_get_path(model, &row);
+        onQuickOpenRowActivated(view, path, nullptr, userData);
+        gtk_tree_path_free(path);
+    }
 }
 
-void LinuxWindow::onTextChanged(GtkTextBuffer* textBuffer, gpointer userData) {
+void LinuxWindow::onQuickOpenRowActivated(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column,
+                                          gpointer userData) {
     LinuxWindow* window = static_cast<LinuxWindow*>(userData);
-    if (window->pImpl->textChangedCallback) {
-        window->pImpl->textChangedCallback(window->getTextContent());
+    Impl* impl = window->pImpl.get();
+    GtkTreeModel* model = gtk_tree_view_get_model(view);
+    GtkTreeIter row;
+    if (!gtk_tree_model_get_iter(model, &row, path)) {
+        return;
+    }
+    // 显示的路径可能经过转换，按条目下标取原始路径
+    guint index = 0;
+    gtk_tree_model_get(model, &row, QUICK_OPEN_COLUMN_INDEX, &index, -1);
+    gchar* target = g_build_filename(impl->quickOpenRoot.c_str(), impl->quickOpenMatcher.getItem(index).c_str(), NULL);
+    window->handleFileDrop(target);
+    g_free(target);
+    
+    if (impl->quickOpenDialog) {
+        gtk_dialog_response(GTK_DIALOG(impl->quickOpenDialog), GTK_RESPONSE_CLOSE);
     }
+    gtk_window_present(GTK_WINDOW(impl->window));
+}
+
+void LinuxWindow::onQuickOpenResponse(GtkDialog* dialog, gint responseId, gpointer userData) {
+    LinuxWindow* window = static_cast<LinuxWindow*>(userData);
+    Impl* impl = window->pImpl.get();
+    impl->quickOpenStore = nullptr;
+    impl->quickOpenList = nullptr;
+    impl->quickOpenEntry = nullptr;
+    impl->quickOpenStatusLabel = nullptr;
+    impl->quickOpenDialog = nullptr;
+    gtk_widget_destroy(GTK_WIDGET(dialog));
 }
 
 #endif // LINUX
@@ -6,6 +6,8 @@
 
 #ifdef LINUX
 
+#include <gtk/gtk.h>
+
 /**
  * Linux 平台窗口实现
  * 使用 GTK+ 实现原生 Linux 界面
@@ -55,6 +57,31 @@ public:
     
     void setStatusText(const std::string& text) override;
     void handleFileDrop(const std::string& filePath) override;
+    
+    /**
+     * 显示查找栏，高亮全部匹配并显示“第 n 个，共 m 个”
+     */
+    void showFindBar();
+    
+    /**
+     * 显示在文件中查找对话框（非模态，查找在后台线程中进行）
+     */
+    void showFindInFiles();
+    
+    /**
+     * 显示快速打开对话框，按输入模糊匹配当前目录下的文件名
+     */
+    void showQuickOpen();
+    
+    /**
+     * 显示行过滤面板，只列出满足全部过滤条件的行
+     */
+    void showLineFilter();
+    
+    /**
+     * 选择多个日志文件，按时间戳合并到只读视图中，每行标明来源
+     */
+    void showMergedLogs();
 
 private:
     class Impl;
@@ -68,6 +95,56 @@ private:
     static gboolean onDeleteEvent(GtkWidget* widget, GdkEvent* event, gpointer userData);
     static void onDestroy(GtkWidget* widget, gpointer userData);
     static void onTextChanged(GtkTextBuffer* textBuffer, gpointer userData);
+    static void onMarkSet(GtkTextBuffer* textBuffer, GtkTextIter* location, GtkTextMark* mark, gpointer userData);
+    static gboolean onKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData);
+    static void onScrolled(GtkAdjustment* adjustment, gpointer userData);
+    static gboolean onRainbowIdle(gpointer userData);
+    static gboolean onTextViewDraw(GtkWidget* widget, cairo_t* cr, gpointer userData);
+    static gboolean onButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData);
+    static gboolean onFoldIdle(gpointer userData);
+    static gboolean onSymbolFlush(gpointer userData);
+    static gboolean onSymbolsReady(gpointer userData);
+    static void onFindChanged(GtkWidget* widget, gpointer userData);
+    static void onFindNext(GtkWidget* widget, gpointer userData);
+    static void onFindPrevious(GtkWidget* widget, gpointer userData);
+    static void onFindClose(GtkWidget* widget, gpointer userData);
+    static gboolean onFindKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData);
+    static gboolean onMatchesReady(gpointer userData);
+    static gboolean onWordsReady(gpointer userData);
+    static gboolean onFollowData(gpointer userData);
+    static gboolean onGzipData(gpointer userData);
+    static void onFilterAdd(GtkWidget* widget, gpointer userData);
+    static void onFilterUndo(GtkWidget* widget, gpointer userData);
+    static void onFilterClose(GtkWidget* widget, gpointer userData);
+    static gboolean onFilterDraw(GtkWidget* widget, cairo_t* cr, gpointer userData);
+    static void onFilterResize(GtkWidget* widget, GdkRectangle* allocation, gpointer userData);
+    static void onFilterScrolled(GtkAdjustment* adjustment, gpointer userData);
+    static gboolean onFilterScroll(GtkWidget* widget, GdkEventScroll* event, gpointer userData);
+    static gboolean onFilterButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData);
+    static gboolean onFiltersReady(gpointer userData);
+    static gboolean onPagedDraw(GtkWidget* widget, cairo_t* cr, gpointer userData);
+    static void onPagedResize(GtkWidget* widget, GdkRectangle* allocation, gpointer userData);
+    static void onPagedScrolled(GtkAdjustment* adjustment, gpointer userData);
+    static gboolean onPagedScroll(GtkWidget* widget, GdkEventScroll* event, gpointer userData);
+    static gboolean onPagedKeyPress(GtkWidget* widget, GdkEventKey* event, gpointer userData);
+    static gboolean onPagedButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData);
+    static gboolean onPagedIndexProgress(gpointer userData);
+    static gboolean onPagedFindReady(gpointer userData);
+    static gboolean onOverviewDraw(GtkWidget* widget, cairo_t* cr, gpointer userData);
+    static gboolean onOverviewButtonPress(GtkWidget* widget, GdkEventButton* event, gpointer userData);
+    static gboolean onHistogramReady(gpointer userData);
+    static void onCompletionActivate(GtkMenuItem* item, gpointer userData);
+    static void onFindInFilesStart(GtkWidget* widget, gpointer userData);
+    static void onFindInFilesResponse(GtkDialog* dialog, gint responseId, gpointer userData);
+    static void onFindInFilesRowActivated(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column,
+                                          gpointer userData);
+    static gboolean onSearchResultsIdle(gpointer userData);
+    static gboolean onQuickOpenLoaded(gpointer userData);
+    static void onQuickOpenChanged(GtkEditable* editable, gpointer userData);
+    static void onQuickOpenActivate(GtkEntry* entry, gpointer userData);
+    static void onQuickOpenRowActivated(GtkTreeView* view, GtkTreePath* path, GtkTreeViewColumn* column,
+                                        gpointer userData);
+    static void onQuickOpenResponse(GtkDialog* dialog, gint responseId, gpointer userData);
 };
 
 #endif // LINUX
@@ -3,6 +3,38 @@
 #include <memory>
 #include "../src/Editor.h"
 #include "../src/ConfigManager.h"
+#include "../src/SyntaxLexer.h"
+#include "../src/SyntaxModel.h"
+#include "../src/FoldingModel.h"
+#include "../src/SymbolIndex.h"
+#include "../src/FileSearcher.h"
+#include "../src/TrigramIndex.h"
+#include "../src/FuzzyMatcher.h"
+#include "../src/BatchEditor.h"
+#include "../src/MatchIndex.h"
+#include "../src/WordIndex.h"
+#include "../src/ProjectSymbolIndex.h"
+#include "../src/UnicodeText.h"
+#include "../src/FileFollower.h"
+#include "../src/LineFilter.h"
+#include "../src/TimestampIndex.h"
+#include "../src/LevelHistogram.h"
+#include "../src/GzipReader.h"
+#include "../src/PagedDocument.h"
+#include "../src/LongLineIndex.h"
+#include "../src/LogMerger.h"
+#include "../src/EncodingDetector.h"
+#include "../src/Transcoder.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+#include <zlib.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /**
  * 简单的测试框架
@@ -36,6 +68,12 @@ public:
         testConfigManagerBasic();
         testConfigManagerTypes();
         
+        // 词法分析测试
+        testSyntaxLexer();
+        
+        // 查找测试
+        testSearch();
+        
         std::cout << "=== All tests completed ===" << std::endl;
     }
 
@@ -104,6 +142,41 @@ private:
             return pos == 0;
         });
         
+        runTest("Editor Range Edit Notification", []() {
+            auto editor = std::make_unique<Editor>();
+            editor->setContent("one\ntwo\nthree");
+            TextEdit last{};
+            editor->addEditListener([&last](const TextEdit& edit) { last = edit; });
+            editor->setContent("one\nTWO\nthree");
+            return last.position == 4 && last.removedLength == 3 && last.insertedLength == 3 &&
+                   last.startLine == 1 && editor->getLine(2) == "TWO";
+        });
+        
+        runTest("Editor Retention Drops Head Lines", []() {
+            auto editor = std::make_unique<Editor>();
+            editor->setRetentionLimit(0, 8);
+            size_t discards = 0;
+            editor->addEditListener([&discards](const TextEdit& edit) {
+                discards += edit.position == 0 && edit.insertedLength == 0 ? 1 : 0;
+            });
+            std::string expected;
+            for (int i = 0; i < 100; i++) {
+                std::string line = "line " + std::to_string(i) + "\n";
+                editor->appendText(line);
+                expected += line;
+            }
+            // 超过 8 行时一次丢弃到 7 行，行索引在新的基准上继续支持编辑
+            const LineIndex& lines = editor->getLineIndex();
+            size_t discarded = editor->getDiscardedLineCount();
+            bool bounded = lines.getLineCount() <= 8 && discards > 10 && !editor->isModified() &&
+                           editor->getContent() == expected.substr(editor->getDiscardedByteCount()) &&
+                           editor->getLine(1) == "line " + std::to_string(discarded);
+            editor->insertText(lines.getLineStart(1), "x");
+            return bounded && editor->getLine(2) == "xline " + std::to_string(discarded + 1) &&
+                   lines.getLineOfOffset(lines.getLineStart(2)) == 2 &&
+                   lines.getLength() == editor->getContent().size();
+        });
+        
         runTest("Editor Replace Text", []() {
             auto editor = std::make_unique<Editor>();
             editor->setContent("Hello World Hello");
@@ -159,6 +232,1077 @@ private:
             return config->hasKey("test.key") && !config->hasKey("nonexistent.key");
         });
     }
+    
+    static void testSyntaxLexer() {
+        std::cout << "\n--- Syntax Lexer Tests ---" << std::endl;
+        
+        runTest("Delimiter Scanner Find Next", []() {
+            DelimiterScanner scanner("\"\\\n");
+            std::string text(200, 'x');
+            text[130] = '\\';
+            return scanner.findNext(text.data(), text.size(), 0) == 130 &&
+                   scanner.findNext(text.data(), text.size(), 131) == text.size();
+        });
+        
+        runTest("Syntax Lexer Tokens", []() {
+            SyntaxLexer lexer(LanguageRules::forLanguage("C++"));
+            std::string text = "int x = 42; // note\n\"a\\\"b\"";
+            std::vector<SyntaxToken> tokens;
+            lexer.tokenize(text.data(), text.size(), LexState(), tokens);
+            return tokens.size() == 7 && tokens[0].type == SyntaxTokenType::Keyword &&
+                   tokens[5].type == SyntaxTokenType::Comment && tokens[6].type == SyntaxTokenType::String &&
+                   tokens[6].length == 6;
+        });
+        
+        runTest("Syntax Lexer Block Comment State", []() {
+            SyntaxLexer lexer(LanguageRules::forLanguage("C"));
+            std::string first = "a /* open";
+            std::string second = "still */ b";
+            std::vector<SyntaxToken> tokens;
+            LexState state = lexer.tokenize(first.data(), first.size(), LexState(), tokens);
+            bool open = state.mode == LexState::Mode::BlockComment;
+            state = lexer.tokenize(second.data(), second.size(), state, tokens);
+            return open && state.mode == LexState::Mode::Normal;
+        });
+        
+        runTest("Bracket Matching Skips Strings", []() {
+            auto editor = std::make_shared<Editor>();
+            SyntaxModel model;
+            model.setLanguage("C");
+            model.setEditor(editor);
+            editor->setContent("f(\")\") {\n  g[1];\n}");
+            size_t open = 0;
+            size_t close = 0;
+            return model.findMatchingBracket(1) == 5 && model.findMatchingBracket(7) == 17 &&
+                   model.findEnclosingBlock(12, open, close) && open == 7 && close == 17;
+        });
+        
+        runTest("Bracket Matching After Edit", []() {
+            auto editor = std::make_shared<Editor>();
+            SyntaxModel model;
+            model.setLanguage("C");
+            model.setEditor(editor);
+            editor->setContent("{\n}\n");
+            editor->insertText(0, "/*");
+            bool commented = model.findMatchingBracket(2) == std::string::npos;
+            editor->deleteText(0, 2);
+            return commented && model.findMatchingBracket(0) == 2;
+        });
+        
+        runTest("Folding Keeps Collapsed Region After Edit", []() {
+            auto editor = std::make_shared<Editor>();
+            SyntaxModel model;
+            model.setLanguage("C++");
+            model.setEditor(editor);
+            FoldingModel folding;
+            folding.setSyntaxModel(&model);
+            editor->setContent("int a;\nvoid f() {\n  x();\n}\n");
+            folding.toggleFold(1);
+            editor->insertText(0, "// one\n// two\n");
+            FoldRegion region;
+            bool edited = folding.findRegionAt(3, region) && region.collapsed && region.endLine == 5 &&
+                          folding.isLineHidden(4) && folding.nextVisibleLine(4) == 6 &&
+                          folding.findRegionAt(0, region) && region.kind == FoldKind::Comment;
+            
+            // 编辑留下的平移懒标记不影响全部折叠后的查询
+            FoldRegionTree tree;
+            for (size_t line = 1; line < 100; line++) {
+                tree.insert({line, line + 1, FoldKind::Bracket, false});
+            }
+            std::vector<FoldRegion> removed;
+            tree.applyLineEdit(0, 0, 100, removed);
+            tree.setAllCollapsed(true);
+            bool shifted = true;
+            for (size_t line = 101; line < 200; line++) {
+                std::vector<FoldRegion> regions;
+                tree.query(line + 1, line + 1, regions);
+                shifted = shifted && std::any_of(regions.begin(), regions.end(), [line](const FoldRegion& found) {
+                    return found.startLine == line && found.endLine == line + 1 && found.collapsed;
+                });
+            }
+            return edited && shifted;
+        });
+        
+        runTest("Folding Indentation And Region Markers", []() {
+            auto editor = std::make_shared<Editor>();
+            SyntaxModel model;
+            model.setLanguage("Python");
+            model.setEditor(editor);
+            FoldingModel folding;
+            folding.setSyntaxModel(&model);
+            editor->setContent("#region setup\ndef f():\n    a = 1\n\n    b = 2\n#endregion\nx = 3\n");
+            FoldRegion block;
+            FoldRegion marker;
+            return folding.findRegionAt(1, block) && block.kind == FoldKind::Indentation && block.endLine == 4 &&
+                   folding.findRegionAt(0, marker) && marker.kind == FoldKind::Region && marker.endLine == 5;
+        });
+        
+        runTest("Symbol Extraction Declarations", []() {
+            SymbolExtractor extractor("C++");
+            std::vector<Symbol> symbols;
+            extractor.extract("class Foo : public Bar {\npublic:\n    int get() const { return 1; }\n};\n"
+                              "int Foo::set(int v)\n{\n    if (v) { return 0; }\n    return v;\n}\n",
+                              symbols);
+            return symbols.size() == 3 && symbols[0].name == "Foo" && symbols[0].kind == SymbolKind::Class &&
+                   symbols[0].endLine == 3 && symbols[1].kind == SymbolKind::Method && symbols[1].container == "Foo" &&
+                   symbols[2].name == "set" && symbols[2].container == "Foo" && symbols[2].line == 4 &&
+                   symbols[2].endLine == 8;
+        });
+        
+        runTest("Symbol Index Incremental Update", []() {
+            auto editor = std::make_shared<Editor>();
+            editor->setContent("class A:\n    def m(self):\n        pass\n\ndef f():\n    return 1\n");
+            SymbolIndex index;
+            index.setLanguage("Python");
+            index.setEditor(editor);
+            editor->insertText(0, "def g():\n    pass\n");
+            index.flush();
+            index.waitForIdle();
+            auto table = index.getSymbolTable();
+            const Symbol* method = table->findByName("m");
+            const Symbol* enclosing = table->findEnclosing(7);
+            return table->getSymbols().size() == 4 && method && method->line == 3 &&
+                   method->kind == SymbolKind::Method && enclosing && enclosing->name == "f" &&
+                   table->isClassName("A") && table->isFunctionName("g");
+        });
+    }
+    
+    static void testSearch() {
+        std::cout << "\n--- Search Tests ---" << std::endl;
+        
+        runTest("Text Search Case Folding", []() {
+            std::string text(300, '.');
+            text.replace(150, 6, "NeeDle");
+            text.replace(280, 6, "needle");
+            TextSearch exact("needle", true);
+            TextSearch folded("needle", false);
+            return exact.find(text.data(), text.size()) == 280 && folded.find(text.data(), text.size()) == 150 &&
+                   folded.find(text.data(), text.size(), 151) == 280 &&
+                   exact.find(text.data(), text.size(), 281) == std::string::npos;
+        });
+        
+        runTest("Range Bounded Backward Search", []() {
+            std::string text(300, '.');
+            text.replace(10, 6, "needle");
+            text.replace(150, 6, "NeeDle");
+            text.replace(280, 6, "needle");
+            TextSearch folded("needle", false);
+            bool kernel = folded.findLast(text.data(), text.size()) == 280 &&
+                          folded.findLast(text.data(), 285) == 150 && folded.findLast(text.data(), 160, 11) == 150 &&
+                          folded.findLast(text.data(), 155, 11) == std::string::npos;
+            Editor editor;
+            editor.setContent(text);
+            // 区间结束截断匹配时不计入，向前查找只看起始位置
+            return kernel && editor.findTextInRange("needle", 0, 286, false) == 280 &&
+                   editor.findTextInRange("needle", 11, 285, true, false) == 150 &&
+                   editor.findTextInRange("needle", 11, 285, true) == std::string::npos &&
+                   editor.findTextBackward("needle", 280) == 10 && editor.findTextBackward("needle", 281) == 280 &&
+                   editor.findTextBackward("NEEDLE", 151, false) == 150 && editor.findTextBackward("needle", 10) ==
+                   std::string::npos;
+        });
+        
+        runTest("Unicode Case Folding And Whole Word", []() {
+            // Ä/ä 只有第二个字节不同，Р/р 连首字节都不同（D0 A0 / D1 80），汉字作为锚点
+            std::string text = std::string(100, ' ') + "ÄPFEL Рыба 中文Ärger foobar foo_x foo.";
+            TextSearch apple("äpfel", false);
+            TextSearch fish("рЫБА", false);
+            TextSearch mixed("文ä", false);
+            bool folding = UnicodeText::fold(0x00C4) == 0x00E4 && UnicodeText::fold(0x0420) == 0x0440 &&
+                           UnicodeText::fold(0x4E2D) == 0x4E2D && apple.find(text.data(), text.size()) == 100 &&
+                           fish.find(text.data(), text.size()) == 107 &&
+                           mixed.findLast(text.data(), text.size()) == text.find("文Ä") &&
+                           TextSearch("äpfel").find(text.data(), text.size()) == std::string::npos;
+            Editor editor;
+            editor.setContent(text);
+            size_t word = text.rfind("foo.");
+            size_t ascii = editor.findText("FOO", 0, false, true);
+            return folding && ascii == word && editor.findTextBackward("foo", text.size(), true, true) == word &&
+                   editor.findText("ärger", 0, false, true) == std::string::npos &&
+                   editor.findText("рыба", 0, false, true) == 107 &&
+                   editor.findText("中文", 0, true, true) == std::string::npos;
+        });
+        
+        runTest("Thread Pool Nested Tasks", []() {
+            ThreadPool pool(4);
+            std::atomic<int> count{0};
+            for (int i = 0; i < 8; ++i) {
+                pool.submit([&pool, &count]() {
+                    for (int j = 0; j < 100; ++j) {
+                        pool.submit([&count]() { count++; });
+                    }
+                });
+            }
+            pool.wait();
+            return count == 800;
+        });
+        
+        runTest("Find In Files Skips Binary And Large Files", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_find_test";
+            fs::remove_all(root);
+            fs::create_directories(root / "sub" / ".git");
+            std::ofstream(root / "a.conf") << "listen 80\nserver_name TODO\n";
+            std::ofstream(root / "sub" / "b.log") << "ok\nok\nerror: todo later\n";
+            std::ofstream(root / "sub" / ".git" / "c") << "todo\n";
+            std::ofstream(root / "bin.dat", std::ios::binary) << std::string("todo\0\1", 7);
+            std::ofstream(root / "big.txt") << std::string(4096, 'x') << "todo\n";
+            
+            FileSearchOptions options;
+            options.pattern = "todo";
+            options.caseSensitive = false;
+            options.maxFileSize = 1024;
+            FileSearcher searcher(2);
+            std::vector<FileSearchMatch> found;
+            searcher.start({root.string()}, options,
+                           [&found](std::vector<FileSearchMatch>& matches) {
+                               found.insert(found.end(), matches.begin(), matches.end());
+                           },
+                           nullptr);
+            searcher.wait();
+            FileSearchStats stats = searcher.getStats();
+            fs::remove_all(root);
+            
+            std::sort(found.begin(), found.end(),
+                      [](const FileSearchMatch& a, const FileSearchMatch& b) { return a.path < b.path; });
+            return found.size() == 2 && found[0].line == 1 && found[0].column == 12 &&
+                   found[1].line == 2 && found[1].lineText == "error: todo later" &&
+                   stats.filesScanned == 2 && stats.filesSkipped == 2;
+        });
+        
+        runTest("Regex Required Literals", []() {
+            auto literals = SearchPattern::extractRequiredLiterals("conn(ect)?ion_\\d+ to\\.host");
+            SearchPattern pattern;
+            size_t start = 0;
+            size_t length = 0;
+            std::string text = "a\nxx connection_42 to.host\n";
+            bool found = pattern.compile("conn(ect)?ion_\\d+", true, true) &&
+                         pattern.findNext(text.data(), text.size(), 0, start, length);
+            return literals.size() == 3 && literals[0] == "conn" && literals[1] == "ion_" &&
+                   literals[2] == " to.host" && SearchPattern::extractRequiredLiterals("ab|cd").empty() &&
+                   SearchPattern::extractRequiredLiterals("colou?r")[0] == "colo" && found && start == 5 &&
+                   length == 13;
+        });
+        
+        runTest("Trigram Index Candidates And Reload", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_trigram_test";
+            fs::remove_all(root);
+            fs::create_directories(root / "src");
+            std::ofstream(root / "src" / "net.cpp") << "void Connect(int port);\n";
+            std::ofstream(root / "src" / "ui.cpp") << "void paint();\n";
+            std::ofstream(root / "notes.txt") << "remember to connect later\n";
+            std::string indexPath = (root / "index.trigram").string();
+            
+            SearchPattern connect;
+            connect.compile("connect\\(", false, true);
+            SearchPattern paint;
+            paint.compile("paint", true, false);
+            bool usedIndex = false;
+            
+            TrigramIndex index;
+            bool loadedMissing = index.load(root.string(), indexPath);
+            index.refresh();
+            auto first = index.findCandidates(connect, &usedIndex);
+            bool saved = index.save();
+            
+            // 重新载入后修改一个文件、删除一个文件
+            TrigramIndex reloaded;
+            bool loaded = reloaded.load(root.string(), indexPath);
+            size_t loadedCount = reloaded.getFileCount();
+            std::ofstream(root / "src" / "ui.cpp") << "void paint(); void connect(int);\n";
+            fs::remove(root / "src" / "net.cpp");
+            reloaded.updateFiles({(root / "src" / "ui.cpp").string(), (root / "src" / "net.cpp").string()});
+            auto second = reloaded.findCandidates(connect);
+            auto third = reloaded.findCandidates(paint);
+            fs::remove_all(root);
+            
+            return !loadedMissing && usedIndex && first.size() == 1 &&
+                   first[0] == (root / "src" / "net.cpp").string() && saved && loaded && loadedCount == 3 &&
+                   second.size() == 1 && second[0] == (root / "src" / "ui.cpp").string() && third.size() == 1;
+        });
+        
+        runTest("Fuzzy Match Ranking And Refinement", []() {
+            FuzzyMatcher matcher;
+            matcher.setItems({"src/Editor.cpp", "src/platform/linux/LinuxWindow.cpp", "docs/editor_notes.md",
+                              "tests/test_main.cpp", "src/EditorConfig.h"});
+            auto first = matcher.match("edc", 10);
+            size_t firstCount = matcher.getMatchCount();
+            // 在上一次查询后追加字符，只在上一次的结果中继续匹配
+            auto refined = matcher.match("edcpp", 10);
+            auto window = matcher.match("LWin", 1);
+            auto none = matcher.match("zzz", 10);
+            auto all = matcher.match("", 2);
+            return firstCount == 2 && first[0].index == 4 && refined.size() == 1 && refined[0].index == 0 &&
+                   window.size() == 1 && window[0].index == 1 && none.empty() && all.size() == 2 &&
+                   FuzzyMatcher::score("src/Editor.cpp", "ecp") >= 0 && FuzzyMatcher::score("abc", "abcd") < 0;
+        });
+        
+        runTest("Batch Replace Rewrites Matching Files", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_batch_test";
+            fs::remove_all(root);
+            fs::create_directories(root / "sub");
+            std::ofstream(root / "a.txt") << "foo bar foo\nFOO\n";
+            std::ofstream(root / "sub" / "b.txt") << "nothing here\n";
+            auto untouched = fs::last_write_time(root / "sub" / "b.txt");
+            fs::permissions(root / "a.txt", fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read);
+#ifndef _WIN32
+            // 以 root 运行时改写后的文件仍属于原所有者
+            bool asRoot = ::geteuid() == 0;
+            if (asRoot && ::chown((root / "a.txt").c_str(), 4242, 4243) != 0) {
+                return false;
+            }
+#endif
+            
+            BatchEditor counter(2);
+            counter.setPattern("foo", false, false);
+            size_t counted = 0;
+            for (const BatchFileResult& result : counter.run({root.string()})) {
+                counted += result.count;
+            }
+            
+            BatchEditor editor(2);
+            editor.setPattern("fo+", true, true);
+            editor.setReplacement("baz");
+            auto results = editor.run({root.string()});
+            std::ifstream stream(root / "a.txt");
+            std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            bool unchanged = fs::last_write_time(root / "sub" / "b.txt") == untouched;
+            bool kept = fs::status(root / "a.txt").permissions() ==
+                        (fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read);
+#ifndef _WIN32
+            struct stat info;
+            kept = kept && ::stat((root / "a.txt").c_str(), &info) == 0 &&
+                   (!asRoot || (info.st_uid == 4242 && info.st_gid == 4243));
+#endif
+            size_t fileCount =
+                static_cast<size_t>(std::distance(fs::directory_iterator(root), fs::directory_iterator()));
+            fs::remove_all(root);
+            
+            
+            // 选项在 --find 之前也进入批量模式，-- 之后的参数只是路径
+            auto isBatch = [](std::vector<std::string> arguments) {
+                std::vector<char*> argv;
+                for (std::string& argument : arguments) {
+                    argv.push_back(&argument[0]);
+                }
+                return BatchEditor::isBatchCommand(static_cast<int>(argv.size()), argv.data());
+            };
+            bool detected = isBatch({"LitePad", "--find", "x", "dir"}) &&
+                            isBatch({"LitePad", "--regex", "--find", "x", "dir"}) &&
+                            isBatch({"LitePad", "--ignore-case", "--replace", "y", "--find", "x", "dir"}) &&
+                            !isBatch({"LitePad", "notes.txt"}) && !isBatch({"LitePad", "--", "--find"});
+            
+            return counted == 3 && results.size() == 2 && results[0].count == 2 && results[1].count == 0 &&
+                   content == "baz bar baz\nFOO\n" && unchanged && kept && fileCount == 2 && detected;
+        });
+        
+        runTest("Match Index Patches Edits", []() {
+            auto editor = std::make_shared<Editor>();
+            editor->setContent("aaaa b aa\nxaa");
+            MatchIndex index;
+            index.setEditor(editor);
+            index.setQuery("aa", true, false);
+            index.waitForIdle();
+            size_t initial = index.getMatchCount();
+            // 删除一个 a 后开头只剩一处匹配，之后的匹配整体前移
+            editor->deleteText(0, 1);
+            bool shifted = index.getMatchCount() == 3 && index.getMatch(1).start == 6 && index.getMatch(2).start == 10;
+            editor->insertText(3, "a");
+            size_t next = 0;
+            size_t previous = 0;
+            bool navigation = index.findNext(3, next) && index.findPrevious(0, previous);
+            return initial == 4 && shifted && index.getMatchCount() == 4 && index.getMatch(1).start == 2 &&
+                   navigation && next == 2 && previous == 3 && index.getMatchesInRange(1, 3).size() == 2;
+        });
+        
+        runTest("Match Index Refines Extended Query", []() {
+            auto pattern = [](const std::string& text, bool caseSensitive) {
+                SearchPattern compiled;
+                compiled.compile(text, caseSensitive, false);
+                return compiled;
+            };
+            // "aa" 能与自身重叠，旧匹配不是全部出现位置，必须重新扫描
+            bool rules = MatchIndex::canRefine(pattern("ab", false), pattern("ABc", false)) &&
+                         !MatchIndex::canRefine(pattern("aa", true), pattern("aab", true)) &&
+                         !MatchIndex::canRefine(pattern("abc", true), pattern("ab", true)) &&
+                         !MatchIndex::canRefine(pattern("ab", true), pattern("abc", false));
+            auto editor = std::make_shared<Editor>();
+            editor->setContent("abcab abd abcabc");
+            MatchIndex index;
+            index.setEditor(editor);
+            index.setQuery("ab", true, false);
+            index.waitForIdle();
+            size_t before = index.getMatchCount();
+            index.setQuery("abc", true, false);
+            index.waitForIdle();
+            return rules && before == 5 && index.getMatchCount() == 3 && index.getMatch(1).start == 10 &&
+                   index.getMatch(2).start == 13;
+        });
+        
+        runTest("Word Index Incremental Prefix Query", []() {
+            auto first = std::make_shared<Editor>();
+            auto second = std::make_shared<Editor>();
+            first->setContent("int counter = 0;\ncounter++;\nreturn count;");
+            second->setContent("counter cost\n");
+            WordIndex index;
+            size_t firstId = index.addDocument(first);
+            index.addDocument(second);
+            // 编辑发生在后台分词期间，结果送达后补上
+            first->insertText(0, "const ");
+            index.waitForIdle();
+            std::vector<WordCandidate> initial = index.complete("co", 10);
+            bool ranked = index.isReady() && initial.size() == 4 && initial[0].word == "counter" &&
+                          initial[0].count == 3 && initial[1].word == "cost" && index.getCount("int") == 1;
+            // 删除第二行并跨行插入，只重新切分受影响的行
+            first->deleteText(first->getContent().find("counter++"), 11);
+            first->insertText(first->getContent().size(), "\nconstexpr cost");
+            bool edited = index.getCount("counter") == 2 && index.getCount("constexpr") == 1 &&
+                          index.getCount("cost") == 2 && index.complete("cons", 10).size() == 2;
+            index.removeDocument(firstId);
+            return ranked && edited && index.getCount("counter") == 1 && index.getCount("return") == 0 &&
+                   index.complete("c", 10).size() == 2 && index.complete("counter", 10).empty();
+        });
+        
+        runTest("Project Symbol Index Refreshes Changed Files", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_symbols_test";
+            fs::remove_all(root);
+            fs::create_directories(root / "src");
+            std::ofstream(root / "src" / "a.cpp") << "class Widget {\n};\n\nint draw(int x) {\n    return x;\n}\n";
+            std::ofstream(root / "tool.py") << "def draw():\n    pass\n";
+            std::ofstream(root / "notes.txt") << "int notes() {}\n";
+            std::string indexPath = (root / "index.symbols").string();
+            
+            ProjectSymbolIndex index;
+            index.load(root.string(), indexPath);
+            bool built = index.refresh() && index.getFileCount() == 2;
+            std::vector<ProjectSymbol> draws = index.findDefinitions("draw");
+            bool found = draws.size() == 2 && draws[0].line == 3 && index.findDefinitions("Widget").size() == 1 &&
+                         index.findDefinitions("notes").empty();
+            
+            // 只修改 Python 文件，重新载入后刷新
+            std::ofstream(root / "tool.py") << "def draw():\n    pass\n\ndef widen():\n    pass\n";
+            ProjectSymbolIndex reopened;
+            bool loaded = reopened.load(root.string(), indexPath) && reopened.getSymbolCount() == 3;
+            bool refreshed = reopened.refresh() && reopened.findByPrefix("wid", 10).size() == 1 &&
+                             reopened.findByPrefix("W", 10).size() == 1 && reopened.getSymbolCount() == 4;
+            fs::remove_all(root);
+            return built && found && loaded && refreshed;
+        });
+        
+        runTest("File Follower Appends And Detects Rotation", []() {
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_follow_test.log";
+            std::ofstream(path) << "first\n";
+            Editor editor;
+            editor.openFile(path.string());
+            std::vector<TextEdit> edits;
+            editor.addEditListener([&edits](const TextEdit& edit) { edits.push_back(edit); });
+            FileFollower follower;
+            if (!follower.start(path.string(), editor.getContentView().size())) {
+                return false;
+            }
+            
+            // 不完整的 UTF-8 字符留到下一次送出
+            std::string line = "second 中文\n";
+            std::ofstream(path, std::ios::app) << line.substr(0, 9);
+            FollowUpdate update;
+            follower.poll();
+            bool partial = follower.collect(update) && !update.reset && update.data == "second ";
+            editor.appendText(update.data);
+            std::ofstream(path, std::ios::app) << line.substr(9);
+            follower.poll();
+            bool appended = follower.collect(update) && update.data == line.substr(7);
+            editor.appendText(update.data);
+            bool notified = edits.size() == 2 && edits[1].position == 13 && edits[1].removedLength == 0 &&
+                            edits[1].insertedLineBreaks == 1 && editor.getContent() == "first\n" + line;
+            
+            // 截断后从头读取
+            std::ofstream(path) << "new\n";
+            follower.poll();
+            bool truncated = follower.collect(update) && update.reset && update.data == "new\n";
+            
+            // 改名轮转：路径指向新的 inode
+            fs::rename(path, path.string() + ".1");
+            std::ofstream(path) << "rotated\n";
+            follower.poll();
+            bool rotated = follower.collect(update) && update.reset && update.data == "rotated\n";
+            follower.stop();
+            fs::remove(path);
+            fs::remove(path.string() + ".1");
+            return partial && appended && notified && truncated && rotated && !follower.collect(update);
+        });
+        
+        runTest("Line Filter Stacked Rules Follow Appends", []() {
+            // 足够多的行使扫描分成多段并行处理
+            std::string content;
+            for (int i = 0; i < 200000; i++) {
+                content += i % 3 == 0 ? "ERROR disk " : i % 3 == 1 ? "INFO ok " : "error net ";
+                content += std::to_string(i) + "\n";
+            }
+            auto editor = std::make_shared<Editor>();
+            editor->setContent(content);
+            LineFilter filter;
+            filter.setEditor(editor);
+            bool rejected = !filter.addRule({"(", true, true, false}) && filter.getRules().empty();
+            filter.addRule({"error", false, false, false});
+            filter.waitForIdle();
+            bool included = filter.getMatchCount() == 133333 && filter.getMatchedLine(1) == 2;
+            filter.addRule({"net", true, false, true});
+            filter.waitForIdle();
+            bool excluded = filter.getMatchCount() == 66667 && filter.getMatchedLine(66666) == 199998 &&
+                            filter.findIndex(4) == 2;
+            
+            // 追加和编辑只重新判断涉及的行
+            editor->appendText("Error disk new\ninfo\nERROR net\n");
+            bool appended = filter.isComplete() && filter.getMatchCount() == 66668 &&
+                            filter.getMatchedLine(66667) == 200000;
+            editor->deleteText(0, 5);
+            editor->insertText(0, "INFO");
+            bool edited = filter.getMatchCount() == 66667 && filter.getMatchedLine(0) == 3;
+            filter.removeLastRule();
+            filter.waitForIdle();
+            bool removed = filter.getMatchCount() == 133334 && filter.getMatchedLine(0) == 2;
+            return rejected && included && excluded && appended && edited && removed;
+        });
+        
+        runTest("Timestamp Index Jumps To Time", []() {
+            // 每秒一行，每 10 行后跟一行没有时间戳的堆栈
+            std::string content;
+            char line[64];
+            for (int i = 0; i < 80000; i++) {
+                std::snprintf(line, sizeof(line), "2024-03-05 %02d:%02d:%02d,%03d INFO tick\n", i / 3600 % 24,
+                              i / 60 % 60, i % 60, i % 1000);
+                content += line;
+                content += i % 10 == 9 ? "    at Worker.run(Worker.java:42)\n" : "";
+            }
+            auto editor = std::make_shared<Editor>();
+            editor->setContent(content);
+            TimestampIndex index(64);
+            index.setEditor(editor);
+            size_t found = 0;
+            // 第 3723 秒在第 3723 + 372 行
+            bool jumped = index.getFormat() == TimestampFormat::Iso8601 && index.findLine("01:02:03", found) &&
+                          found == 4095 && index.getParsedSampleCount() < 40;
+            bool dated = index.findLine("2024-03-05T01:02:03.800", found) && found == 4096 &&
+                         index.findLine("2024-03-06", found) && found == 88000 && !index.findLine("later", found);
+            
+            // 追加后只重新解析末尾的采样点
+            size_t parsed = index.getParsedSampleCount();
+            editor->appendText("2024-03-06 00:00:01 INFO next day\n");
+            bool kept = index.getParsedSampleCount() > 0 && index.getParsedSampleCount() + 2 >= parsed;
+            bool appended = kept && index.findLine("2024-03-06 00:00:01", found) && found == 88000 &&
+                            index.findLine("2024-03-06 00:00:02", found) && found == 88001;
+            
+            // 分页文档作为来源：行索引尚未完整时也能跳转
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_timestamp_test.log";
+            std::ofstream(path, std::ios::binary) << content;
+            PagedDocument document;
+            TimestampIndex pagedIndex(64);
+            bool paged = document.open(path.string(), 1 << 20, 4096);
+            pagedIndex.setPagedDocument(&document);
+            paged = paged && pagedIndex.getFormat() == TimestampFormat::Iso8601 &&
+                    pagedIndex.findLine("01:02:03", found) && found == 4095 &&
+                    pagedIndex.findLine("2024-03-05 20:00:00", found) && found == 79200;
+            document.waitForIndex();
+            paged = paged && pagedIndex.findLine("2024-03-06", found) && found == 88000;
+            pagedIndex.setPagedDocument(nullptr);
+            document.close();
+            fs::remove(path);
+            
+            int64_t time = 0;
+            bool formats = TimestampIndex::detectFormat("Mar  5 14:32:05 host sshd[1]: ok\n", 33) ==
+                               TimestampFormat::Syslog &&
+                           TimestampIndex::parseTimestamp("127.0.0.1 - - [05/Mar/2024:14:32:05 +0000] \"GET /\"", 48,
+                                                          TimestampFormat::CommonLog, time) &&
+                           time == TimestampIndex::toMilliseconds(2024, 3, 5, 14, 32, 5, 0) &&
+                           TimestampIndex::detectFormat("Mar 05, 2024 2:32:05 PM Main run\n", 33) ==
+                               TimestampFormat::JavaLogging &&
+                           TimestampIndex::toMilliseconds(1970, 1, 2, 0, 0, 0, 1) == 86400001;
+            return jumped && dated && appended && paged && formats;
+        });
+        
+        runTest("Level Histogram Buckets Follow Appends", []() {
+            // 100 行：每 10 行一个 ERROR，其余交替为 INFO 和 DEBUG，WARNING 出现在 ERROR 行中时不计
+            std::string content;
+            for (int i = 0; i < 100; i++) {
+                content += i % 10 == 0 ? "E ERROR WARNING x\n" : i % 2 ? "I INFO x\n" : "D DEBUG x\n";
+            }
+            auto editor = std::make_shared<Editor>();
+            editor->setContent(content);
+            LevelHistogram histogram(8);
+            histogram.setEditor(editor);
+            histogram.waitForIdle();
+            bool counted = histogram.getTotal(LogLevel::Error) == 10 && histogram.getTotal(LogLevel::Warn) == 0 &&
+                           histogram.getTotal(LogLevel::Info) == 50 && histogram.getTotal(LogLevel::Debug) == 40;
+            // 8 个桶容纳 100 行需要每桶 16 行，第一个桶内有 2 个 ERROR
+            bool bucketed = histogram.getLinesPerBucket() == 16 && histogram.getBucketCount() == 7 &&
+                            histogram.getBucket(0).counts[0] == 2 && histogram.getBucket(0).counts[2] == 8;
+            
+            // 追加时原来的最后一行被延长后重新归类
+            editor->appendText("W WARN");
+            editor->appendText(" x\nERRORS\nWARNING");
+            bool appended = histogram.isComplete() && histogram.getTotal(LogLevel::Warn) == 2 &&
+                            histogram.getTotal(LogLevel::Error) == 10;
+            editor->appendText(" ERROR\n");
+            bool extended = histogram.getTotal(LogLevel::Warn) == 1 && histogram.getTotal(LogLevel::Error) == 11;
+            
+            // 中间的编辑重新扫描
+            editor->deleteText(0, 18);
+            histogram.setKeywords(LogLevel::Debug, "");
+            histogram.waitForIdle();
+            bool rescanned = histogram.getTotal(LogLevel::Error) == 10 && histogram.getTotal(LogLevel::Debug) == 0 &&
+                             histogram.getTotal(LogLevel::Info) == 50;
+            return counted && bucketed && appended && extended && rescanned;
+        });
+        
+        runTest("Gzip Reader Seeks From Checkpoints", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_gzip_test";
+            fs::remove_all(root);
+            fs::create_directories(root);
+            std::string path = (root / "app.log.gz").string();
+            std::string indexPath = (root / "app.gzindex").string();
+            
+            // 两个 gzip 成员首尾相接（gzip -c a >> b 的效果）
+            std::string content;
+            for (int i = 0; i < 60000; i++) {
+                content += "line " + std::to_string(i) + " payload " + std::to_string(i * 7919 % 100003) + "\n";
+            }
+            size_t half = content.find('\n', content.size() / 2) + 1;
+            for (int member = 0; member < 2; member++) {
+                gzFile file = gzopen(path.c_str(), member == 0 ? "wb" : "ab");
+                std::string part = member == 0 ? content.substr(0, half) : content.substr(half);
+                gzwrite(file, part.data(), static_cast<unsigned>(part.size()));
+                gzclose(file);
+            }
+            
+            GzipReader reader;
+            reader.setSpan(64 * 1024);
+            std::string all;
+            bool opened = GzipReader::isGzipFile(path) && reader.open(path, indexPath) && !reader.isIndexComplete();
+            bool decoded = reader.readAll(all) && all == content && reader.isIndexComplete() &&
+                           reader.getUncompressedSize() == content.size() && reader.getLineCount() == 60001 &&
+                           reader.getCheckpointCount() > 10;
+            
+            // 随机读取和按行定位从检查点开始，包括第二个成员中的位置
+            std::string data;
+            bool seeked = true;
+            uint64_t tail = content.size() - 50;
+            for (uint64_t offset : {uint64_t(0), uint64_t(100000), uint64_t(half - 10), tail}) {
+                seeked = seeked && reader.read(offset, 100, data) && data == content.substr(offset, 100);
+            }
+            uint64_t lineOffset = 0;
+            std::string target = "line 45678 ";
+            bool located = reader.findLine(45678, lineOffset) && lineOffset == content.find(target) &&
+                           reader.findLine(60000, lineOffset) && lineOffset == content.size() &&
+                           !reader.findLine(60001, lineOffset);
+            
+            // 再次打开时直接载入缓存的索引
+            GzipReader reopened;
+            bool cached = reopened.open(path, indexPath) && reopened.isIndexComplete() &&
+                          reopened.getCheckpointCount() == reader.getCheckpointCount() &&
+                          reopened.read(300000, 20, data) && data == content.substr(300000, 20);
+            
+            // 后台流式解压
+            std::string streamed;
+            reopened.startStreaming();
+            while (!reopened.isFinished()) {
+                if (reopened.collect(data)) {
+                    streamed += data;
+                }
+            }
+            while (reopened.collect(data)) {
+                streamed += data;
+            }
+            bool streamedOk = streamed == content && !reopened.hasError();
+            
+            // 编辑器以只读方式打开压缩文件
+            Editor editor;
+            bool readOnly = editor.openFile(path) && editor.isReadOnly() && editor.getContentView() == content &&
+                            !editor.saveFile();
+            fs::remove_all(root);
+            return opened && decoded && seeked && located && cached && streamedOk && readOnly;
+        });
+        
+        runTest("Paged Document Bounded Cache And Sparse Index", []() {
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_paged_test.log";
+            std::string content;
+            for (int i = 0; i < 50000; i++) {
+                content += "entry " + std::to_string(i) + (i % 1000 == 999 ? " needle" : "") + " value\n";
+            }
+            content += "needles tail";
+            std::ofstream(path, std::ios::binary) << content;
+            auto lineStart = [&content](size_t line) {
+                size_t offset = 0;
+                for (size_t i = 0; i < line; i++) {
+                    offset = content.find('\n', offset) + 1;
+                }
+                return offset;
+            };
+            
+            // 64KB 上限：8KB 行索引（1024 个采样点），14 个 4KB 块
+            PagedDocument document;
+            bool opened = document.open(path.string(), 64 * 1024, 4096) && document.getBlockCapacity() == 14;
+            // 索引尚未建立时按需扩展
+            std::string text;
+            bool onDemand = document.getLine(42000, text, 100) && text == "entry 42000 value";
+            document.waitForIndex();
+            bool indexed = document.getLineCount() == 50001 && document.getSampleInterval() == 64;
+            bool lines = document.getLine(0, text, 100) && text == "entry 0 value" &&
+                         document.getLine(999, text, 100) && text == "entry 999 needle value" &&
+                         document.getLine(50000, text, 100) && text == "needles tail" &&
+                         document.getLine(12345, text, 5) && text == "entry" && !document.getLine(50001, text, 100);
+            uint64_t offset = 0;
+            bool offsets = document.getLineOffset(31234, offset) && offset == lineStart(31234) &&
+                           document.getLineOfOffset(lineStart(27000) + 3) == 27000 &&
+                           document.getLineOfOffset(content.size()) == 50000;
+            bool bounded = document.getCachedBlockCount() <= document.getBlockCapacity();
+            
+            // 顺序向后翻看时预读后面的块
+            document.read(200 * 4096, 10, text);
+            document.read(201 * 4096, 10, text);
+            document.waitForIdle();
+            bool prefetched = document.isCached(202 * 4096) && document.isCached(204 * 4096) &&
+                              !document.isCached(206 * 4096);
+            
+            // 查找跨越块边界，全字匹配不把 needles 当作 needle
+            TextSearch needle("needle", true, true);
+            size_t second = content.find(" needle", content.find(" needle") + 1) + 1;
+            bool found = document.find(needle, 0, true, offset) && offset == content.find(" needle") + 1 &&
+                         document.find(needle, offset + 1, true, offset) && offset == second &&
+                         document.find(needle, content.size(), false, offset) &&
+                         offset == content.rfind(" needle") + 1 &&
+                         document.find(TextSearch("needles"), 0, true, offset) &&
+                         offset == content.rfind("needles");
+            document.startFind(needle, second, false);
+            document.waitForIdle();
+            bool ready = false;
+            bool background = document.collectFind(ready, offset) && ready && offset == content.find(" needle") + 1;
+            document.close();
+            fs::remove(path);
+            return opened && onDemand && indexed && lines && offsets && bounded && prefetched && found && background;
+        });
+        
+        runTest("Long Line Index Maps Columns", []() {
+            // 一行 20 万字符：ASCII 与三字节的汉字交替，分批追加时批次边界落在字符中间
+            std::string line;
+            for (int i = 0; i < 100000; i++) {
+                line += (i % 7 == 0) ? "\xe4\xb8\xad" : "a";
+                line += (i % 5 == 0) ? "\xe6\x96\x87" : "b";
+            }
+            LongLineIndex index(64);
+            for (size_t position = 0; position < line.size(); position += 1001) {
+                index.append(line.data() + position, std::min<size_t>(1001, line.size() - position));
+            }
+            uint64_t columns = LongLineIndex::countColumns(line.data(), line.size());
+            bool counted = index.getLength() == line.size() && index.getColumnCount() == columns && columns == 200000;
+            // 每段从字符首字节开始，段的列号与从行首数起一致
+            bool segments = index.getSegmentCount() > 1000;
+            for (size_t i = 0; segments && i < index.getSegmentCount(); i += 97) {
+                uint64_t offset = index.getSegmentOffset(i);
+                segments = (static_cast<unsigned char>(line[offset]) & 0xC0) != 0x80 &&
+                           index.getSegmentColumn(i) == LongLineIndex::countColumns(line.data(), offset) &&
+                           index.getSegmentLength(i) >= 64 && index.getSegmentLength(i) <= 66;
+            }
+            // 列号经段定位再在段内跳过，与从行首跳过结果一致
+            bool mapped = true;
+            for (uint64_t column : {0ull, 1ull, 63ull, 12345ull, 150001ull, 199999ull}) {
+                size_t segment = index.findSegmentByColumn(column);
+                uint64_t offset = index.getSegmentOffset(segment);
+                size_t skip = LongLineIndex::skipColumns(line.data() + offset, line.size() - offset,
+                                                         column - index.getSegmentColumn(segment));
+                mapped = mapped && offset + skip == LongLineIndex::skipColumns(line.data(), line.size(), column) &&
+                         index.findSegmentByOffset(offset + skip) == segment;
+            }
+            
+            // 打开前的超长行检查，以及不复制的行视图
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_long_line_test.json";
+            std::ofstream(path, std::ios::binary) << "{\n" << line << "\n}\n";
+            auto editor = std::make_unique<Editor>();
+            bool opened = editor->openFile(path.string());
+            bool detected = LongLineIndex::hasLineLongerThan(editor->getContentView(), 100000) &&
+                            !LongLineIndex::hasLineLongerThan(editor->getContentView(), line.size());
+            bool viewed = opened && editor->getLineView(2).data() ==
+                          editor->getContentView().data() + 2 && editor->getLineView(2) == line &&
+                          editor->getLineView(3) == "}" && editor->getLineView(9).empty();
+            fs::remove(path);
+            return counted && segments && mapped && detected && viewed;
+        });
+        
+        runTest("Log Merger Interleaves Sources By Timestamp", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_merge_test";
+            fs::remove_all(root);
+            fs::create_directories(root);
+            // 三个来源的秒数交错，有相同的时刻，也有沿用上一行时间的续行
+            struct Expected { int64_t time; size_t source; uint64_t line; std::string text; };
+            std::vector<Expected> expected;
+            std::vector<std::string> paths;
+            for (size_t source = 0; source < 3; source++) {
+                std::string content;
+                uint64_t line = 0;
+                for (int i = 0; i < 3000; i++) {
+                    int second = i * 3 + static_cast<int>(source) * (i % 2);
+                    char stamp[32];
+                    std::snprintf(stamp, sizeof(stamp), "2024-03-05 %02d:%02d:%02d", 10 + second / 3600,
+                                  second / 60 % 60, second % 60);
+                    std::string text = std::string(stamp) + " s" + std::to_string(source) + " #" + std::to_string(i);
+                    int64_t time = TimestampIndex::toMilliseconds(2024, 3, 5, 10 + second / 3600, second / 60 % 60,
+                                                                  second % 60, 0);
+                    content += text + "\n";
+                    expected.push_back({time, source, line++, text});
+                    if (i % 10 == static_cast<int>(source)) {
+                        content += "    at frame " + std::to_string(i) + "\n";
+                        expected.push_back({time, source, line++, "    at frame " + std::to_string(i)});
+                    }
+                }
+                paths.push_back((root / ("s" + std::to_string(source) + ".log")).string());
+                std::ofstream(paths.back(), std::ios::binary) << content;
+            }
+            std::sort(expected.begin(), expected.end(), [](const Expected& a, const Expected& b) {
+                return std::tie(a.time, a.source, a.line) < std::tie(b.time, b.source, b.line);
+            });
+            auto matches = [&expected](const std::vector<MergedLine>& lines, uint64_t row) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    const Expected& want = expected[row + i];
+                    if (lines[i].source != want.source || lines[i].line != want.line || lines[i].text != want.text) {
+                        return false;
+                    }
+                }
+                return !lines.empty();
+            };
+            
+            // 逐行移动（翻页）与按时间二分定位（随机跳转）得到同样的顺序
+            LogMerger stepping;
+            LogMerger seeking(0);
+            bool opened = true;
+            for (const std::string& path : paths) {
+                opened = opened && stepping.addSource(path, 1 << 20) && seeking.addSource(path, 1 << 20);
+            }
+            stepping.waitForIndex();
+            seeking.waitForIndex();
+            bool counted = opened && stepping.getLineCount() == expected.size() &&
+                           stepping.getSourceFormat(2) == TimestampFormat::Iso8601;
+            std::vector<MergedLine> lines;
+            bool paged = true;
+            for (uint64_t row = 0; paged && row < expected.size(); row += 40) {
+                paged = stepping.getLines(row, 40, lines, 256) && matches(lines, row);
+            }
+            bool backward = stepping.getLines(5000, 30, lines, 256) && matches(lines, 5000) &&
+                            stepping.getLines(4950, 30, lines, 256) && matches(lines, 4950);
+            bool jumped = true;
+            uint64_t last = expected.size() - 3;
+            for (uint64_t row : {uint64_t(0), uint64_t(1), uint64_t(777), uint64_t(4500), uint64_t(8999), last}) {
+                jumped = jumped && seeking.getLines(row, 10, lines, 256) && matches(lines, row);
+            }
+            bool bounded = !seeking.getLines(expected.size(), 10, lines, 256) &&
+                           seeking.getLines(expected.size() - 2, 10, lines, 256) && lines.size() == 2;
+            stepping.clear();
+            seeking.clear();
+            fs::remove_all(root);
+            return counted && paged && backward && jumped && bounded;
+        });
+        
+        runTest("Encoding Detector Classifies Content", []() {
+            auto detect = [](const std::string& text, size_t sample = EncodingDetector::kDefaultSampleBytes) {
+                return EncodingDetector::detect(text.data(), text.size(), sample);
+            };
+            DetectedEncoding bom = detect("\xEF\xBB\xBFhi");
+            bool boms = bom.encoding == TextEncoding::Utf8 && bom.bomLength == 3 &&
+                        detect(std::string("\xFF\xFEh\0i\0", 6)).encoding == TextEncoding::Utf16LE &&
+                        detect(std::string("\xFE\xFF\0h\0i", 6)).encoding == TextEncoding::Utf16BE;
+            bool utf16 = detect(std::string("l\0o\0g\0 \0o\0k\0\n\0", 14)).encoding == TextEncoding::Utf16LE &&
+                         detect(std::string("\0l\0o\0g\0 \0o\0k\0\n", 14)).encoding == TextEncoding::Utf16BE &&
+                         detect(std::string("\x7F" "ELF\x02\x01\x01\0\0\0\0\0\0\0\0\0\x02\0\x3E\0", 20)).encoding ==
+                             TextEncoding::Binary;
+            // 足够长的混合内容让 UTF-8 验证走过向量化的整块路径和尾部
+            std::string utf8;
+            for (int i = 0; i < 200; i++) {
+                utf8 += "2024-03-05 INFO 用户登录成功 naïve café 😀 line " + std::to_string(i) + "\n";
+            }
+            std::string ascii(1000, 'a');
+            bool unicode = detect(ascii).encoding == TextEncoding::Ascii &&
+                           detect(utf8).encoding == TextEncoding::Utf8 &&
+                           EncodingDetector::isValidUtf8(utf8.data(), utf8.size()) &&
+                           !EncodingDetector::isValidUtf8((utf8 + "\xED\xA0\x80").data(), utf8.size() + 3) &&
+                           !EncodingDetector::isValidUtf8((utf8 + "\xC0\xAF").data(), utf8.size() + 2) &&
+                           !EncodingDetector::isValidUtf8((utf8 + "\xF4\x90\x80\x80").data(), utf8.size() + 4) &&
+                           !EncodingDetector::isValidUtf8(utf8.data(), utf8.find("用") + 1);
+            // 多字节字符与各类错误从每个偏移开始，跨过 32 字节块的边界
+            bool boundaries = true;
+            const std::string valid = "é中😀ßк";
+            for (size_t shift = 0; shift < 70; shift++) {
+                std::string padding(shift, 'a');
+                std::string text = padding + valid + valid + padding;
+                boundaries = boundaries && EncodingDetector::isValidUtf8(text.data(), text.size());
+                for (const char* broken : {"\xE4\xB8", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80",
+                                           "\xF0\x9F\x98", "\xC3\xA9\xA9"}) {
+                    std::string bad = padding + broken + valid + padding;
+                    std::string end = valid + padding + broken;
+                    boundaries = boundaries && !EncodingDetector::isValidUtf8(bad.data(), bad.size()) &&
+                                 !EncodingDetector::isValidUtf8(end.data(), end.size());
+                }
+            }
+            
+            // 只检查开头时截断在字符中间不算错误
+            DetectedEncoding sampled = detect(utf8, utf8.find("登") + 1);
+            bool prefix = sampled.encoding == TextEncoding::Utf8 && sampled.sampled;
+            // GBK 的“中文日志”与 Windows-1252 的“café naïve”
+            std::string gbk;
+            for (int i = 0; i < 50; i++) {
+                gbk += "2024-03-05 \xD6\xD0\xCE\xC4\xC8\xD5\xD6\xBE ok\n";
+            }
+            bool legacy = detect(gbk).encoding == TextEncoding::Gb18030 &&
+                          detect("caf\xE9 na\xEFve r\xE9sum\xE9\n").encoding == TextEncoding::Windows1252;
+            
+            // 打开不是 UTF-8 的文件时记录编码，内容转换为 UTF-8
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_encoding_test.log";
+            std::ofstream(path, std::ios::binary) << gbk;
+            auto editor = std::make_unique<Editor>();
+            bool opened = editor->openFile(path.string()) && editor->isTranscoded() &&
+                          editor->getEncoding().encoding == TextEncoding::Gb18030 &&
+                          editor->getContent().find("中文日志") != std::string::npos;
+            std::ofstream(path, std::ios::binary) << utf8;
+            opened = opened && editor->openFile(path.string()) && !editor->isReadOnly() &&
+                     editor->getEncoding().encoding == TextEncoding::Utf8;
+            // 超出检测范围后才出现的无效字节：整份验证后只读，内容保持原样
+            std::string tail = utf8 + std::string(EncodingDetector::kDefaultSampleBytes, 'a') + "\xFF\n";
+            std::ofstream(path, std::ios::binary) << tail;
+            opened = opened && editor->openFile(path.string()) && editor->isReadOnly() &&
+                     !editor->isTranscoded() && !editor->getEncoding().isUtf8Compatible() &&
+                     editor->getContentView() == tail;
+            fs::remove(path);
+            return boms && utf16 && unicode && boundaries && prefix && legacy && opened;
+        });
+        
+        runTest("Transcoder Round Trips Legacy Encodings", []() {
+            // 任意位置分段解码再分段编码，结果与一次转换相同，编码回去与原内容逐字节相同
+            auto roundTrip = [](TextEncoding encoding, const std::string& original, const std::string& expected) {
+                for (size_t split = 0; split <= original.size(); split++) {
+                    Transcoder decoder(encoding);
+                    std::string utf8;
+                    if (!decoder.decode(original.data(), split, utf8, false) ||
+                        !decoder.decode(original.data() + split, original.size() - split, utf8, true) ||
+                        utf8 != expected) {
+                        return false;
+                    }
+                    Transcoder encoder(encoding);
+                    std::string back;
+                    size_t cut = std::min(split, utf8.size());
+                    if (!encoder.encode(utf8.data(), cut, back, false) ||
+                        !encoder.encode(utf8.data() + cut, utf8.size() - cut, back, true) || back != original) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            // GBK 双字节与 GB18030 四字节（BMP 中的 U+00B5、U+1800 和 BMP 以外的 U+1F600）
+            std::string gb = "log \xD6\xD0\xCE\xC4 caf\xA8\xA6 \xA2\xE3 \x81\x30\x85\x38 \x81\x34\xD2\x38 "
+                             "\x94\x39\xFC\x36 end";
+            std::string gbUtf8 = "log 中文 café € µ ᠀ 😀 end";
+            // UTF-16 的 ASCII 足够长，走过向量化的整段路径
+            std::string text = std::string(40, 'a') + "中文 😀 naïve";
+            std::string le;
+            std::string be;
+            for (size_t i = 0; i < text.size();) {
+                uint32_t codePoint = 0;
+                i += UnicodeText::decode(text.data() + i, text.size() - i, codePoint);
+                std::vector<uint32_t> units;
+                if (codePoint >= 0x10000) {
+                    units = {0xD800 + ((codePoint - 0x10000) >> 10), 0xDC00 + ((codePoint - 0x10000) & 0x3FF)};
+                } else {
+                    units = {codePoint};
+                }
+                for (uint32_t unit : units) {
+                    le += static_cast<char>(unit & 0xFF);
+                    le += static_cast<char>(unit >> 8);
+                    be += static_cast<char>(unit >> 8);
+                    be += static_cast<char>(unit & 0xFF);
+                }
+            }
+            bool trips = roundTrip(TextEncoding::Gb18030, gb, gbUtf8) && roundTrip(TextEncoding::Utf16LE, le, text) &&
+                         roundTrip(TextEncoding::Utf16BE, be, text) &&
+                         roundTrip(TextEncoding::Windows1252, "caf\xE9 \x80 \x9F\x81", "café € Ÿ\xC2\x81");
+            
+            // 无效内容与无法表示的字符报告错误
+            std::string output;
+            bool invalid = !Transcoder(TextEncoding::Utf16LE).decode("\x00\xDC", 2, output, true) &&
+                           !Transcoder(TextEncoding::Utf16LE).decode("a\x00\x00", 3, output, true) &&
+                           !Transcoder(TextEncoding::Gb18030).decode("\x81\x20", 2, output, true) &&
+                           !Transcoder(TextEncoding::Gb18030).decode("\xD6", 1, output, true) &&
+                           !Transcoder(TextEncoding::Windows1252).encode("中", 3, output, true);
+            
+            // 打开时转换为 UTF-8 可以编辑，保存时按原编码和字节顺序标记写回
+            namespace fs = std::filesystem;
+            fs::path path = fs::temp_directory_path() / "litepad_transcoder_test.txt";
+            std::string bomLe = "\xFF\xFE" + le;
+            std::ofstream(path, std::ios::binary) << bomLe;
+            auto editor = std::make_unique<Editor>();
+            bool saved = editor->openFile(path.string()) && !editor->isReadOnly() && editor->isTranscoded() &&
+                         editor->getContent() == text && editor->saveFile("");
+            std::ifstream reread(path, std::ios::binary);
+            std::string written((std::istreambuf_iterator<char>(reread)), std::istreambuf_iterator<char>());
+            reread.close();
+            saved = saved && written == bomLe;
+            // 无法解码的内容（孤立的代理码元）保持原样只读
+            std::string broken = bomLe + std::string("\x00\xDC", 2);
+            std::ofstream(path, std::ios::binary) << broken;
+            bool fallback = editor->openFile(path.string()) && editor->isReadOnly() && !editor->isTranscoded() &&
+                            editor->getContent() == broken;
+            // 文本视图显示的替换字符副本不会写回只读文档
+            editor->setContent("\xEF\xBF\xBD");
+            fallback = fallback && editor->getContent() == broken && !editor->isModified();
+            fs::remove(path);
+            return trips && invalid && saved && fallback;
+        });
+        
+        runTest("Atomic File Writer Keeps Links And Permissions", []() {
+            namespace fs = std::filesystem;
+            fs::path root = fs::temp_directory_path() / "litepad_atomic_test";
+            fs::remove_all(root);
+            fs::create_directories(root);
+            auto readAll = [](const fs::path& path) {
+                std::ifstream stream(path, std::ios::binary);
+                return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            };
+            fs::path real = root / "real.txt";
+            fs::path link = root / "link.txt";
+            fs::path hard = root / "hard.txt";
+            std::ofstream(real, std::ios::binary) << "\xD6\xD0\xCE\xC4\n";
+            fs::perms mode = fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read;
+            fs::permissions(real, mode);
+            fs::create_symlink(real.filename(), link);
+            DetectedEncoding gbk;
+            gbk.encoding = TextEncoding::Gb18030;
+            
+            // 经符号链接保存：链接保留，写入的是它指向的文件，权限不变
+            bool symlinked = Transcoder::encodeFile(link.string(), gbk, "中文日志\n") && fs::is_symlink(link) &&
+                             readAll(real) == "\xD6\xD0\xCE\xC4\xC8\xD5\xD6\xBE\n" &&
+                             fs::status(real).permissions() == mode;
+            // 有硬链接时写回原文件，两个名字仍指向同一内容
+            fs::create_hard_link(real, hard);
+            bool linked = Transcoder::encodeFile(hard.string(), gbk, "中\n") && fs::hard_link_count(real) == 2 &&
+                          readAll(real) == "\xD6\xD0\n" && readAll(hard) == "\xD6\xD0\n";
+            // 编码失败时原文件不变，新文件不会留下
+            DetectedEncoding latin;
+            latin.encoding = TextEncoding::Windows1252;
+            bool kept = !Transcoder::encodeFile(real.string(), latin, "中") && readAll(real) == "\xD6\xD0\n" &&
+                        !Transcoder::encodeFile((root / "new.txt").string(), latin, "中") &&
+                        Transcoder::encodeFile((root / "other.txt").string(), latin, "caf\xC3\xA9") &&
+                        readAll(root / "other.txt") == "caf\xE9";
+            // 不留下临时文件
+            size_t fileCount =
+                static_cast<size_t>(std::distance(fs::directory_iterator(root), fs::directory_iterator()));
+            fs::remove_all(root);
+            return symlinked && linked && kept && fileCount == 4;
+        });
+    }
 };
 
 /**